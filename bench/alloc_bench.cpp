@@ -0,0 +1,132 @@
+#include "bench_device.h"
+#include "memory/device_allocator.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const uint32_t ITERATIONS = 20000;
+const uint32_t LIVE_ALLOCATIONS = 256;
+
+typedef struct BenchResult {
+    double seconds;
+    uint32_t operations;
+} BenchResult;
+
+static void print_result(const char* name, const BenchResult& result) {
+    std::cout << name << ": " << result.operations << " alloc+free in " << result.seconds * 1000.0 << " ms, "
+              << result.seconds * 1e9 / result.operations << " ns/op, "
+              << result.operations / result.seconds << " ops/s\n";
+}
+
+// Same size stream for both paths: LIVE_ALLOCATIONS live at a time, random slot replaced per iteration
+static std::vector<VkDeviceSize> make_sizes(uint32_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> pages(1, 256);
+
+    std::vector<VkDeviceSize> sizes(count);
+    for (auto& size : sizes) {
+        size = pages(rng) * 4096ull;
+    }
+    return sizes;
+}
+
+static BenchResult bench_raw(const BenchDevice& bench, uint32_t memory_type, const std::vector<VkDeviceSize>& sizes) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<VkDeviceMemory> live(LIVE_ALLOCATIONS, VK_NULL_HANDLE);
+    std::mt19937 rng(99);
+
+    auto start = clock::now();
+    for (uint32_t i = 0; i < sizes.size(); i++) {
+        uint32_t slot = rng() % LIVE_ALLOCATIONS;
+        if (live[slot] != VK_NULL_HANDLE) {
+            vkFreeMemory(bench.device, live[slot], nullptr);
+        }
+
+        VkMemoryAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = sizes[i],
+            .memoryTypeIndex = memory_type,
+        };
+
+        if (vkAllocateMemory(bench.device, &alloc_info, nullptr, &live[slot]) != VK_SUCCESS) {
+            throw std::runtime_error("vkAllocateMemory failed");
+        }
+    }
+
+    for (auto memory : live) {
+        if (memory != VK_NULL_HANDLE) {
+            vkFreeMemory(bench.device, memory, nullptr);
+        }
+    }
+    auto end = clock::now();
+
+    return { std::chrono::duration<double>(end - start).count(), (uint32_t)sizes.size() };
+}
+
+static BenchResult bench_allocator(DeviceAllocator& allocator, uint32_t memory_type, const std::vector<VkDeviceSize>& sizes) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<Allocation> live(LIVE_ALLOCATIONS);
+    std::mt19937 rng(99);
+
+    auto start = clock::now();
+    for (uint32_t i = 0; i < sizes.size(); i++) {
+        uint32_t slot = rng() % LIVE_ALLOCATIONS;
+        allocator.free(live[slot]);
+
+        VkMemoryRequirements requirements = {
+            .size = sizes[i],
+            .alignment = 256,
+            .memoryTypeBits = 1u << memory_type,
+        };
+        live[slot] = allocator.allocate(requirements, 0, AllocationKind::Linear);
+    }
+
+    AllocatorStats stats = allocator.stats();
+
+    for (auto& allocation : live) {
+        allocator.free(allocation);
+    }
+    auto end = clock::now();
+
+    std::cout << "allocator stats at peak: " << stats.used_bytes << " / " << stats.reserved_bytes << " bytes, "
+              << stats.allocation_count << " allocations in " << stats.device_allocation_count << " blocks, fragmentation "
+              << stats.fragmentation << "\n";
+
+    return { std::chrono::duration<double>(end - start).count(), (uint32_t)sizes.size() };
+}
+
+int main() {
+    try {
+        BenchDevice bench = create_bench_device();
+
+        VkPhysicalDeviceMemoryProperties memory_properties;
+        vkGetPhysicalDeviceMemoryProperties(bench.physical_device, &memory_properties);
+
+        uint32_t memory_type = 0;
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+            if (memory_properties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+                memory_type = i;
+                break;
+            }
+        }
+
+        std::vector<VkDeviceSize> sizes = make_sizes(ITERATIONS);
+
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+            print_result("DeviceAllocator", bench_allocator(allocator, memory_type, sizes));
+        }
+        print_result("vkAllocateMemory", bench_raw(bench, memory_type, sizes));
+
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "bench_device.h"
+#include "assets/asset_baker.h"
+#include "assets/asset_pack.h"
+#include "assets/asset_streamer.h"
+#include "memory/device_allocator.h"
+#include "transfer/upload_manager.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint32_t FRAME_COUNT = 2;
+const float VISIBLE_PRIORITY = 1.0f;
+const float HIDDEN_PRIORITY = 0.0f;
+
+typedef struct AssetBenchConfig {
+    std::string pack_path = "asset_bench.pak";
+    uint32_t meshes = 32;
+    // Per mesh
+    uint32_t vertices = 65536;
+    uint32_t textures = 32;
+    uint32_t texture_size = 1024;
+    VkFormat texture_format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    // Every nth asset gets the visible priority
+    uint32_t visible_every = 4;
+} AssetBenchConfig;
+
+typedef struct LoadResult {
+    double open_ms = 0.0;
+    double visible_ms = 0.0;
+    double total_ms = 0.0;
+    double io_ms = 0.0;
+    uint64_t bytes = 0;
+} LoadResult;
+
+// Bumpy UV sphere, roughly vertex_count vertices
+static void build_sphere(uint32_t vertex_count, uint32_t seed, std::vector<AssetVertex>& vertices, std::vector<uint32_t>& indices) {
+    uint32_t rings = std::max((uint32_t)std::sqrt((double)vertex_count / 2.0), 2u);
+    uint32_t segments = rings * 2;
+    const float pi = 3.14159265358979f;
+
+    vertices.clear();
+    indices.clear();
+    for (uint32_t ring = 0; ring <= rings; ring++) {
+        float theta = pi * (float)ring / (float)rings;
+        for (uint32_t segment = 0; segment <= segments; segment++) {
+            float phi = 2.0f * pi * (float)segment / (float)segments;
+            float normal[3] = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            float radius = 1.0f + 0.05f * std::sin((float)seed + theta * 7.0f) * std::cos(phi * 5.0f);
+
+            AssetVertex vertex = {
+                .position = {normal[0] * radius, normal[1] * radius, normal[2] * radius},
+                .normal = {normal[0], normal[1], normal[2]},
+                .uv = {(float)segment / (float)segments, (float)ring / (float)rings},
+            };
+            vertices.push_back(vertex);
+        }
+    }
+
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + segments + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+}
+
+// Smooth gradients with a checker on top, so BC1 has both easy and hard blocks
+static std::vector<uint8_t> build_texture(uint32_t size, uint32_t seed) {
+    std::vector<uint8_t> rgba((size_t)size * size * 4);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            bool checker = ((x / 32) + (y / 32) + seed) % 2 == 0;
+            uint8_t* texel = &rgba[((size_t)y * size + x) * 4];
+            texel[0] = (uint8_t)((x * 255 / size + seed * 40) % 256);
+            texel[1] = (uint8_t)((y * 255 / size + seed * 90) % 256);
+            texel[2] = checker ? 220 : 40;
+            texel[3] = 255;
+        }
+    }
+    return rgba;
+}
+
+static void bake_pack(const AssetBenchConfig& config) {
+    auto start = std::chrono::steady_clock::now();
+
+    AssetBaker baker;
+    std::vector<AssetVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<AssetMaterial> materials;
+
+    for (uint32_t i = 0; i < config.textures; i++) {
+        TextureBakeOptions options = {.format = config.texture_format, .mips = true};
+        uint32_t texture = baker.add_texture("texture" + std::to_string(i), config.texture_size, config.texture_size,
+                                             build_texture(config.texture_size, i), options);
+        materials.push_back({
+            .base_color = {1.0f, 1.0f, 1.0f, 1.0f},
+            .base_color_texture = texture,
+            .roughness = 0.5f,
+            .metallic = 0.0f,
+            .padding = 0,
+        });
+    }
+
+    for (uint32_t i = 0; i < config.meshes; i++) {
+        build_sphere(config.vertices, i, vertices, indices);
+        baker.add_mesh("mesh" + std::to_string(i), vertices, indices);
+    }
+
+    baker.add_materials("materials", materials);
+    baker.write(config.pack_path);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Baked " << config.pack_path << ": " << baker.asset_count() << " assets, " << baker.payload_bytes() / (1024 * 1024)
+              << " MiB in " << ms << " ms\n";
+}
+
+// Opens the pack and streams every asset to the GPU, the visible ones at a higher priority.
+// visible_ms ends when the last visible asset's upload has completed on the GPU, total_ms when
+// everything has.
+static LoadResult load_pack(const BenchDevice& bench, DeviceAllocator& allocator, const AssetBenchConfig& config) {
+    using clock = std::chrono::steady_clock;
+    auto ms_since = [](clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    LoadResult result;
+    auto start = clock::now();
+
+    AssetPack pack(config.pack_path);
+    result.open_ms = ms_since(start);
+
+    // upload_bench covers the dedicated transfer queue; this measures the I/O side
+    UploadQueues queues = {
+        .transfer_queue = bench.queue,
+        .transfer_family = bench.queue_family,
+        .graphics_family = bench.queue_family,
+    };
+
+    UploadManager uploads(bench.device, allocator, queues, FRAME_COUNT);
+    {
+        AssetStreamer streamer(bench.physical_device, bench.device, allocator, pack);
+
+        std::vector<uint32_t> visible;
+        for (uint32_t i = 0; i < pack.asset_count(); i++) {
+            bool is_visible = i % config.visible_every == 0 || pack.asset(i).kind == AssetKind::Material;
+            streamer.request(i, is_visible ? VISIBLE_PRIORITY : HIDDEN_PRIORITY);
+            if (is_visible) {
+                visible.push_back(i);
+            }
+        }
+
+        VkSemaphore timeline = uploads.timeline();
+        uint64_t visible_value = 0;
+        uint64_t last_value = 0;
+        bool done = false;
+
+        for (uint64_t frame_number = 0; !done; frame_number++) {
+            uploads.begin_frame(frame_number % FRAME_COUNT);
+            done = streamer.stream(uploads);
+
+            uint64_t value = uploads.flush();
+            last_value = value > 0 ? value : last_value;
+
+            if (visible_value == 0) {
+                bool visible_queued = true;
+                for (uint32_t asset : visible) {
+                    visible_queued &= streamer.is_resident(asset);
+                }
+                visible_value = visible_queued ? last_value : 0;
+            }
+
+            if (visible_value > 0 && result.visible_ms == 0.0) {
+                uint64_t completed;
+                vkGetSemaphoreCounterValue(bench.device, timeline, &completed);
+                if (completed >= visible_value) {
+                    result.visible_ms = ms_since(start);
+                }
+            }
+
+            // Nothing prefetched yet; give the I/O thread the core
+            if (value == 0 && !done) {
+                std::this_thread::yield();
+            }
+        }
+
+        uploads.wait_idle();
+        result.total_ms = ms_since(start);
+        if (result.visible_ms == 0.0) {
+            result.visible_ms = result.total_ms;
+        }
+
+        AssetStreamerStats stats = streamer.stats();
+        result.io_ms = stats.io_ms;
+        result.bytes = stats.bytes_uploaded;
+    }
+
+    return result;
+}
+
+static void print_result(const char* name, const LoadResult& result) {
+    std::cout << name << ": open " << result.open_ms << " ms, visible " << result.visible_ms << " ms, all " << result.total_ms
+              << " ms, " << (double)result.bytes / (1024.0 * 1024.0) / (result.total_ms / 1000.0) << " MiB/s, "
+              << result.io_ms << " ms of I/O thread faulting\n";
+}
+
+int main(int argc, char** argv) {
+    AssetBenchConfig config;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "--pack" && i + 1 < argc) {
+                config.pack_path = argv[++i];
+            } else if (arg == "--meshes" && i + 1 < argc) {
+                config.meshes = (uint32_t)std::stoul(argv[++i]);
+            } else if (arg == "--vertices" && i + 1 < argc) {
+                config.vertices = (uint32_t)std::stoul(argv[++i]);
+            } else if (arg == "--textures" && i + 1 < argc) {
+                config.textures = (uint32_t)std::stoul(argv[++i]);
+            } else if (arg == "--texture-size" && i + 1 < argc) {
+                config.texture_size = (uint32_t)std::stoul(argv[++i]);
+            } else if (arg == "--rgba8") {
+                config.texture_format = VK_FORMAT_R8G8B8A8_UNORM;
+            } else if (arg == "--visible-every" && i + 1 < argc) {
+                config.visible_every = std::max((uint32_t)std::stoul(argv[++i]), 1u);
+            } else {
+                throw std::runtime_error("Unknown argument: " + arg);
+            }
+        }
+
+        bake_pack(config);
+
+        BenchDevice bench = create_bench_device();
+
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+
+            // Cold: the pack was just written, so flush it and drop it from the page cache
+            if (AssetPack::drop_page_cache(config.pack_path)) {
+                print_result("cold page cache", load_pack(bench, allocator, config));
+            } else {
+                std::cout << "Can't drop the page cache on this platform, skipping the cold run\n";
+            }
+
+            // Warm: the cold run (or this first load) left every page cached
+            load_pack(bench, allocator, config);
+            print_result("warm page cache", load_pack(bench, allocator, config));
+        }
+
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
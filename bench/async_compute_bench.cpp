@@ -0,0 +1,221 @@
+#include "bench_device.h"
+#include "compute/image_filter.h"
+#include "descriptor/bindless_table.h"
+#include "memory/device_allocator.h"
+#include "pipeline/pipeline_cache.h"
+#include "pipeline/shader_library.h"
+#include "render/render_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const uint32_t FRAME_COUNT = 2;
+const uint32_t WARMUP_FRAMES = 10;
+
+// Each frame is a graphics pass that clears a large target over and over (standing in for raster
+// work) and an independent compute pass running the image filter over a large buffer. Without a
+// compute queue both run back to back on the graphics queue; with one the graph puts the filter on
+// it and the two overlap, synchronised by the graph's timeline semaphores.
+typedef struct AsyncBenchConfig {
+    uint32_t frames = 200;
+    VkExtent2D target_extent = {2048, 2048};
+    uint32_t clears = 16;
+    uint32_t filter_pixels = 8u * 1024 * 1024;
+    uint32_t filter_passes = 4;
+} AsyncBenchConfig;
+
+typedef struct AsyncBenchResult {
+    double frame_ms = 0.0;
+} AsyncBenchResult;
+
+static AsyncBenchResult run_frames(const BenchDevice& bench, DeviceAllocator& allocator, PipelineCache& pipelines,
+                                   const RenderGraphQueues& queues, const AsyncBenchConfig& config) {
+    using clock = std::chrono::steady_clock;
+
+    ShaderLibraryConfig shader_config = {
+        .frames_in_flight = FRAME_COUNT,
+    };
+
+    BindlessTable table(bench.physical_device, bench.device, FRAME_COUNT);
+    ShaderLibrary shaders(bench.device, pipelines, shader_config);
+    ImageFilter filter(shaders, table);
+
+    // Only ever touched by the compute queue, so it needs no concurrent sharing
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = (VkDeviceSize)config.filter_pixels * sizeof(uint32_t),
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VkBuffer pixels;
+    if (vkCreateBuffer(bench.device, &buffer_info, nullptr, &pixels) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create filter buffer");
+    }
+    Allocation pixels_memory = allocator.allocate_buffer(pixels, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    uint32_t pixels_slot = table.add_storage_buffer(pixels);
+    table.flush();
+
+    AsyncBenchResult result;
+    {
+        RenderGraph graph(bench.device, allocator, queues, FRAME_COUNT);
+
+        ResourceHandle target = graph.create_image("raster target", VK_FORMAT_R8G8B8A8_UNORM, config.target_extent);
+        graph.mark_output(target);
+
+        PassHandle raster = graph.add_pass("raster stand-in", RenderQueue::Graphics, [&](VkCommandBuffer command_buffer) {
+            VkImageSubresourceRange range = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            };
+
+            for (uint32_t i = 0; i < config.clears; i++) {
+                VkClearColorValue color = {{(float)i / (float)config.clears, 0.0f, 0.0f, 1.0f}};
+                vkCmdClearColorImage(command_buffer, graph.image(target), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &range);
+            }
+        });
+        graph.write(raster, target, ResourceUsage::TransferDst);
+
+        ResourceState idle = {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+        ResourceHandle filtered = graph.import_buffer("filter pixels", pixels, idle, idle);
+
+        PassHandle post = graph.add_pass("image filter", RenderQueue::Compute, [&](VkCommandBuffer command_buffer) {
+            VkMemoryBarrier2 between = {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+                .srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+            };
+
+            VkDependencyInfo dependency_info = {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .memoryBarrierCount = 1,
+                .pMemoryBarriers = &between,
+            };
+
+            for (uint32_t i = 0; i < config.filter_passes; i++) {
+                if (i > 0) {
+                    vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+                }
+                filter.record(command_buffer, pixels_slot, pixels_slot, config.filter_pixels, 1.01f);
+            }
+        });
+        graph.read(post, filtered, ResourceUsage::StorageWrite);
+        graph.write(post, filtered, ResourceUsage::StorageWrite);
+
+        graph.compile();
+
+        std::vector<VkFence> fences(FRAME_COUNT);
+        for (auto& fence : fences) {
+            VkFenceCreateInfo fence_info = {
+                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+            };
+            vkCreateFence(bench.device, &fence_info, nullptr, &fence);
+        }
+
+        clock::time_point start;
+        for (uint32_t frame = 0; frame < WARMUP_FRAMES + config.frames; frame++) {
+            if (frame == WARMUP_FRAMES) {
+                vkDeviceWaitIdle(bench.device);
+                start = clock::now();
+            }
+
+            uint32_t frame_index = frame % FRAME_COUNT;
+            vkWaitForFences(bench.device, 1, &fences[frame_index], VK_TRUE, UINT64_MAX);
+            vkResetFences(bench.device, 1, &fences[frame_index]);
+
+            RenderGraphExecuteInfo info = {
+                .frame_index = frame_index,
+                .fence = fences[frame_index],
+            };
+            graph.execute(info);
+        }
+
+        vkDeviceWaitIdle(bench.device);
+        result.frame_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count() / config.frames;
+
+        for (auto fence : fences) {
+            vkDestroyFence(bench.device, fence, nullptr);
+        }
+    }
+
+    table.release(BindlessKind::StorageBuffer, pixels_slot);
+    vkDestroyBuffer(bench.device, pixels, nullptr);
+    allocator.free(pixels_memory);
+
+    return result;
+}
+
+static void print_result(const char* name, const AsyncBenchResult& result, const AsyncBenchConfig& config) {
+    double filtered_mp = (double)config.filter_pixels * config.filter_passes / 1e6;
+    std::cout << name << ": " << result.frame_ms << " ms/frame, " << 1000.0 / result.frame_ms << " frames/s, filter "
+              << filtered_mp / (result.frame_ms / 1000.0) << " MP/s alongside " << config.clears << " clears of "
+              << config.target_extent.width << "x" << config.target_extent.height << "\n";
+}
+
+int main(int argc, char** argv) {
+    AsyncBenchConfig config;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "--frames" && i + 1 < argc) {
+                config.frames = std::max((uint32_t)std::stoul(argv[++i]), 1u);
+            } else if (arg == "--clears" && i + 1 < argc) {
+                config.clears = (uint32_t)std::stoul(argv[++i]);
+            } else if (arg == "--pixels" && i + 1 < argc) {
+                config.filter_pixels = std::max((uint32_t)std::stoul(argv[++i]), 1u);
+            } else if (arg == "--filter-passes" && i + 1 < argc) {
+                config.filter_passes = (uint32_t)std::stoul(argv[++i]);
+            } else {
+                throw std::runtime_error("Unknown argument: " + arg);
+            }
+        }
+
+        BenchDevice bench = create_bench_device();
+
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+            PipelineCache pipelines(bench.physical_device, bench.device, "");
+
+            RenderGraphQueues overlap_off = {
+                .graphics_queue = bench.queue,
+                .graphics_family = bench.queue_family,
+                .compute_queue = bench.queue,
+                .compute_family = bench.queue_family,
+            };
+            AsyncBenchResult serial = run_frames(bench, allocator, pipelines, overlap_off, config);
+            print_result("overlap off (graphics queue only)", serial, config);
+
+            if (bench.compute_family != bench.queue_family) {
+                RenderGraphQueues overlap_on = {
+                    .graphics_queue = bench.queue,
+                    .graphics_family = bench.queue_family,
+                    .compute_queue = bench.compute_queue,
+                    .compute_family = bench.compute_family,
+                };
+                AsyncBenchResult overlapped = run_frames(bench, allocator, pipelines, overlap_on, config);
+                print_result("overlap on (async compute queue)", overlapped, config);
+                std::cout << "overlap speedup " << serial.frame_ms / overlapped.frame_ms << "x\n";
+            } else {
+                std::cout << "No dedicated compute family on this device, skipping the overlapped run\n";
+            }
+        }
+
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// Minimal windowless instance + device for benchmarks; picks the first device (lavapipe on CI)
+typedef struct BenchDevice {
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queue_family = 0;
+    // Separate transfer family when the device has one, otherwise the graphics queue
+    VkQueue transfer_queue = VK_NULL_HANDLE;
+    uint32_t transfer_family = 0;
+    // Compute family without graphics when the device has one, otherwise the graphics queue
+    VkQueue compute_queue = VK_NULL_HANDLE;
+    uint32_t compute_family = 0;
+} BenchDevice;
+
+inline BenchDevice create_bench_device() {
+    BenchDevice bench;
+
+    VkApplicationInfo app_info = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pApplicationName = "pluto bench",
+        .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+        .pEngineName = "No Engine",
+        .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+        .apiVersion = VK_API_VERSION_1_3
+    };
+
+    const char* instance_extensions[] = { VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME };
+
+    VkInstanceCreateInfo instance_info = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,
+        .pApplicationInfo = &app_info,
+        .enabledExtensionCount = 1,
+        .ppEnabledExtensionNames = instance_extensions,
+    };
+
+    if (vkCreateInstance(&instance_info, nullptr, &bench.instance) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create vulkan instance");
+    }
+
+    uint32_t device_count = 0;
+    vkEnumeratePhysicalDevices(bench.instance, &device_count, nullptr);
+    if (device_count == 0) {
+        throw std::runtime_error("Failed to find GPUs with Vulkan support");
+    }
+
+    std::vector<VkPhysicalDevice> physical_devices(device_count);
+    vkEnumeratePhysicalDevices(bench.instance, &device_count, physical_devices.data());
+    bench.physical_device = physical_devices[0];
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(bench.physical_device, &properties);
+    std::cout << "Device: " << properties.deviceName << "\n";
+
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(bench.physical_device, &queue_family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(bench.physical_device, &queue_family_count, queue_families.data());
+
+    for (uint32_t i = 0; i < queue_family_count; i++) {
+        if (queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            bench.queue_family = i;
+            break;
+        }
+    }
+
+    bench.transfer_family = bench.queue_family;
+    for (uint32_t i = 0; i < queue_family_count; i++) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+            bench.transfer_family = i;
+            if (!(flags & VK_QUEUE_COMPUTE_BIT)) {
+                break;
+            }
+        }
+    }
+
+    bench.compute_family = bench.queue_family;
+    for (uint32_t i = 0; i < queue_family_count; i++) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+            bench.compute_family = i;
+            break;
+        }
+    }
+
+    float queue_priority = 1.0f;
+    std::vector<VkDeviceQueueCreateInfo> queue_infos;
+    for (uint32_t family : {bench.queue_family, bench.transfer_family, bench.compute_family}) {
+        bool seen = false;
+        for (const auto& queue_info : queue_infos) {
+            seen |= queue_info.queueFamilyIndex == family;
+        }
+        if (seen) {
+            continue;
+        }
+
+        queue_infos.push_back({
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = family,
+            .queueCount = 1,
+            .pQueuePriorities = &queue_priority,
+        });
+    }
+
+    VkPhysicalDeviceVulkan13Features vulkan13_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = VK_TRUE,
+        .dynamicRendering = VK_TRUE,
+    };
+
+    // What the bindless table and the GPU-driven scene need
+    VkPhysicalDeviceVulkan12Features vulkan12_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = &vulkan13_features,
+        .drawIndirectCount = VK_TRUE,
+        .descriptorIndexing = VK_TRUE,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageImageArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+        .timelineSemaphore = VK_TRUE,
+    };
+
+    VkPhysicalDeviceFeatures device_features = {
+        .multiDrawIndirect = VK_TRUE,
+        .drawIndirectFirstInstance = VK_TRUE,
+        .shaderSampledImageArrayDynamicIndexing = VK_TRUE,
+        .shaderStorageBufferArrayDynamicIndexing = VK_TRUE,
+        .shaderStorageImageArrayDynamicIndexing = VK_TRUE,
+    };
+
+    VkDeviceCreateInfo device_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &vulkan12_features,
+        .queueCreateInfoCount = (uint32_t)queue_infos.size(),
+        .pQueueCreateInfos = queue_infos.data(),
+        .pEnabledFeatures = &device_features,
+    };
+
+    if (vkCreateDevice(bench.physical_device, &device_info, nullptr, &bench.device) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create logical device");
+    }
+
+    vkGetDeviceQueue(bench.device, bench.queue_family, 0, &bench.queue);
+    vkGetDeviceQueue(bench.device, bench.transfer_family, 0, &bench.transfer_queue);
+    vkGetDeviceQueue(bench.device, bench.compute_family, 0, &bench.compute_queue);
+
+    return bench;
+}
+
+inline void destroy_bench_device(BenchDevice& bench) {
+    vkDestroyDevice(bench.device, nullptr);
+    vkDestroyInstance(bench.instance, nullptr);
+    bench = {};
+}
@@ -0,0 +1,400 @@
+#include "bench_device.h"
+#include "descriptor/bindless_table.h"
+#include "memory/device_allocator.h"
+#include "pipeline/builtin_shaders.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const uint32_t DEFAULT_DRAW_COUNT = 20000;
+const uint32_t RESOURCE_COUNT = 256;
+// Streaming churn in the bindless path: buffers swapped for new slots every frame
+const uint32_t SLOTS_CHURNED_PER_FRAME = 32;
+const uint32_t FRAME_COUNT = 2;
+const uint32_t ITERATIONS = 20;
+
+typedef struct BenchResources {
+    std::vector<VkImage> images;
+    std::vector<VkImageView> views;
+    std::vector<VkBuffer> buffers;
+    std::vector<Allocation> allocations;
+} BenchResources;
+
+static BenchResources create_resources(const BenchDevice& bench, DeviceAllocator& allocator) {
+    BenchResources resources;
+
+    for (uint32_t i = 0; i < RESOURCE_COUNT; i++) {
+        VkImageCreateInfo image_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .extent = {4, 4, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+
+        VkImage image;
+        if (vkCreateImage(bench.device, &image_info, nullptr, &image) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image");
+        }
+        resources.images.push_back(image);
+        resources.allocations.push_back(allocator.allocate_image(image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+        VkImageViewCreateInfo view_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            },
+        };
+
+        VkImageView view;
+        if (vkCreateImageView(bench.device, &view_info, nullptr, &view) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image view");
+        }
+        resources.views.push_back(view);
+
+        VkBufferCreateInfo buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = 256,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        VkBuffer buffer;
+        if (vkCreateBuffer(bench.device, &buffer_info, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create buffer");
+        }
+        resources.buffers.push_back(buffer);
+        resources.allocations.push_back(allocator.allocate_buffer(buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    }
+
+    return resources;
+}
+
+static void destroy_resources(const BenchDevice& bench, DeviceAllocator& allocator, BenchResources& resources) {
+    for (uint32_t i = 0; i < RESOURCE_COUNT; i++) {
+        vkDestroyImageView(bench.device, resources.views[i], nullptr);
+        vkDestroyImage(bench.device, resources.images[i], nullptr);
+        vkDestroyBuffer(bench.device, resources.buffers[i], nullptr);
+    }
+    for (auto& allocation : resources.allocations) {
+        allocator.free(allocation);
+    }
+    resources = {};
+}
+
+static VkPipeline create_noop_pipeline(VkDevice device, VkPipelineLayout layout) {
+    VkShaderModuleCreateInfo module_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = sizeof(noop_compute_spirv),
+        .pCode = noop_compute_spirv,
+    };
+
+    VkShaderModule module;
+    if (vkCreateShaderModule(device, &module_info, nullptr, &module) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module");
+    }
+
+    VkComputePipelineCreateInfo pipeline_info = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = module,
+            .pName = "main",
+        },
+        .layout = layout,
+    };
+
+    VkPipeline pipeline;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline");
+    }
+
+    vkDestroyShaderModule(device, module, nullptr);
+    return pipeline;
+}
+
+typedef struct Recording {
+    VkCommandPool pool;
+    VkCommandBuffer command_buffer;
+} Recording;
+
+static Recording create_recording(const BenchDevice& bench) {
+    Recording recording;
+
+    VkCommandPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = bench.queue_family,
+    };
+
+    if (vkCreateCommandPool(bench.device, &pool_info, nullptr, &recording.pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create command pool");
+    }
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = recording.pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    vkAllocateCommandBuffers(bench.device, &alloc_info, &recording.command_buffer);
+    return recording;
+}
+
+static void begin_recording(const BenchDevice& bench, const Recording& recording) {
+    vkResetCommandPool(bench.device, recording.pool, 0);
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    vkBeginCommandBuffer(recording.command_buffer, &begin_info);
+}
+
+// Average milliseconds per frame with a freshly allocated and written set per draw, the way the
+// engine would do it without bindless
+static double bench_classic(const BenchDevice& bench, const BenchResources& resources, uint32_t draw_count) {
+    using clock = std::chrono::steady_clock;
+
+    VkDescriptorSetLayoutBinding bindings[] = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        },
+    };
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .bindingCount = 2,
+        .pBindings = bindings,
+    };
+
+    VkDescriptorSetLayout set_layout;
+    if (vkCreateDescriptorSetLayout(bench.device, &set_layout_info, nullptr, &set_layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor set layout");
+    }
+
+    VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = 4 * sizeof(uint32_t),
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range,
+    };
+
+    VkPipelineLayout layout;
+    if (vkCreatePipelineLayout(bench.device, &layout_info, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout");
+    }
+
+    VkPipeline pipeline = create_noop_pipeline(bench.device, layout);
+
+    VkDescriptorPoolSize pool_sizes[] = {
+        {.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = draw_count},
+        {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = draw_count},
+    };
+
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .maxSets = draw_count,
+        .poolSizeCount = 2,
+        .pPoolSizes = pool_sizes,
+    };
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(bench.device, &pool_info, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create descriptor pool");
+    }
+
+    Recording recording = create_recording(bench);
+    VkCommandBuffer command_buffer = recording.command_buffer;
+
+    double total_ms = 0.0;
+    for (uint32_t iteration = 0; iteration <= ITERATIONS; iteration++) {
+        auto start = clock::now();
+
+        vkResetDescriptorPool(bench.device, pool, 0);
+        begin_recording(bench, recording);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+        for (uint32_t draw = 0; draw < draw_count; draw++) {
+            VkDescriptorSetAllocateInfo alloc_info = {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = pool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &set_layout,
+            };
+
+            VkDescriptorSet set;
+            if (vkAllocateDescriptorSets(bench.device, &alloc_info, &set) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate descriptor set");
+            }
+
+            uint32_t resource = draw % RESOURCE_COUNT;
+            VkDescriptorImageInfo image_info = {
+                .imageView = resources.views[resource],
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            };
+            VkDescriptorBufferInfo buffer_info = {
+                .buffer = resources.buffers[resource],
+                .offset = 0,
+                .range = VK_WHOLE_SIZE,
+            };
+
+            VkWriteDescriptorSet writes[] = {
+                {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = set,
+                    .dstBinding = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                    .pImageInfo = &image_info,
+                },
+                {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = set,
+                    .dstBinding = 1,
+                    .descriptorCount = 1,
+                    .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                    .pBufferInfo = &buffer_info,
+                },
+            };
+            vkUpdateDescriptorSets(bench.device, 2, writes, 0, nullptr);
+
+            uint32_t constants[4] = {draw, 0, 0, 0};
+            vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+            vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), constants);
+            vkCmdDispatch(command_buffer, 1, 1, 1);
+        }
+
+        vkEndCommandBuffer(command_buffer);
+
+        // First iteration warms the pools
+        if (iteration > 0) {
+            total_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        }
+    }
+
+    vkDestroyCommandPool(bench.device, recording.pool, nullptr);
+    vkDestroyDescriptorPool(bench.device, pool, nullptr);
+    vkDestroyPipeline(bench.device, pipeline, nullptr);
+    vkDestroyPipelineLayout(bench.device, layout, nullptr);
+    vkDestroyDescriptorSetLayout(bench.device, set_layout, nullptr);
+    return total_ms / ITERATIONS;
+}
+
+// Average milliseconds per frame binding the table once and passing slots through push constants,
+// including the per-frame cost of replacing SLOTS_CHURNED_PER_FRAME buffers
+static double bench_bindless(const BenchDevice& bench, const BenchResources& resources, uint32_t draw_count) {
+    using clock = std::chrono::steady_clock;
+
+    BindlessTable table(bench.physical_device, bench.device, FRAME_COUNT);
+    VkPipeline pipeline = create_noop_pipeline(bench.device, table.pipeline_layout());
+
+    std::vector<uint32_t> image_slots;
+    std::vector<uint32_t> buffer_slots;
+    for (uint32_t i = 0; i < RESOURCE_COUNT; i++) {
+        image_slots.push_back(table.add_sampled_image(resources.views[i]));
+        buffer_slots.push_back(table.add_storage_buffer(resources.buffers[i]));
+    }
+    table.flush();
+
+    Recording recording = create_recording(bench);
+    VkCommandBuffer command_buffer = recording.command_buffer;
+
+    uint32_t churn_cursor = 0;
+    double total_ms = 0.0;
+    for (uint32_t iteration = 0; iteration <= ITERATIONS; iteration++) {
+        auto start = clock::now();
+
+        table.begin_frame(iteration % FRAME_COUNT);
+        for (uint32_t i = 0; i < SLOTS_CHURNED_PER_FRAME; i++) {
+            uint32_t resource = churn_cursor++ % RESOURCE_COUNT;
+            table.release(BindlessKind::StorageBuffer, buffer_slots[resource]);
+            buffer_slots[resource] = table.add_storage_buffer(resources.buffers[resource]);
+        }
+
+        begin_recording(bench, recording);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        table.bind(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+        for (uint32_t draw = 0; draw < draw_count; draw++) {
+            uint32_t resource = draw % RESOURCE_COUNT;
+            uint32_t constants[4] = {draw, image_slots[resource], buffer_slots[resource], 0};
+            vkCmdPushConstants(command_buffer, table.pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), constants);
+            vkCmdDispatch(command_buffer, 1, 1, 1);
+        }
+
+        vkEndCommandBuffer(command_buffer);
+        // Update-after-bind: the churned slots are written after the bind, before submission
+        table.flush();
+
+        if (iteration > 0) {
+            total_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        }
+    }
+
+    table.report();
+
+    vkDestroyCommandPool(bench.device, recording.pool, nullptr);
+    vkDestroyPipeline(bench.device, pipeline, nullptr);
+    return total_ms / ITERATIONS;
+}
+
+int main(int argc, char** argv) {
+    try {
+        uint32_t draw_count = argc > 1 ? (uint32_t)std::stoul(argv[1]) : DEFAULT_DRAW_COUNT;
+
+        BenchDevice bench = create_bench_device();
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+            BenchResources resources = create_resources(bench, allocator);
+
+            double classic_ms = bench_classic(bench, resources, draw_count);
+            double bindless_ms = bench_bindless(bench, resources, draw_count);
+
+            std::cout << "classic:  " << draw_count << " draws in " << classic_ms << " ms (" << classic_ms * 1e6 / draw_count << " ns/draw)\n";
+            std::cout << "bindless: " << draw_count << " draws in " << bindless_ms << " ms (" << bindless_ms * 1e6 / draw_count
+                      << " ns/draw, " << classic_ms / bindless_ms << "x)\n";
+
+            destroy_resources(bench, allocator, resources);
+        }
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
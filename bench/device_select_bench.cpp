@@ -0,0 +1,39 @@
+#include "bench_device.h"
+#include "device/device_selector.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const uint32_t SELECT_ITERATIONS = 100;
+
+int main() {
+    try {
+        // The real device list, e.g. lavapipe on CI; no surface, so presentation isn't required
+        BenchDevice bench = create_bench_device();
+        {
+            using clock = std::chrono::steady_clock;
+
+            std::vector<DeviceCandidate> candidates;
+            std::vector<DeviceScore> scores;
+            int32_t selected = -1;
+
+            auto start = clock::now();
+            for (uint32_t i = 0; i < SELECT_ITERATIONS; i++) {
+                candidates = enumerate_device_candidates(bench.instance, VK_NULL_HANDLE, {});
+                selected = select_device(candidates, "", scores);
+            }
+            double select_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+            std::cout << "== this machine\n";
+            log_device_selection(candidates, scores, selected);
+            std::cout << "  enumerate + select " << select_ms / SELECT_ITERATIONS << " ms\n";
+        }
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
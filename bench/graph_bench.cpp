@@ -0,0 +1,167 @@
+#include "bench_device.h"
+#include "memory/device_allocator.h"
+#include "render/render_graph.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const uint32_t FRAME_COUNT = 2;
+const uint32_t EXECUTE_FRAMES = 500;
+const VkExtent2D SCENE_EXTENT = {1920, 1080};
+
+// Deferred-style frame: depth prepass, gbuffer, SSAO + blur, lighting, bloom, tonemap. The debug
+// view and the luminance histogram feed nothing and should be culled. Pass bodies are empty; the
+// graph's barriers, transitions and submissions are what's being measured.
+static void build_scene(RenderGraph& graph) {
+    VkExtent2D half = {SCENE_EXTENT.width / 2, SCENE_EXTENT.height / 2};
+    auto nothing = [](VkCommandBuffer) {};
+
+    ResourceHandle depth = graph.create_image("depth", VK_FORMAT_D32_SFLOAT, SCENE_EXTENT);
+    ResourceHandle albedo = graph.create_image("albedo", VK_FORMAT_R8G8B8A8_UNORM, SCENE_EXTENT);
+    ResourceHandle normal = graph.create_image("normal", VK_FORMAT_R16G16B16A16_SFLOAT, SCENE_EXTENT);
+    ResourceHandle ao = graph.create_image("ao", VK_FORMAT_R8G8B8A8_UNORM, SCENE_EXTENT);
+    ResourceHandle ao_blur = graph.create_image("ao blur", VK_FORMAT_R8G8B8A8_UNORM, SCENE_EXTENT);
+    ResourceHandle hdr = graph.create_image("hdr", VK_FORMAT_R16G16B16A16_SFLOAT, SCENE_EXTENT);
+    ResourceHandle bloom_half = graph.create_image("bloom half", VK_FORMAT_R16G16B16A16_SFLOAT, half);
+    ResourceHandle bloom = graph.create_image("bloom", VK_FORMAT_R16G16B16A16_SFLOAT, SCENE_EXTENT);
+    ResourceHandle output = graph.create_image("output", VK_FORMAT_R8G8B8A8_UNORM, SCENE_EXTENT);
+    ResourceHandle debug_view = graph.create_image("debug view", VK_FORMAT_R8G8B8A8_UNORM, SCENE_EXTENT);
+    ResourceHandle histogram = graph.create_buffer("histogram", 256 * sizeof(uint32_t));
+    graph.mark_output(output);
+
+    PassHandle prepass = graph.add_pass("depth prepass", RenderQueue::Graphics, nothing);
+    graph.write(prepass, depth, ResourceUsage::DepthAttachment);
+
+    PassHandle gbuffer = graph.add_pass("gbuffer", RenderQueue::Graphics, nothing);
+    graph.read(gbuffer, depth, ResourceUsage::DepthRead);
+    graph.write(gbuffer, depth, ResourceUsage::DepthAttachment);
+    graph.write(gbuffer, albedo, ResourceUsage::ColorAttachment);
+    graph.write(gbuffer, normal, ResourceUsage::ColorAttachment);
+
+    PassHandle ssao = graph.add_pass("ssao", RenderQueue::Compute, nothing);
+    graph.read(ssao, depth, ResourceUsage::ComputeSampled);
+    graph.read(ssao, normal, ResourceUsage::ComputeSampled);
+    graph.write(ssao, ao, ResourceUsage::StorageWrite);
+
+    PassHandle ssao_blur = graph.add_pass("ssao blur", RenderQueue::Compute, nothing);
+    graph.read(ssao_blur, ao, ResourceUsage::ComputeSampled);
+    graph.write(ssao_blur, ao_blur, ResourceUsage::StorageWrite);
+
+    PassHandle debug = graph.add_pass("debug view", RenderQueue::Graphics, nothing);
+    graph.read(debug, normal, ResourceUsage::FragmentSampled);
+    graph.write(debug, debug_view, ResourceUsage::ColorAttachment);
+
+    PassHandle lighting = graph.add_pass("lighting", RenderQueue::Graphics, nothing);
+    graph.read(lighting, albedo, ResourceUsage::FragmentSampled);
+    graph.read(lighting, normal, ResourceUsage::FragmentSampled);
+    graph.read(lighting, depth, ResourceUsage::FragmentSampled);
+    graph.read(lighting, ao_blur, ResourceUsage::FragmentSampled);
+    graph.write(lighting, hdr, ResourceUsage::ColorAttachment);
+
+    PassHandle luminance = graph.add_pass("luminance histogram", RenderQueue::Compute, nothing);
+    graph.read(luminance, hdr, ResourceUsage::ComputeSampled);
+    graph.write(luminance, histogram, ResourceUsage::StorageWrite);
+
+    PassHandle bloom_down = graph.add_pass("bloom down", RenderQueue::Compute, nothing);
+    graph.read(bloom_down, hdr, ResourceUsage::ComputeSampled);
+    graph.write(bloom_down, bloom_half, ResourceUsage::StorageWrite);
+
+    PassHandle bloom_up = graph.add_pass("bloom up", RenderQueue::Compute, nothing);
+    graph.read(bloom_up, bloom_half, ResourceUsage::ComputeSampled);
+    graph.write(bloom_up, bloom, ResourceUsage::StorageWrite);
+
+    PassHandle tonemap = graph.add_pass("tonemap", RenderQueue::Graphics, nothing);
+    graph.read(tonemap, hdr, ResourceUsage::FragmentSampled);
+    graph.read(tonemap, bloom, ResourceUsage::FragmentSampled);
+    graph.write(tonemap, output, ResourceUsage::ColorAttachment);
+}
+
+static void bench_scene(const BenchDevice& bench, DeviceAllocator& allocator, const RenderGraphQueues& queues, const char* name) {
+    using clock = std::chrono::steady_clock;
+
+    std::cout << "== " << name << "\n";
+
+    RenderGraph graph(bench.device, allocator, queues, FRAME_COUNT);
+    build_scene(graph);
+
+    auto compile_start = clock::now();
+    graph.compile();
+    double compile_ms = std::chrono::duration<double, std::milli>(clock::now() - compile_start).count();
+
+    graph.report();
+    std::cout << "  compile " << compile_ms << " ms\n";
+
+    std::vector<VkFence> fences(FRAME_COUNT);
+    for (auto& fence : fences) {
+        VkFenceCreateInfo fence_info = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+        };
+        vkCreateFence(bench.device, &fence_info, nullptr, &fence);
+    }
+
+    double execute_ms = 0.0;
+    auto start = clock::now();
+    for (uint32_t frame = 0; frame < EXECUTE_FRAMES; frame++) {
+        uint32_t frame_index = frame % FRAME_COUNT;
+        vkWaitForFences(bench.device, 1, &fences[frame_index], VK_TRUE, UINT64_MAX);
+        vkResetFences(bench.device, 1, &fences[frame_index]);
+
+        RenderGraphExecuteInfo info = {
+            .frame_index = frame_index,
+            .fence = fences[frame_index],
+        };
+
+        auto execute_start = clock::now();
+        graph.execute(info);
+        execute_ms += std::chrono::duration<double, std::milli>(clock::now() - execute_start).count();
+    }
+
+    vkDeviceWaitIdle(bench.device);
+    double total_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::cout << "  " << EXECUTE_FRAMES << " frames: execute " << execute_ms / EXECUTE_FRAMES << " ms cpu/frame, "
+              << total_ms / EXECUTE_FRAMES << " ms/frame wall\n";
+
+    for (auto fence : fences) {
+        vkDestroyFence(bench.device, fence, nullptr);
+    }
+}
+
+int main() {
+    try {
+        BenchDevice bench = create_bench_device();
+
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+
+            RenderGraphQueues single_queue = {
+                .graphics_queue = bench.queue,
+                .graphics_family = bench.queue_family,
+                .compute_queue = bench.queue,
+                .compute_family = bench.queue_family,
+            };
+            bench_scene(bench, allocator, single_queue, "graphics queue only");
+
+            if (bench.compute_family != bench.queue_family) {
+                RenderGraphQueues async_compute = {
+                    .graphics_queue = bench.queue,
+                    .graphics_family = bench.queue_family,
+                    .compute_queue = bench.compute_queue,
+                    .compute_family = bench.compute_family,
+                };
+                bench_scene(bench, allocator, async_compute, "async compute");
+            } else {
+                std::cout << "No dedicated compute family on this device\n";
+            }
+        }
+
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,352 @@
+#include "bench_device.h"
+#include "descriptor/bindless_table.h"
+#include "memory/device_allocator.h"
+#include "pipeline/pipeline_cache.h"
+#include "pipeline/shader_library.h"
+#include "render/gpu_scene.h"
+#include "transfer/upload_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const uint32_t DEFAULT_MAX_OBJECTS = 1000000;
+const uint32_t SCENE_SCALES[] = {1000, 10000, 100000, 1000000};
+const VkExtent2D TARGET_EXTENT = {1280, 720};
+const VkFormat TARGET_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+const uint32_t FRAME_COUNT = 2;
+const uint32_t ITERATIONS = 20;
+
+typedef struct Target {
+    VkImage images[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    VkImageView views[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    Allocation memory[2];
+} Target;
+
+typedef struct Recording {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    VkQueryPool timestamps = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+} Recording;
+
+typedef struct ModeResult {
+    double cpu_ms = 0.0;
+    double gpu_ms = 0.0;
+    uint32_t cpu_draws = 0;
+} ModeResult;
+
+// Index 0 is the colour target, 1 the depth buffer
+static Target create_target(const BenchDevice& bench, DeviceAllocator& allocator) {
+    Target target;
+
+    const VkFormat formats[2] = {TARGET_FORMAT, SCENE_DEPTH_FORMAT};
+    const VkImageUsageFlags usages[2] = {VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+    const VkImageAspectFlags aspects[2] = {VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_ASPECT_DEPTH_BIT};
+
+    for (uint32_t i = 0; i < 2; i++) {
+        VkImageCreateInfo image_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = formats[i],
+            .extent = {TARGET_EXTENT.width, TARGET_EXTENT.height, 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = usages[i],
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+
+        if (vkCreateImage(bench.device, &image_info, nullptr, &target.images[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create target image");
+        }
+        target.memory[i] = allocator.allocate_image(target.images[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkImageViewCreateInfo view_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = target.images[i],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = formats[i],
+            .subresourceRange = {aspects[i], 0, 1, 0, 1},
+        };
+
+        if (vkCreateImageView(bench.device, &view_info, nullptr, &target.views[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create target image view");
+        }
+    }
+
+    return target;
+}
+
+static void destroy_target(const BenchDevice& bench, DeviceAllocator& allocator, Target& target) {
+    for (uint32_t i = 0; i < 2; i++) {
+        vkDestroyImageView(bench.device, target.views[i], nullptr);
+        vkDestroyImage(bench.device, target.images[i], nullptr);
+        allocator.free(target.memory[i]);
+    }
+}
+
+static Recording create_recording(const BenchDevice& bench) {
+    Recording recording;
+
+    VkCommandPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = bench.queue_family,
+    };
+
+    if (vkCreateCommandPool(bench.device, &pool_info, nullptr, &recording.pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create command pool");
+    }
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = recording.pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+    vkAllocateCommandBuffers(bench.device, &alloc_info, &recording.command_buffer);
+
+    VkQueryPoolCreateInfo query_info = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2,
+    };
+
+    if (vkCreateQueryPool(bench.device, &query_info, nullptr, &recording.timestamps) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create timestamp query pool");
+    }
+
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    if (vkCreateFence(bench.device, &fence_info, nullptr, &recording.fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create fence");
+    }
+
+    return recording;
+}
+
+static void destroy_recording(const BenchDevice& bench, Recording& recording) {
+    vkDestroyFence(bench.device, recording.fence, nullptr);
+    vkDestroyQueryPool(bench.device, recording.timestamps, nullptr);
+    vkDestroyCommandPool(bench.device, recording.pool, nullptr);
+}
+
+static void memory_barrier(VkCommandBuffer command_buffer, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stage,
+                           VkAccessFlags2 dst_access) {
+    VkMemoryBarrier2 barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        .srcStageMask = src_stage,
+        .srcAccessMask = src_access,
+        .dstStageMask = dst_stage,
+        .dstAccessMask = dst_access,
+    };
+
+    VkDependencyInfo dependency = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .memoryBarrierCount = 1,
+        .pMemoryBarriers = &barrier,
+    };
+    vkCmdPipelineBarrier2(command_buffer, &dependency);
+}
+
+// Contents are discarded every iteration; the scene loads colour but the bench never looks at it
+static void target_barriers(VkCommandBuffer command_buffer, const Target& target) {
+    VkImageMemoryBarrier2 barriers[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = target.images[0],
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .srcStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+            .dstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = target.images[1],
+            .subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1},
+        },
+    };
+
+    VkDependencyInfo dependency = {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 2,
+        .pImageMemoryBarriers = barriers,
+    };
+    vkCmdPipelineBarrier2(command_buffer, &dependency);
+}
+
+// Streams the whole scene through the staging ring, one flush per "frame", and waits for it to land
+static void stream_scene(GpuScene& scene, UploadManager& uploads) {
+    uint32_t frame = 0;
+    bool resident = false;
+    while (!resident) {
+        uploads.begin_frame(frame++ % FRAME_COUNT);
+        resident = scene.stream(uploads);
+        uploads.flush();
+    }
+    uploads.wait_idle();
+}
+
+static ModeResult bench_mode(const BenchDevice& bench, const GpuScene& scene, const Target& target, Recording& recording, bool indirect) {
+    using clock = std::chrono::steady_clock;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(bench.physical_device, &properties);
+
+    VkCommandBuffer command_buffer = recording.command_buffer;
+    ModeResult result;
+
+    for (uint32_t iteration = 0; iteration <= ITERATIONS; iteration++) {
+        auto start = clock::now();
+
+        vkResetCommandPool(bench.device, recording.pool, 0);
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        vkBeginCommandBuffer(command_buffer, &begin_info);
+        vkCmdResetQueryPool(command_buffer, recording.timestamps, 0, 2);
+        target_barriers(command_buffer, target);
+        vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, recording.timestamps, 0);
+
+        uint32_t cpu_draws = 0;
+        if (indirect) {
+            // The previous iteration's draw read the buffers the reset and cull now overwrite
+            memory_barrier(command_buffer, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+                           VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+            scene.record_reset(command_buffer);
+            memory_barrier(command_buffer, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+            scene.record_cull(command_buffer);
+            memory_barrier(command_buffer, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                           VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+            scene.record_draw(command_buffer, target.views[0], target.views[1], TARGET_EXTENT);
+        } else {
+            cpu_draws = scene.record_draw_direct(command_buffer, target.views[0], target.views[1], TARGET_EXTENT);
+        }
+
+        vkCmdWriteTimestamp2(command_buffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, recording.timestamps, 1);
+        vkEndCommandBuffer(command_buffer);
+
+        double cpu_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+        VkCommandBufferSubmitInfo command_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = command_buffer,
+        };
+
+        VkSubmitInfo2 submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .commandBufferInfoCount = 1,
+            .pCommandBufferInfos = &command_info,
+        };
+
+        if (vkQueueSubmit2(bench.queue, 1, &submit_info, recording.fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit scene commands");
+        }
+        vkWaitForFences(bench.device, 1, &recording.fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(bench.device, 1, &recording.fence);
+
+        uint64_t ticks[2];
+        vkGetQueryPoolResults(bench.device, recording.timestamps, 0, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+        // The first iteration warms caches and pipelines and is not counted
+        if (iteration > 0) {
+            result.cpu_ms += cpu_ms;
+            result.gpu_ms += (double)(ticks[1] - ticks[0]) * properties.limits.timestampPeriod * 1e-6;
+            result.cpu_draws = cpu_draws;
+        }
+    }
+
+    result.cpu_ms /= ITERATIONS;
+    result.gpu_ms /= ITERATIONS;
+    return result;
+}
+
+static void bench_scale(const BenchDevice& bench, DeviceAllocator& allocator, PipelineCache& pipelines, const Target& target, Recording& recording,
+                        uint32_t object_count) {
+    UploadQueues queues = {
+        .transfer_queue = bench.queue,
+        .transfer_family = bench.queue_family,
+        .graphics_family = bench.queue_family,
+    };
+
+    // Built-in SPIR-V only, nothing to watch
+    ShaderLibraryConfig shader_config = {
+        .frames_in_flight = FRAME_COUNT,
+    };
+
+    BindlessTable table(bench.physical_device, bench.device, FRAME_COUNT);
+    ShaderLibrary shaders(bench.device, pipelines, shader_config);
+    UploadManager uploads(bench.device, allocator, queues, FRAME_COUNT);
+    {
+        GpuScene scene(bench.physical_device, bench.device, allocator, table, shaders, TARGET_FORMAT, object_count);
+        scene.set_objects(generate_scene_objects(object_count, object_count));
+        table.flush();
+        stream_scene(scene, uploads);
+
+        // Looking at the centre from the edge of the scene, so the frustum culls a good part of it
+        float radius = scene_half_extent(object_count);
+        float eye[3] = {radius, radius * 0.25f, 0.0f};
+        float centre[3] = {0.0f, 0.0f, 0.0f};
+        scene.set_camera(eye, centre, 1.0f, (float)TARGET_EXTENT.width / (float)TARGET_EXTENT.height, 0.1f, radius * 4.0f);
+
+        ModeResult indirect = bench_mode(bench, scene, target, recording, true);
+        ModeResult direct = bench_mode(bench, scene, target, recording, false);
+
+        std::cout << object_count << " objects (" << scene.stats().device_bytes / 1024 << " KiB), " << direct.cpu_draws << " visible\n";
+        std::cout << "  indirect: cpu " << indirect.cpu_ms << " ms, gpu " << indirect.gpu_ms << " ms\n";
+        std::cout << "  direct:   cpu " << direct.cpu_ms << " ms, gpu " << direct.gpu_ms << " ms (cpu "
+                  << direct.cpu_ms / std::max(indirect.cpu_ms, 1e-6) << "x)\n";
+    }
+    uploads.wait_idle();
+}
+
+int main(int argc, char** argv) {
+    try {
+        uint32_t max_objects = argc > 1 ? (uint32_t)std::stoul(argv[1]) : DEFAULT_MAX_OBJECTS;
+
+        BenchDevice bench = create_bench_device();
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+            PipelineCache pipelines(bench.physical_device, bench.device, "");
+            Target target = create_target(bench, allocator);
+            Recording recording = create_recording(bench);
+
+            for (uint32_t object_count : SCENE_SCALES) {
+                if (object_count <= max_objects) {
+                    bench_scale(bench, allocator, pipelines, target, recording, object_count);
+                }
+            }
+
+            destroy_recording(bench, recording);
+            destroy_target(bench, allocator, target);
+        }
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
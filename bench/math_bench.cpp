@@ -0,0 +1,158 @@
+#include "math/math.h"
+#include "math/soa_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+const uint32_t DEFAULT_OBJECT_COUNT = 16384;
+const uint32_t HIERARCHY_DEPTH = 4;
+const uint32_t ITERATIONS = 200;
+
+typedef struct Scene {
+    TransformSoA local;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> levels;
+    AabbSoA boxes;
+    std::vector<Mat4> models;
+    Mat4 view_proj;
+    Vec4 planes[6];
+} Scene;
+
+// A forest sorted by depth: an eighth of the objects are roots, the rest split evenly over the
+// deeper levels with parents picked from the level above
+static Scene make_scene(uint32_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    Scene scene;
+    scene.local.resize(count);
+    scene.parents.resize(count);
+    scene.boxes.resize(count);
+    scene.models.resize(count);
+
+    uint32_t roots = std::max(count / 8, 1u);
+    uint32_t per_level = std::max((count - roots) / (HIERARCHY_DEPTH - 1), 1u);
+    uint32_t parent_begin = 0, level_begin = 0, level_end = roots;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i == level_end) {
+            parent_begin = level_begin;
+            level_begin = level_end;
+            level_end = std::min(count, level_end + per_level);
+        }
+
+        bool root = level_begin == 0;
+        if (root) {
+            scene.parents[i] = -1;
+        } else {
+            std::uniform_int_distribution<uint32_t> parent(parent_begin, level_begin - 1);
+            scene.parents[i] = (int32_t)parent(rng);
+        }
+
+        Vec3 position = Vec3{unit(rng), unit(rng), unit(rng)} * (root ? 50.0f : 2.0f);
+        Quat rotation = quat_axis_angle({unit(rng), unit(rng), unit(rng) + 1.5f}, unit(rng) * 3.14159f);
+        scene.local.set(i, position, rotation, 0.75f + 0.25f * unit(rng));
+        scene.boxes.set(i, Vec3{unit(rng), unit(rng), unit(rng)} * 60.0f, {1.0f, 1.0f, 1.0f});
+    }
+    scene.levels = hierarchy_levels(scene.parents.data(), count);
+
+    transforms_to_matrices(scene.local, scene.models.data());
+
+    scene.view_proj = multiply(perspective(1.0f, 16.0f / 9.0f, 0.1f, 200.0f), look_at({0.0f, 10.0f, 80.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}));
+    frustum_planes(scene.view_proj, scene.planes);
+    return scene;
+}
+
+template <typename Fn>
+static double time_ns_per_object(uint32_t count, Fn fn) {
+    using clock = std::chrono::steady_clock;
+
+    fn();
+    auto start = clock::now();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        fn();
+    }
+    double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    return ns / ((double)ITERATIONS * count);
+}
+
+typedef struct Results {
+    double hierarchy_ns;
+    double matrices_ns;
+    double multiply_ns;
+    double cull_ns;
+    TransformSoA world;
+    std::vector<Mat4> matrices;
+    std::vector<Mat4> mvp;
+    std::vector<uint32_t> visible;
+} Results;
+
+static Results run_level(const Scene& scene, SimdLevel level) {
+    set_simd_level(level);
+
+    uint32_t count = scene.local.size();
+    Results results;
+    results.matrices.resize(count);
+    results.mvp.resize(count);
+    results.visible.resize(count);
+
+    uint32_t visible_count = 0;
+    results.hierarchy_ns = time_ns_per_object(count, [&] { compose_hierarchy(scene.local, scene.parents.data(), scene.levels, results.world); });
+    results.matrices_ns = time_ns_per_object(count, [&] { transforms_to_matrices(results.world, results.matrices.data()); });
+    results.multiply_ns = time_ns_per_object(count, [&] { multiply_matrices(scene.view_proj, scene.models.data(), results.mvp.data(), count); });
+    results.cull_ns = time_ns_per_object(count, [&] { visible_count = cull_aabbs(scene.boxes, scene.planes, results.visible.data()); });
+    results.visible.resize(visible_count);
+    return results;
+}
+
+// What per-object AoS code does today: a Mat4 per node, parent * local, one object at a time
+static double run_aos(const Scene& scene) {
+    uint32_t count = scene.local.size();
+    std::vector<Mat4> world(count);
+
+    return time_ns_per_object(count, [&] {
+        for (uint32_t i = 0; i < count; i++) {
+            Mat4 local = mat4_from_transform({scene.local.position_x[i], scene.local.position_y[i], scene.local.position_z[i]},
+                                             {scene.local.rotation_x[i], scene.local.rotation_y[i], scene.local.rotation_z[i], scene.local.rotation_w[i]},
+                                             scene.local.scale[i]);
+            world[i] = scene.parents[i] < 0 ? local : multiply(world[scene.parents[i]], local);
+        }
+    });
+}
+
+int main(int argc, char** argv) {
+    try {
+        uint32_t count = argc > 1 ? (uint32_t)std::stoul(argv[1]) : DEFAULT_OBJECT_COUNT;
+
+        Scene scene = make_scene(count);
+        SimdLevel detected = detected_simd_level();
+        std::cout << count << " objects, " << scene.levels.size() - 1 << " hierarchy levels, detected " << simd_level_name(detected) << "\n";
+
+        double aos_ns = run_aos(scene);
+        std::cout << "  aos per-object hierarchy: " << aos_ns << " ns/object\n";
+
+        // Correctness against the scalar path is checked by pluto_tests; this only times each level
+        Results reference = run_level(scene, SimdLevel::Scalar);
+
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2}) {
+            if (level > detected) {
+                continue;
+            }
+
+            Results results = level == SimdLevel::Scalar ? reference : run_level(scene, level);
+            std::cout << "  " << simd_level_name(level) << ": hierarchy " << results.hierarchy_ns << " ns (" << reference.hierarchy_ns / results.hierarchy_ns
+                      << "x, " << aos_ns / results.hierarchy_ns << "x vs aos), to matrices " << results.matrices_ns << " ns ("
+                      << reference.matrices_ns / results.matrices_ns << "x), multiply " << results.multiply_ns << " ns ("
+                      << reference.multiply_ns / results.multiply_ns << "x), cull " << results.cull_ns << " ns (" << reference.cull_ns / results.cull_ns
+                      << "x, " << results.visible.size() << " visible)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
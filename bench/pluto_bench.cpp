@@ -0,0 +1,314 @@
+#include "engine/engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Runs the engine headless (lavapipe on CI) and writes what it measured as JSON. With --baseline,
+// every metric is compared against a previous run's JSON and the exit code is non-zero when one
+// got worse by more than the tolerance. Refresh a baseline by copying a run's JSON over it.
+const uint64_t DEFAULT_BENCH_FRAMES = 1000;
+// Frames dropped from the percentiles: pipeline compilation, scene streaming, swapchain warm-up
+const uint64_t DEFAULT_WARMUP_FRAMES = 100;
+const uint32_t DEFAULT_BENCH_OBJECTS = 100000;
+const double DEFAULT_TOLERANCE = 0.10;
+const char* DEFAULT_JSON_PATH = "pluto_bench.json";
+
+typedef struct BenchConfig {
+    EngineConfig engine;
+    uint64_t warmup_frames = DEFAULT_WARMUP_FRAMES;
+    std::string json_path = DEFAULT_JSON_PATH;
+    std::string baseline_path;
+    double tolerance = DEFAULT_TOLERANCE;
+} BenchConfig;
+
+// Differences below min_delta are noise whatever the relative change
+typedef struct Metric {
+    std::string name;
+    double value;
+    bool higher_is_better;
+    double min_delta;
+} Metric;
+
+static BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig config;
+    config.engine.backend = PresentBackend::HeadlessSurface;
+    config.engine.max_frames = DEFAULT_BENCH_FRAMES;
+    config.engine.scene_objects = DEFAULT_BENCH_OBJECTS;
+    config.engine.validation = false;
+    // The watcher thread would only add noise
+    config.engine.shader_source_dir.clear();
+    config.engine.pipeline_cache_path = "pluto_bench_pipeline_cache.bin";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--frames" && i + 1 < argc) {
+            config.engine.max_frames = std::stoull(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            config.warmup_frames = std::stoull(argv[++i]);
+        } else if (arg == "--objects" && i + 1 < argc) {
+            config.engine.scene_objects = (uint32_t)std::stoul(argv[++i]);
+        } else if (arg == "--synthetic-draws" && i + 1 < argc) {
+            config.engine.synthetic_draws = (uint32_t)std::stoul(argv[++i]);
+        } else if (arg == "--device" && i + 1 < argc) {
+            config.engine.device = argv[++i];
+        } else if (arg == "--pipeline-cache" && i + 1 < argc) {
+            config.engine.pipeline_cache_path = argv[++i];
+        } else if (arg == "--present-policy" && i + 1 < argc) {
+            config.engine.present_policy = parse_present_policy(argv[++i]);
+        } else if (arg == "--target-fps" && i + 1 < argc) {
+            config.engine.target_fps = std::stod(argv[++i]);
+        } else if (arg == "--offscreen") {
+            config.engine.backend = PresentBackend::Offscreen;
+        } else if (arg == "--no-async-compute") {
+            config.engine.async_compute = false;
+        } else if (arg == "--classic-render-path") {
+            config.engine.classic_render_path = true;
+        } else if (arg == "--resize-every" && i + 1 < argc) {
+            config.engine.resize_every = (uint32_t)std::stoul(argv[++i]);
+        } else if (arg == "--breadcrumbs") {
+            config.engine.breadcrumbs = true;
+        } else if (arg == "--inject-device-lost" && i + 1 < argc) {
+            config.engine.inject_device_lost_after = std::stoull(argv[++i]);
+        } else if (arg == "--inject-pass" && i + 1 < argc) {
+            config.engine.inject_device_lost_pass = argv[++i];
+        } else if (arg == "--extent" && i + 1 < argc) {
+            std::string extent = argv[++i];
+            size_t split = extent.find('x');
+            if (split == std::string::npos) {
+                throw std::runtime_error("--extent expects WIDTHxHEIGHT");
+            }
+            config.engine.width = (uint32_t)std::stoul(extent.substr(0, split));
+            config.engine.height = (uint32_t)std::stoul(extent.substr(split + 1));
+        } else if (arg == "--json" && i + 1 < argc) {
+            config.json_path = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            config.baseline_path = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            config.tolerance = std::stod(argv[++i]);
+        } else {
+            throw std::runtime_error("Unknown argument: " + arg);
+        }
+    }
+
+    if (config.warmup_frames >= config.engine.max_frames) {
+        throw std::runtime_error("--warmup must be less than --frames");
+    }
+
+    // Every injected loss is expected; the run should ride them all out
+    if (config.engine.inject_device_lost_after > 0) {
+        config.engine.max_device_lost_recoveries = (uint32_t)std::min<uint64_t>(config.engine.max_frames, UINT32_MAX);
+    }
+
+    return config;
+}
+
+static std::vector<Metric> collect_metrics(const BenchConfig& config, const EngineReport& report) {
+    const double mib = 1024.0 * 1024.0;
+
+    if (report.frames.frame_ms.size() <= config.warmup_frames) {
+        throw std::runtime_error("Run ended before the warm-up frames were over");
+    }
+
+    std::vector<double> frame_ms(report.frames.frame_ms.begin() + config.warmup_frames, report.frames.frame_ms.end());
+    std::vector<double> cpu_ms(report.frames.cpu_ms.begin() + config.warmup_frames, report.frames.cpu_ms.end());
+    std::vector<double> latency_ms(report.frames.latency_ms.begin() + config.warmup_frames, report.frames.latency_ms.end());
+
+    std::vector<Metric> metrics = {
+        {"startup_instance_ms", report.startup.instance_ms, false, 1.0},
+        {"startup_device_ms", report.startup.device_ms, false, 1.0},
+        {"startup_pipelines_ms", report.startup.pipelines_ms, false, 1.0},
+        {"startup_swapchain_ms", report.startup.swapchain_ms, false, 1.0},
+        {"startup_total_ms", report.startup.total_ms, false, 2.0},
+        {"frame_p50_ms", FrameStats::percentile(frame_ms, 0.50), false, 0.1},
+        {"frame_p99_ms", FrameStats::percentile(frame_ms, 0.99), false, 0.2},
+        {"frame_p999_ms", FrameStats::percentile(frame_ms, 0.999), false, 0.5},
+        {"cpu_p50_ms", FrameStats::percentile(cpu_ms, 0.50), false, 0.1},
+        {"cpu_p99_ms", FrameStats::percentile(cpu_ms, 0.99), false, 0.2},
+        {"cpu_p999_ms", FrameStats::percentile(cpu_ms, 0.999), false, 0.5},
+        {"latency_p50_ms", FrameStats::percentile(latency_ms, 0.50), false, 0.1},
+        {"latency_p99_ms", FrameStats::percentile(latency_ms, 0.99), false, 0.2},
+        {"memory_used_mib", report.memory.used_bytes / mib, false, 1.0},
+        {"memory_reserved_mib", report.memory.reserved_bytes / mib, false, 1.0},
+        {"startup_host_allocations", (double)report.startup_host_memory.allocations, false, 50.0},
+        {"host_allocations", (double)report.host_memory.allocations, false, 100.0},
+        {"host_peak_kib", report.host_memory.peak_bytes / 1024.0, false, 64.0},
+    };
+
+    // --resize-every runs; compare the dynamic rendering path against --classic-render-path
+    if (!report.frames.recreate_ms.empty()) {
+        const std::vector<double>& recreate_ms = report.frames.recreate_ms;
+        const SwapchainObjectStats& objects = report.swapchain_objects;
+        metrics.push_back({"resize_p50_ms", FrameStats::percentile(recreate_ms, 0.50), false, 0.1});
+        metrics.push_back({"resize_max_ms", *std::max_element(recreate_ms.begin(), recreate_ms.end()), false, 0.5});
+        metrics.push_back({"swapchain_objects", (double)(objects.image_views + objects.framebuffers + objects.render_passes), false, 1.0});
+    }
+
+    // --inject-device-lost runs
+    if (!report.frames.recovery_ms.empty()) {
+        const std::vector<double>& recovery_ms = report.frames.recovery_ms;
+        metrics.push_back({"device_lost_recoveries", (double)recovery_ms.size(), false, 0.5});
+        metrics.push_back({"recovery_p50_ms", FrameStats::percentile(recovery_ms, 0.50), false, 2.0});
+        metrics.push_back({"recovery_max_ms", *std::max_element(recovery_ms.begin(), recovery_ms.end()), false, 5.0});
+    }
+
+    // Scene streaming is the only uploader, so its bytes over the time it took are the upload rate
+    if (report.stream_ms > 0.0) {
+        metrics.push_back({"upload_mib_per_s", report.uploads.bytes / mib / (report.stream_ms / 1000.0), true, 1.0});
+        metrics.push_back({"stream_ms", report.stream_ms, false, 1.0});
+    }
+
+    return metrics;
+}
+
+// The fault-injection test: every frame was still drawn, at least one loss was recovered from, and
+// with --breadcrumbs the breadcrumbs pointed at the pass the loss was injected into
+static void check_fault_injection(const BenchConfig& config, const EngineReport& report) {
+    const EngineConfig& engine = config.engine;
+    if (engine.inject_device_lost_after == 0) {
+        return;
+    }
+
+    if (report.frames.recovery_ms.empty()) {
+        throw std::runtime_error("Fault injection: no device loss was recovered from");
+    }
+    if (report.frames.frame_ms.size() != engine.max_frames) {
+        throw std::runtime_error("Fault injection: " + std::to_string(report.frames.frame_ms.size()) + " of " +
+                                 std::to_string(engine.max_frames) + " frames drawn");
+    }
+
+    if (engine.breadcrumbs) {
+        const std::vector<std::string>& passes = report.lost_in_passes;
+        bool named = engine.inject_device_lost_pass.empty() ? !passes.empty()
+                                                            : std::find(passes.begin(), passes.end(), engine.inject_device_lost_pass) != passes.end();
+        if (!named) {
+            throw std::runtime_error("Fault injection: breadcrumbs did not show the pass the device was lost in");
+        }
+    }
+
+    std::cout << "Fault injection: " << report.frames.recovery_ms.size() << " device losses recovered from\n";
+}
+
+static std::string json_escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+static void write_json(const std::string& path, const BenchConfig& config, const EngineReport& report, const std::vector<Metric>& metrics) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    file.precision(6);
+    file << "{\n";
+    file << "  \"device\": \"" << json_escape(report.device_name) << "\",\n";
+    file << "  \"backend\": \"" << (config.engine.backend == PresentBackend::Offscreen ? "offscreen" : "headless_surface") << "\",\n";
+    file << "  \"present_policy\": \"" << present_policy_name(config.engine.present_policy) << "\",\n";
+    file << "  \"render_path\": \"" << render_path_name(report.render_path) << (report.synchronization2 ? ", sync2" : ", sync1") << "\",\n";
+    file << "  \"target_fps\": " << config.engine.target_fps << ",\n";
+    file << "  \"extent\": [" << config.engine.width << ", " << config.engine.height << "],\n";
+    file << "  \"frames\": " << config.engine.max_frames << ",\n";
+    file << "  \"warmup_frames\": " << config.warmup_frames << ",\n";
+    file << "  \"objects\": " << config.engine.scene_objects << ",\n";
+    file << "  \"metrics\": {\n";
+    for (size_t i = 0; i < metrics.size(); i++) {
+        file << "    \"" << metrics[i].name << "\": " << metrics[i].value << (i + 1 < metrics.size() ? ",\n" : "\n");
+    }
+    file << "  }\n";
+    file << "}\n";
+}
+
+// Only reads what write_json writes: the flat "metrics" object of numbers
+static std::map<std::string, double> read_baseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open baseline " + path);
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+
+    size_t begin = text.find("\"metrics\"");
+    size_t end = begin == std::string::npos ? std::string::npos : text.find('}', begin);
+    if (end == std::string::npos) {
+        throw std::runtime_error("Baseline " + path + " has no metrics object");
+    }
+
+    std::map<std::string, double> metrics;
+    std::regex entry("\"(\\w+)\"\\s*:\\s*(-?[0-9.]+(?:[eE][-+]?[0-9]+)?)");
+    std::string object = text.substr(begin, end - begin);
+    for (auto it = std::sregex_iterator(object.begin(), object.end(), entry); it != std::sregex_iterator(); ++it) {
+        metrics[(*it)[1]] = std::stod((*it)[2]);
+    }
+    return metrics;
+}
+
+// Returns the number of regressions
+static uint32_t compare_baseline(const std::vector<Metric>& metrics, const std::map<std::string, double>& baseline, double tolerance) {
+    uint32_t regressions = 0;
+
+    std::cout << "Baseline comparison (tolerance " << tolerance * 100.0 << "%):\n";
+    for (const Metric& metric : metrics) {
+        auto it = baseline.find(metric.name);
+        if (it == baseline.end()) {
+            std::cout << "  " << metric.name << ": " << metric.value << " (not in baseline)\n";
+            continue;
+        }
+
+        double previous = it->second;
+        double worse_by = metric.higher_is_better ? previous - metric.value : metric.value - previous;
+        bool regressed = worse_by > metric.min_delta && worse_by > std::fabs(previous) * tolerance;
+        regressions += regressed ? 1 : 0;
+
+        double change = previous != 0.0 ? (metric.value - previous) / std::fabs(previous) * 100.0 : 0.0;
+        std::cout << "  " << metric.name << ": " << metric.value << " vs " << previous << " (" << (change >= 0.0 ? "+" : "") << change << "%)"
+                  << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    try {
+        BenchConfig config = parse_args(argc, argv);
+
+        HelloEngine engine(config.engine);
+        engine.run();
+
+        const EngineReport& report = engine.report();
+        check_fault_injection(config, report);
+        std::vector<Metric> metrics = collect_metrics(config, report);
+
+        write_json(config.json_path, config, report, metrics);
+        std::cout << "Wrote " << config.json_path << "\n";
+
+        if (!config.baseline_path.empty()) {
+            uint32_t regressions = compare_baseline(metrics, read_baseline(config.baseline_path), config.tolerance);
+            if (regressions > 0) {
+                std::cerr << regressions << " metrics regressed against " << config.baseline_path << "\n";
+                return EXIT_FAILURE;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
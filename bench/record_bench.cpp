@@ -0,0 +1,166 @@
+#include "bench_device.h"
+#include "jobs/job_system.h"
+#include "pipeline/builtin_shaders.h"
+#include "render/parallel_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint32_t DEFAULT_DRAW_COUNT = 50000;
+const uint32_t DRAWS_PER_SECONDARY = 512;
+const uint32_t ITERATIONS = 20;
+
+typedef struct BenchPipeline {
+    VkPipelineLayout layout;
+    VkPipeline pipeline;
+} BenchPipeline;
+
+static BenchPipeline create_bench_pipeline(VkDevice device) {
+    BenchPipeline result;
+
+    VkShaderModuleCreateInfo module_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = sizeof(noop_compute_spirv),
+        .pCode = noop_compute_spirv,
+    };
+
+    VkShaderModule module;
+    if (vkCreateShaderModule(device, &module_info, nullptr, &module) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module");
+    }
+
+    VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = 4 * sizeof(uint32_t),
+    };
+
+    VkPipelineLayoutCreateInfo layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range,
+    };
+
+    if (vkCreatePipelineLayout(device, &layout_info, nullptr, &result.layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline layout");
+    }
+
+    VkComputePipelineCreateInfo pipeline_info = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = module,
+            .pName = "main",
+        },
+        .layout = result.layout,
+    };
+
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &result.pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline");
+    }
+
+    vkDestroyShaderModule(device, module, nullptr);
+    return result;
+}
+
+// Average milliseconds to record draw_count synthetic draws into one primary with thread_count threads
+static double bench_recording(const BenchDevice& bench, const BenchPipeline& pipeline, uint32_t thread_count, uint32_t draw_count) {
+    using clock = std::chrono::steady_clock;
+
+    JobSystem jobs(thread_count);
+    ParallelRecorder recorder(bench.device, bench.queue_family, 1, jobs);
+
+    VkCommandPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = bench.queue_family,
+    };
+
+    VkCommandPool primary_pool;
+    if (vkCreateCommandPool(bench.device, &pool_info, nullptr, &primary_pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create command pool");
+    }
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = primary_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    VkCommandBuffer primary;
+    vkAllocateCommandBuffers(bench.device, &alloc_info, &primary);
+
+    auto record_draws = [&pipeline](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+        vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+        for (uint32_t draw = begin; draw < end; draw++) {
+            uint32_t constants[4] = {draw, draw * 3, draw * 7, 0};
+            vkCmdPushConstants(secondary, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), constants);
+            vkCmdDispatch(secondary, 1, 1, 1);
+        }
+    };
+
+    double total_ms = 0.0;
+    for (uint32_t iteration = 0; iteration <= ITERATIONS; iteration++) {
+        auto start = clock::now();
+
+        vkResetCommandPool(bench.device, primary_pool, 0);
+        recorder.begin_frame(0);
+
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        vkBeginCommandBuffer(primary, &begin_info);
+        recorder.record(primary, draw_count, DRAWS_PER_SECONDARY, record_draws);
+        vkEndCommandBuffer(primary);
+
+        // First iteration warms the command pools
+        if (iteration > 0) {
+            total_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        }
+    }
+
+    vkDestroyCommandPool(bench.device, primary_pool, nullptr);
+    return total_ms / ITERATIONS;
+}
+
+int main(int argc, char** argv) {
+    try {
+        uint32_t draw_count = argc > 1 ? (uint32_t)std::stoul(argv[1]) : DEFAULT_DRAW_COUNT;
+
+        BenchDevice bench = create_bench_device();
+        BenchPipeline pipeline = create_bench_pipeline(bench.device);
+
+        std::vector<uint32_t> thread_counts = {1, 2, 4};
+        uint32_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        if (std::find(thread_counts.begin(), thread_counts.end(), hardware_threads) == thread_counts.end()) {
+            thread_counts.push_back(hardware_threads);
+        }
+
+        double single_thread_ms = 0.0;
+        for (uint32_t thread_count : thread_counts) {
+            double ms = bench_recording(bench, pipeline, thread_count, draw_count);
+            if (thread_count == 1) {
+                single_thread_ms = ms;
+            }
+
+            std::cout << thread_count << " threads: " << draw_count << " draws in " << ms << " ms ("
+                      << draw_count / ms << " draws/ms, " << single_thread_ms / ms << "x)\n";
+        }
+
+        vkDestroyPipeline(bench.device, pipeline.pipeline, nullptr);
+        vkDestroyPipelineLayout(bench.device, pipeline.layout, nullptr);
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "bench_device.h"
+#include "memory/device_allocator.h"
+#include "transfer/upload_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+const uint32_t FRAME_COUNT = 2;
+const VkDeviceSize BYTES_PER_FRAME = 8ull * 1024 * 1024;
+const VkDeviceSize TOTAL_BYTES = 512ull * 1024 * 1024;
+const VkDeviceSize DESTINATION_SIZE = 64ull * 1024 * 1024;
+
+typedef struct GraphicsFrame {
+    VkCommandPool command_pool;
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+} GraphicsFrame;
+
+// Streams TOTAL_BYTES in chunk_size uploads, one flush per frame, with a graphics submission per
+// frame that acquires the uploads and waits on the timeline like the engine does
+static void bench_uploads(const BenchDevice& bench, DeviceAllocator& allocator, const UploadQueues& queues, const char* name, VkDeviceSize chunk_size) {
+    using clock = std::chrono::steady_clock;
+
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = DESTINATION_SIZE,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    VkBuffer destination;
+    if (vkCreateBuffer(bench.device, &buffer_info, nullptr, &destination) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create destination buffer");
+    }
+    Allocation destination_memory = allocator.allocate_buffer(destination, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::vector<GraphicsFrame> frames(FRAME_COUNT);
+    for (auto& frame : frames) {
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = bench.queue_family,
+        };
+        vkCreateCommandPool(bench.device, &pool_info, nullptr, &frame.command_pool);
+
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = frame.command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        vkAllocateCommandBuffers(bench.device, &alloc_info, &frame.command_buffer);
+
+        VkFenceCreateInfo fence_info = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+        };
+        vkCreateFence(bench.device, &fence_info, nullptr, &frame.fence);
+    }
+
+    std::vector<char> source(chunk_size, 0x5a);
+    uint64_t chunks_per_frame = BYTES_PER_FRAME / chunk_size;
+    uint64_t frame_total = TOTAL_BYTES / BYTES_PER_FRAME;
+
+    {
+        UploadManager uploads(bench.device, allocator, queues, FRAME_COUNT);
+
+        auto start = clock::now();
+        for (uint64_t frame_number = 0; frame_number < frame_total; frame_number++) {
+            uint32_t frame_index = frame_number % FRAME_COUNT;
+            GraphicsFrame& frame = frames[frame_index];
+
+            vkWaitForFences(bench.device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+            vkResetFences(bench.device, 1, &frame.fence);
+            uploads.begin_frame(frame_index);
+
+            for (uint64_t i = 0; i < chunks_per_frame; i++) {
+                VkDeviceSize dst_offset = (i * chunk_size) % DESTINATION_SIZE;
+                if (!uploads.upload_buffer(destination, dst_offset, source.data(), chunk_size)) {
+                    throw std::runtime_error("Staging ring exhausted");
+                }
+            }
+
+            uint64_t upload_value = uploads.flush();
+
+            vkResetCommandPool(bench.device, frame.command_pool, 0);
+            VkCommandBufferBeginInfo begin_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            };
+            vkBeginCommandBuffer(frame.command_buffer, &begin_info);
+            uploads.record_acquire_barriers(frame.command_buffer);
+            vkEndCommandBuffer(frame.command_buffer);
+
+            VkSemaphore timeline = uploads.timeline();
+            VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+            VkTimelineSemaphoreSubmitInfo timeline_submit = {
+                .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                .waitSemaphoreValueCount = 1,
+                .pWaitSemaphoreValues = &upload_value,
+            };
+
+            VkSubmitInfo submit_info = {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .pNext = &timeline_submit,
+                .waitSemaphoreCount = 1,
+                .pWaitSemaphores = &timeline,
+                .pWaitDstStageMask = &wait_stage,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &frame.command_buffer,
+            };
+
+            if (vkQueueSubmit(bench.queue, 1, &submit_info, frame.fence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to submit graphics frame");
+            }
+        }
+
+        uploads.wait_idle();
+        vkQueueWaitIdle(bench.queue);
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+        const UploadStats& stats = uploads.stats();
+        std::cout << name << " " << chunk_size / 1024 << " KiB: " << stats.bytes / seconds / (1024.0 * 1024.0) << " MB/s, "
+                  << stats.upload_count << " uploads in " << stats.batch_count << " batches, latency avg "
+                  << stats.total_latency_ms / std::max<uint64_t>(stats.completed_count, 1) << " ms, max "
+                  << stats.max_latency_ms << " ms\n";
+    }
+
+    for (auto& frame : frames) {
+        vkDestroyFence(bench.device, frame.fence, nullptr);
+        vkDestroyCommandPool(bench.device, frame.command_pool, nullptr);
+    }
+
+    vkDestroyBuffer(bench.device, destination, nullptr);
+    allocator.free(destination_memory);
+}
+
+int main() {
+    try {
+        BenchDevice bench = create_bench_device();
+
+        {
+            DeviceAllocator allocator(bench.physical_device, bench.device);
+
+            const VkDeviceSize chunk_sizes[] = {4 * 1024, 64 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+
+            UploadQueues graphics_queues = {
+                .transfer_queue = bench.queue,
+                .transfer_family = bench.queue_family,
+                .graphics_family = bench.queue_family,
+            };
+
+            for (auto chunk_size : chunk_sizes) {
+                bench_uploads(bench, allocator, graphics_queues, "graphics queue", chunk_size);
+            }
+
+            if (bench.transfer_family != bench.queue_family) {
+                UploadQueues transfer_queues = {
+                    .transfer_queue = bench.transfer_queue,
+                    .transfer_family = bench.transfer_family,
+                    .graphics_family = bench.queue_family,
+                };
+
+                for (auto chunk_size : chunk_sizes) {
+                    bench_uploads(bench, allocator, transfer_queues, "transfer queue", chunk_size);
+                }
+            } else {
+                std::cout << "No dedicated transfer family on this device\n";
+            }
+        }
+
+        destroy_bench_device(bench);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "assets/asset_format.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef struct TextureBakeOptions {
+    // VK_FORMAT_BC1_RGBA_UNORM_BLOCK or VK_FORMAT_R8G8B8A8_UNORM
+    VkFormat format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    bool mips = true;
+} TextureBakeOptions;
+
+// Builds an asset pack offline: converts source data to the GPU layout (mip chains, BC1 blocks,
+// std430 materials), splits it into chunks and writes the file AssetPack maps. Used by
+// pluto_baker and by the benchmarks to generate test packs.
+class AssetBaker {
+public:
+    // Each returns the asset's index in the pack
+    uint32_t add_mesh(const std::string& name, const std::vector<AssetVertex>& vertices, const std::vector<uint32_t>& indices);
+    // rgba is width * height RGBA8 texels, row-major
+    uint32_t add_texture(const std::string& name, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba,
+                         const TextureBakeOptions& options = {});
+    uint32_t add_materials(const std::string& name, const std::vector<AssetMaterial>& materials);
+
+    // ASSET_NOT_FOUND when nothing of that name has been added
+    uint32_t find(const std::string& name) const;
+    uint32_t asset_count() const { return (uint32_t)m_assets.size(); }
+    uint64_t payload_bytes() const;
+
+    void write(const std::string& path) const;
+
+private:
+    typedef struct Payload {
+        std::vector<uint8_t> bytes;
+        uint64_t destination_offset;
+        uint32_t mip_level;
+    } Payload;
+
+    typedef struct BakedAsset {
+        std::string name;
+        AssetEntry entry;
+        std::vector<Payload> chunks;
+    } BakedAsset;
+
+    std::vector<BakedAsset> m_assets;
+
+    uint32_t add_buffer(const std::string& name, const AssetEntry& entry, const uint8_t* data, uint64_t size);
+};
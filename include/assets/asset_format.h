@@ -0,0 +1,115 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <cstdint>
+
+// On-disk layout of a baked asset pack (pluto_baker writes it, AssetPack maps it). Everything is
+// little-endian and naturally aligned so the tables are read in place, and every payload is
+// already in the layout its GPU buffer or image expects, so loading is a copy from the mapping
+// into staging memory.
+//
+//   AssetPackHeader
+//   AssetEntry[asset_count]
+//   AssetChunk[chunk_count]
+//   string table (NUL-terminated names)
+//   payloads, each starting on an ASSET_PAYLOAD_ALIGNMENT boundary
+
+const uint32_t ASSET_PACK_MAGIC = 0x4B415050; // "PPAK"
+const uint32_t ASSET_PACK_VERSION = 1;
+// Page sized, so each chunk maps and faults in on its own
+const uint64_t ASSET_PAYLOAD_ALIGNMENT = 4096;
+// Buffer payloads are split into chunks of at most this size
+const uint64_t ASSET_MAX_CHUNK_SIZE = 4ull * 1024 * 1024;
+// A texture mip is always one chunk; the baker rejects larger ones
+const uint64_t ASSET_MAX_MIP_SIZE = 16ull * 1024 * 1024;
+const uint32_t ASSET_NOT_FOUND = UINT32_MAX;
+
+enum class AssetKind : uint32_t {
+    // Vertex and index buffer in one: AssetVertex[vertex_count], then uint32 indices at index_offset
+    Mesh,
+    // Full mip chain, mip 0 first, tightly packed texels or blocks
+    Texture,
+    // AssetMaterial[material_count], ready to bind as a storage buffer
+    Material
+};
+
+typedef struct AssetVertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+} AssetVertex;
+
+// std430 layout
+typedef struct AssetMaterial {
+    float base_color[4];
+    // Index of a texture asset in the same pack, or ASSET_NOT_FOUND
+    uint32_t base_color_texture;
+    float roughness;
+    float metallic;
+    uint32_t padding;
+} AssetMaterial;
+
+typedef struct AssetMeshInfo {
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint64_t index_offset;
+    // Bounding sphere: centre xyz, radius
+    float bounds[4];
+} AssetMeshInfo;
+
+typedef struct AssetTextureInfo {
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+    // VkFormat: VK_FORMAT_R8G8B8A8_UNORM or VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    uint32_t format;
+} AssetTextureInfo;
+
+typedef struct AssetMaterialInfo {
+    uint32_t material_count;
+} AssetMaterialInfo;
+
+typedef struct AssetEntry {
+    AssetKind kind;
+    // Into the string table
+    uint32_t name_offset;
+    uint32_t first_chunk;
+    uint32_t chunk_count;
+    // Bytes of device memory the payload fills: the buffer size, or every mip of the image
+    uint64_t size;
+    union {
+        AssetMeshInfo mesh;
+        AssetTextureInfo texture;
+        AssetMaterialInfo material;
+    };
+} AssetEntry;
+
+// A contiguous run of payload bytes with a single destination. Chunks of one asset are stored
+// consecutively, in the order they should be uploaded.
+typedef struct AssetChunk {
+    uint64_t file_offset;
+    uint64_t size;
+    // Byte offset into the buffer; 0 for textures
+    uint64_t destination_offset;
+    uint32_t asset;
+    // Texture mip this chunk fills; 0 for buffers
+    uint32_t mip_level;
+} AssetChunk;
+
+typedef struct AssetPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t asset_count;
+    uint32_t chunk_count;
+    uint64_t asset_table_offset;
+    uint64_t chunk_table_offset;
+    uint64_t string_table_offset;
+    uint64_t string_table_size;
+    uint64_t file_size;
+} AssetPackHeader;
+
+static_assert(sizeof(AssetVertex) == 32, "AssetVertex must match the vertex input layout");
+static_assert(sizeof(AssetMaterial) == 32, "AssetMaterial must match the std430 layout");
+static_assert(sizeof(AssetEntry) == 56, "AssetEntry is part of the file format");
+static_assert(sizeof(AssetChunk) == 32, "AssetChunk is part of the file format");
+static_assert(sizeof(AssetPackHeader) == 56, "AssetPackHeader is part of the file format");
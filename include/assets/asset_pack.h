@@ -0,0 +1,57 @@
+#pragma once
+
+#include "assets/asset_format.h"
+#include <cstdint>
+#include <string>
+
+// A baked asset pack mapped read-only into memory. Opening checks the header and that every table
+// entry stays inside the file; payloads are never read or copied here, they are handed out as
+// pointers into the mapping. Thread-safe once constructed.
+class AssetPack {
+public:
+    explicit AssetPack(const std::string& path);
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    uint32_t asset_count() const { return m_header->asset_count; }
+    uint32_t chunk_count() const { return m_header->chunk_count; }
+    const AssetEntry& asset(uint32_t index) const { return m_assets[index]; }
+    const AssetChunk& chunk(uint32_t index) const { return m_chunks[index]; }
+    const char* name(uint32_t asset) const { return m_strings + m_assets[asset].name_offset; }
+    // ASSET_NOT_FOUND when no asset has that name
+    uint32_t find(const std::string& name) const;
+
+    const void* data(const AssetChunk& chunk) const { return m_base + chunk.file_offset; }
+    uint64_t size() const { return m_size; }
+    uint64_t largest_chunk() const { return m_largest_chunk; }
+
+    // Asks the kernel to read the chunk ahead, then touches every page so it is resident before
+    // this returns. Blocks on disk I/O for a cold chunk; meant for a background thread.
+    void prefetch(const AssetChunk& chunk) const;
+
+    // Evicts the file from the OS page cache so the next open reads from disk. Returns false
+    // where that isn't supported.
+    static bool drop_page_cache(const std::string& path);
+
+private:
+    std::string m_path;
+    const char* m_base = nullptr;
+    uint64_t m_size = 0;
+    uint64_t m_largest_chunk = 0;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+
+    const AssetPackHeader* m_header = nullptr;
+    const AssetEntry* m_assets = nullptr;
+    const AssetChunk* m_chunks = nullptr;
+    const char* m_strings = nullptr;
+
+    void map(const std::string& path);
+    void unmap();
+    void validate();
+};
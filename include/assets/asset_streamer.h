@@ -0,0 +1,95 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "assets/asset_pack.h"
+#include "memory/device_allocator.h"
+#include "transfer/upload_manager.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef struct AssetStreamerStats {
+    uint32_t requested = 0;
+    uint32_t resident = 0;
+    uint64_t chunks_prefetched = 0;
+    uint64_t chunks_uploaded = 0;
+    uint64_t bytes_uploaded = 0;
+    // Time the I/O thread spent faulting chunks in
+    double io_ms = 0.0;
+} AssetStreamerStats;
+
+// Device objects for one asset: a buffer for meshes and materials, an image and view for textures
+typedef struct AssetResource {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    Allocation memory;
+} AssetResource;
+
+// Streams assets out of a mapped AssetPack into device-local buffers and images. A background I/O
+// thread faults requested chunks into memory, always picking the highest-priority asset next, and
+// the render thread copies chunks that are already resident straight from the mapping into the
+// staging ring, so neither side parses anything and the render thread never waits on the disk.
+// Everything but the I/O thread's prefetching runs on the render thread; not thread-safe.
+class AssetStreamer {
+public:
+    AssetStreamer(VkPhysicalDevice physical_device, VkDevice device, DeviceAllocator& allocator, const AssetPack& pack);
+    // The GPU must be done with the resources and with any upload still referencing them
+    ~AssetStreamer();
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    // Creates the asset's buffer or image and queues it; higher priorities stream first, so
+    // callers raise what is visible. Requesting again only changes the priority.
+    void request(uint32_t asset, float priority);
+
+    // Queues the chunks the I/O thread has made resident, highest priority first, until the
+    // staging ring fills. Returns true once every requested asset is resident; like GpuScene, an
+    // asset counts as resident once its last upload is queued, since graphics waits on the flush.
+    bool stream(UploadManager& uploads);
+
+    bool is_resident(uint32_t asset) const { return m_states[asset].uploaded == m_pack.asset(asset).chunk_count && m_states[asset].requested; }
+    const AssetResource& resource(uint32_t asset) const { return m_states[asset].resource; }
+    const AssetPack& pack() const { return m_pack; }
+
+    AssetStreamerStats stats() const;
+    void report() const;
+
+private:
+    typedef struct AssetState {
+        AssetResource resource;
+        bool requested = false;
+        float priority = 0.0f;
+        uint32_t uploaded = 0;
+        // Written by the I/O thread; chunks [0, prefetched) can be copied without faulting
+        std::atomic<uint32_t> prefetched{0};
+    } AssetState;
+
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    const AssetPack& m_pack;
+
+    std::unique_ptr<AssetState[]> m_states;
+    // Requested and not yet resident, render thread only
+    std::vector<uint32_t> m_active;
+    AssetStreamerStats m_stats;
+
+    // Guards m_io_queue and the priorities the I/O thread reads
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<uint32_t> m_io_queue;
+    bool m_stop = false;
+    std::atomic<uint64_t> m_chunks_prefetched{0};
+    std::atomic<uint64_t> m_io_ns{0};
+    std::thread m_thread;
+
+    void create_resource(uint32_t asset);
+    void destroy_resource(AssetResource& resource);
+    bool upload_chunk(UploadManager& uploads, const AssetEntry& entry, const AssetChunk& chunk);
+    void io_main();
+};
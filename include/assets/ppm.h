@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary P6 with a maxval of 255, comments allowed in the header. rgba is width * height RGBA8
+// texels, row-major; alpha is 255 on load and dropped on save.
+void load_ppm(const std::string& path, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba);
+void save_ppm(const std::string& path, uint32_t width, uint32_t height, const uint8_t* rgba);
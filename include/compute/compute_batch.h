@@ -0,0 +1,87 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "compute/image_filter.h"
+#include "descriptor/bindless_table.h"
+#include "memory/device_allocator.h"
+#include "pipeline/shader_library.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t DEFAULT_BATCH_IN_FLIGHT = 3;
+
+typedef struct ComputeBatchConfig {
+    // Binary PPMs
+    std::vector<std::string> inputs;
+    // Each result is written here under its input's file name
+    std::string output_dir = ".";
+    float exposure = 1.0f;
+    // Images loaded, filtered and saved at once; 1 serialises the CPU and the GPU
+    uint32_t in_flight = DEFAULT_BATCH_IN_FLIGHT;
+} ComputeBatchConfig;
+
+typedef struct ComputeBatchStats {
+    uint32_t images = 0;
+    uint64_t pixels = 0;
+    double total_ms = 0.0;
+    // CPU time decoding and encoding PPMs, and blocked on the GPU
+    double load_ms = 0.0;
+    double save_ms = 0.0;
+    double wait_ms = 0.0;
+} ComputeBatchStats;
+
+// Headless batch image processing: runs ImageFilter over a list of PPMs on one compute-capable
+// queue. Each image in flight has its own host-visible storage buffer, filtered in place, and a
+// timeline value; the next images are decoded while the GPU works on the earlier ones. Needs no
+// surface, swapchain or graphics queue.
+class ComputeBatch {
+public:
+    ComputeBatch(VkDevice device, DeviceAllocator& allocator, BindlessTable& bindless, ShaderLibrary& shaders, VkQueue queue,
+                 uint32_t queue_family, uint32_t in_flight = DEFAULT_BATCH_IN_FLIGHT);
+    ~ComputeBatch();
+
+    ComputeBatch(const ComputeBatch&) = delete;
+    ComputeBatch& operator=(const ComputeBatch&) = delete;
+
+    // Throws on the first image that fails to load or save
+    const ComputeBatchStats& run(const ComputeBatchConfig& config);
+
+    const ComputeBatchStats& stats() const { return m_stats; }
+    void report() const;
+
+private:
+    typedef struct BatchSlot {
+        VkCommandPool command_pool = VK_NULL_HANDLE;
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        Allocation memory;
+        uint32_t bindless_slot = BINDLESS_INVALID_SLOT;
+        VkDeviceSize capacity = 0;
+        uint64_t timeline_value = 0;
+        // Where the image being filtered goes; empty when the slot is free
+        std::string output;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    } BatchSlot;
+
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    BindlessTable& m_bindless;
+    VkQueue m_queue;
+    ImageFilter m_filter;
+
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    uint64_t m_timeline_value = 0;
+    std::vector<BatchSlot> m_slots;
+    // Decode scratch, reused across images
+    std::vector<uint8_t> m_pixels;
+
+    ComputeBatchStats m_stats;
+
+    void reserve(BatchSlot& slot, VkDeviceSize size);
+    void destroy_buffer(BatchSlot& slot);
+    void submit(BatchSlot& slot, float exposure);
+    // Waits for the slot's image and saves it
+    void finish(BatchSlot& slot);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "descriptor/bindless_table.h"
+#include "pipeline/shader_library.h"
+#include <cstdint>
+
+const uint32_t IMAGE_FILTER_WORKGROUP_SIZE = 64;
+// The smallest maxComputeWorkGroupCount[0] the spec allows; bigger images take several dispatches
+const uint32_t IMAGE_FILTER_MAX_GROUPS = 65535;
+
+// Exposure adjustment over packed RGBA8 pixels in bindless storage buffers. Needs only a
+// compute-capable queue, so it runs on the async compute queue or in the headless batch mode.
+class ImageFilter {
+public:
+    ImageFilter(ShaderLibrary& shaders, BindlessTable& bindless);
+
+    ImageFilter(const ImageFilter&) = delete;
+    ImageFilter& operator=(const ImageFilter&) = delete;
+
+    // src and dst are storage buffer slots of at least pixel_count uints; they may be the same
+    void record(VkCommandBuffer command_buffer, uint32_t src, uint32_t dst, uint32_t pixel_count, float exposure) const;
+
+private:
+    ShaderLibrary& m_shaders;
+    BindlessTable& m_bindless;
+
+    // Owned by the shader library, which may swap it between frames
+    PipelineHandle m_pipeline = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "memory/device_allocator.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GPU crash breadcrumbs: a begin and an end marker per slot (one slot per render graph pass) in
+// host-visible memory, which stays readable after the device is lost. Markers are vkCmdFillBuffer
+// writes of the frame serial; the begin marker lands when the queue reaches the pass, the end
+// marker only once the pass's work has completed. A slot whose begin is newer than its end is a
+// pass that started and never finished. Waiting for the pass to complete drains the queue before
+// every end marker, so they are for debugging device losses, not for normal runs.
+class Breadcrumbs {
+public:
+    // Every family in queue_families records markers; more than one makes the buffer concurrent
+    Breadcrumbs(VkDevice device, DeviceAllocator& allocator, uint32_t slot_count, const std::vector<uint32_t>& queue_families);
+    ~Breadcrumbs();
+
+    Breadcrumbs(const Breadcrumbs&) = delete;
+    Breadcrumbs& operator=(const Breadcrumbs&) = delete;
+
+    // Labels must be string literals, like the pass names they come from
+    void set_label(uint32_t slot, const char* label);
+    // Markers recorded from here on carry a new serial
+    void begin_frame() { m_serial++; }
+
+    void record_begin(VkCommandBuffer command_buffer, uint32_t slot) const;
+    void record_end(VkCommandBuffer command_buffer, uint32_t slot) const;
+    // Makes the markers recorded so far visible to the host once command_buffer completes
+    void record_host_barrier(VkCommandBuffer command_buffer) const;
+
+    uint32_t slot_count() const { return (uint32_t)m_labels.size(); }
+    // Labels of the slots whose last begin marker has no matching end marker
+    std::vector<std::string> unfinished() const;
+    // Post-mortem: where each labelled slot got to
+    void report() const;
+
+private:
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    Allocation m_memory;
+    // Begin, end pairs; 0 until a slot's first marker lands
+    const uint32_t* m_markers = nullptr;
+    std::vector<const char*> m_labels;
+    uint32_t m_serial = 0;
+};
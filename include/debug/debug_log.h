@@ -0,0 +1,134 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint32_t DEFAULT_DEBUG_RING_CAPACITY = 1024;
+// Occurrences of one message ID logged in full before the rest are only counted
+const uint32_t DEFAULT_DEBUG_REPEAT_LIMIT = 3;
+const uint32_t DEBUG_MESSAGE_CHARS = 1024;
+const uint32_t DEBUG_ID_NAME_CHARS = 96;
+// Distinct message IDs that get their own counter; past that, messages are logged without deduplication
+const uint32_t DEBUG_COUNTER_SLOTS = 512;
+
+typedef struct DebugLogConfig {
+    // Severities below this are never subscribed to, so the layers don't even format them
+    VkDebugUtilsMessageSeverityFlagBitsEXT min_severity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+    // VUID names (e.g. "VUID-vkCmdDraw-None-02859") or message ID numbers, decimal or 0x hex
+    std::vector<std::string> muted;
+    uint32_t ring_capacity = DEFAULT_DEBUG_RING_CAPACITY;
+    uint32_t repeat_limit = DEFAULT_DEBUG_REPEAT_LIMIT;
+} DebugLogConfig;
+
+// A PERFORMANCE-type message, handed to the performance handler on the logger thread
+typedef struct DebugEvent {
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+    VkDebugUtilsMessageTypeFlagsEXT type;
+    int32_t message_id;
+    std::string id_name;
+    std::string message;
+    // Occurrences of this message ID so far, this one included
+    uint64_t count;
+} DebugEvent;
+
+typedef struct DebugLogStats {
+    uint64_t received = 0;
+    // Below the minimum severity or muted by ID
+    uint64_t muted = 0;
+    // Repeats past the limit, counted but not logged
+    uint64_t suppressed = 0;
+    // Ring was full; the driver thread never waits for the logger
+    uint64_t dropped = 0;
+    uint64_t logged = 0;
+    uint64_t performance_events = 0;
+} DebugLogStats;
+
+VkDebugUtilsMessageSeverityFlagBitsEXT parse_debug_severity(const std::string& name);
+
+// Debug-utils messenger sink. The callback runs inside driver calls on whatever thread made them,
+// so it only filters, bumps a lock-free per-ID counter and copies the message into a bounded
+// multi-producer ring; a logger thread formats and writes it. Nothing on the callback path
+// allocates, locks or blocks.
+class DebugLog {
+public:
+    explicit DebugLog(const DebugLogConfig& config);
+    ~DebugLog();
+
+    DebugLog(const DebugLog&) = delete;
+    DebugLog& operator=(const DebugLog&) = delete;
+
+    // For vkCreateDebugUtilsMessengerEXT and the VkInstanceCreateInfo pNext chain
+    VkDebugUtilsMessengerCreateInfoEXT messenger_info();
+
+    // Called on the logger thread; set before the messenger is created
+    void set_performance_handler(std::function<void(const DebugEvent&)> handler) { m_performance_handler = std::move(handler); }
+
+    // Waits until everything queued so far has been written
+    void flush();
+    DebugLogStats stats() const;
+    // Message IDs that repeated, with their counts
+    void report() const;
+
+private:
+    typedef struct Message {
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+        VkDebugUtilsMessageTypeFlagsEXT type;
+        int32_t message_id;
+        uint64_t count;
+        char id_name[DEBUG_ID_NAME_CHARS];
+        char text[DEBUG_MESSAGE_CHARS];
+    } Message;
+
+    // Vyukov's bounded MPMC queue: a slot is free for the producer whose ticket matches its sequence
+    typedef struct Slot {
+        std::atomic<uint64_t> sequence;
+        Message message;
+    } Slot;
+
+    typedef struct Counter {
+        // 0 while the slot is free
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> count{0};
+        int32_t message_id = 0;
+        char id_name[DEBUG_ID_NAME_CHARS] = {};
+    } Counter;
+
+    DebugLogConfig m_config;
+    std::vector<int32_t> m_muted_ids;
+    std::function<void(const DebugEvent&)> m_performance_handler;
+
+    std::unique_ptr<Slot[]> m_ring;
+    uint64_t m_ring_mask;
+    std::atomic<uint64_t> m_enqueue_position{0};
+    uint64_t m_dequeue_position = 0;
+
+    std::unique_ptr<Counter[]> m_counters;
+
+    std::atomic<uint64_t> m_received{0};
+    std::atomic<uint64_t> m_muted_count{0};
+    std::atomic<uint64_t> m_suppressed{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_logged{0};
+    std::atomic<uint64_t> m_performance_events{0};
+    std::atomic<uint64_t> m_written{0};
+
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+
+    bool is_muted(const VkDebugUtilsMessengerCallbackDataEXT* data) const;
+    uint64_t count_occurrence(const VkDebugUtilsMessengerCallbackDataEXT* data);
+    bool enqueue(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+                 const VkDebugUtilsMessengerCallbackDataEXT* data, uint64_t count);
+    bool dequeue(Message& message);
+    void write(const Message& message);
+    void logger_main();
+
+    static VKAPI_ATTR VkBool32 VKAPI_CALL callback(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+                                                   const VkDebugUtilsMessengerCallbackDataEXT* data, void* user_data);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+// Thrown where a Vulkan call returns VK_ERROR_DEVICE_LOST. The engine recovers from it by rebuilding
+// the device; every other std::runtime_error stays fatal.
+class DeviceLostError : public std::runtime_error {
+public:
+    explicit DeviceLostError(const std::string& what) : std::runtime_error(what) {}
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Requested slots per binding; clamped to the device's update-after-bind limits
+const uint32_t BINDLESS_SAMPLED_IMAGES = 16384;
+const uint32_t BINDLESS_STORAGE_IMAGES = 4096;
+const uint32_t BINDLESS_STORAGE_BUFFERS = 16384;
+const uint32_t BINDLESS_SAMPLERS = 64;
+// The push constant range every bindless pipeline shares; 128 bytes is the guaranteed minimum
+const uint32_t BINDLESS_PUSH_CONSTANT_SIZE = 128;
+
+// One binding per descriptor type in set 0, in this order. Shaders index the arrays with slots
+// passed through push constants.
+enum class BindlessKind {
+    SampledImage,
+    StorageImage,
+    StorageBuffer,
+    Sampler
+};
+
+const uint32_t BINDLESS_KIND_COUNT = 4;
+const uint32_t BINDLESS_INVALID_SLOT = UINT32_MAX;
+
+typedef struct BindlessStats {
+    uint32_t capacity[BINDLESS_KIND_COUNT] = {};
+    uint32_t used[BINDLESS_KIND_COUNT] = {};
+    uint64_t writes = 0;
+    uint64_t update_calls = 0;
+} BindlessStats;
+
+// A single update-after-bind, partially bound descriptor set holding every image, buffer and sampler
+// the engine uses, plus the one pipeline layout that goes with it. Bind once per command buffer.
+// Slots come from a free list per binding; released slots are recycled frame_count frames later so
+// in-flight frames never see a descriptor change under them. Not thread-safe.
+class BindlessTable {
+public:
+    BindlessTable(VkPhysicalDevice physical_device, VkDevice device, uint32_t frame_count, const VkAllocationCallbacks* host_allocator = nullptr);
+    ~BindlessTable();
+
+    BindlessTable(const BindlessTable&) = delete;
+    BindlessTable& operator=(const BindlessTable&) = delete;
+
+    // Recycles the slots released the last time frame_index was in flight
+    void begin_frame(uint32_t frame_index);
+
+    uint32_t add_sampled_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t add_storage_image(VkImageView view);
+    uint32_t add_storage_buffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    uint32_t add_sampler(VkSampler sampler);
+    void release(BindlessKind kind, uint32_t slot);
+
+    // Writes queued since the last flush go out in one vkUpdateDescriptorSets call. Update-after-bind
+    // lets this happen after the set was bound, as long as it's before submission.
+    void flush();
+
+    void bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point) const;
+
+    VkDescriptorSetLayout set_layout() const { return m_set_layout; }
+    VkPipelineLayout pipeline_layout() const { return m_pipeline_layout; }
+    VkDescriptorSet set() const { return m_set; }
+    const BindlessStats& stats() const { return m_stats; }
+    void report() const;
+
+private:
+    typedef struct SlotAllocator {
+        uint32_t capacity = 0;
+        uint32_t next = 0;
+        std::vector<uint32_t> free;
+    } SlotAllocator;
+
+    // Image and buffer infos are kept by index so the vectors can grow while writes are queued
+    typedef struct PendingWrite {
+        BindlessKind kind;
+        uint32_t slot;
+        uint32_t info;
+    } PendingWrite;
+
+    VkDevice m_device;
+    const VkAllocationCallbacks* m_host_allocator;
+    VkDescriptorSetLayout m_set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool m_pool = VK_NULL_HANDLE;
+    VkDescriptorSet m_set = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+
+    SlotAllocator m_slots[BINDLESS_KIND_COUNT];
+    // Per frame slot: (kind, slot) pairs waiting for the frame to retire
+    std::vector<std::vector<std::pair<BindlessKind, uint32_t>>> m_retired;
+    uint32_t m_frame_index = 0;
+
+    std::vector<PendingWrite> m_pending;
+    std::vector<VkDescriptorImageInfo> m_image_infos;
+    std::vector<VkDescriptorBufferInfo> m_buffer_infos;
+
+    BindlessStats m_stats;
+
+    uint32_t allocate_slot(BindlessKind kind);
+};
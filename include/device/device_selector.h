@@ -0,0 +1,80 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A fixed table of extension or layer names, normally a static array
+typedef struct NameList {
+    const char* const* names = nullptr;
+    uint32_t count = 0;
+} NameList;
+
+template <size_t N>
+NameList name_list(const char* const (&names)[N]) {
+    return {names, (uint32_t)N};
+}
+
+// Every required name appears in available. Linear strcmp scans: both lists are a few dozen entries at most.
+bool has_names(const std::vector<VkExtensionProperties>& available, NameList required);
+bool has_names(const std::vector<VkLayerProperties>& available, NameList required);
+
+// Everything device selection looks at, captured up front so ranking runs on plain data and a
+// mocked device list can be scored without a Vulkan instance
+typedef struct DeviceCandidate {
+    VkPhysicalDevice handle = VK_NULL_HANDLE;
+    std::string name;
+    uint8_t uuid[VK_UUID_SIZE] = {};
+    VkPhysicalDeviceType type = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+    uint32_t api_version = 0;
+    VkDeviceSize device_local_bytes = 0;
+    uint32_t max_image_dimension_2d = 0;
+    uint32_t max_compute_shared_memory = 0;
+
+    // Required
+    bool graphics_queue = false;
+    bool present_queue = false;
+    bool timeline_semaphore = false;
+    // Update-after-bind, partially bound, non-uniformly indexed descriptor arrays for the bindless table
+    bool bindless = false;
+    // multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount for the GPU-driven scene
+    bool indirect_count = false;
+    bool swapchain_adequate = false;
+
+    // Optional
+    // Vulkan 1.3 only; without both the engine falls back to render pass objects and sync1 barriers
+    bool synchronization2 = false;
+    bool dynamic_rendering = false;
+    bool combined_graphics_present = false;
+    bool async_compute_queue = false;
+    bool dedicated_transfer_queue = false;
+    bool pipeline_statistics = false;
+} DeviceCandidate;
+
+typedef struct ScoreTerm {
+    const char* label;
+    int64_t points;
+} ScoreTerm;
+
+typedef struct DeviceScore {
+    // Empty when the device meets every requirement
+    std::string rejection;
+    int64_t total = 0;
+    std::vector<ScoreTerm> terms;
+} DeviceScore;
+
+// surface may be null, in which case presentation is not required
+DeviceCandidate describe_physical_device(VkPhysicalDevice device, VkSurfaceKHR surface, NameList required_extensions);
+std::vector<DeviceCandidate> enumerate_device_candidates(VkInstance instance, VkSurfaceKHR surface, NameList required_extensions);
+
+DeviceScore score_device(const DeviceCandidate& candidate);
+std::string format_uuid(const uint8_t uuid[VK_UUID_SIZE]);
+
+// Highest scoring suitable device, or the one the override names. The override matches a
+// case-insensitive substring of the device name or the full UUID, with or without dashes.
+// Returns -1 when nothing is suitable; throws when the override matches no suitable device.
+int32_t select_device(const std::vector<DeviceCandidate>& candidates, const std::string& override_device, std::vector<DeviceScore>& scores);
+
+void log_device_selection(const std::vector<DeviceCandidate>& candidates, const std::vector<DeviceScore>& scores, int32_t selected);
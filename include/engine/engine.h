@@ -0,0 +1,395 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "memory/device_allocator.h"
+#include "memory/host_allocator.h"
+#include "pipeline/pipeline_cache.h"
+#include "pipeline/shader_library.h"
+#include "jobs/job_system.h"
+#include "render/parallel_recorder.h"
+#include "transfer/upload_manager.h"
+#include "profiler/profiler.h"
+#include "render/render_graph.h"
+#include "descriptor/bindless_table.h"
+#include "render/gpu_scene.h"
+#include "present/present_policy.h"
+#include "debug/debug_log.h"
+#include "debug/breadcrumbs.h"
+#include "debug/device_lost.h"
+#include "assets/asset_streamer.h"
+#include "compute/compute_batch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+typedef struct GLFWwindow GLFWwindow;
+
+const uint32_t WINDOW_WIDTH = 800;
+const uint32_t WINDOW_HEIGHT = 600;
+const bool DEBUG = true;
+
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+const uint64_t DEFAULT_HEADLESS_FRAMES = 1000;
+const uint32_t DEFAULT_MAX_DEVICE_LOST_RECOVERIES = 8;
+
+// Set on pluto_core by CMake; the sources are watched for hot reload and the build-time SPIR-V preferred over builtin_shaders.h
+#ifndef PLUTO_SHADER_SOURCE_DIR
+#define PLUTO_SHADER_SOURCE_DIR ""
+#endif
+#ifndef PLUTO_SHADER_BINARY_DIR
+#define PLUTO_SHADER_BINARY_DIR ""
+#endif
+#ifndef PLUTO_SHADER_COMPILER
+#define PLUTO_SHADER_COMPILER "glslc"
+#endif
+
+typedef struct QueueFamiliyIndicies {
+    std::optional<uint32_t> graphics_family;
+    std::optional<uint32_t> present_family;
+    // Transfer-capable family without graphics, when the device exposes one
+    std::optional<uint32_t> transfer_family;
+    // Compute-capable family without graphics, when the device exposes one and async compute is on.
+    // May be the transfer family, in which case it gets the second queue if there is one.
+    std::optional<uint32_t> compute_family;
+    uint32_t compute_queue_index = 0;
+
+    bool is_complete() {
+        return graphics_family.has_value() && present_family.has_value();
+    }
+} QueueFamiliyIndicies;
+
+typedef struct SwapChainSupportDetails {
+    VkSurfaceCapabilitiesKHR capabilites;
+    std::vector<VkSurfaceFormatKHR> surface_formats;
+    std::vector<VkPresentModeKHR> surface_present_modes;
+} SwapChainSupportDetails;
+
+// Window presents through GLFW, HeadlessSurface through a VK_EXT_headless_surface swapchain,
+// Offscreen renders into device-local images and never touches a window system. ComputeOnly renders
+// nothing: it runs EngineConfig::compute_batch on the compute queue and exits.
+enum class PresentBackend {
+    Window,
+    HeadlessSurface,
+    Offscreen,
+    ComputeOnly
+};
+
+typedef struct EngineConfig {
+    PresentBackend backend = PresentBackend::Window;
+    uint32_t width = WINDOW_WIDTH;
+    uint32_t height = WINDOW_HEIGHT;
+    uint32_t frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT;
+    // 0 runs until the window is closed
+    uint64_t max_frames = 0;
+    std::string pipeline_cache_path = "pipeline_cache.bin";
+    // Empty disables shader hot reload
+    std::string shader_source_dir = PLUTO_SHADER_SOURCE_DIR;
+    std::string shader_cache_dir = "shader_cache";
+    // 0 sizes the job system to the core count
+    uint32_t worker_threads = 0;
+    // Dispatches of the no-op pipeline recorded across worker threads each frame
+    uint32_t synthetic_draws = 0;
+    // Objects in the GPU-culled scene; 0 disables it
+    uint32_t scene_objects = 0;
+    // Pack from pluto_baker, streamed in from the first frame; empty for none
+    std::string asset_pack;
+    // Chrome trace written on exit when set; needs a PLUTO_PROFILER build
+    std::string trace_path;
+    // Device name substring or UUID; empty picks the highest scoring device
+    std::string device;
+    // Validation layers and the debug messenger; benchmarks turn them off
+    bool validation = DEBUG;
+    DebugLogConfig debug;
+    PresentPolicy present_policy = PresentPolicy::Balanced;
+    // Frame starts are held to this rate, 0 runs as fast as the present mode allows
+    double target_fps = 0.0;
+    // Scene culling on a dedicated compute queue, overlapping graphics, when the device has one
+    bool async_compute = true;
+    // Render pass + framebuffers and sync1 barriers even where the Vulkan 1.3 path is available, for
+    // comparison; devices without dynamicRendering and synchronization2 always get them
+    bool classic_render_path = false;
+    // Forces a swapchain recreation every this many frames, alternating between the configured
+    // extent and half of it; 0 never does. A window keeps its own size, so there it only recreates.
+    uint32_t resize_every = 0;
+    // Begin and end markers around every render graph pass, reported when the device is lost. Off by
+    // default: each end marker waits for all earlier work on its queue, which drains the GPU every pass.
+    bool breadcrumbs = false;
+    // Device losses rebuilt from before the next one is rethrown; 0 makes the first one fatal
+    uint32_t max_device_lost_recoveries = DEFAULT_MAX_DEVICE_LOST_RECOVERIES;
+    // Fault injection: the device is reported lost this many frames after startup and after each
+    // recovery, inside inject_device_lost_pass (the last pass if empty); 0 never does
+    uint64_t inject_device_lost_after = 0;
+    std::string inject_device_lost_pass;
+    // Only used by PresentBackend::ComputeOnly
+    ComputeBatchConfig compute_batch;
+} EngineConfig;
+
+// Command buffers are owned by the render graph
+typedef struct FrameData {
+    VkSemaphore image_available_semaphore = VK_NULL_HANDLE;
+    VkFence in_flight_fence = VK_NULL_HANDLE;
+} FrameData;
+
+// cpu_ms excludes time blocked on fences, image acquisition and frame pacing, frame_ms is
+// start-to-start, latency_ms runs from the input poll until vkQueuePresentKHR returned
+typedef struct FrameStats {
+    std::vector<double> cpu_ms;
+    std::vector<double> frame_ms;
+    std::vector<double> latency_ms;
+    std::vector<double> recreate_ms;
+    // Device-lost recoveries: from the loss being caught until the rebuilt device could draw again
+    std::vector<double> recovery_ms;
+
+    void add(double cpu, double frame, double latency) {
+        cpu_ms.push_back(cpu);
+        frame_ms.push_back(frame);
+        latency_ms.push_back(latency);
+    }
+
+    static double average(const std::vector<double>& samples, size_t first = 0) {
+        if (first >= samples.size()) return 0.0;
+
+        double total = 0.0;
+        for (size_t i = first; i < samples.size(); i++) {
+            total += samples[i];
+        }
+        return total / (double)(samples.size() - first);
+    }
+
+    static double percentile(std::vector<double> samples, double p) {
+        if (samples.empty()) return 0.0;
+
+        size_t index = (size_t)(p * (double)(samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    void report() const;
+} FrameStats;
+
+// Objects created for the swapchain over the whole run, initial creation included: the image views
+// every path needs (depth included) and the framebuffers only the classic render path adds
+typedef struct SwapchainObjectStats {
+    uint64_t image_views = 0;
+    uint64_t framebuffers = 0;
+    uint32_t render_passes = 0;
+} SwapchainObjectStats;
+
+// A swapchain handed to its replacement through oldSwapchain, kept alive until frames that used it have retired
+typedef struct RetiredSwapchain {
+    // VK_NULL_HANDLE for the offscreen backend, which retires its images instead
+    VkSwapchainKHR swapchain;
+    std::vector<VkImage> offscreen_images;
+    std::vector<Allocation> offscreen_memory;
+    std::vector<VkImageView> image_views;
+    // Empty on the dynamic rendering path
+    std::vector<VkFramebuffer> framebuffers;
+    std::vector<VkSemaphore> render_finished_semaphores;
+    // Scene depth buffer sized to the old extent, VK_NULL_HANDLE without a scene
+    VkImage depth_image;
+    VkImageView depth_view;
+    Allocation depth_memory;
+    uint64_t retire_frame;
+} RetiredSwapchain;
+
+// Wall-clock time of each startup stage, in the order they run; total also covers the scene and the render graph
+typedef struct StartupTimes {
+    // Instance, debug messenger and surface
+    double instance_ms = 0.0;
+    // Physical device selection and the logical device
+    double device_ms = 0.0;
+    // Allocator, upload manager, bindless table, pipeline cache and startup pipelines
+    double pipelines_ms = 0.0;
+    // Swapchain (or offscreen images) and image views
+    double swapchain_ms = 0.0;
+    double total_ms = 0.0;
+} StartupTimes;
+
+// What one run measured, captured when the main loop exits and before anything is destroyed
+typedef struct EngineReport {
+    std::string device_name;
+    StartupTimes startup;
+    FrameStats frames;
+    UploadStats uploads;
+    // From the first frame until the last scene object was queued for upload; 0 without a scene or if streaming never finished
+    double stream_ms = 0.0;
+    // Same for the asset pack's last chunk
+    double assets_ms = 0.0;
+    AllocatorStats memory;
+    // Vulkan host allocations summed over every scope, when init_vulkan returned and when the main loop exited
+    HostScopeStats startup_host_memory;
+    HostScopeStats host_memory;
+    // PresentBackend::ComputeOnly only
+    ComputeBatchStats compute_batch;
+    RenderPath render_path = RenderPath::Dynamic;
+    bool synchronization2 = true;
+    SwapchainObjectStats swapchain_objects;
+    // Passes the breadcrumbs showed started but not finished at the last device loss
+    std::vector<std::string> lost_in_passes;
+    // Zero without validation
+    DebugLogStats debug_messages;
+    std::vector<DebugEvent> performance_events;
+} EngineReport;
+
+class HelloEngine {
+public:
+    HelloEngine(const EngineConfig& config) : m_config(config), m_pacer(config.target_fps, config.present_policy) {}
+
+    void run();
+
+    // Valid once run() returns
+    const EngineReport& report() const { return m_report; }
+
+private:
+    // Declared first so it outlives every Vulkan object
+    HostAllocator m_host_allocator;
+
+    GLFWwindow* m_window = nullptr;
+    VkInstance m_instance = VK_NULL_HANDLE;
+
+    VkDebugUtilsMessengerEXT m_debug_messenger = VK_NULL_HANDLE;
+    // Null without validation
+    std::unique_ptr<DebugLog> m_debug_log;
+    // The performance handler appends to m_report from the logger thread
+    std::mutex m_performance_events_mutex;
+
+    VkPhysicalDevice m_physical_device = VK_NULL_HANDLE;
+    // Queried once the physical device is picked
+    QueueFamiliyIndicies m_queue_families;
+    // Both come down to Classic / false on devices without the Vulkan 1.3 features
+    RenderPath m_render_path = RenderPath::Dynamic;
+    bool m_synchronization2 = true;
+    VkDevice m_device = VK_NULL_HANDLE;
+    // Set from a caught DeviceLostError until the device is rebuilt; skips work a lost device can't do
+    bool m_device_lost = false;
+
+    std::unique_ptr<DeviceAllocator> m_allocator;
+    std::unique_ptr<PipelineCache> m_pipeline_cache;
+    std::unique_ptr<ShaderLibrary> m_shaders;
+
+    // Every pipeline uses the bindless table's layout
+    std::unique_ptr<BindlessTable> m_bindless;
+    PipelineHandle m_noop_pipeline = 0;
+
+    std::unique_ptr<GpuScene> m_scene;
+    std::unique_ptr<AssetPack> m_asset_pack;
+    std::unique_ptr<AssetStreamer> m_assets;
+    std::unique_ptr<ComputeBatch> m_compute_batch;
+    VkImage m_depth_image = VK_NULL_HANDLE;
+    VkImageView m_depth_view = VK_NULL_HANDLE;
+    Allocation m_depth_memory;
+
+    std::unique_ptr<JobSystem> m_jobs;
+    std::unique_ptr<ParallelRecorder> m_recorder;
+    std::unique_ptr<UploadManager> m_uploads;
+    std::unique_ptr<RenderGraph> m_render_graph;
+    ResourceHandle m_backbuffer = 0;
+    ResourceHandle m_scene_depth = 0;
+    ResourceHandle m_scene_commands = 0;
+    ResourceHandle m_scene_count = 0;
+    // Stays null when the profiler is compiled out
+    std::unique_ptr<Profiler> m_profiler;
+    bool m_pipeline_statistics_supported = false;
+    // Null with EngineConfig::breadcrumbs off
+    std::unique_ptr<Breadcrumbs> m_breadcrumbs;
+
+    VkQueue m_graphics_queue = VK_NULL_HANDLE;
+    VkQueue m_present_queue = VK_NULL_HANDLE;
+    VkQueue m_transfer_queue = VK_NULL_HANDLE;
+    // The graphics queue without a separate compute family
+    VkQueue m_compute_queue = VK_NULL_HANDLE;
+
+    VkSurfaceKHR m_surface = VK_NULL_HANDLE;
+    // Filled by the first create_swapchain; later ones only refresh the capabilities
+    SwapChainSupportDetails m_swapchain_support;
+
+    VkSwapchainKHR m_swapchain = VK_NULL_HANDLE;
+    std::vector<VkImage> m_swapchain_images;
+    std::vector<Allocation> m_offscreen_memory;
+    VkImageLayout m_present_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    std::vector<VkImageView> m_swapchain_image_views;
+    // One per swapchain image over its view and the depth view, RenderPath::Classic with a scene only
+    std::vector<VkFramebuffer> m_framebuffers;
+    VkFormat m_swapchain_format;
+    VkExtent2D m_swapchain_extent;
+    // The image acquired for the frame being recorded
+    uint32_t m_image_index = 0;
+
+    std::vector<RetiredSwapchain> m_retired_swapchains;
+    bool m_framebuffer_resized = false;
+    // Toggled by each EngineConfig::resize_every recreation
+    bool m_resize_halved = false;
+    SwapchainObjectStats m_swapchain_objects;
+
+    EngineConfig m_config;
+
+    std::vector<FrameData> m_frames;
+    std::vector<VkSemaphore> m_render_finished_semaphores;
+    std::vector<VkFence> m_images_in_flight;
+    uint32_t m_current_frame = 0;
+    uint64_t m_frame_number = 0;
+    // Reset by each device-lost recovery, for EngineConfig::inject_device_lost_after
+    uint64_t m_frames_since_recovery = 0;
+
+    FramePacer m_pacer;
+    std::chrono::steady_clock::time_point m_input_time;
+    double m_present_latency_ms = 0.0;
+
+    FrameStats m_frame_stats;
+    EngineReport m_report;
+    std::chrono::steady_clock::time_point m_loop_start;
+
+    bool uses_window() const { return m_config.backend == PresentBackend::Window; }
+    bool uses_surface() const { return m_config.backend != PresentBackend::Offscreen && !compute_only(); }
+    bool compute_only() const { return m_config.backend == PresentBackend::ComputeOnly; }
+
+    std::vector<const char *> get_required_extenstions();
+    void create_instance();
+    void init_window();
+    void create_surface();
+    void create_offscreen_images();
+    void create_swapchain_image_views();
+    void create_framebuffers();
+    void init_vulkan();
+    void create_device_resources(StartupTimes& times);
+    void destroy_device_resources();
+    void recover_device_lost();
+    void create_depth_image();
+    void create_scene();
+    void create_asset_streamer();
+    void update_scene_camera();
+    void create_shader_library();
+    void create_startup_pipelines();
+    void create_frame_resources();
+    void create_swapchain_sync_objects();
+    void create_swapchain();
+    void create_logical_device();
+    void create_profiler();
+    void create_upload_manager();
+    void create_render_graph();
+    void add_scene_passes();
+    QueueFamiliyIndicies find_queue_families(VkPhysicalDevice device);
+    void pick_physical_device();
+    void setup_debug_messenger();
+    bool check_validation_layer_support();
+    SwapChainSupportDetails query_swapchain_support(VkPhysicalDevice device);
+    VkSurfaceFormatKHR choose_swapchain_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats);
+    VkExtent2D choose_swapchain_extent(const VkSurfaceCapabilitiesKHR& capabilites);
+    VkExtent2D requested_extent() const;
+    void recreate_swapchain();
+    void destroy_retired_swapchain(RetiredSwapchain& retired);
+    void destroy_retired_swapchains(bool force);
+    bool acquire_image(FrameData& frame, uint32_t& image_index);
+    void present_image(uint32_t image_index);
+    bool should_close();
+    bool draw_frame(double& wait_ms);
+    void main_loop();
+    void run_compute_batch();
+    void cleanup();
+    static void framebuffer_resize_callback(GLFWwindow* window, int width, int height);
+};
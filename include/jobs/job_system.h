@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Each thread owns a deque: it pops its own work LIFO and steals
+// from the others FIFO. The thread that calls parallel_for works too and is thread index 0.
+class JobSystem {
+public:
+    // 0 sizes the pool to the core count (hardware threads - 1 workers plus the caller)
+    explicit JobSystem(uint32_t thread_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t thread_count() const { return (uint32_t)m_queues.size(); }
+
+    // 0 for the owning thread, 1..thread_count()-1 for workers
+    static uint32_t current_thread_index();
+
+    // Runs fn over [0, count) in chunks of grain and returns once every chunk has finished.
+    // The first exception thrown by a chunk is rethrown on the calling thread.
+    void parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& fn);
+
+private:
+    typedef struct Batch {
+        std::atomic<uint32_t> remaining;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    } Batch;
+
+    typedef struct Job {
+        std::function<void()> fn;
+        Batch* batch;
+    } Job;
+
+    typedef struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    } WorkQueue;
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<uint32_t> m_pending{0};
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+
+    void push(uint32_t queue, Job job);
+    bool pop(uint32_t thread_index, Job& job);
+    bool try_run_one(uint32_t thread_index);
+    void worker_main(uint32_t thread_index);
+};
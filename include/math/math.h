@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Per-object math. Mat4 products use SSE whenever the target has it (every x86-64 build);
+// everything else is scalar and left to the compiler. Batched work belongs in soa_kernels.h.
+#if defined(__SSE2__) || defined(_M_X64)
+#define PLUTO_MATH_SSE 1
+#include <immintrin.h>
+#endif
+
+typedef struct Vec3 {
+    float x, y, z;
+} Vec3;
+
+typedef struct Vec4 {
+    float x, y, z, w;
+} Vec4;
+
+// Unit quaternion, w is the scalar part
+typedef struct Quat {
+    float x, y, z, w;
+} Quat;
+
+// Column-major, m[column * 4 + row], the layout GLSL expects
+typedef struct alignas(16) Mat4 {
+    float m[16];
+} Mat4;
+
+inline Vec3 operator+(Vec3 a, Vec3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3 operator-(Vec3 a, Vec3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3 operator*(Vec3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+
+inline float dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float length(Vec3 v) { return std::sqrt(dot(v, v)); }
+inline Vec3 normalize(Vec3 v) { return v * (1.0f / length(v)); }
+
+inline Vec3 cross(Vec3 a, Vec3 b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline Quat quat_identity() { return {0.0f, 0.0f, 0.0f, 1.0f}; }
+
+inline Quat quat_axis_angle(Vec3 axis, float angle) {
+    Vec3 v = normalize(axis) * std::sin(angle * 0.5f);
+    return {v.x, v.y, v.z, std::cos(angle * 0.5f)};
+}
+
+inline Quat normalize(Quat q) {
+    float inverse = 1.0f / std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    return {q.x * inverse, q.y * inverse, q.z * inverse, q.w * inverse};
+}
+
+// a * b applies b first
+inline Quat multiply(Quat a, Quat b) {
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+    };
+}
+
+// v + 2w(u x v) + 2(u x (u x v)), u the vector part
+inline Vec3 rotate(Quat q, Vec3 v) {
+    Vec3 u = {q.x, q.y, q.z};
+    Vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+inline Mat4 mat4_identity() {
+    return {{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+}
+
+// Translation * rotation * uniform scale
+inline Mat4 mat4_from_transform(Vec3 position, Quat rotation, float scale) {
+    float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+    return {{
+        (1.0f - 2.0f * (y * y + z * z)) * scale, 2.0f * (x * y + z * w) * scale, 2.0f * (x * z - y * w) * scale, 0.0f,
+        2.0f * (x * y - z * w) * scale, (1.0f - 2.0f * (x * x + z * z)) * scale, 2.0f * (y * z + x * w) * scale, 0.0f,
+        2.0f * (x * z + y * w) * scale, 2.0f * (y * z - x * w) * scale, (1.0f - 2.0f * (x * x + y * y)) * scale, 0.0f,
+        position.x, position.y, position.z, 1.0f,
+    }};
+}
+
+inline Mat4 multiply(const Mat4& a, const Mat4& b) {
+    Mat4 out;
+#ifdef PLUTO_MATH_SSE
+    // Each output column is a linear combination of a's columns
+    __m128 a0 = _mm_load_ps(&a.m[0]);
+    __m128 a1 = _mm_load_ps(&a.m[4]);
+    __m128 a2 = _mm_load_ps(&a.m[8]);
+    __m128 a3 = _mm_load_ps(&a.m[12]);
+    for (uint32_t column = 0; column < 4; column++) {
+        const float* b_column = &b.m[column * 4];
+        __m128 result = _mm_mul_ps(a0, _mm_set1_ps(b_column[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(b_column[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(b_column[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(b_column[3])));
+        _mm_store_ps(&out.m[column * 4], result);
+    }
+#else
+    for (uint32_t column = 0; column < 4; column++) {
+        for (uint32_t row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (uint32_t k = 0; k < 4; k++) {
+                sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+            }
+            out.m[column * 4 + row] = sum;
+        }
+    }
+#endif
+    return out;
+}
+
+inline Vec3 transform_point(const Mat4& m, Vec3 p) {
+    return {
+        m.m[0] * p.x + m.m[4] * p.y + m.m[8] * p.z + m.m[12],
+        m.m[1] * p.x + m.m[5] * p.y + m.m[9] * p.z + m.m[13],
+        m.m[2] * p.x + m.m[6] * p.y + m.m[10] * p.z + m.m[14],
+    };
+}
+
+// Right-handed, y up, looking from eye towards target
+inline Mat4 look_at(Vec3 eye, Vec3 target, Vec3 up) {
+    Vec3 forward = normalize(target - eye);
+    Vec3 side = normalize(cross(forward, up));
+    Vec3 true_up = cross(side, forward);
+    return {{
+        side.x, true_up.x, -forward.x, 0.0f,
+        side.y, true_up.y, -forward.y, 0.0f,
+        side.z, true_up.z, -forward.z, 0.0f,
+        -dot(side, eye), -dot(true_up, eye), dot(forward, eye), 1.0f,
+    }};
+}
+
+// Vulkan clip space: y down, depth in [0, 1]
+inline Mat4 perspective(float fov_y, float aspect, float near_plane, float far_plane) {
+    float f = 1.0f / std::tan(fov_y * 0.5f);
+    return {{
+        f / aspect, 0.0f, 0.0f, 0.0f,
+        0.0f, -f, 0.0f, 0.0f,
+        0.0f, 0.0f, far_plane / (near_plane - far_plane), -1.0f,
+        0.0f, 0.0f, near_plane * far_plane / (near_plane - far_plane), 0.0f,
+    }};
+}
+
+// Gribb-Hartmann: -w <= x, y <= w and 0 <= z <= w as combinations of the matrix rows. Planes are
+// normalised and point inwards: left, right, bottom, top, near, far.
+inline void frustum_planes(const Mat4& view_proj, Vec4 planes[6]) {
+    auto row = [&view_proj](uint32_t r) {
+        return Vec4{view_proj.m[r], view_proj.m[4 + r], view_proj.m[8 + r], view_proj.m[12 + r]};
+    };
+
+    Vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+    planes[0] = {w.x + x.x, w.y + x.y, w.z + x.z, w.w + x.w};
+    planes[1] = {w.x - x.x, w.y - x.y, w.z - x.z, w.w - x.w};
+    planes[2] = {w.x + y.x, w.y + y.y, w.z + y.z, w.w + y.w};
+    planes[3] = {w.x - y.x, w.y - y.y, w.z - y.z, w.w - y.w};
+    planes[4] = z;
+    planes[5] = {w.x - z.x, w.y - z.y, w.z - z.z, w.w - z.w};
+
+    for (uint32_t i = 0; i < 6; i++) {
+        Vec4& plane = planes[i];
+        float inverse = 1.0f / std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        plane = {plane.x * inverse, plane.y * inverse, plane.z * inverse, plane.w * inverse};
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "math/math.h"
+#include <cstdint>
+#include <vector>
+
+// Batched math over structure-of-arrays data, thousands of objects per call. Every kernel has a
+// scalar, SSE and AVX2+FMA path with identical results up to float rounding; the widest one the
+// CPU supports is picked at startup. Non-x86 builds only have the scalar path.
+enum class SimdLevel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Highest level both the build and this CPU support
+SimdLevel detected_simd_level();
+SimdLevel simd_level();
+// Clamped to detected_simd_level(); benchmarks use it to compare paths
+void set_simd_level(SimdLevel level);
+const char* simd_level_name(SimdLevel level);
+
+// Translation, rotation and uniform scale per object
+typedef struct TransformSoA {
+    std::vector<float> position_x, position_y, position_z;
+    std::vector<float> rotation_x, rotation_y, rotation_z, rotation_w;
+    std::vector<float> scale;
+
+    void resize(uint32_t count);
+    uint32_t size() const { return (uint32_t)scale.size(); }
+    void set(uint32_t index, Vec3 position, Quat rotation, float uniform_scale);
+} TransformSoA;
+
+typedef struct AabbSoA {
+    std::vector<float> center_x, center_y, center_z;
+    std::vector<float> extent_x, extent_y, extent_z;
+
+    void resize(uint32_t count);
+    uint32_t size() const { return (uint32_t)center_x.size(); }
+    void set(uint32_t index, Vec3 center, Vec3 extent);
+} AabbSoA;
+
+// First index of each depth level plus a final entry equal to count. parents[i] < 0 marks a
+// root; objects must be sorted by depth, which also puts every parent before its children.
+std::vector<uint32_t> hierarchy_levels(const int32_t* parents, uint32_t count);
+
+// world[i] = world[parents[i]] * local[i], roots copy local. One level at a time, so a batch
+// never reads a parent it is still writing. world is resized to match local.
+void compose_hierarchy(const TransformSoA& local, const int32_t* parents, const std::vector<uint32_t>& levels, TransformSoA& world);
+
+// out[i] = mat4_from_transform(transforms[i])
+void transforms_to_matrices(const TransformSoA& transforms, Mat4* out);
+
+// out[i] = a[i] * b[i]
+void multiply_matrices(const Mat4* a, const Mat4* b, Mat4* out, uint32_t count);
+// out[i] = a * b[i], e.g. view_proj * model
+void multiply_matrices(const Mat4& a, const Mat4* b, Mat4* out, uint32_t count);
+
+// Writes the indices of boxes not fully outside any plane (planes point inwards, as from
+// frustum_planes) to visible and returns how many there are. Conservative near frustum corners.
+uint32_t cull_aabbs(const AabbSoA& boxes, const Vec4 planes[6], uint32_t* visible);
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "memory/tlsf_pool.h"
+#include "memory/ring_arena.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+const VkDeviceSize DEFAULT_MEMORY_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+// Buffers and linear images may not share a bufferImageGranularity page with optimal images
+enum class AllocationKind {
+    Linear,
+    Optimal
+};
+
+typedef struct MemoryBlock MemoryBlock;
+
+typedef struct Allocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    // Null unless the memory type is host visible
+    void* mapped = nullptr;
+    uint32_t memory_type = 0;
+
+    MemoryBlock* block = nullptr;
+    uint32_t handle = TlsfPool::INVALID_HANDLE;
+} Allocation;
+
+typedef struct AllocatorStats {
+    VkDeviceSize reserved_bytes = 0;
+    VkDeviceSize used_bytes = 0;
+    VkDeviceSize transient_reserved_bytes = 0;
+    VkDeviceSize transient_used_bytes = 0;
+    uint32_t device_allocation_count = 0;
+    uint32_t allocation_count = 0;
+    // 1 - largest free range / total free bytes across pool blocks
+    double fragmentation = 0.0;
+} AllocatorStats;
+
+struct MemoryBlock {
+    VkDeviceMemory memory;
+    void* mapped;
+    TlsfPool pool;
+};
+
+typedef struct TransientArena {
+    VkDeviceMemory memory;
+    void* mapped;
+    uint32_t memory_type;
+    RingArena ring;
+} TransientArena;
+
+// Sub-allocates device memory out of large per-memory-type blocks: a TLSF pool per block for
+// long-lived resources and per-frame ring arenas for transient data. Not thread-safe.
+class DeviceAllocator {
+public:
+    DeviceAllocator(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize block_size = DEFAULT_MEMORY_BLOCK_SIZE,
+                    const VkAllocationCallbacks* host_allocator = nullptr);
+    ~DeviceAllocator();
+
+    DeviceAllocator(const DeviceAllocator&) = delete;
+    DeviceAllocator& operator=(const DeviceAllocator&) = delete;
+
+    Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, AllocationKind kind);
+    void free(Allocation& allocation);
+
+    Allocation allocate_image(VkImage image, VkMemoryPropertyFlags properties, AllocationKind kind = AllocationKind::Optimal);
+    Allocation allocate_buffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+
+    // memory_type_bits comes from the requirements of a representative buffer
+    TransientArena* create_transient_arena(VkDeviceSize size, uint32_t memory_type_bits, VkMemoryPropertyFlags properties, uint32_t frame_count);
+    // Release the transient allocations made the last time frame_index was in flight
+    void begin_frame(uint32_t frame_index);
+    Allocation allocate_transient(TransientArena* arena, VkDeviceSize size, VkDeviceSize alignment);
+
+    uint32_t find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) const;
+    AllocatorStats stats() const;
+
+    // Modules that create buffers and images for this allocator pass these to Vulkan as well
+    const VkAllocationCallbacks* host_allocator() const { return m_host_allocator; }
+
+private:
+    VkDevice m_device;
+    const VkAllocationCallbacks* m_host_allocator;
+    VkPhysicalDeviceMemoryProperties m_memory_properties;
+    VkDeviceSize m_block_size;
+    VkDeviceSize m_buffer_image_granularity;
+    uint32_t m_max_allocation_count;
+    uint32_t m_device_allocation_count = 0;
+
+    // Indexed by memory type * 2 + kind
+    std::vector<std::vector<std::unique_ptr<MemoryBlock>>> m_pools;
+    std::vector<std::unique_ptr<TransientArena>> m_transient_arenas;
+
+    VkDeviceMemory allocate_device_memory(VkDeviceSize size, uint32_t memory_type, void** mapped);
+    void free_device_memory(VkDeviceMemory memory);
+    VkDeviceSize block_size_for(uint32_t memory_type, VkDeviceSize request) const;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <atomic>
+#include <cstdint>
+
+// Which part of the engine created the Vulkan object a host allocation belongs to. An object
+// must be destroyed with the same scope it was created with.
+enum class HostScope {
+    // Instance, surface and debug messenger
+    Instance,
+    Device,
+    // Swapchain, its image views and semaphores, offscreen and depth images
+    Swapchain,
+    // Pipeline cache, pipelines, shader modules and descriptor layouts
+    Pipelines,
+    // Device memory, buffers and images, and everything the modules built on DeviceAllocator create
+    Resources,
+    // Command pools, query pools, fences and frame semaphores
+    Commands,
+    Count
+};
+
+typedef struct HostScopeStats {
+    uint64_t allocations = 0;
+    uint64_t reallocations = 0;
+    uint64_t frees = 0;
+    uint64_t live_bytes = 0;
+    uint64_t peak_bytes = 0;
+    // Driver allocations made outside the callbacks and only reported to them
+    uint64_t internal_bytes = 0;
+} HostScopeStats;
+
+// Backs every VkAllocationCallbacks the engine hands to Vulkan. Each allocation carries a small
+// header with its size so frees and reallocations can be counted against the scope that made
+// them. Thread-safe: drivers allocate from whatever thread calls into them.
+class HostAllocator {
+public:
+    HostAllocator();
+
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+
+    const VkAllocationCallbacks* callbacks(HostScope scope) const { return &m_scopes[(uint32_t)scope].callbacks; }
+
+    HostScopeStats stats(HostScope scope) const;
+    HostScopeStats total() const;
+    void report() const;
+
+    static const char* scope_name(HostScope scope);
+
+private:
+    typedef struct Scope {
+        VkAllocationCallbacks callbacks;
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> reallocations{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> live_bytes{0};
+        std::atomic<uint64_t> peak_bytes{0};
+        std::atomic<uint64_t> internal_bytes{0};
+    } Scope;
+
+    Scope m_scopes[(uint32_t)HostScope::Count];
+
+    static void* VKAPI_CALL allocate(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope allocation_scope);
+    static void* VKAPI_CALL reallocate(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope allocation_scope);
+    static void VKAPI_CALL release(void* user_data, void* memory);
+    static void VKAPI_CALL internal_allocation(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope allocation_scope);
+    static void VKAPI_CALL internal_free(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope allocation_scope);
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Bump allocator over a ring of [0, size) for per-frame transient data. Allocations are
+// released a whole frame at a time once that frame's slot comes around again.
+class RingArena {
+public:
+    RingArena(uint64_t size, uint32_t frame_count);
+
+    // Call after the fence for frame_index has signalled; releases everything allocated in that slot
+    void begin_frame(uint32_t frame_index);
+
+    // Returns false when the ring is full
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+
+    uint64_t size() const { return m_size; }
+    uint64_t used_bytes() const { return m_used; }
+
+private:
+    uint64_t m_size;
+    uint64_t m_head = 0;
+    uint64_t m_tail = 0;
+    uint64_t m_used = 0;
+    uint32_t m_current_frame = 0;
+
+    std::vector<uint64_t> m_frame_ends;
+    std::vector<uint64_t> m_frame_bytes;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit allocator over an abstract [0, size) range. Only offsets are
+// handed out, so it can manage device memory that is never mapped. O(1) allocate and free.
+class TlsfPool {
+public:
+    static const uint32_t INVALID_HANDLE = UINT32_MAX;
+
+    explicit TlsfPool(uint64_t size);
+
+    // Returns false when no free block can hold size bytes at the requested alignment
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset, uint32_t& handle);
+    void free(uint32_t handle);
+
+    uint64_t size() const { return m_size; }
+    uint64_t used_bytes() const { return m_used; }
+    uint64_t free_bytes() const { return m_size - m_used; }
+    uint64_t largest_free_block() const;
+    uint32_t allocation_count() const { return m_allocation_count; }
+    bool empty() const { return m_allocation_count == 0; }
+
+private:
+    static const uint32_t SL_LOG2 = 4;
+    static const uint32_t SL_COUNT = 1 << SL_LOG2;
+    static const uint32_t FL_COUNT = 64;
+    static const uint64_t MIN_BLOCK_SIZE = 16;
+
+    typedef struct Node {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t prev_physical;
+        uint32_t next_physical;
+        uint32_t prev_free;
+        uint32_t next_free;
+        bool is_free;
+    } Node;
+
+    uint64_t m_size;
+    uint64_t m_used = 0;
+    uint32_t m_allocation_count = 0;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_unused_nodes;
+
+    uint64_t m_fl_bitmap = 0;
+    uint32_t m_sl_bitmap[FL_COUNT] = {};
+    uint32_t m_free_heads[FL_COUNT][SL_COUNT];
+
+    static void mapping_insert(uint64_t size, uint32_t& fl, uint32_t& sl);
+    static void mapping_search(uint64_t size, uint32_t& fl, uint32_t& sl);
+
+    uint32_t new_node();
+    uint32_t find_free_block(uint64_t size);
+    uint32_t split(uint32_t node, uint64_t size);
+    void insert_free(uint32_t node);
+    void remove_free(uint32_t node);
+};
@@ -0,0 +1,447 @@
+#pragma once
+
+#include <cstdint>
+
+// SPIR-V for an empty GLCompute entry point "main" with local size 1x1x1
+const uint32_t noop_compute_spirv[] = {
+    0x07230203, 0x00010000, 0x00000000, 5, 0,
+    0x00020011, 1,
+    0x0003000E, 0, 1,
+    0x0005000F, 5, 3, 0x6E69616D, 0x00000000,
+    0x00060010, 3, 17, 1, 1, 1,
+    0x00020013, 1,
+    0x00030021, 2, 1,
+    0x00050036, 1, 3, 0, 2,
+    0x000200F8, 4,
+    0x000100FD,
+    0x00010038,
+};
+
+// SPIR-V 1.5 for the GPU scene's culling pass, equivalent to:
+//   layout(local_size_x = 64) in;
+//   layout(set = 0, binding = 2) buffer Vec4s { vec4 data[]; } vec4_buffers[];
+//   layout(set = 0, binding = 2) buffer Uints { uint data[]; } uint_buffers[];
+//   layout(push_constant) uniform Cull { vec4 planes[6]; uint object_count, bounds, mesh_ids, meshes, commands, count; };
+//   void main() {
+//       uint i = gl_GlobalInvocationID.x;
+//       if (i < object_count) {
+//           vec4 sphere = vec4_buffers[bounds].data[i];
+//           if (all six dot(planes[p].xyz, sphere.xyz) + planes[p].w >= -sphere.w) {
+//               uint mesh = uint_buffers[mesh_ids].data[i] * 3;
+//               uint command = atomicAdd(uint_buffers[count].data[0], 1) * 5;
+//               commands[command + 0..4] = {meshes[mesh], 1, meshes[mesh + 1], meshes[mesh + 2], i};
+//           }
+//       }
+//   }
+const uint32_t scene_cull_spirv[] = {
+    0x07230203, 0x00010500, 0x00000000, 141, 0,
+    0x00020011, 1,
+    0x00020011, 5302,
+    0x0003000E, 0, 1,
+    0x0009000F, 5, 1, 0x6E69616D, 0x00000000, 2, 3, 4, 5,
+    0x00060010, 1, 17, 64, 1, 1,
+    0x00040047, 2, 11, 28,
+    0x00040047, 6, 6, 16,
+    0x00050048, 7, 0, 35, 0,
+    0x00050048, 7, 1, 35, 96,
+    0x00050048, 7, 2, 35, 100,
+    0x00050048, 7, 3, 35, 104,
+    0x00050048, 7, 4, 35, 108,
+    0x00050048, 7, 5, 35, 112,
+    0x00050048, 7, 6, 35, 116,
+    0x00030047, 7, 2,
+    0x00040047, 8, 6, 16,
+    0x00050048, 9, 0, 35, 0,
+    0x00030047, 9, 2,
+    0x00040047, 10, 6, 4,
+    0x00050048, 11, 0, 35, 0,
+    0x00030047, 11, 2,
+    0x00040047, 4, 34, 0,
+    0x00040047, 4, 33, 2,
+    0x00040047, 5, 34, 0,
+    0x00040047, 5, 33, 2,
+    0x00020013, 12,
+    0x00030021, 13, 12,
+    0x00020014, 14,
+    0x00040015, 15, 32, 0,
+    0x00040015, 16, 32, 1,
+    0x00030016, 17, 32,
+    0x00040017, 18, 15, 3,
+    0x00040017, 19, 17, 3,
+    0x00040017, 20, 17, 4,
+    0x0004002B, 16, 21, 0,
+    0x0004002B, 16, 22, 1,
+    0x0004002B, 16, 23, 2,
+    0x0004002B, 16, 24, 3,
+    0x0004002B, 16, 25, 4,
+    0x0004002B, 16, 26, 5,
+    0x0004002B, 16, 27, 6,
+    0x0004002B, 15, 28, 0,
+    0x0004002B, 15, 29, 1,
+    0x0004002B, 15, 30, 2,
+    0x0004002B, 15, 31, 3,
+    0x0004002B, 15, 32, 4,
+    0x0004002B, 15, 33, 5,
+    0x0004002B, 15, 34, 6,
+    0x0004002B, 17, 35, 1065353216,
+    0x0003001D, 8, 20,
+    0x0003001E, 9, 8,
+    0x0003001D, 36, 9,
+    0x0003001D, 10, 15,
+    0x0003001E, 11, 10,
+    0x0003001D, 37, 11,
+    0x00040020, 38, 12, 36,
+    0x00040020, 39, 12, 37,
+    0x00040020, 40, 12, 20,
+    0x00040020, 41, 12, 15,
+    0x00040020, 42, 9, 15,
+    0x00040020, 43, 9, 20,
+    0x0004003B, 38, 4, 12,
+    0x0004003B, 39, 5, 12,
+    0x0004001C, 6, 20, 34,
+    0x0009001E, 7, 6, 15, 15, 15, 15, 15, 15,
+    0x00040020, 44, 9, 7,
+    0x0004003B, 44, 3, 9,
+    0x00040020, 45, 1, 18,
+    0x0004003B, 45, 2, 1,
+    0x00050036, 12, 1, 0, 13,
+    0x000200F8, 46,
+    0x0004003D, 18, 47, 2,
+    0x00050051, 15, 48, 47, 0,
+    0x00050041, 42, 49, 3, 22,
+    0x0004003D, 15, 50, 49,
+    0x000500B0, 14, 51, 48, 50,
+    0x000300F7, 52, 0,
+    0x000400FA, 51, 53, 52,
+    0x000200F8, 53,
+    0x00050041, 42, 54, 3, 23,
+    0x0004003D, 15, 55, 54,
+    0x00070041, 40, 56, 4, 55, 21, 48,
+    0x0004003D, 20, 57, 56,
+    0x0008004F, 19, 58, 57, 57, 0, 1, 2,
+    0x00050051, 17, 59, 57, 3,
+    0x0004007F, 17, 60, 59,
+    0x00060041, 43, 61, 3, 21, 21,
+    0x0004003D, 20, 62, 61,
+    0x0008004F, 19, 63, 62, 62, 0, 1, 2,
+    0x00050051, 17, 64, 62, 3,
+    0x00050094, 17, 65, 63, 58,
+    0x00050081, 17, 66, 65, 64,
+    0x000500BE, 14, 67, 66, 60,
+    0x00060041, 43, 68, 3, 21, 22,
+    0x0004003D, 20, 69, 68,
+    0x0008004F, 19, 70, 69, 69, 0, 1, 2,
+    0x00050051, 17, 71, 69, 3,
+    0x00050094, 17, 72, 70, 58,
+    0x00050081, 17, 73, 72, 71,
+    0x000500BE, 14, 74, 73, 60,
+    0x00060041, 43, 75, 3, 21, 23,
+    0x0004003D, 20, 76, 75,
+    0x0008004F, 19, 77, 76, 76, 0, 1, 2,
+    0x00050051, 17, 78, 76, 3,
+    0x00050094, 17, 79, 77, 58,
+    0x00050081, 17, 80, 79, 78,
+    0x000500BE, 14, 81, 80, 60,
+    0x00060041, 43, 82, 3, 21, 24,
+    0x0004003D, 20, 83, 82,
+    0x0008004F, 19, 84, 83, 83, 0, 1, 2,
+    0x00050051, 17, 85, 83, 3,
+    0x00050094, 17, 86, 84, 58,
+    0x00050081, 17, 87, 86, 85,
+    0x000500BE, 14, 88, 87, 60,
+    0x00060041, 43, 89, 3, 21, 25,
+    0x0004003D, 20, 90, 89,
+    0x0008004F, 19, 91, 90, 90, 0, 1, 2,
+    0x00050051, 17, 92, 90, 3,
+    0x00050094, 17, 93, 91, 58,
+    0x00050081, 17, 94, 93, 92,
+    0x000500BE, 14, 95, 94, 60,
+    0x00060041, 43, 96, 3, 21, 26,
+    0x0004003D, 20, 97, 96,
+    0x0008004F, 19, 98, 97, 97, 0, 1, 2,
+    0x00050051, 17, 99, 97, 3,
+    0x00050094, 17, 100, 98, 58,
+    0x00050081, 17, 101, 100, 99,
+    0x000500BE, 14, 102, 101, 60,
+    0x000500A7, 14, 103, 67, 74,
+    0x000500A7, 14, 104, 103, 81,
+    0x000500A7, 14, 105, 104, 88,
+    0x000500A7, 14, 106, 105, 95,
+    0x000500A7, 14, 107, 106, 102,
+    0x000300F7, 108, 0,
+    0x000400FA, 107, 109, 108,
+    0x000200F8, 109,
+    0x00050041, 42, 110, 3, 24,
+    0x0004003D, 15, 111, 110,
+    0x00050041, 42, 112, 3, 25,
+    0x0004003D, 15, 113, 112,
+    0x00050041, 42, 114, 3, 26,
+    0x0004003D, 15, 115, 114,
+    0x00050041, 42, 116, 3, 27,
+    0x0004003D, 15, 117, 116,
+    0x00070041, 41, 118, 5, 111, 21, 48,
+    0x0004003D, 15, 119, 118,
+    0x00070041, 41, 120, 5, 117, 21, 21,
+    0x000700EA, 15, 121, 120, 29, 28, 29,
+    0x00050084, 15, 122, 119, 31,
+    0x00050080, 15, 123, 122, 29,
+    0x00050080, 15, 124, 122, 30,
+    0x00070041, 41, 125, 5, 113, 21, 122,
+    0x0004003D, 15, 126, 125,
+    0x00070041, 41, 127, 5, 113, 21, 123,
+    0x0004003D, 15, 128, 127,
+    0x00070041, 41, 129, 5, 113, 21, 124,
+    0x0004003D, 15, 130, 129,
+    0x00050084, 15, 131, 121, 33,
+    0x00050080, 15, 132, 131, 29,
+    0x00050080, 15, 133, 131, 30,
+    0x00050080, 15, 134, 131, 31,
+    0x00050080, 15, 135, 131, 32,
+    0x00070041, 41, 136, 5, 115, 21, 131,
+    0x0003003E, 136, 126,
+    0x00070041, 41, 137, 5, 115, 21, 132,
+    0x0003003E, 137, 29,
+    0x00070041, 41, 138, 5, 115, 21, 133,
+    0x0003003E, 138, 128,
+    0x00070041, 41, 139, 5, 115, 21, 134,
+    0x0003003E, 139, 130,
+    0x00070041, 41, 140, 5, 115, 21, 135,
+    0x0003003E, 140, 48,
+    0x000200F9, 108,
+    0x000200F8, 108,
+    0x000200F9, 52,
+    0x000200F8, 52,
+    0x000100FD,
+    0x00010038,
+};
+
+// SPIR-V 1.5 for the GPU scene's vertex shader, equivalent to:
+//   layout(location = 0) in vec3 position;
+//   layout(location = 0) out vec4 color;
+//   layout(push_constant) uniform Draw { mat4 view_proj; uint transforms, colors; };
+//   void main() {
+//       vec4 transform = vec4_buffers[transforms].data[gl_InstanceIndex];
+//       gl_Position = view_proj * vec4(position * transform.w + transform.xyz, 1.0);
+//       color = unpackUnorm4x8(uint_buffers[colors].data[gl_InstanceIndex]);
+//   }
+// with both buffer arrays readonly
+const uint32_t scene_vertex_spirv[] = {
+    0x07230203, 0x00010500, 0x00000000, 73, 0,
+    0x00020011, 1,
+    0x00020011, 5302,
+    0x0006000B, 1, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000,
+    0x0003000E, 0, 1,
+    0x000C000F, 0, 2, 0x6E69616D, 0x00000000, 3, 4, 5, 6, 7, 8, 9,
+    0x00040047, 3, 30, 0,
+    0x00040047, 4, 11, 43,
+    0x00040047, 5, 11, 0,
+    0x00040047, 6, 30, 0,
+    0x00040048, 10, 0, 5,
+    0x00050048, 10, 0, 7, 16,
+    0x00050048, 10, 0, 35, 0,
+    0x00050048, 10, 1, 35, 64,
+    0x00050048, 10, 2, 35, 68,
+    0x00030047, 10, 2,
+    0x00040048, 11, 0, 24,
+    0x00040048, 12, 0, 24,
+    0x00040047, 13, 6, 16,
+    0x00050048, 11, 0, 35, 0,
+    0x00030047, 11, 2,
+    0x00040047, 14, 6, 4,
+    0x00050048, 12, 0, 35, 0,
+    0x00030047, 12, 2,
+    0x00040047, 8, 34, 0,
+    0x00040047, 8, 33, 2,
+    0x00040047, 9, 34, 0,
+    0x00040047, 9, 33, 2,
+    0x00020013, 15,
+    0x00030021, 16, 15,
+    0x00020014, 17,
+    0x00040015, 18, 32, 0,
+    0x00040015, 19, 32, 1,
+    0x00030016, 20, 32,
+    0x00040017, 21, 18, 3,
+    0x00040017, 22, 20, 3,
+    0x00040017, 23, 20, 4,
+    0x0004002B, 19, 24, 0,
+    0x0004002B, 19, 25, 1,
+    0x0004002B, 19, 26, 2,
+    0x0004002B, 19, 27, 3,
+    0x0004002B, 19, 28, 4,
+    0x0004002B, 19, 29, 5,
+    0x0004002B, 19, 30, 6,
+    0x0004002B, 18, 31, 0,
+    0x0004002B, 18, 32, 1,
+    0x0004002B, 18, 33, 2,
+    0x0004002B, 18, 34, 3,
+    0x0004002B, 18, 35, 4,
+    0x0004002B, 18, 36, 5,
+    0x0004002B, 18, 37, 6,
+    0x0004002B, 20, 38, 1065353216,
+    0x0003001D, 13, 23,
+    0x0003001E, 11, 13,
+    0x0003001D, 39, 11,
+    0x0003001D, 14, 18,
+    0x0003001E, 12, 14,
+    0x0003001D, 40, 12,
+    0x00040020, 41, 12, 39,
+    0x00040020, 42, 12, 40,
+    0x00040020, 43, 12, 23,
+    0x00040020, 44, 12, 18,
+    0x00040020, 45, 9, 18,
+    0x00040020, 46, 9, 23,
+    0x0004003B, 41, 8, 12,
+    0x0004003B, 42, 9, 12,
+    0x00040018, 47, 23, 4,
+    0x0005001E, 10, 47, 18, 18,
+    0x00040020, 48, 9, 10,
+    0x00040020, 49, 9, 47,
+    0x0004003B, 48, 7, 9,
+    0x00040020, 50, 1, 22,
+    0x00040020, 51, 1, 19,
+    0x00040020, 52, 3, 23,
+    0x0004003B, 50, 3, 1,
+    0x0004003B, 51, 4, 1,
+    0x0004003B, 52, 5, 3,
+    0x0004003B, 52, 6, 3,
+    0x00050036, 15, 2, 0, 16,
+    0x000200F8, 53,
+    0x0004003D, 19, 54, 4,
+    0x00050041, 45, 55, 7, 25,
+    0x0004003D, 18, 56, 55,
+    0x00050041, 45, 57, 7, 26,
+    0x0004003D, 18, 58, 57,
+    0x00070041, 43, 59, 8, 56, 24, 54,
+    0x0004003D, 23, 60, 59,
+    0x0008004F, 22, 61, 60, 60, 0, 1, 2,
+    0x00050051, 20, 62, 60, 3,
+    0x0004003D, 22, 63, 3,
+    0x0005008E, 22, 64, 63, 62,
+    0x00050081, 22, 65, 64, 61,
+    0x00050050, 23, 66, 65, 38,
+    0x00050041, 49, 67, 7, 24,
+    0x0004003D, 47, 68, 67,
+    0x00050091, 23, 69, 68, 66,
+    0x0003003E, 5, 69,
+    0x00070041, 44, 70, 9, 58, 24, 54,
+    0x0004003D, 18, 71, 70,
+    0x0006000C, 23, 72, 1, 64, 71,
+    0x0003003E, 6, 72,
+    0x000100FD,
+    0x00010038,
+};
+
+// SPIR-V 1.5 for a fragment shader writing its interpolated location 0 colour to attachment 0
+const uint32_t scene_fragment_spirv[] = {
+    0x07230203, 0x00010500, 0x00000000, 12, 0,
+    0x00020011, 1,
+    0x0003000E, 0, 1,
+    0x0007000F, 4, 1, 0x6E69616D, 0x00000000, 2, 3,
+    0x00030010, 1, 7,
+    0x00040047, 2, 30, 0,
+    0x00040047, 3, 30, 0,
+    0x00020013, 4,
+    0x00030021, 5, 4,
+    0x00030016, 6, 32,
+    0x00040017, 7, 6, 4,
+    0x00040020, 8, 1, 7,
+    0x00040020, 9, 3, 7,
+    0x0004003B, 8, 2, 1,
+    0x0004003B, 9, 3, 3,
+    0x00050036, 4, 1, 0, 5,
+    0x000200F8, 10,
+    0x0004003D, 7, 11, 2,
+    0x0003003E, 3, 11,
+    0x000100FD,
+    0x00010038,
+};
+
+// SPIR-V 1.5 for the batch image filter, equivalent to:
+//   layout(local_size_x = 64) in;
+//   layout(set = 0, binding = 2) buffer Uints { uint data[]; } uint_buffers[];
+//   layout(push_constant) uniform Filter { uint first, pixel_count, src, dst; float exposure; };
+//   void main() {
+//       uint i = first + gl_GlobalInvocationID.x;
+//       if (i < pixel_count) {
+//           vec4 color = unpackUnorm4x8(uint_buffers[src].data[i]);
+//           uint_buffers[dst].data[i] = packUnorm4x8(vec4(color.rgb * exposure, color.a));
+//       }
+//   }
+const uint32_t image_filter_spirv[] = {
+    0x07230203, 0x00010500, 0x00000000, 64, 0,
+    0x00020011, 1,
+    0x00020011, 5302,
+    0x0006000B, 5, 0x4C534C47, 0x6474732E, 0x3035342E, 0x00000000,
+    0x0003000E, 0, 1,
+    0x0008000F, 5, 1, 0x6E69616D, 0x00000000, 2, 3, 4,
+    0x00060010, 1, 17, 64, 1, 1,
+    0x00040047, 2, 11, 28,
+    0x00040047, 18, 6, 4,
+    0x00050048, 19, 0, 35, 0,
+    0x00030047, 19, 2,
+    0x00050048, 23, 0, 35, 0,
+    0x00050048, 23, 1, 35, 4,
+    0x00050048, 23, 2, 35, 8,
+    0x00050048, 23, 3, 35, 12,
+    0x00050048, 23, 4, 35, 16,
+    0x00030047, 23, 2,
+    0x00040047, 4, 34, 0,
+    0x00040047, 4, 33, 2,
+    0x00020013, 10,
+    0x00030021, 11, 10,
+    0x00020014, 12,
+    0x00040015, 13, 32, 0,
+    0x00040015, 14, 32, 1,
+    0x00030016, 15, 32,
+    0x00040017, 16, 13, 3,
+    0x00040017, 17, 15, 4,
+    0x0004002B, 14, 30, 0,
+    0x0004002B, 14, 31, 1,
+    0x0004002B, 14, 32, 2,
+    0x0004002B, 14, 33, 3,
+    0x0004002B, 14, 34, 4,
+    0x0003001D, 18, 13,
+    0x0003001E, 19, 18,
+    0x0003001D, 20, 19,
+    0x00040020, 21, 12, 20,
+    0x00040020, 22, 12, 13,
+    0x0007001E, 23, 13, 13, 13, 13, 15,
+    0x00040020, 24, 9, 23,
+    0x00040020, 25, 9, 13,
+    0x00040020, 26, 9, 15,
+    0x00040020, 27, 1, 16,
+    0x0004003B, 21, 4, 12,
+    0x0004003B, 24, 3, 9,
+    0x0004003B, 27, 2, 1,
+    0x00050036, 10, 1, 0, 11,
+    0x000200F8, 40,
+    0x0004003D, 16, 41, 2,
+    0x00050051, 13, 61, 41, 0,
+    0x00050041, 25, 62, 3, 30,
+    0x0004003D, 13, 63, 62,
+    0x00050080, 13, 42, 63, 61,
+    0x00050041, 25, 43, 3, 31,
+    0x0004003D, 13, 44, 43,
+    0x000500B0, 12, 45, 42, 44,
+    0x000300F7, 47, 0,
+    0x000400FA, 45, 46, 47,
+    0x000200F8, 46,
+    0x00050041, 25, 48, 3, 32,
+    0x0004003D, 13, 49, 48,
+    0x00070041, 22, 50, 4, 49, 30, 42,
+    0x0004003D, 13, 51, 50,
+    0x0006000C, 17, 52, 5, 64, 51,
+    0x00050041, 26, 53, 3, 34,
+    0x0004003D, 15, 54, 53,
+    0x0005008E, 17, 55, 52, 54,
+    0x0009004F, 17, 56, 55, 52, 0, 1, 2, 7,
+    0x0006000C, 13, 57, 5, 55, 56,
+    0x00050041, 25, 58, 3, 33,
+    0x0004003D, 13, 59, 58,
+    0x00070041, 22, 60, 4, 59, 30, 42,
+    0x0003003E, 60, 57,
+    0x000200F9, 47,
+    0x000200F8, 47,
+    0x000100FD,
+    0x00010038,
+};
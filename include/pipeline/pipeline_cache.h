@@ -0,0 +1,45 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// VkPipelineCache persisted to disk between runs. A blob is only handed to the driver when its
+// header matches this device's vendor, device ID and pipelineCacheUUID.
+class PipelineCache {
+public:
+    PipelineCache(VkPhysicalDevice physical_device, VkDevice device, const std::string& path, const VkAllocationCallbacks* host_allocator = nullptr);
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    VkPipelineCache handle() const { return m_cache; }
+    bool is_warm() const { return m_loaded_bytes > 0; }
+    // Pipelines made here must be destroyed with these
+    const VkAllocationCallbacks* host_allocator() const { return m_host_allocator; }
+
+    // Safe to call from several threads; the driver synchronises VkPipelineCache itself
+    VkPipeline create_compute_pipeline(const VkComputePipelineCreateInfo& create_info);
+    VkPipeline create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info);
+
+    // Writes to a temporary file and renames it, so a crash mid-save never leaves a torn blob
+    void save();
+    void report() const;
+
+private:
+    VkDevice m_device;
+    const VkAllocationCallbacks* m_host_allocator;
+    VkPipelineCache m_cache = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties m_properties;
+    std::string m_path;
+
+    size_t m_loaded_bytes = 0;
+    std::mutex m_stats_mutex;
+    uint32_t m_pipeline_count = 0;
+    double m_build_ms = 0.0;
+
+    bool validate_header(const std::string& blob) const;
+    void record_build(double ms);
+};
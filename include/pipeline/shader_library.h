@@ -0,0 +1,120 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "pipeline/pipeline_cache.h"
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint32_t SHADER_POLL_INTERVAL_MS = 250;
+
+typedef uint32_t ShaderHandle;
+typedef uint32_t PipelineHandle;
+
+// Builds a pipeline from one module per shader, in the order they were passed to add_pipeline.
+// Runs on the render thread for the first build and on the compile thread for reloads.
+typedef std::function<VkPipeline(PipelineCache& cache, const std::vector<VkShaderModule>& modules)> PipelineBuilder;
+
+typedef struct ShaderLibraryConfig {
+    // GLSL/HLSL sources watched for changes; empty disables hot reload
+    std::string source_dir;
+    // SPIR-V from the pluto_shaders build target, preferred over the built-in fallback
+    std::string spirv_dir;
+    // SPIR-V compiled at runtime, named by a hash of the source
+    std::string cache_dir;
+    std::string compiler = "glslc";
+    uint32_t frames_in_flight = 2;
+} ShaderLibraryConfig;
+
+typedef struct ShaderLibraryStats {
+    uint32_t compiled = 0;
+    uint32_t cache_hits = 0;
+    uint32_t failures = 0;
+    uint32_t pipelines_rebuilt = 0;
+    double compile_ms = 0.0;
+    double max_compile_ms = 0.0;
+} ShaderLibraryStats;
+
+// Owns every pipeline built from shader files. A background thread polls the sources, recompiles
+// the ones that changed and rebuilds the pipelines that use them; begin_frame swaps finished
+// pipelines in, so the render loop never waits on the compiler or the driver. The replaced
+// pipeline is destroyed once the frames that may have bound it have retired.
+class ShaderLibrary {
+public:
+    ShaderLibrary(VkDevice device, PipelineCache& pipelines, const ShaderLibraryConfig& config);
+    ~ShaderLibrary();
+
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    // file is relative to source_dir, e.g. "scene.vert" or "blur.comp.hlsl". fallback is used
+    // until a compiled version exists and must outlive the library.
+    ShaderHandle add_shader(const std::string& file, const uint32_t* fallback, size_t fallback_size);
+    // The first build is synchronous
+    PipelineHandle add_pipeline(const std::vector<ShaderHandle>& shaders, PipelineBuilder builder);
+
+    // Render thread only; stable between begin_frame calls
+    VkPipeline pipeline(PipelineHandle handle) const { return m_pipelines[handle].current; }
+
+    // Swaps in rebuilt pipelines and destroys retired ones
+    void begin_frame(uint64_t frame_number);
+
+    bool hot_reload() const { return m_thread.joinable(); }
+    ShaderLibraryStats stats() const;
+    void report() const;
+
+private:
+    typedef struct Shader {
+        std::string file;
+        std::filesystem::path source;
+        std::filesystem::file_time_type modified;
+        std::vector<uint32_t> spirv;
+        // Bumped on every successful compile; pipelines rebuild when theirs fall behind
+        uint32_t version = 0;
+    } Shader;
+
+    typedef struct Pipeline {
+        std::vector<ShaderHandle> shaders;
+        PipelineBuilder builder;
+        std::vector<uint32_t> built_versions;
+        VkPipeline current = VK_NULL_HANDLE;
+    } Pipeline;
+
+    typedef struct Replacement {
+        PipelineHandle handle;
+        VkPipeline pipeline;
+    } Replacement;
+
+    typedef struct RetiredPipeline {
+        VkPipeline pipeline;
+        uint64_t retire_frame;
+    } RetiredPipeline;
+
+    VkDevice m_device;
+    PipelineCache& m_pipeline_cache;
+    ShaderLibraryConfig m_config;
+
+    // Guards m_shaders, the shader lists and builders in m_pipelines, m_replacements and m_stats.
+    // Pipeline::current belongs to the render thread.
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    std::vector<Shader> m_shaders;
+    std::vector<Pipeline> m_pipelines;
+    std::vector<Replacement> m_replacements;
+    std::vector<RetiredPipeline> m_retired;
+    ShaderLibraryStats m_stats;
+
+    void watch_main();
+    void poll_sources();
+    void rebuild_pipelines();
+    bool compile(const Shader& shader, std::vector<uint32_t>& spirv);
+    VkPipeline build(const Pipeline& pipeline, const std::vector<const std::vector<uint32_t>*>& spirv);
+};
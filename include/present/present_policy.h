@@ -0,0 +1,55 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What the swapchain optimises for. Balanced is the old default; the others trade latency,
+// tearing and power against each other.
+enum class PresentPolicy {
+    // MAILBOX when available, otherwise FIFO, one image above the minimum
+    Balanced,
+    // IMMEDIATE (tears), then MAILBOX, then FIFO, with as few images as the mode allows
+    LowLatency,
+    // FIFO: never renders faster than the display, so the GPU idles between vblanks
+    PowerSaving,
+    // FIFO_RELAXED: vsynced, but a late frame tears instead of waiting another vblank
+    Relaxed
+};
+
+// Accepts balanced, low-latency, power-saving and relaxed; throws on anything else
+PresentPolicy parse_present_policy(const std::string& name);
+const char* present_policy_name(PresentPolicy policy);
+const char* present_mode_name(VkPresentModeKHR mode);
+
+// FIFO is always supported, so every policy ends up with a mode
+VkPresentModeKHR choose_present_mode(PresentPolicy policy, const std::vector<VkPresentModeKHR>& available_modes);
+
+// Each queued image is a frame of latency. IMMEDIATE never waits for the display so the
+// minimum is enough; MAILBOX needs one spare to render into while another waits for vblank.
+uint32_t choose_image_count(PresentPolicy policy, VkPresentModeKHR mode, const VkSurfaceCapabilitiesKHR& capabilities);
+
+// Holds frame starts to a fixed interval so the CPU sleeps instead of running ahead and blocking
+// on the swapchain with input it sampled long ago. sleep_for overshoots by up to a scheduler tick,
+// so the latency-oriented policies spin the last stretch; PowerSaving and Relaxed are vsynced
+// anyway and only ever sleep.
+class FramePacer {
+public:
+    // 0 disables pacing
+    explicit FramePacer(double target_fps = 0.0, PresentPolicy policy = PresentPolicy::Balanced);
+
+    bool enabled() const { return m_interval.count() > 0; }
+
+    // Blocks until the next frame is due and returns the milliseconds spent waiting. A frame that
+    // ran long moves the schedule instead of making the following frames rush to catch up.
+    double wait();
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    clock::duration m_interval{};
+    clock::duration m_spin_margin{};
+    clock::time_point m_next_frame{};
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Building without PLUTO_PROFILER compiles every scope away; the engine then never creates a Profiler
+#ifdef PLUTO_PROFILER
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+#define PROFILE_CPU_SCOPE(profiler, name) CpuScope PROFILER_CONCAT(cpu_scope_, __LINE__)(profiler, name)
+#define PROFILE_GPU_SCOPE(profiler, command_buffer, name) GpuScope PROFILER_CONCAT(gpu_scope_, __LINE__)(profiler, command_buffer, name)
+#else
+#define PROFILE_CPU_SCOPE(profiler, name) ((void)0)
+#define PROFILE_GPU_SCOPE(profiler, command_buffer, name) ((void)0)
+#endif
+
+const uint32_t DEFAULT_MAX_GPU_SCOPES = 64;
+// Graphics command buffers per frame that each get their own statistics query, summed on readback
+const uint32_t MAX_STATISTICS_QUERIES = 8;
+const size_t DEFAULT_MAX_TRACE_EVENTS = 1 << 20;
+
+typedef struct TraceEvent {
+    const char* name;
+    bool gpu;
+    double start_us;
+    double duration_us;
+} TraceEvent;
+
+typedef struct PipelineStatistics {
+    uint64_t input_assembly_vertices;
+    uint64_t vertex_invocations;
+    uint64_t fragment_invocations;
+    uint64_t compute_invocations;
+} PipelineStatistics;
+
+// CPU and GPU scopes on one timeline. GPU scopes are timestamp pairs in a per-frame query pool,
+// read back without waiting once that frame's fence has signalled, so the cost is two
+// vkCmdWriteTimestamp per scope plus two clock reads and a hash lookup per CPU scope. Totals are
+// always kept; individual events only once enable_trace() is called, in a bounded ring. Scope
+// names must outlive the profiler (string literals); totals are keyed by the pointer. Main thread
+// and primary command buffers only.
+class Profiler {
+public:
+    Profiler(VkPhysicalDevice physical_device, VkDevice device, VkQueue queue, uint32_t queue_family, uint32_t frame_count,
+             bool pipeline_statistics, uint32_t max_gpu_scopes = DEFAULT_MAX_GPU_SCOPES, const VkAllocationCallbacks* host_allocator = nullptr);
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Call once the fence for frame_index has signalled; resolves the queries that slot wrote last time
+    void begin_frame(uint32_t frame_index);
+
+    // Bracket each of the frame's primary graphics command buffers, in submission order, right after
+    // vkBeginCommandBuffer and before vkEndCommandBuffer. A query can't span command buffers, so
+    // each gets its own statistics query; the first also resets the frame's queries.
+    void begin_commands(VkCommandBuffer command_buffer);
+    void end_commands(VkCommandBuffer command_buffer);
+
+    uint32_t begin_gpu_scope(VkCommandBuffer command_buffer, const char* name);
+    void end_gpu_scope(VkCommandBuffer command_buffer, uint32_t scope);
+
+    double now_us() const;
+    // Called by CpuScope with the start it sampled itself
+    void end_cpu_scope(const char* name, double start_us);
+
+    // Keeps the last max_events scopes (and as many statistics samples) for export_chrome_trace
+    void enable_trace(size_t max_events = DEFAULT_MAX_TRACE_EVENTS);
+
+    // Secondaries executed while the statistics query is open must inherit these flags
+    VkQueryPipelineStatisticFlags inherited_statistics() const { return m_statistics_flags; }
+
+    bool gpu_timing_supported() const { return m_timestamp_mask != 0; }
+
+    void report() const;
+    void export_chrome_trace(const std::string& path) const;
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    typedef struct FrameQueries {
+        VkQueryPool timestamps = VK_NULL_HANDLE;
+        VkQueryPool statistics = VK_NULL_HANDLE;
+        std::vector<const char*> names;
+        uint32_t scope_count = 0;
+        uint32_t statistics_count = 0;
+        bool statistics_open = false;
+        bool recorded = false;
+    } FrameQueries;
+
+    typedef struct ScopeTotals {
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+        uint64_t count = 0;
+    } ScopeTotals;
+
+    typedef struct StatisticsSample {
+        double timestamp_us;
+        PipelineStatistics statistics;
+    } StatisticsSample;
+
+    VkDevice m_device;
+    const VkAllocationCallbacks* m_host_allocator;
+    uint32_t m_max_gpu_scopes;
+    double m_timestamp_period_ns;
+    uint64_t m_timestamp_mask = 0;
+    VkQueryPipelineStatisticFlags m_statistics_flags = 0;
+
+    clock::time_point m_epoch;
+    // CPU microseconds minus GPU microseconds, measured once at startup
+    double m_gpu_offset_us = 0.0;
+
+    std::vector<FrameQueries> m_frames;
+    uint32_t m_frame_index = 0;
+
+    // Ring buffers once full: m_next_event is the oldest event, overwritten next. 0 until enable_trace.
+    size_t m_max_events = 0;
+    std::vector<TraceEvent> m_events;
+    size_t m_next_event = 0;
+    uint64_t m_overwritten_events = 0;
+    std::vector<StatisticsSample> m_statistics;
+    size_t m_next_statistics = 0;
+    std::optional<PipelineStatistics> m_last_statistics;
+    std::unordered_map<const char*, ScopeTotals> m_cpu_totals;
+    std::unordered_map<const char*, ScopeTotals> m_gpu_totals;
+
+    double gpu_ticks_to_us(uint64_t ticks) const;
+    void calibrate(VkQueue queue, uint32_t queue_family);
+    void resolve(FrameQueries& frame);
+    void push_event(const TraceEvent& event);
+    static void add_total(std::unordered_map<const char*, ScopeTotals>& totals, const char* name, double ms);
+};
+
+class CpuScope {
+public:
+    CpuScope(Profiler* profiler, const char* name) : m_profiler(profiler), m_name(name) {
+        if (m_profiler) {
+            m_start_us = m_profiler->now_us();
+        }
+    }
+
+    ~CpuScope() {
+        if (m_profiler) {
+            m_profiler->end_cpu_scope(m_name, m_start_us);
+        }
+    }
+
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+
+private:
+    Profiler* m_profiler;
+    const char* m_name;
+    double m_start_us = 0.0;
+};
+
+class GpuScope {
+public:
+    GpuScope(Profiler* profiler, VkCommandBuffer command_buffer, const char* name) : m_profiler(profiler), m_command_buffer(command_buffer) {
+        if (m_profiler) {
+            m_scope = m_profiler->begin_gpu_scope(m_command_buffer, name);
+        }
+    }
+
+    ~GpuScope() {
+        if (m_profiler) {
+            m_profiler->end_gpu_scope(m_command_buffer, m_scope);
+        }
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+
+private:
+    Profiler* m_profiler;
+    VkCommandBuffer m_command_buffer;
+    uint32_t m_scope = 0;
+};
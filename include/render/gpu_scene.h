@@ -0,0 +1,178 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "descriptor/bindless_table.h"
+#include "memory/device_allocator.h"
+#include "pipeline/shader_library.h"
+#include "transfer/upload_manager.h"
+#include <cstdint>
+#include <vector>
+
+const uint32_t SCENE_CULL_WORKGROUP_SIZE = 64;
+// Objects per array per upload; a 1M object scene streams in over a few frames
+const uint32_t SCENE_STREAM_CHUNK = 16384;
+const VkFormat SCENE_DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+
+enum class SceneMesh {
+    Cube,
+    Octahedron,
+    Tetrahedron
+};
+
+const uint32_t SCENE_MESH_COUNT = 3;
+
+// Dynamic begins rendering straight on the target's image views (Vulkan 1.3 dynamicRendering).
+// Classic is the fallback for devices without it: the scene owns a VkRenderPass and the caller
+// builds a VkFramebuffer per target from render_pass(), rebuilding them whenever the views change.
+enum class RenderPath {
+    Dynamic,
+    Classic
+};
+
+const char* render_path_name(RenderPath path);
+
+typedef struct SceneObject {
+    float position[3];
+    float scale;
+    SceneMesh mesh;
+    // RGBA8, R in the low byte
+    uint32_t color;
+} SceneObject;
+
+// Matches the cull shader's mesh table; vertex_offset is an int32 in VkDrawIndexedIndirectCommand
+typedef struct SceneMeshRange {
+    uint32_t index_count;
+    uint32_t first_index;
+    uint32_t vertex_offset;
+} SceneMeshRange;
+
+typedef struct GpuSceneStats {
+    uint32_t object_count = 0;
+    uint32_t resident_count = 0;
+    // Draws one indirect-count call may issue; visible objects beyond this are dropped
+    uint32_t max_draws = 0;
+    VkDeviceSize device_bytes = 0;
+} GpuSceneStats;
+
+// Deterministic objects scattered through a cube around the origin, spaced so density stays
+// constant as count grows
+std::vector<SceneObject> generate_scene_objects(uint32_t count, uint32_t seed);
+// Half the side of the cube generate_scene_objects fills
+float scene_half_extent(uint32_t count);
+
+// GPU-driven scene: object data lives in SoA storage buffers registered in the bindless table, a
+// compute pass frustum-culls every object and appends one VkDrawIndexedIndirectCommand per visible
+// object, and a single vkCmdDrawIndexedIndirectCount draws them. The CPU records the same handful
+// of commands whatever the object count. Each frame: record_reset, barrier, record_cull, barrier,
+// record_draw; the commands and count buffers are reused every frame, so one frame's draw must
+// finish before the next frame's reset. Reset and cull may run on an async compute queue when the
+// buffers were created for the families of every queue that touches them.
+class GpuScene {
+public:
+    // With more than one distinct family in queue_families every buffer is VK_SHARING_MODE_CONCURRENT
+    // across them and uploads skip the ownership transfer; include the upload queue's family
+    GpuScene(VkPhysicalDevice physical_device, VkDevice device, DeviceAllocator& allocator, BindlessTable& bindless, ShaderLibrary& shaders,
+             VkFormat color_format, uint32_t max_objects, const std::vector<uint32_t>& queue_families = {},
+             RenderPath render_path = RenderPath::Dynamic);
+    ~GpuScene();
+
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    // Replaces the scene; stream() moves it to the GPU
+    void set_objects(const std::vector<SceneObject>& objects);
+    // Queues as many pending chunks as the staging ring takes. Returns true once every object is
+    // resident; only resident objects are culled and drawn.
+    bool stream(UploadManager& uploads);
+
+    // Right-handed, y up, looking from eye towards target
+    void set_camera(const float eye[3], const float target[3], float fov_y, float aspect, float near_plane, float far_plane);
+
+    void record_reset(VkCommandBuffer command_buffer) const;
+    void record_cull(VkCommandBuffer command_buffer) const;
+    // Colour is loaded, depth cleared; both must be in attachment layouts. RenderPath::Classic
+    // renders into framebuffer, which must be built over the same views, and ignores the views.
+    void record_draw(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent,
+                     VkFramebuffer framebuffer = VK_NULL_HANDLE) const;
+
+    // The CPU-driven equivalent of cull + draw: tests every resident object on the CPU and records
+    // one vkCmdDrawIndexed per visible object. Kept as a baseline. Returns the draw count.
+    uint32_t record_draw_direct(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent,
+                                VkFramebuffer framebuffer = VK_NULL_HANDLE) const;
+
+    RenderPath render_path() const { return m_render_path; }
+    // VK_NULL_HANDLE on RenderPath::Dynamic. Attachment 0 is colour, 1 is depth.
+    VkRenderPass render_pass() const { return m_render_pass; }
+
+    VkBuffer commands_buffer() const { return m_commands.buffer; }
+    VkBuffer count_buffer() const { return m_count.buffer; }
+    const GpuSceneStats& stats() const { return m_stats; }
+    void report() const;
+
+private:
+    typedef struct SceneBuffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        Allocation memory;
+        uint32_t slot = BINDLESS_INVALID_SLOT;
+    } SceneBuffer;
+
+    // Indexed by the SoA arrays below
+    enum StreamArray {
+        STREAM_BOUNDS,
+        STREAM_TRANSFORMS,
+        STREAM_COLORS,
+        STREAM_MESH_IDS,
+        STREAM_ARRAY_COUNT
+    };
+
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    BindlessTable& m_bindless;
+    ShaderLibrary& m_shaders;
+    uint32_t m_max_objects;
+    // Distinct; empty unless the buffers are concurrent
+    std::vector<uint32_t> m_queue_families;
+    RenderPath m_render_path;
+    VkRenderPass m_render_pass = VK_NULL_HANDLE;
+
+    // Owned by the shader library, which may swap them between frames
+    PipelineHandle m_cull_pipeline = 0;
+    PipelineHandle m_draw_pipeline = 0;
+
+    SceneBuffer m_vertices;
+    SceneBuffer m_indices;
+    SceneBuffer m_meshes;
+    // Per object: bounding sphere (xyz, radius), translation + uniform scale, RGBA8 colour, mesh id
+    SceneBuffer m_arrays[STREAM_ARRAY_COUNT];
+    // Cull output
+    SceneBuffer m_commands;
+    SceneBuffer m_count;
+
+    // CPU copies of the SoA arrays, streamed from and used by record_draw_direct
+    std::vector<float> m_bounds;
+    std::vector<float> m_transforms;
+    std::vector<uint32_t> m_colors;
+    std::vector<uint32_t> m_mesh_ids;
+    uint32_t m_stream_cursor[STREAM_ARRAY_COUNT] = {};
+    bool m_geometry_uploaded = false;
+
+    SceneMeshRange m_mesh_ranges[SCENE_MESH_COUNT];
+    std::vector<float> m_vertex_data;
+    std::vector<uint16_t> m_index_data;
+
+    float m_view_proj[16] = {};
+    // Normalised, pointing inwards: left, right, bottom, top, near, far
+    float m_planes[6][4] = {};
+
+    GpuSceneStats m_stats;
+
+    SceneBuffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, bool bindless);
+    void destroy_buffer(SceneBuffer& buffer);
+    void build_meshes();
+    void create_render_pass(VkFormat color_format);
+    void create_pipelines(VkFormat color_format);
+    void begin_rendering(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent, VkFramebuffer framebuffer) const;
+    void end_rendering(VkCommandBuffer command_buffer) const;
+    const void* stream_data(uint32_t array, uint32_t first) const;
+    VkDeviceSize stream_stride(uint32_t array) const;
+};
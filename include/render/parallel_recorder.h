@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "jobs/job_system.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Records secondary command buffers on every JobSystem thread and stitches them into a primary.
+// Each (frame, thread) pair owns a command pool that is reset once per frame, never per buffer.
+class ParallelRecorder {
+public:
+    typedef std::function<void(VkCommandBuffer command_buffer, uint32_t begin, uint32_t end)> RecordFn;
+
+    ParallelRecorder(VkDevice device, uint32_t queue_family, uint32_t frame_count, JobSystem& jobs, const VkAllocationCallbacks* host_allocator = nullptr);
+    ~ParallelRecorder();
+
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+    // Call once the fence for frame_index has signalled
+    void begin_frame(uint32_t frame_index);
+
+    // Splits [0, count) into chunks of grain, records each chunk into its own secondary and
+    // executes them into primary in chunk order. inheritance may carry render pass state.
+    void record(VkCommandBuffer primary, uint32_t count, uint32_t grain, const RecordFn& fn,
+                const VkCommandBufferInheritanceInfo* inheritance = nullptr, VkCommandBufferUsageFlags usage = 0);
+
+    uint32_t secondary_count() const { return m_secondary_count; }
+
+private:
+    typedef struct ThreadPool {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers;
+        uint32_t used = 0;
+    } ThreadPool;
+
+    VkDevice m_device;
+    const VkAllocationCallbacks* m_host_allocator;
+    JobSystem& m_jobs;
+    uint32_t m_frame_index = 0;
+    uint32_t m_secondary_count = 0;
+
+    // Indexed by frame * thread_count + thread
+    std::vector<ThreadPool> m_pools;
+    std::vector<VkCommandBuffer> m_secondaries;
+
+    VkCommandBuffer next_buffer(ThreadPool& pool);
+};
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "memory/device_allocator.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Profiler;
+class Breadcrumbs;
+
+enum class RenderQueue {
+    Graphics,
+    Compute
+};
+
+// How a pass touches a resource. Each usage maps to one sync2 stage / access / layout triple.
+enum class ResourceUsage {
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,
+    FragmentSampled,
+    ComputeSampled,
+    StorageRead,
+    StorageWrite,
+    TransferSrc,
+    TransferDst,
+    IndirectBuffer,
+    VertexBuffer,
+    IndexBuffer
+};
+
+typedef uint32_t ResourceHandle;
+typedef uint32_t PassHandle;
+
+// For buffers the layout is ignored
+typedef struct ResourceState {
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 access;
+    VkImageLayout layout;
+} ResourceState;
+
+// compute_queue may equal graphics_queue, in which case Compute passes run on the graphics queue
+typedef struct RenderGraphQueues {
+    VkQueue graphics_queue;
+    uint32_t graphics_family;
+    VkQueue compute_queue;
+    uint32_t compute_family;
+} RenderGraphQueues;
+
+typedef struct RenderGraphStats {
+    uint32_t declared_passes = 0;
+    uint32_t culled_passes = 0;
+    uint32_t batches = 0;
+    uint32_t queue_waits = 0;
+    uint32_t barrier_calls = 0;
+    uint32_t image_barriers = 0;
+    uint32_t memory_barriers = 0;
+    // One full barrier per pass plus a transition per image access, as hand-written code tends to do
+    uint32_t naive_barrier_calls = 0;
+    uint32_t naive_image_barriers = 0;
+    uint32_t transient_resources = 0;
+    uint32_t memory_buckets = 0;
+    VkDeviceSize transient_bytes = 0;
+    VkDeviceSize aliased_bytes = 0;
+} RenderGraphStats;
+
+typedef struct RenderGraphExecuteInfo {
+    uint32_t frame_index;
+    // Binary semaphore waited by the first graphics batch, e.g. swapchain acquire
+    VkSemaphore wait_semaphore = VK_NULL_HANDLE;
+    VkPipelineStageFlags2 wait_stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    // Extra timeline wait for the first batch on each queue, e.g. uploads
+    VkSemaphore wait_timeline = VK_NULL_HANDLE;
+    uint64_t wait_timeline_value = 0;
+    // Binary semaphore and fence signalled by the last graphics batch
+    VkSemaphore signal_semaphore = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    // Recorded at the start of the first and the end of the last graphics batch
+    std::function<void(VkCommandBuffer)> prologue;
+    std::function<void(VkCommandBuffer)> epilogue;
+} RenderGraphExecuteInfo;
+
+// Passes declare what they read and write; compile() culls passes nothing depends on, orders the
+// rest (keeping same-queue passes together), aliases transient resources whose lifetimes don't
+// overlap and precomputes the minimal sync2 barriers. Consecutive passes on one queue form a batch;
+// batches on different queues are chained with per-queue timeline semaphores. Built once and
+// executed every frame; only imported images may change between frames.
+class RenderGraph {
+public:
+    typedef std::function<void(VkCommandBuffer command_buffer)> ExecuteFn;
+
+    // Without synchronization2 (Vulkan 1.2 devices) each pass's barriers are folded into one
+    // vkCmdPipelineBarrier and batches go through vkQueueSubmit with timeline values chained in
+    RenderGraph(VkDevice device, DeviceAllocator& allocator, const RenderGraphQueues& queues, uint32_t frame_count,
+                bool synchronization2 = true);
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Names must be string literals; pass names double as profiler scopes
+    ResourceHandle create_image(const char* name, VkFormat format, VkExtent2D extent);
+    ResourceHandle create_buffer(const char* name, VkDeviceSize size);
+    // Imported resources are never culled and are left in final after their last use. They must be
+    // VK_SHARING_MODE_CONCURRENT if both queues touch them.
+    ResourceHandle import_image(const char* name, VkImage image, VkImageView view, const ResourceState& initial, const ResourceState& final,
+                                VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT);
+    ResourceHandle import_buffer(const char* name, VkBuffer buffer, const ResourceState& initial, const ResourceState& final);
+    void set_image(ResourceHandle resource, VkImage image, VkImageView view);
+
+    PassHandle add_pass(const char* name, RenderQueue queue, ExecuteFn fn);
+    void read(PassHandle pass, ResourceHandle resource, ResourceUsage usage);
+    void write(PassHandle pass, ResourceHandle resource, ResourceUsage usage);
+    // Passes with side effects outside the graph are never culled
+    void set_side_effects(PassHandle pass);
+    void mark_output(ResourceHandle resource);
+
+    void compile();
+    void execute(const RenderGraphExecuteInfo& info);
+
+    void set_profiler(Profiler* profiler) { m_profiler = profiler; }
+    // Marker slots are pass handles, so breadcrumbs needs at least pass_count() of them. Call after compile().
+    void set_breadcrumbs(Breadcrumbs* breadcrumbs);
+    // Fault injection: the next execute() stops inside the named pass (the last scheduled pass if
+    // empty) as if the GPU hung there, submits what it recorded so the breadcrumbs show it, and
+    // throws DeviceLostError. The frame's wait semaphore and fence are still submitted, whichever
+    // queue the pass is on.
+    void inject_device_lost(const std::string& pass_name);
+
+    uint32_t pass_count() const { return (uint32_t)m_passes.size(); }
+
+    VkImage image(ResourceHandle resource) const { return m_resources[resource].image; }
+    VkImageView image_view(ResourceHandle resource) const { return m_resources[resource].view; }
+    VkBuffer buffer(ResourceHandle resource) const { return m_resources[resource].buffer; }
+    VkExtent2D extent(ResourceHandle resource) const { return m_resources[resource].extent; }
+
+    bool uses_async_compute() const { return m_async_compute; }
+    const RenderGraphStats& stats() const { return m_stats; }
+    void report() const;
+
+private:
+    // A pass touches each resource once; a read and a write of the same resource merge into a
+    // read-modify-write that depends on the previous contents
+    typedef struct Access {
+        ResourceHandle resource;
+        VkPipelineStageFlags2 stage;
+        VkAccessFlags2 access;
+        VkAccessFlags2 write_access;
+        VkImageLayout layout;
+        VkImageUsageFlags image_usage;
+        VkBufferUsageFlags buffer_usage;
+        bool read;
+        bool write;
+    } Access;
+
+    typedef struct Pass {
+        const char* name;
+        RenderQueue queue;
+        ExecuteFn fn;
+        std::vector<Access> accesses;
+        bool side_effects = false;
+        bool culled = false;
+        uint32_t batch = 0;
+        // Barriers recorded before the pass; image handles are patched in at execute time
+        std::vector<VkImageMemoryBarrier2> image_barriers;
+        std::vector<ResourceHandle> image_barrier_resources;
+        std::vector<VkMemoryBarrier2> memory_barriers;
+    } Pass;
+
+    typedef struct Resource {
+        const char* name;
+        bool is_image;
+        bool imported;
+        bool output = false;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkExtent2D extent = {0, 0};
+        VkDeviceSize size = 0;
+        VkImageAspectFlags aspect = 0;
+        ResourceState initial = {};
+        ResourceState final = {};
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        // Compiled: schedule positions of first and last use, memory bucket for transients
+        int32_t first_use = -1;
+        int32_t last_use = -1;
+        int32_t bucket = -1;
+        int32_t alias_predecessor = -1;
+        VkMemoryRequirements requirements = {};
+    } Resource;
+
+    typedef struct Batch {
+        RenderQueue queue;
+        std::vector<PassHandle> passes;
+        // Latest batch on the other queue this one has to wait for, or -1
+        int32_t wait_batch = -1;
+        std::vector<VkImageMemoryBarrier2> final_image_barriers;
+        std::vector<ResourceHandle> final_image_resources;
+        std::vector<VkMemoryBarrier2> final_memory_barriers;
+    } Batch;
+
+    typedef struct MemoryBucket {
+        VkMemoryRequirements requirements;
+        AllocationKind kind;
+        std::vector<ResourceHandle> resources;
+        Allocation allocation;
+    } MemoryBucket;
+
+    typedef struct QueueCommands {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> buffers;
+        uint32_t used = 0;
+        uint64_t timeline_value = 0;
+    } QueueCommands;
+
+    // Indexed by RenderQueue
+    typedef struct FrameCommands {
+        QueueCommands queues[2];
+    } FrameCommands;
+
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    RenderGraphQueues m_queues;
+    bool m_async_compute;
+    bool m_synchronization2;
+    Profiler* m_profiler = nullptr;
+    Breadcrumbs* m_breadcrumbs = nullptr;
+    bool m_inject_device_lost = false;
+    std::string m_inject_pass;
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PassHandle> m_schedule;
+    std::vector<Batch> m_batches;
+    std::vector<MemoryBucket> m_buckets;
+    bool m_compiled = false;
+    // Set per queue when its first batch has to wait for the other queue's previous frame
+    bool m_frame_waits[2] = {false, false};
+
+    VkSemaphore m_timelines[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    uint64_t m_timeline_values[2] = {0, 0};
+    std::vector<FrameCommands> m_frames;
+
+    RenderGraphStats m_stats;
+
+    // Reused by the sync1 fallback so translating barriers doesn't allocate every pass
+    std::vector<VkImageMemoryBarrier> m_sync1_image_barriers;
+    std::vector<VkMemoryBarrier> m_sync1_memory_barriers;
+
+    void add_access(PassHandle pass, ResourceHandle resource, ResourceUsage usage, bool write);
+    RenderQueue queue_of(const Pass& pass) const;
+    VkQueue vk_queue(RenderQueue queue) const;
+    uint32_t family(RenderQueue queue) const;
+
+    void cull();
+    void schedule();
+    void build_batches();
+    void create_transients();
+    void build_barriers();
+    void destroy_transients();
+
+    VkCommandBuffer next_command_buffer(QueueCommands& commands);
+    int32_t find_fault_pass() const;
+    void simulate_device_lost(VkQueue queue, const std::vector<VkSemaphoreSubmitInfo>& waits, VkCommandBuffer command_buffer, const Pass& pass,
+                              const RenderGraphExecuteInfo& info, bool frame_wait_submitted);
+    void record_barriers(VkCommandBuffer command_buffer, std::vector<VkImageMemoryBarrier2>& image_barriers,
+                         const std::vector<ResourceHandle>& image_resources, const std::vector<VkMemoryBarrier2>& memory_barriers);
+    // command_buffer may be VK_NULL_HANDLE for a submission that only waits and signals
+    VkResult submit(VkQueue queue, const std::vector<VkSemaphoreSubmitInfo>& waits, VkCommandBuffer command_buffer,
+                    const std::vector<VkSemaphoreSubmitInfo>& signals, VkFence fence);
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "vulkan/vulkan_core.h"
+#include "memory/device_allocator.h"
+#include "memory/ring_arena.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+const VkDeviceSize DEFAULT_STAGING_SIZE = 32ull * 1024 * 1024;
+
+typedef struct UploadQueues {
+    VkQueue transfer_queue;
+    uint32_t transfer_family;
+    uint32_t graphics_family;
+} UploadQueues;
+
+typedef struct UploadStats {
+    uint64_t bytes = 0;
+    uint64_t upload_count = 0;
+    uint64_t batch_count = 0;
+    uint64_t completed_count = 0;
+    double total_latency_ms = 0.0;
+    double max_latency_ms = 0.0;
+} UploadStats;
+
+// Streams data to device-local buffers and images through a persistently mapped staging ring.
+// Copies are batched into one submission per frame on the transfer queue (the graphics queue
+// when the device has no separate transfer family) and signal a timeline semaphore that
+// graphics waits on. Not thread-safe.
+class UploadManager {
+public:
+    UploadManager(VkDevice device, DeviceAllocator& allocator, const UploadQueues& queues, uint32_t frame_count, VkDeviceSize staging_size = DEFAULT_STAGING_SIZE);
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    // Waits for this slot's previous batch (normally long finished) and recycles its staging space
+    void begin_frame(uint32_t frame_index);
+
+    // Both return false when the staging ring is full; retry next frame. Concurrent buffers need no
+    // ownership transfer, so they get no release or acquire barrier on a dedicated queue.
+    bool upload_buffer(VkBuffer dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size, bool concurrent = false);
+    // One whole mip of a single layer colour image, left in final_layout; extent is the mip's.
+    // Other mips are untouched, so a mip chain can arrive over several frames.
+    bool upload_image(VkImage dst, VkExtent3D extent, VkImageLayout final_layout, const void* data, VkDeviceSize size, uint32_t mip_level = 0);
+
+    // Submits everything queued since the last flush. Returns the timeline value consumers must
+    // wait on, or 0 when nothing was queued.
+    uint64_t flush();
+
+    // With a dedicated transfer family, resources change queue ownership; record the matching
+    // acquire barriers into the graphics command buffer that consumes the last flush
+    void record_acquire_barriers(VkCommandBuffer command_buffer);
+
+    void wait_idle();
+    void poll();
+
+    VkSemaphore timeline() const { return m_timeline; }
+    // Largest single upload that can ever be staged
+    VkDeviceSize staging_size() const { return m_ring.size(); }
+    bool uses_dedicated_queue() const { return m_queues.transfer_family != m_queues.graphics_family; }
+    const UploadStats& stats() const { return m_stats; }
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    typedef struct FrameSlot {
+        VkCommandPool command_pool = VK_NULL_HANDLE;
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        uint64_t timeline_value = 0;
+    } FrameSlot;
+
+    typedef struct BufferCopy {
+        VkBuffer dst;
+        VkBufferCopy region;
+        bool concurrent;
+    } BufferCopy;
+
+    typedef struct ImageCopy {
+        VkImage dst;
+        VkBufferImageCopy region;
+        VkImageSubresourceRange range;
+        VkImageLayout final_layout;
+    } ImageCopy;
+
+    typedef struct InFlightBatch {
+        uint64_t timeline_value;
+        std::vector<clock::time_point> enqueue_times;
+    } InFlightBatch;
+
+    VkDevice m_device;
+    DeviceAllocator& m_allocator;
+    UploadQueues m_queues;
+
+    VkBuffer m_staging_buffer = VK_NULL_HANDLE;
+    Allocation m_staging_memory;
+    RingArena m_ring;
+
+    VkSemaphore m_timeline = VK_NULL_HANDLE;
+    uint64_t m_timeline_value = 0;
+
+    std::vector<FrameSlot> m_frames;
+    uint32_t m_frame_index = 0;
+
+    std::vector<BufferCopy> m_buffer_copies;
+    std::vector<ImageCopy> m_image_copies;
+    std::vector<clock::time_point> m_enqueue_times;
+
+    std::vector<VkBufferMemoryBarrier> m_acquire_buffers;
+    std::vector<VkImageMemoryBarrier> m_acquire_images;
+
+    std::deque<InFlightBatch> m_in_flight;
+    UploadStats m_stats;
+
+    bool stage(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+};
@@ -0,0 +1,21 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+// gl_InstanceIndex is the object index the cull pass wrote into firstInstance
+layout(set = 0, binding = 2) readonly buffer Vec4s { vec4 data[]; } vec4_buffers[];
+layout(set = 0, binding = 2) readonly buffer Uints { uint data[]; } uint_buffers[];
+
+layout(push_constant) uniform Draw {
+    mat4 view_proj;
+    uint transforms;
+    uint colors;
+};
+
+layout(location = 0) in vec3 position;
+layout(location = 0) out vec4 color;
+
+void main() {
+    vec4 transform = vec4_buffers[transforms].data[gl_InstanceIndex];
+    gl_Position = view_proj * vec4(position * transform.w + transform.xyz, 1.0);
+    color = unpackUnorm4x8(uint_buffers[colors].data[gl_InstanceIndex]);
+}
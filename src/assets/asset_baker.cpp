@@ -0,0 +1,335 @@
+#include "assets/asset_baker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// 2x2 box filter; odd edges reuse the last row or column
+static std::vector<uint8_t> downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height) {
+    uint32_t next_width = std::max(width / 2, 1u);
+    uint32_t next_height = std::max(height / 2, 1u);
+    std::vector<uint8_t> result((size_t)next_width * next_height * 4);
+
+    for (uint32_t y = 0; y < next_height; y++) {
+        uint32_t y0 = std::min(y * 2, height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < next_width; x++) {
+            uint32_t x0 = std::min(x * 2, width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c] +
+                               source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                result[((size_t)y * next_width + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+static uint16_t pack_565(const int color[3]) {
+    return (uint16_t)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+}
+
+static void unpack_565(uint16_t packed, int color[3]) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// Range fit: endpoints are the block's colour bounding box pulled in by 1/16 of its extent, and
+// every texel takes the nearest of the four palette entries. Alpha is dropped; blocks are always
+// in the opaque four-colour mode.
+static void encode_bc1_block(const uint8_t texels[16][4], uint8_t block[8]) {
+    int low[3] = {255, 255, 255};
+    int high[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < 16; i++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            low[c] = std::min(low[c], (int)texels[i][c]);
+            high[c] = std::max(high[c], (int)texels[i][c]);
+        }
+    }
+
+    for (uint32_t c = 0; c < 3; c++) {
+        int inset = (high[c] - low[c]) / 16;
+        low[c] += inset;
+        high[c] -= inset;
+    }
+
+    uint16_t color0 = pack_565(high);
+    uint16_t color1 = pack_565(low);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (uint32_t c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t best = 0;
+            int best_distance = INT32_MAX;
+            for (uint32_t p = 0; p < 4; p++) {
+                int distance = 0;
+                for (uint32_t c = 0; c < 3; c++) {
+                    int d = (int)texels[i][c] - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    std::memcpy(block, &color0, 2);
+    std::memcpy(block + 2, &color1, 2);
+    std::memcpy(block + 4, &indices, 4);
+}
+
+// Partial blocks at the right and bottom edges repeat the last texel
+static std::vector<uint8_t> encode_bc1(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height) {
+    uint32_t blocks_x = (width + 3) / 4;
+    uint32_t blocks_y = (height + 3) / 4;
+    std::vector<uint8_t> result((size_t)blocks_x * blocks_y * 8);
+
+    for (uint32_t by = 0; by < blocks_y; by++) {
+        for (uint32_t bx = 0; bx < blocks_x; bx++) {
+            uint8_t texels[16][4];
+            for (uint32_t i = 0; i < 16; i++) {
+                uint32_t x = std::min(bx * 4 + i % 4, width - 1);
+                uint32_t y = std::min(by * 4 + i / 4, height - 1);
+                std::memcpy(texels[i], &rgba[((size_t)y * width + x) * 4], 4);
+            }
+            encode_bc1_block(texels, &result[((size_t)by * blocks_x + bx) * 8]);
+        }
+    }
+    return result;
+}
+
+uint32_t AssetBaker::add_buffer(const std::string& name, const AssetEntry& entry, const uint8_t* data, uint64_t size) {
+    BakedAsset asset = {
+        .name = name,
+        .entry = entry,
+    };
+    asset.entry.size = size;
+
+    for (uint64_t offset = 0; offset < size; offset += ASSET_MAX_CHUNK_SIZE) {
+        uint64_t chunk_size = std::min(ASSET_MAX_CHUNK_SIZE, size - offset);
+        asset.chunks.push_back({
+            .bytes = std::vector<uint8_t>(data + offset, data + offset + chunk_size),
+            .destination_offset = offset,
+            .mip_level = 0,
+        });
+    }
+
+    m_assets.push_back(std::move(asset));
+    return (uint32_t)m_assets.size() - 1;
+}
+
+uint32_t AssetBaker::add_mesh(const std::string& name, const std::vector<AssetVertex>& vertices, const std::vector<uint32_t>& indices) {
+    AssetEntry entry = {};
+    entry.kind = AssetKind::Mesh;
+    entry.mesh.vertex_count = (uint32_t)vertices.size();
+    entry.mesh.index_count = (uint32_t)indices.size();
+    entry.mesh.index_offset = vertices.size() * sizeof(AssetVertex);
+
+    // Centre of the bounding box and the farthest vertex from it; loose but cheap to cull against
+    float low[3] = {INFINITY, INFINITY, INFINITY};
+    float high[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (const AssetVertex& vertex : vertices) {
+        for (uint32_t c = 0; c < 3; c++) {
+            low[c] = std::min(low[c], vertex.position[c]);
+            high[c] = std::max(high[c], vertex.position[c]);
+        }
+    }
+
+    float radius = 0.0f;
+    if (!vertices.empty()) {
+        for (uint32_t c = 0; c < 3; c++) {
+            entry.mesh.bounds[c] = (low[c] + high[c]) * 0.5f;
+        }
+        for (const AssetVertex& vertex : vertices) {
+            float dx = vertex.position[0] - entry.mesh.bounds[0];
+            float dy = vertex.position[1] - entry.mesh.bounds[1];
+            float dz = vertex.position[2] - entry.mesh.bounds[2];
+            radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+        }
+    }
+    entry.mesh.bounds[3] = radius;
+
+    std::vector<uint8_t> bytes(entry.mesh.index_offset + indices.size() * sizeof(uint32_t));
+    std::memcpy(bytes.data(), vertices.data(), vertices.size() * sizeof(AssetVertex));
+    std::memcpy(bytes.data() + entry.mesh.index_offset, indices.data(), indices.size() * sizeof(uint32_t));
+
+    return add_buffer(name, entry, bytes.data(), bytes.size());
+}
+
+uint32_t AssetBaker::add_materials(const std::string& name, const std::vector<AssetMaterial>& materials) {
+    AssetEntry entry = {};
+    entry.kind = AssetKind::Material;
+    entry.material.material_count = (uint32_t)materials.size();
+
+    return add_buffer(name, entry, (const uint8_t*)materials.data(), materials.size() * sizeof(AssetMaterial));
+}
+
+uint32_t AssetBaker::add_texture(const std::string& name, uint32_t width, uint32_t height, const std::vector<uint8_t>& rgba,
+                                 const TextureBakeOptions& options) {
+    if (width == 0 || height == 0 || rgba.size() != (size_t)width * height * 4) {
+        throw std::runtime_error("Failed to bake texture " + name + ": expected " + std::to_string(width) + "x" + std::to_string(height) + " RGBA8 texels");
+    }
+    if (options.format != VK_FORMAT_BC1_RGBA_UNORM_BLOCK && options.format != VK_FORMAT_R8G8B8A8_UNORM) {
+        throw std::runtime_error("Failed to bake texture " + name + ": only BC1 and RGBA8 are supported");
+    }
+
+    uint32_t mip_count = 1;
+    if (options.mips) {
+        mip_count = (uint32_t)std::floor(std::log2((double)std::max(width, height))) + 1;
+    }
+
+    BakedAsset asset = {
+        .name = name,
+        .entry = {},
+    };
+    asset.entry.kind = AssetKind::Texture;
+    asset.entry.texture.width = width;
+    asset.entry.texture.height = height;
+    asset.entry.texture.mip_count = mip_count;
+    asset.entry.texture.format = (uint32_t)options.format;
+
+    std::vector<uint8_t> level = rgba;
+    uint32_t level_width = width;
+    uint32_t level_height = height;
+    for (uint32_t mip = 0; mip < mip_count; mip++) {
+        if (mip > 0) {
+            level = downsample(level, level_width, level_height);
+            level_width = std::max(level_width / 2, 1u);
+            level_height = std::max(level_height / 2, 1u);
+        }
+
+        std::vector<uint8_t> bytes = options.format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK ? encode_bc1(level, level_width, level_height) : level;
+        if (bytes.size() > ASSET_MAX_MIP_SIZE) {
+            throw std::runtime_error("Failed to bake texture " + name + ": mip " + std::to_string(mip) + " is " +
+                                     std::to_string(bytes.size()) + " bytes, over the per-mip limit");
+        }
+
+        asset.entry.size += bytes.size();
+        asset.chunks.push_back({
+            .bytes = std::move(bytes),
+            .destination_offset = 0,
+            .mip_level = mip,
+        });
+    }
+
+    m_assets.push_back(std::move(asset));
+    return (uint32_t)m_assets.size() - 1;
+}
+
+uint32_t AssetBaker::find(const std::string& name) const {
+    for (uint32_t i = 0; i < (uint32_t)m_assets.size(); i++) {
+        if (m_assets[i].name == name) {
+            return i;
+        }
+    }
+    return ASSET_NOT_FOUND;
+}
+
+uint64_t AssetBaker::payload_bytes() const {
+    uint64_t total = 0;
+    for (const BakedAsset& asset : m_assets) {
+        total += asset.entry.size;
+    }
+    return total;
+}
+
+void AssetBaker::write(const std::string& path) const {
+    std::vector<AssetEntry> entries;
+    std::vector<AssetChunk> chunks;
+    std::string strings;
+
+    for (const BakedAsset& asset : m_assets) {
+        AssetEntry entry = asset.entry;
+        entry.name_offset = (uint32_t)strings.size();
+        entry.first_chunk = (uint32_t)chunks.size();
+        entry.chunk_count = (uint32_t)asset.chunks.size();
+        strings.append(asset.name);
+        strings.push_back('\0');
+
+        for (const Payload& payload : asset.chunks) {
+            chunks.push_back({
+                .file_offset = 0,
+                .size = payload.bytes.size(),
+                .destination_offset = payload.destination_offset,
+                .asset = (uint32_t)entries.size(),
+                .mip_level = payload.mip_level,
+            });
+        }
+        entries.push_back(entry);
+    }
+    if (strings.empty()) {
+        strings.push_back('\0');
+    }
+
+    AssetPackHeader header = {
+        .magic = ASSET_PACK_MAGIC,
+        .version = ASSET_PACK_VERSION,
+        .asset_count = (uint32_t)entries.size(),
+        .chunk_count = (uint32_t)chunks.size(),
+        .asset_table_offset = sizeof(AssetPackHeader),
+        .chunk_table_offset = 0,
+        .string_table_offset = 0,
+        .string_table_size = strings.size(),
+        .file_size = 0,
+    };
+    header.chunk_table_offset = header.asset_table_offset + entries.size() * sizeof(AssetEntry);
+    header.string_table_offset = header.chunk_table_offset + chunks.size() * sizeof(AssetChunk);
+
+    uint64_t offset = header.string_table_offset + strings.size();
+    for (AssetChunk& chunk : chunks) {
+        offset = align_up(offset, ASSET_PAYLOAD_ALIGNMENT);
+        chunk.file_offset = offset;
+        offset += chunk.size;
+    }
+    header.file_size = offset;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to write asset pack " + path);
+    }
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)entries.data(), entries.size() * sizeof(AssetEntry));
+    file.write((const char*)chunks.data(), chunks.size() * sizeof(AssetChunk));
+    file.write(strings.data(), strings.size());
+
+    static const char zeros[ASSET_PAYLOAD_ALIGNMENT] = {};
+    uint64_t written = header.string_table_offset + strings.size();
+    uint32_t index = 0;
+    for (const BakedAsset& asset : m_assets) {
+        for (const Payload& payload : asset.chunks) {
+            file.write(zeros, chunks[index].file_offset - written);
+            file.write((const char*)payload.bytes.data(), payload.bytes.size());
+            written = chunks[index].file_offset + payload.bytes.size();
+            index++;
+        }
+    }
+
+    if (!file) {
+        throw std::runtime_error("Failed to write asset pack " + path);
+    }
+}
@@ -0,0 +1,220 @@
+#include "assets/asset_pack.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const uint64_t PREFETCH_PAGE_SIZE = 4096;
+
+AssetPack::AssetPack(const std::string& path) : m_path(path) {
+    map(path);
+
+    try {
+        validate();
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+AssetPack::~AssetPack() {
+    unmap();
+}
+
+#ifdef _WIN32
+void AssetPack::map(const std::string& path) {
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        throw std::runtime_error("Failed to open asset pack " + path);
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = (uint64_t)size.QuadPart;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_base = m_mapping ? (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (m_base == nullptr) {
+        unmap();
+        throw std::runtime_error("Failed to map asset pack " + path);
+    }
+}
+
+void AssetPack::unmap() {
+    if (m_base != nullptr) {
+        UnmapViewOfFile(m_base);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+    m_base = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+#else
+void AssetPack::map(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open asset pack " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Failed to open asset pack " + path + ": empty file");
+    }
+    m_size = (uint64_t)info.st_size;
+
+    // The mapping keeps its own reference to the file
+    void* base = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Failed to map asset pack " + path);
+    }
+
+    // Chunks are requested by priority, not file order, so the kernel's sequential readahead
+    // would mostly fetch the wrong pages; prefetch() asks for each chunk explicitly
+    madvise(base, m_size, MADV_RANDOM);
+    m_base = (const char*)base;
+}
+
+void AssetPack::unmap() {
+    if (m_base != nullptr) {
+        munmap((void*)m_base, m_size);
+    }
+    m_base = nullptr;
+}
+#endif
+
+void AssetPack::validate() {
+    auto fail = [&](const char* reason) {
+        throw std::runtime_error("Failed to open asset pack " + m_path + ": " + reason);
+    };
+
+    if (m_size < sizeof(AssetPackHeader)) {
+        fail("truncated header");
+    }
+
+    m_header = (const AssetPackHeader*)m_base;
+    if (m_header->magic != ASSET_PACK_MAGIC) {
+        fail("not an asset pack");
+    }
+    if (m_header->version != ASSET_PACK_VERSION) {
+        fail("unsupported version, rebake it");
+    }
+    if (m_header->file_size != m_size) {
+        fail("size does not match the header, the file is truncated");
+    }
+
+    auto in_file = [&](uint64_t offset, uint64_t size) {
+        return offset <= m_size && size <= m_size - offset;
+    };
+
+    if (!in_file(m_header->asset_table_offset, (uint64_t)m_header->asset_count * sizeof(AssetEntry)) ||
+        !in_file(m_header->chunk_table_offset, (uint64_t)m_header->chunk_count * sizeof(AssetChunk)) ||
+        !in_file(m_header->string_table_offset, m_header->string_table_size) ||
+        m_header->asset_table_offset % alignof(AssetEntry) != 0 || m_header->chunk_table_offset % alignof(AssetChunk) != 0) {
+        fail("table outside the file");
+    }
+
+    m_assets = (const AssetEntry*)(m_base + m_header->asset_table_offset);
+    m_chunks = (const AssetChunk*)(m_base + m_header->chunk_table_offset);
+    m_strings = m_base + m_header->string_table_offset;
+
+    if (m_header->string_table_size == 0 || m_strings[m_header->string_table_size - 1] != '\0') {
+        fail("unterminated string table");
+    }
+
+    for (uint32_t i = 0; i < m_header->asset_count; i++) {
+        const AssetEntry& entry = m_assets[i];
+        if (entry.name_offset >= m_header->string_table_size) {
+            fail("asset name outside the string table");
+        }
+        if (entry.first_chunk > m_header->chunk_count || entry.chunk_count > m_header->chunk_count - entry.first_chunk) {
+            fail("asset chunks outside the chunk table");
+        }
+        if (entry.kind == AssetKind::Texture && entry.chunk_count != entry.texture.mip_count) {
+            fail("texture without one chunk per mip");
+        }
+    }
+
+    for (uint32_t i = 0; i < m_header->chunk_count; i++) {
+        const AssetChunk& chunk = m_chunks[i];
+        if (!in_file(chunk.file_offset, chunk.size) || chunk.asset >= m_header->asset_count) {
+            fail("chunk outside the file");
+        }
+
+        const AssetEntry& entry = m_assets[chunk.asset];
+        if (entry.kind != AssetKind::Texture && (chunk.destination_offset > entry.size || chunk.size > entry.size - chunk.destination_offset)) {
+            fail("chunk outside its buffer");
+        }
+        m_largest_chunk = std::max(m_largest_chunk, chunk.size);
+    }
+}
+
+uint32_t AssetPack::find(const std::string& name) const {
+    for (uint32_t i = 0; i < asset_count(); i++) {
+        if (name == this->name(i)) {
+            return i;
+        }
+    }
+    return ASSET_NOT_FOUND;
+}
+
+void AssetPack::prefetch(const AssetChunk& chunk) const {
+    if (chunk.size == 0) {
+        return;
+    }
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = {(void*)(m_base + chunk.file_offset), (SIZE_T)chunk.size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page-aligned start; payloads are, but be safe with hand-built packs
+    uintptr_t start = (uintptr_t)(m_base + chunk.file_offset) & ~(uintptr_t)(PREFETCH_PAGE_SIZE - 1);
+    uintptr_t end = (uintptr_t)(m_base + chunk.file_offset + chunk.size);
+    madvise((void*)start, end - start, MADV_WILLNEED);
+#endif
+
+    // WILLNEED only starts the reads; faulting each page here is what keeps the render thread's
+    // copy into staging from ever blocking on the disk
+    const volatile char* bytes = (const volatile char*)(m_base + chunk.file_offset);
+    char sum = 0;
+    for (uint64_t offset = 0; offset < chunk.size; offset += PREFETCH_PAGE_SIZE) {
+        sum ^= bytes[offset];
+    }
+    sum ^= bytes[chunk.size - 1];
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    (void)sum;
+}
+
+bool AssetPack::drop_page_cache(const std::string& path) {
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    // Only clean pages are dropped; a freshly written pack must reach the disk first
+    fdatasync(fd);
+    bool dropped = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return dropped;
+#else
+    return false;
+#endif
+}
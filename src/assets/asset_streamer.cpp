@@ -0,0 +1,264 @@
+#include "assets/asset_streamer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+AssetStreamer::AssetStreamer(VkPhysicalDevice physical_device, VkDevice device, DeviceAllocator& allocator, const AssetPack& pack)
+    : m_device(device), m_allocator(allocator), m_pack(pack), m_states(new AssetState[pack.asset_count()]) {
+    // A BC1 pack on a device without BCn fails here rather than at the first upload
+    for (uint32_t i = 0; i < pack.asset_count(); i++) {
+        const AssetEntry& entry = pack.asset(i);
+        if (entry.kind != AssetKind::Texture) {
+            continue;
+        }
+
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physical_device, (VkFormat)entry.texture.format, &properties);
+        VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+        if ((properties.optimalTilingFeatures & needed) != needed) {
+            throw std::runtime_error(std::string("Failed to load asset pack: texture ") + pack.name(i) +
+                                     " has a format this device cannot sample, rebake with --rgba8");
+        }
+    }
+
+    m_thread = std::thread(&AssetStreamer::io_main, this);
+}
+
+AssetStreamer::~AssetStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    for (uint32_t i = 0; i < m_pack.asset_count(); i++) {
+        destroy_resource(m_states[i].resource);
+    }
+}
+
+void AssetStreamer::create_resource(uint32_t asset) {
+    const AssetEntry& entry = m_pack.asset(asset);
+    AssetResource& resource = m_states[asset].resource;
+
+    if (entry.kind != AssetKind::Texture) {
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        if (entry.kind == AssetKind::Mesh) {
+            usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        }
+
+        VkBufferCreateInfo buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .size = std::max<VkDeviceSize>(entry.size, 4),
+            .usage = usage,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        };
+
+        if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &resource.buffer) != VK_SUCCESS) {
+            throw std::runtime_error(std::string("Failed to create buffer for asset ") + m_pack.name(asset));
+        }
+        resource.memory = m_allocator.allocate_buffer(resource.buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        return;
+    }
+
+    VkFormat format = (VkFormat)entry.texture.format;
+
+    VkImageCreateInfo image_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = {
+            .width = entry.texture.width,
+            .height = entry.texture.height,
+            .depth = 1
+        },
+        .mipLevels = entry.texture.mip_count,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    if (vkCreateImage(m_device, &image_info, m_allocator.host_allocator(), &resource.image) != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to create image for asset ") + m_pack.name(asset));
+    }
+    resource.memory = m_allocator.allocate_image(resource.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo view_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = resource.image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+        },
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = entry.texture.mip_count,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    if (vkCreateImageView(m_device, &view_info, m_allocator.host_allocator(), &resource.view) != VK_SUCCESS) {
+        throw std::runtime_error(std::string("Failed to create image view for asset ") + m_pack.name(asset));
+    }
+}
+
+void AssetStreamer::destroy_resource(AssetResource& resource) {
+    if (resource.view != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, resource.view, m_allocator.host_allocator());
+    }
+    if (resource.image != VK_NULL_HANDLE) {
+        vkDestroyImage(m_device, resource.image, m_allocator.host_allocator());
+    }
+    if (resource.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(m_device, resource.buffer, m_allocator.host_allocator());
+    }
+    if (resource.memory.memory != VK_NULL_HANDLE) {
+        m_allocator.free(resource.memory);
+    }
+    resource = AssetResource();
+}
+
+void AssetStreamer::request(uint32_t asset, float priority) {
+    AssetState& state = m_states[asset];
+
+    if (state.requested) {
+        if (state.priority != priority) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            state.priority = priority;
+        }
+        return;
+    }
+
+    create_resource(asset);
+    state.requested = true;
+    m_stats.requested++;
+    m_active.push_back(asset);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        state.priority = priority;
+        if (m_pack.asset(asset).chunk_count > 0) {
+            m_io_queue.push_back(asset);
+        }
+    }
+    m_wake.notify_one();
+}
+
+bool AssetStreamer::upload_chunk(UploadManager& uploads, const AssetEntry& entry, const AssetChunk& chunk) {
+    const AssetResource& resource = m_states[chunk.asset].resource;
+
+    if (entry.kind != AssetKind::Texture) {
+        return uploads.upload_buffer(resource.buffer, chunk.destination_offset, m_pack.data(chunk), chunk.size);
+    }
+
+    VkExtent3D extent = {
+        .width = std::max(entry.texture.width >> chunk.mip_level, 1u),
+        .height = std::max(entry.texture.height >> chunk.mip_level, 1u),
+        .depth = 1
+    };
+    return uploads.upload_image(resource.image, extent, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_pack.data(chunk), chunk.size, chunk.mip_level);
+}
+
+bool AssetStreamer::stream(UploadManager& uploads) {
+    if (m_pack.largest_chunk() > uploads.staging_size()) {
+        throw std::runtime_error("Failed to stream asset pack: a " + std::to_string(m_pack.largest_chunk()) +
+                                 " byte chunk does not fit the staging ring");
+    }
+
+    std::stable_sort(m_active.begin(), m_active.end(), [&](uint32_t a, uint32_t b) {
+        return m_states[a].priority > m_states[b].priority;
+    });
+
+    // Lower-priority assets still fill staging the higher ones can't use yet because the I/O
+    // thread hasn't reached their chunks
+    bool staging_full = false;
+    for (uint32_t asset : m_active) {
+        AssetState& state = m_states[asset];
+        const AssetEntry& entry = m_pack.asset(asset);
+        uint32_t prefetched = state.prefetched.load(std::memory_order_acquire);
+
+        while (state.uploaded < prefetched) {
+            const AssetChunk& chunk = m_pack.chunk(entry.first_chunk + state.uploaded);
+            if (!upload_chunk(uploads, entry, chunk)) {
+                staging_full = true;
+                break;
+            }
+            state.uploaded++;
+            m_stats.chunks_uploaded++;
+            m_stats.bytes_uploaded += chunk.size;
+        }
+
+        if (state.uploaded == entry.chunk_count) {
+            m_stats.resident++;
+        }
+        if (staging_full) {
+            break;
+        }
+    }
+
+    m_active.erase(std::remove_if(m_active.begin(), m_active.end(), [&](uint32_t asset) {
+        return m_states[asset].uploaded == m_pack.asset(asset).chunk_count;
+    }), m_active.end());
+
+    return m_active.empty();
+}
+
+void AssetStreamer::io_main() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || !m_io_queue.empty(); });
+        if (m_stop) {
+            return;
+        }
+
+        // Picked again after every chunk, so a raised priority takes effect within one chunk
+        auto next = std::max_element(m_io_queue.begin(), m_io_queue.end(), [&](uint32_t a, uint32_t b) {
+            return m_states[a].priority < m_states[b].priority;
+        });
+        uint32_t asset = *next;
+        const AssetEntry& entry = m_pack.asset(asset);
+        AssetState& state = m_states[asset];
+
+        uint32_t index = state.prefetched.load(std::memory_order_relaxed);
+        if (index + 1 == entry.chunk_count) {
+            m_io_queue.erase(next);
+        }
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        m_pack.prefetch(m_pack.chunk(entry.first_chunk + index));
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        m_io_ns.fetch_add((uint64_t)elapsed.count(), std::memory_order_relaxed);
+        m_chunks_prefetched.fetch_add(1, std::memory_order_relaxed);
+        state.prefetched.store(index + 1, std::memory_order_release);
+
+        lock.lock();
+    }
+}
+
+AssetStreamerStats AssetStreamer::stats() const {
+    AssetStreamerStats stats = m_stats;
+    stats.chunks_prefetched = m_chunks_prefetched.load(std::memory_order_relaxed);
+    stats.io_ms = (double)m_io_ns.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+}
+
+void AssetStreamer::report() const {
+    AssetStreamerStats stats = this->stats();
+    std::cout << "Assets: " << stats.resident << "/" << stats.requested << " resident of " << m_pack.asset_count() << ", "
+              << stats.chunks_uploaded << " chunks (" << stats.bytes_uploaded / (1024 * 1024) << " MiB) uploaded, "
+              << stats.io_ms << " ms faulting in " << stats.chunks_prefetched << " chunks\n";
+}
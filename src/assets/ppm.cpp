@@ -0,0 +1,56 @@
+#include "assets/ppm.h"
+#include <fstream>
+#include <stdexcept>
+
+void load_ppm(const std::string& path, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open image " + path);
+    }
+
+    auto next_token = [&]() {
+        std::string token;
+        while (file >> token && token[0] == '#') {
+            std::getline(file, token);
+        }
+        return token;
+    };
+
+    if (next_token() != "P6") {
+        throw std::runtime_error("Failed to load image " + path + ": only binary PPM (P6) is supported");
+    }
+    width = (uint32_t)std::stoul(next_token());
+    height = (uint32_t)std::stoul(next_token());
+    if (next_token() != "255") {
+        throw std::runtime_error("Failed to load image " + path + ": only 8-bit PPM is supported");
+    }
+    file.get();
+
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    if (!file.read((char*)rgb.data(), rgb.size())) {
+        throw std::runtime_error("Failed to load image " + path + ": truncated");
+    }
+
+    rgba.resize((size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void save_ppm(const std::string& path, uint32_t width, uint32_t height, const uint8_t* rgba) {
+    std::vector<uint8_t> rgb((size_t)width * height * 3);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        rgb[i * 3 + 0] = rgba[i * 4 + 0];
+        rgb[i * 3 + 1] = rgba[i * 4 + 1];
+        rgb[i * 3 + 2] = rgba[i * 4 + 2];
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    if (!file.write((const char*)rgb.data(), rgb.size())) {
+        throw std::runtime_error("Failed to write image " + path);
+    }
+}
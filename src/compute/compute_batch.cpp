@@ -0,0 +1,225 @@
+#include "compute/compute_batch.h"
+#include "assets/ppm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+typedef std::chrono::steady_clock batch_clock;
+
+static double ms_since(batch_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(batch_clock::now() - start).count();
+}
+
+static std::string file_name_of(const std::string& path) {
+    size_t split = path.find_last_of("/\\");
+    return split == std::string::npos ? path : path.substr(split + 1);
+}
+
+ComputeBatch::ComputeBatch(VkDevice device, DeviceAllocator& allocator, BindlessTable& bindless, ShaderLibrary& shaders, VkQueue queue,
+                           uint32_t queue_family, uint32_t in_flight)
+    : m_device(device), m_allocator(allocator), m_bindless(bindless), m_queue(queue), m_filter(shaders, bindless) {
+    VkSemaphoreTypeCreateInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_info,
+    };
+
+    if (vkCreateSemaphore(m_device, &semaphore_info, m_allocator.host_allocator(), &m_timeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute batch timeline semaphore");
+    }
+
+    m_slots.resize(std::max(in_flight, 1u));
+    for (auto& slot : m_slots) {
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queue_family,
+        };
+
+        if (vkCreateCommandPool(m_device, &pool_info, m_allocator.host_allocator(), &slot.command_pool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create compute batch command pool");
+        }
+
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = slot.command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+        if (vkAllocateCommandBuffers(m_device, &alloc_info, &slot.command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate compute batch command buffer");
+        }
+    }
+}
+
+ComputeBatch::~ComputeBatch() {
+    if (m_timeline_value > 0) {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &m_timeline,
+            .pValues = &m_timeline_value,
+        };
+        vkWaitSemaphores(m_device, &wait_info, UINT64_MAX);
+    }
+
+    for (auto& slot : m_slots) {
+        destroy_buffer(slot);
+        vkDestroyCommandPool(m_device, slot.command_pool, m_allocator.host_allocator());
+    }
+    vkDestroySemaphore(m_device, m_timeline, m_allocator.host_allocator());
+}
+
+// Only called on a finished slot, so the old buffer is idle
+void ComputeBatch::reserve(BatchSlot& slot, VkDeviceSize size) {
+    if (size <= slot.capacity) {
+        return;
+    }
+    destroy_buffer(slot);
+
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &slot.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute batch buffer");
+    }
+
+    slot.memory = m_allocator.allocate_buffer(slot.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    slot.bindless_slot = m_bindless.add_storage_buffer(slot.buffer);
+    slot.capacity = size;
+}
+
+void ComputeBatch::destroy_buffer(BatchSlot& slot) {
+    if (slot.buffer == VK_NULL_HANDLE) {
+        return;
+    }
+
+    m_bindless.release(BindlessKind::StorageBuffer, slot.bindless_slot);
+    vkDestroyBuffer(m_device, slot.buffer, m_allocator.host_allocator());
+    m_allocator.free(slot.memory);
+    slot.buffer = VK_NULL_HANDLE;
+    slot.bindless_slot = BINDLESS_INVALID_SLOT;
+    slot.capacity = 0;
+}
+
+void ComputeBatch::submit(BatchSlot& slot, float exposure) {
+    vkResetCommandPool(m_device, slot.command_pool, 0);
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    if (vkBeginCommandBuffer(slot.command_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin compute batch command buffer");
+    }
+
+    // Host writes are visible at submission; the results need a barrier to the host
+    m_filter.record(slot.command_buffer, slot.bindless_slot, slot.bindless_slot, slot.width * slot.height, exposure);
+
+    // Sync1, like the upload manager, so the batch also runs on devices without synchronization2
+    VkMemoryBarrier to_host = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+    vkCmdPipelineBarrier(slot.command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &to_host, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(slot.command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record compute batch command buffer");
+    }
+
+    // Descriptor writes for newly grown buffers
+    m_bindless.flush();
+
+    slot.timeline_value = ++m_timeline_value;
+
+    VkTimelineSemaphoreSubmitInfo timeline_submit = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &slot.timeline_value,
+    };
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_submit,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &slot.command_buffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &m_timeline,
+    };
+
+    if (vkQueueSubmit(m_queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit compute batch");
+    }
+}
+
+void ComputeBatch::finish(BatchSlot& slot) {
+    if (slot.output.empty()) {
+        return;
+    }
+
+    auto wait_start = batch_clock::now();
+    VkSemaphoreWaitInfo wait_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &m_timeline,
+        .pValues = &slot.timeline_value,
+    };
+    vkWaitSemaphores(m_device, &wait_info, UINT64_MAX);
+    m_stats.wait_ms += ms_since(wait_start);
+
+    auto save_start = batch_clock::now();
+    save_ppm(slot.output, slot.width, slot.height, (const uint8_t*)slot.memory.mapped);
+    m_stats.save_ms += ms_since(save_start);
+
+    m_stats.images++;
+    m_stats.pixels += (uint64_t)slot.width * slot.height;
+    slot.output.clear();
+}
+
+const ComputeBatchStats& ComputeBatch::run(const ComputeBatchConfig& config) {
+    auto start = batch_clock::now();
+
+    for (size_t i = 0; i < config.inputs.size(); i++) {
+        BatchSlot& slot = m_slots[i % m_slots.size()];
+        finish(slot);
+
+        auto load_start = batch_clock::now();
+        load_ppm(config.inputs[i], slot.width, slot.height, m_pixels);
+        reserve(slot, std::max<VkDeviceSize>(m_pixels.size(), 4));
+        std::memcpy(slot.memory.mapped, m_pixels.data(), m_pixels.size());
+        m_stats.load_ms += ms_since(load_start);
+
+        slot.output = config.output_dir + "/" + file_name_of(config.inputs[i]);
+        submit(slot, config.exposure);
+    }
+
+    // Oldest first, so results land in input order
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        finish(m_slots[(config.inputs.size() + i) % m_slots.size()]);
+    }
+
+    m_stats.total_ms += ms_since(start);
+    return m_stats;
+}
+
+void ComputeBatch::report() const {
+    double seconds = m_stats.total_ms / 1000.0;
+    std::cout << "Compute batch: " << m_stats.images << " images, " << (double)m_stats.pixels / 1e6 << " MP in " << m_stats.total_ms
+              << " ms (" << (seconds > 0.0 ? (double)m_stats.pixels / 1e6 / seconds : 0.0) << " MP/s, "
+              << m_slots.size() << " in flight), load " << m_stats.load_ms << " ms, save " << m_stats.save_ms
+              << " ms, waiting on the GPU " << m_stats.wait_ms << " ms\n";
+}
@@ -0,0 +1,54 @@
+#include "compute/image_filter.h"
+#include "pipeline/builtin_shaders.h"
+#include <algorithm>
+
+// Push constant block, laid out as the shader declares it
+typedef struct FilterConstants {
+    uint32_t first;
+    uint32_t pixel_count;
+    uint32_t src;
+    uint32_t dst;
+    float exposure;
+} FilterConstants;
+
+static_assert(sizeof(FilterConstants) <= BINDLESS_PUSH_CONSTANT_SIZE, "filter constants exceed the push constant range");
+
+ImageFilter::ImageFilter(ShaderLibrary& shaders, BindlessTable& bindless) : m_shaders(shaders), m_bindless(bindless) {
+    VkPipelineLayout layout = m_bindless.pipeline_layout();
+    ShaderHandle shader = m_shaders.add_shader("image_filter.comp", image_filter_spirv, sizeof(image_filter_spirv));
+
+    m_pipeline = m_shaders.add_pipeline({shader}, [layout](PipelineCache& cache, const std::vector<VkShaderModule>& modules) {
+        VkComputePipelineCreateInfo pipeline_info = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = modules[0],
+                .pName = "main",
+            },
+            .layout = layout,
+        };
+
+        return cache.create_compute_pipeline(pipeline_info);
+    });
+}
+
+void ImageFilter::record(VkCommandBuffer command_buffer, uint32_t src, uint32_t dst, uint32_t pixel_count, float exposure) const {
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_shaders.pipeline(m_pipeline));
+    m_bindless.bind(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    const uint32_t pixels_per_dispatch = IMAGE_FILTER_MAX_GROUPS * IMAGE_FILTER_WORKGROUP_SIZE;
+    for (uint32_t first = 0; first < pixel_count; first += pixels_per_dispatch) {
+        FilterConstants constants = {
+            .first = first,
+            .pixel_count = pixel_count,
+            .src = src,
+            .dst = dst,
+            .exposure = exposure,
+        };
+
+        uint32_t pixels = std::min(pixel_count - first, pixels_per_dispatch);
+        vkCmdPushConstants(command_buffer, m_bindless.pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), &constants);
+        vkCmdDispatch(command_buffer, (pixels + IMAGE_FILTER_WORKGROUP_SIZE - 1) / IMAGE_FILTER_WORKGROUP_SIZE, 1, 1);
+    }
+}
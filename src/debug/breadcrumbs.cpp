@@ -0,0 +1,104 @@
+#include "debug/breadcrumbs.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+Breadcrumbs::Breadcrumbs(VkDevice device, DeviceAllocator& allocator, uint32_t slot_count, const std::vector<uint32_t>& queue_families)
+    : m_device(device), m_allocator(allocator), m_labels(slot_count, nullptr) {
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = std::max<VkDeviceSize>((VkDeviceSize)slot_count * 2 * sizeof(uint32_t), 16),
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = queue_families.size() > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = queue_families.size() > 1 ? (uint32_t)queue_families.size() : 0,
+        .pQueueFamilyIndices = queue_families.size() > 1 ? queue_families.data() : nullptr,
+    };
+
+    if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &m_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create breadcrumb buffer");
+    }
+
+    // Coherent, so markers the GPU got to are in host memory even if it never signals again
+    m_memory = m_allocator.allocate_buffer(m_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    std::memset(m_memory.mapped, 0, buffer_info.size);
+    m_markers = (const uint32_t*)m_memory.mapped;
+}
+
+Breadcrumbs::~Breadcrumbs() {
+    vkDestroyBuffer(m_device, m_buffer, m_allocator.host_allocator());
+    m_allocator.free(m_memory);
+}
+
+void Breadcrumbs::set_label(uint32_t slot, const char* label) {
+    if (slot >= m_labels.size()) {
+        throw std::runtime_error("Breadcrumb slot out of range");
+    }
+    m_labels[slot] = label;
+}
+
+void Breadcrumbs::record_begin(VkCommandBuffer command_buffer, uint32_t slot) const {
+    vkCmdFillBuffer(command_buffer, m_buffer, (VkDeviceSize)slot * 2 * sizeof(uint32_t), sizeof(uint32_t), m_serial);
+}
+
+// The barrier holds the end marker back until everything recorded before it has completed, and
+// orders it after earlier markers so a slot never goes back to an older serial
+void Breadcrumbs::record_end(VkCommandBuffer command_buffer, uint32_t slot) const {
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    };
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    vkCmdFillBuffer(command_buffer, m_buffer, ((VkDeviceSize)slot * 2 + 1) * sizeof(uint32_t), sizeof(uint32_t), m_serial);
+}
+
+void Breadcrumbs::record_host_barrier(VkCommandBuffer command_buffer) const {
+    VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+    };
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+std::vector<std::string> Breadcrumbs::unfinished() const {
+    std::vector<std::string> result;
+    for (uint32_t slot = 0; slot < m_labels.size(); slot++) {
+        if (m_labels[slot] != nullptr && m_markers[slot * 2] != m_markers[slot * 2 + 1]) {
+            result.push_back(m_labels[slot]);
+        }
+    }
+    return result;
+}
+
+// Frames in flight overlap, so passes of the previous frame may legitimately still be running when
+// the latest one started; the serials say which frame each marker came from
+void Breadcrumbs::report() const {
+    std::cout << "GPU breadcrumbs, latest frame serial " << m_serial << ":\n";
+
+    for (uint32_t slot = 0; slot < m_labels.size(); slot++) {
+        if (m_labels[slot] == nullptr) {
+            continue;
+        }
+
+        uint32_t begin = m_markers[slot * 2];
+        uint32_t end = m_markers[slot * 2 + 1];
+        std::cout << "  " << m_labels[slot] << ": ";
+        if (begin != end) {
+            std::cout << "started in frame " << begin << ", never finished";
+            if (end > 0) {
+                std::cout << " (last finished in frame " << end << ")";
+            }
+        } else if (begin == m_serial) {
+            std::cout << "finished";
+        } else if (begin > 0) {
+            std::cout << "not reached, last finished in frame " << end;
+        } else {
+            std::cout << "never reached";
+        }
+        std::cout << "\n";
+    }
+}
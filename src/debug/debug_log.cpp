@@ -0,0 +1,297 @@
+#include "debug/debug_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// The logger polls rather than waits on a condition variable, which would need a lock on the callback path
+const uint32_t DEBUG_LOGGER_POLL_MS = 2;
+const uint32_t DEBUG_REPORT_TOP_REPEATS = 10;
+
+static void copy_truncated(char* destination, size_t capacity, const char* source) {
+    size_t length = source != nullptr ? std::min(std::strlen(source), capacity - 1) : 0;
+    std::memcpy(destination, source != nullptr ? source : "", length);
+    destination[length] = '\0';
+}
+
+static uint64_t hash_text(const char* text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; text != nullptr && *text != '\0'; text++) {
+        hash = (hash ^ (uint8_t)*text) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static const char* severity_name(VkDebugUtilsMessageSeverityFlagBitsEXT severity) {
+    switch (severity) {
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
+        return "verbose";
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
+        return "info";
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
+        return "warning";
+    default:
+        return "error";
+    }
+}
+
+static const char* type_name(VkDebugUtilsMessageTypeFlagsEXT type) {
+    if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) {
+        return "Performance";
+    }
+    if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT) {
+        return "Validation";
+    }
+    return "General";
+}
+
+VkDebugUtilsMessageSeverityFlagBitsEXT parse_debug_severity(const std::string& name) {
+    if (name == "verbose") return VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+    if (name == "info") return VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+    if (name == "warning") return VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+    if (name == "error") return VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+
+    throw std::runtime_error("Unknown debug severity: " + name + " (expected verbose, info, warning or error)");
+}
+
+DebugLog::DebugLog(const DebugLogConfig& config) : m_config(config) {
+    // Numeric entries mute by message ID; the rest stay in m_config.muted and match the VUID name
+    auto names_end = std::remove_if(m_config.muted.begin(), m_config.muted.end(), [this](const std::string& entry) {
+        try {
+            size_t parsed = 0;
+            int64_t id = std::stoll(entry, &parsed, 0);
+            if (parsed == entry.size()) {
+                m_muted_ids.push_back((int32_t)id);
+                return true;
+            }
+        } catch (const std::exception&) {
+        }
+        return false;
+    });
+    m_config.muted.erase(names_end, m_config.muted.end());
+
+    uint64_t capacity = 1;
+    while (capacity < std::max(m_config.ring_capacity, 2u)) {
+        capacity <<= 1;
+    }
+    m_ring_mask = capacity - 1;
+    m_ring.reset(new Slot[capacity]);
+    for (uint64_t i = 0; i < capacity; i++) {
+        m_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_counters.reset(new Counter[DEBUG_COUNTER_SLOTS]);
+    m_thread = std::thread(&DebugLog::logger_main, this);
+}
+
+DebugLog::~DebugLog() {
+    m_stop.store(true, std::memory_order_release);
+    m_thread.join();
+}
+
+VkDebugUtilsMessengerCreateInfoEXT DebugLog::messenger_info() {
+    VkDebugUtilsMessageSeverityFlagsEXT severities = 0;
+    for (VkDebugUtilsMessageSeverityFlagBitsEXT severity : {VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT, VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
+                                                            VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT}) {
+        if (severity >= m_config.min_severity) {
+            severities |= severity;
+        }
+    }
+
+    return {
+        .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
+        .messageSeverity = severities,
+        .messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT,
+        .pfnUserCallback = callback,
+        .pUserData = this,
+    };
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL DebugLog::callback(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+                                                  const VkDebugUtilsMessengerCallbackDataEXT* data, void* user_data) {
+    DebugLog* log = (DebugLog*)user_data;
+    log->m_received.fetch_add(1, std::memory_order_relaxed);
+
+    if (severity < log->m_config.min_severity || log->is_muted(data)) {
+        log->m_muted_count.fetch_add(1, std::memory_order_relaxed);
+        return VK_FALSE;
+    }
+
+    uint64_t count = log->count_occurrence(data);
+    if (count > log->m_config.repeat_limit) {
+        log->m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return VK_FALSE;
+    }
+
+    if (!log->enqueue(severity, type, data, count)) {
+        log->m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Never abort the call that triggered the message
+    return VK_FALSE;
+}
+
+bool DebugLog::is_muted(const VkDebugUtilsMessengerCallbackDataEXT* data) const {
+    if (std::find(m_muted_ids.begin(), m_muted_ids.end(), data->messageIdNumber) != m_muted_ids.end()) {
+        return true;
+    }
+
+    if (data->pMessageIdName != nullptr) {
+        for (const std::string& name : m_config.muted) {
+            if (std::strcmp(name.c_str(), data->pMessageIdName) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Returns how often this message ID has been seen, this time included, or 0 once the table is full.
+// Messages without an ID number are keyed by their ID name, then by their text.
+uint64_t DebugLog::count_occurrence(const VkDebugUtilsMessengerCallbackDataEXT* data) {
+    uint64_t key = data->messageIdNumber != 0 ? (uint64_t)(uint32_t)data->messageIdNumber | (1ull << 32)
+                                              : hash_text(data->pMessageIdName != nullptr ? data->pMessageIdName : data->pMessage) | 1;
+
+    for (uint32_t probe = 0; probe < DEBUG_COUNTER_SLOTS; probe++) {
+        Counter& counter = m_counters[(key + probe) % DEBUG_COUNTER_SLOTS];
+
+        uint64_t current = counter.key.load(std::memory_order_acquire);
+        if (current == 0) {
+            if (counter.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                // Only read by report(), after the logger has stopped
+                counter.message_id = data->messageIdNumber;
+                copy_truncated(counter.id_name, DEBUG_ID_NAME_CHARS, data->pMessageIdName);
+                return counter.count.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+        }
+
+        if (current == key) {
+            return counter.count.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+    }
+
+    return 0;
+}
+
+bool DebugLog::enqueue(VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
+                       const VkDebugUtilsMessengerCallbackDataEXT* data, uint64_t count) {
+    uint64_t position = m_enqueue_position.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &m_ring[position & m_ring_mask];
+        int64_t difference = (int64_t)slot->sequence.load(std::memory_order_acquire) - (int64_t)position;
+
+        if (difference == 0) {
+            if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = m_enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->message.severity = severity;
+    slot->message.type = type;
+    slot->message.message_id = data->messageIdNumber;
+    slot->message.count = count;
+    copy_truncated(slot->message.id_name, DEBUG_ID_NAME_CHARS, data->pMessageIdName);
+    copy_truncated(slot->message.text, DEBUG_MESSAGE_CHARS, data->pMessage);
+
+    m_logged.fetch_add(1, std::memory_order_relaxed);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+// Logger thread only
+bool DebugLog::dequeue(Message& message) {
+    Slot& slot = m_ring[m_dequeue_position & m_ring_mask];
+    if ((int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)(m_dequeue_position + 1) < 0) {
+        return false;
+    }
+
+    message = slot.message;
+    slot.sequence.store(m_dequeue_position + m_ring_mask + 1, std::memory_order_release);
+    m_dequeue_position++;
+    return true;
+}
+
+void DebugLog::write(const Message& message) {
+    std::cerr << type_name(message.type) << " " << severity_name(message.severity);
+    if (message.id_name[0] != '\0') {
+        std::cerr << " [" << message.id_name << "]";
+    }
+    std::cerr << ": " << message.text;
+    if (message.count != 0 && message.count == m_config.repeat_limit) {
+        std::cerr << " (repeated " << message.count << " times, further repeats are only counted)";
+    }
+    std::cerr << "\n";
+
+    if (message.type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) {
+        m_performance_events.fetch_add(1, std::memory_order_relaxed);
+
+        if (m_performance_handler) {
+            m_performance_handler({message.severity, message.type, message.message_id, message.id_name, message.text, message.count});
+        }
+    }
+}
+
+void DebugLog::logger_main() {
+    Message message;
+    for (;;) {
+        bool stopping = m_stop.load(std::memory_order_acquire);
+
+        bool wrote = false;
+        while (dequeue(message)) {
+            write(message);
+            m_written.fetch_add(1, std::memory_order_release);
+            wrote = true;
+        }
+
+        if (stopping) {
+            break;
+        }
+        if (!wrote) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DEBUG_LOGGER_POLL_MS));
+        }
+    }
+}
+
+void DebugLog::flush() {
+    uint64_t target = m_logged.load(std::memory_order_relaxed);
+    while (m_written.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DEBUG_LOGGER_POLL_MS));
+    }
+}
+
+DebugLogStats DebugLog::stats() const {
+    DebugLogStats stats;
+    stats.received = m_received.load(std::memory_order_relaxed);
+    stats.muted = m_muted_count.load(std::memory_order_relaxed);
+    stats.suppressed = m_suppressed.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.logged = m_logged.load(std::memory_order_relaxed);
+    stats.performance_events = m_performance_events.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DebugLog::report() const {
+    DebugLogStats totals = stats();
+    std::cout << "Debug messages: " << totals.received << " received, " << totals.logged << " logged, " << totals.muted << " muted, "
+              << totals.suppressed << " repeats suppressed, " << totals.dropped << " dropped, " << totals.performance_events
+              << " performance events\n";
+
+    std::vector<const Counter*> repeated;
+    for (uint32_t i = 0; i < DEBUG_COUNTER_SLOTS; i++) {
+        if (m_counters[i].count.load(std::memory_order_relaxed) > 1) {
+            repeated.push_back(&m_counters[i]);
+        }
+    }
+
+    std::sort(repeated.begin(), repeated.end(), [](const Counter* a, const Counter* b) { return a->count.load() > b->count.load(); });
+    for (size_t i = 0; i < repeated.size() && i < DEBUG_REPORT_TOP_REPEATS; i++) {
+        std::cout << "  " << (repeated[i]->id_name[0] != '\0' ? repeated[i]->id_name : "(no id)") << " x" << repeated[i]->count.load() << "\n";
+    }
+}
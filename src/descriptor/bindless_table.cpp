@@ -0,0 +1,248 @@
+#include "descriptor/bindless_table.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+static const VkDescriptorType descriptor_types[BINDLESS_KIND_COUNT] = {
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_SAMPLER,
+};
+
+static const char* kind_names[BINDLESS_KIND_COUNT] = {"sampled images", "storage images", "storage buffers", "samplers"};
+
+BindlessTable::BindlessTable(VkPhysicalDevice physical_device, VkDevice device, uint32_t frame_count, const VkAllocationCallbacks* host_allocator)
+    : m_device(device), m_host_allocator(host_allocator) {
+    VkPhysicalDeviceDescriptorIndexingProperties indexing_properties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+    };
+
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &indexing_properties,
+    };
+
+    vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+    // Every binding is visible to every stage, so the per-stage limits apply to the whole set
+    m_slots[(uint32_t)BindlessKind::SampledImage].capacity = std::min({BINDLESS_SAMPLED_IMAGES,
+        indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages, indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    m_slots[(uint32_t)BindlessKind::StorageImage].capacity = std::min({BINDLESS_STORAGE_IMAGES,
+        indexing_properties.maxDescriptorSetUpdateAfterBindStorageImages, indexing_properties.maxPerStageDescriptorUpdateAfterBindStorageImages});
+    m_slots[(uint32_t)BindlessKind::StorageBuffer].capacity = std::min({BINDLESS_STORAGE_BUFFERS,
+        indexing_properties.maxDescriptorSetUpdateAfterBindStorageBuffers, indexing_properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+    m_slots[(uint32_t)BindlessKind::Sampler].capacity = std::min({BINDLESS_SAMPLERS,
+        indexing_properties.maxDescriptorSetUpdateAfterBindSamplers, indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers});
+
+    // maxPerStageUpdateAfterBindResources caps the total; shrink the big arrays proportionally if needed
+    uint32_t total = 0;
+    for (const auto& slots : m_slots) {
+        total += slots.capacity;
+    }
+    if (total > indexing_properties.maxPerStageUpdateAfterBindResources) {
+        for (auto& slots : m_slots) {
+            slots.capacity = (uint32_t)((uint64_t)slots.capacity * indexing_properties.maxPerStageUpdateAfterBindResources / total);
+        }
+    }
+
+    VkDescriptorSetLayoutBinding bindings[BINDLESS_KIND_COUNT];
+    VkDescriptorBindingFlags binding_flags[BINDLESS_KIND_COUNT];
+    VkDescriptorPoolSize pool_sizes[BINDLESS_KIND_COUNT];
+
+    for (uint32_t kind = 0; kind < BINDLESS_KIND_COUNT; kind++) {
+        m_stats.capacity[kind] = m_slots[kind].capacity;
+
+        bindings[kind] = {
+            .binding = kind,
+            .descriptorType = descriptor_types[kind],
+            .descriptorCount = m_slots[kind].capacity,
+            .stageFlags = VK_SHADER_STAGE_ALL,
+        };
+
+        binding_flags[kind] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                              VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+        pool_sizes[kind] = {
+            .type = descriptor_types[kind],
+            .descriptorCount = m_slots[kind].capacity,
+        };
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = BINDLESS_KIND_COUNT,
+        .pBindingFlags = binding_flags,
+    };
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &binding_flags_info,
+        .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = BINDLESS_KIND_COUNT,
+        .pBindings = bindings,
+    };
+
+    if (vkCreateDescriptorSetLayout(m_device, &layout_info, m_host_allocator, &m_set_layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor set layout");
+    }
+
+    VkDescriptorPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = BINDLESS_KIND_COUNT,
+        .pPoolSizes = pool_sizes,
+    };
+
+    if (vkCreateDescriptorPool(m_device, &pool_info, m_host_allocator, &m_pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor pool");
+    }
+
+    VkDescriptorSetAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = m_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &m_set_layout,
+    };
+
+    if (vkAllocateDescriptorSets(m_device, &alloc_info, &m_set) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate bindless descriptor set");
+    }
+
+    VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_ALL,
+        .offset = 0,
+        .size = BINDLESS_PUSH_CONSTANT_SIZE,
+    };
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &m_set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range,
+    };
+
+    if (vkCreatePipelineLayout(m_device, &pipeline_layout_info, m_host_allocator, &m_pipeline_layout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless pipeline layout");
+    }
+
+    m_retired.resize(frame_count);
+}
+
+BindlessTable::~BindlessTable() {
+    vkDestroyPipelineLayout(m_device, m_pipeline_layout, m_host_allocator);
+    vkDestroyDescriptorPool(m_device, m_pool, m_host_allocator);
+    vkDestroyDescriptorSetLayout(m_device, m_set_layout, m_host_allocator);
+}
+
+void BindlessTable::begin_frame(uint32_t frame_index) {
+    m_frame_index = frame_index;
+
+    for (const auto& [kind, slot] : m_retired[frame_index]) {
+        m_slots[(uint32_t)kind].free.push_back(slot);
+        m_stats.used[(uint32_t)kind]--;
+    }
+    m_retired[frame_index].clear();
+}
+
+uint32_t BindlessTable::allocate_slot(BindlessKind kind) {
+    SlotAllocator& slots = m_slots[(uint32_t)kind];
+
+    uint32_t slot;
+    if (!slots.free.empty()) {
+        slot = slots.free.back();
+        slots.free.pop_back();
+    } else if (slots.next < slots.capacity) {
+        slot = slots.next++;
+    } else {
+        throw std::runtime_error(std::string("Bindless table is out of ") + kind_names[(uint32_t)kind]);
+    }
+
+    m_stats.used[(uint32_t)kind]++;
+    return slot;
+}
+
+uint32_t BindlessTable::add_sampled_image(VkImageView view, VkImageLayout layout) {
+    uint32_t slot = allocate_slot(BindlessKind::SampledImage);
+    m_pending.push_back({BindlessKind::SampledImage, slot, (uint32_t)m_image_infos.size()});
+    m_image_infos.push_back({.imageView = view, .imageLayout = layout});
+    return slot;
+}
+
+uint32_t BindlessTable::add_storage_image(VkImageView view) {
+    uint32_t slot = allocate_slot(BindlessKind::StorageImage);
+    m_pending.push_back({BindlessKind::StorageImage, slot, (uint32_t)m_image_infos.size()});
+    m_image_infos.push_back({.imageView = view, .imageLayout = VK_IMAGE_LAYOUT_GENERAL});
+    return slot;
+}
+
+uint32_t BindlessTable::add_storage_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    uint32_t slot = allocate_slot(BindlessKind::StorageBuffer);
+    m_pending.push_back({BindlessKind::StorageBuffer, slot, (uint32_t)m_buffer_infos.size()});
+    m_buffer_infos.push_back({.buffer = buffer, .offset = offset, .range = range});
+    return slot;
+}
+
+uint32_t BindlessTable::add_sampler(VkSampler sampler) {
+    uint32_t slot = allocate_slot(BindlessKind::Sampler);
+    m_pending.push_back({BindlessKind::Sampler, slot, (uint32_t)m_image_infos.size()});
+    m_image_infos.push_back({.sampler = sampler});
+    return slot;
+}
+
+// Partially bound: the stale descriptor stays in the slot, which is fine as long as nothing indexes it
+void BindlessTable::release(BindlessKind kind, uint32_t slot) {
+    if (slot == BINDLESS_INVALID_SLOT) {
+        return;
+    }
+
+    m_retired[m_frame_index].push_back({kind, slot});
+}
+
+void BindlessTable::flush() {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(m_pending.size());
+
+    for (const auto& pending : m_pending) {
+        bool is_buffer = pending.kind == BindlessKind::StorageBuffer;
+        writes.push_back({
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = m_set,
+            .dstBinding = (uint32_t)pending.kind,
+            .dstArrayElement = pending.slot,
+            .descriptorCount = 1,
+            .descriptorType = descriptor_types[(uint32_t)pending.kind],
+            .pImageInfo = is_buffer ? nullptr : &m_image_infos[pending.info],
+            .pBufferInfo = is_buffer ? &m_buffer_infos[pending.info] : nullptr,
+        });
+    }
+
+    vkUpdateDescriptorSets(m_device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+
+    m_stats.writes += writes.size();
+    m_stats.update_calls++;
+
+    m_pending.clear();
+    m_image_infos.clear();
+    m_buffer_infos.clear();
+}
+
+void BindlessTable::bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point) const {
+    vkCmdBindDescriptorSets(command_buffer, bind_point, m_pipeline_layout, 0, 1, &m_set, 0, nullptr);
+}
+
+void BindlessTable::report() const {
+    std::cout << "Bindless table:";
+    for (uint32_t kind = 0; kind < BINDLESS_KIND_COUNT; kind++) {
+        std::cout << (kind == 0 ? " " : ", ") << m_stats.used[kind] << "/" << m_stats.capacity[kind] << " " << kind_names[kind];
+    }
+    std::cout << "; " << m_stats.writes << " writes in " << m_stats.update_calls << " updates\n";
+}
@@ -0,0 +1,316 @@
+#include "device/device_selector.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+const VkDeviceSize MiB = 1024ull * 1024;
+// Heap points are capped so a huge shared system heap can't outrank a discrete GPU
+const int64_t MAX_HEAP_POINTS = 256;
+
+static std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+static std::string strip_dashes(const std::string& text) {
+    std::string stripped;
+    for (char c : text) {
+        if (c != '-') {
+            stripped.push_back(c);
+        }
+    }
+    return stripped;
+}
+
+template <typename Properties, size_t N>
+static bool has_all(const std::vector<Properties>& available, char const (Properties::*name)[N], NameList required) {
+    for (uint32_t i = 0; i < required.count; i++) {
+        auto match = [&](const Properties& properties) { return std::strcmp(properties.*name, required.names[i]) == 0; };
+        if (std::none_of(available.begin(), available.end(), match)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool has_names(const std::vector<VkExtensionProperties>& available, NameList required) {
+    return has_all(available, &VkExtensionProperties::extensionName, required);
+}
+
+bool has_names(const std::vector<VkLayerProperties>& available, NameList required) {
+    return has_all(available, &VkLayerProperties::layerName, required);
+}
+
+static bool has_extensions(VkPhysicalDevice device, NameList required_extensions) {
+    if (required_extensions.count == 0) {
+        return true;
+    }
+
+    uint32_t extension_count = 0;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extension_count, available_extensions.data());
+
+    return has_names(available_extensions, required_extensions);
+}
+
+DeviceCandidate describe_physical_device(VkPhysicalDevice device, VkSurfaceKHR surface, NameList required_extensions) {
+    DeviceCandidate candidate;
+    candidate.handle = device;
+
+    VkPhysicalDeviceIDProperties id_properties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+    };
+
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &id_properties,
+    };
+
+    vkGetPhysicalDeviceProperties2(device, &properties2);
+    const VkPhysicalDeviceProperties& properties = properties2.properties;
+
+    candidate.name = properties.deviceName;
+    std::copy(id_properties.deviceUUID, id_properties.deviceUUID + VK_UUID_SIZE, candidate.uuid);
+    candidate.type = properties.deviceType;
+    candidate.api_version = properties.apiVersion;
+    candidate.max_image_dimension_2d = properties.limits.maxImageDimension2D;
+    candidate.max_compute_shared_memory = properties.limits.maxComputeSharedMemorySize;
+
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memory_properties);
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; i++) {
+        if (memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            candidate.device_local_bytes = std::max(candidate.device_local_bytes, memory_properties.memoryHeaps[i].size);
+        }
+    }
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(device, &features);
+    candidate.pipeline_statistics = features.pipelineStatisticsQuery && features.inheritedQueries;
+    bool multi_draw_indirect = features.multiDrawIndirect && features.drawIndirectFirstInstance;
+    bool dynamic_indexing = features.shaderSampledImageArrayDynamicIndexing && features.shaderStorageBufferArrayDynamicIndexing &&
+                            features.shaderStorageImageArrayDynamicIndexing;
+
+    if (properties.apiVersion >= VK_API_VERSION_1_2) {
+        // Only chained on 1.3 devices; a 1.2 device leaves both fast path features false
+        VkPhysicalDeviceVulkan13Features vulkan13_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        };
+
+        VkPhysicalDeviceVulkan12Features vulkan12_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = properties.apiVersion >= VK_API_VERSION_1_3 ? &vulkan13_features : nullptr,
+        };
+
+        VkPhysicalDeviceFeatures2 features2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &vulkan12_features,
+        };
+
+        vkGetPhysicalDeviceFeatures2(device, &features2);
+        candidate.timeline_semaphore = vulkan12_features.timelineSemaphore;
+        candidate.synchronization2 = vulkan13_features.synchronization2;
+        candidate.dynamic_rendering = vulkan13_features.dynamicRendering;
+        candidate.indirect_count = multi_draw_indirect && vulkan12_features.drawIndirectCount;
+        candidate.bindless = dynamic_indexing && vulkan12_features.descriptorIndexing && vulkan12_features.runtimeDescriptorArray &&
+                             vulkan12_features.descriptorBindingPartiallyBound && vulkan12_features.descriptorBindingUpdateUnusedWhilePending &&
+                             vulkan12_features.descriptorBindingSampledImageUpdateAfterBind && vulkan12_features.descriptorBindingStorageImageUpdateAfterBind &&
+                             vulkan12_features.descriptorBindingStorageBufferUpdateAfterBind &&
+                             vulkan12_features.shaderSampledImageArrayNonUniformIndexing && vulkan12_features.shaderStorageImageArrayNonUniformIndexing &&
+                             vulkan12_features.shaderStorageBufferArrayNonUniformIndexing;
+    }
+
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
+
+    for (uint32_t i = 0; i < queue_family_count; i++) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        bool graphics = flags & VK_QUEUE_GRAPHICS_BIT;
+
+        VkBool32 present = graphics;
+        if (surface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present);
+        }
+
+        candidate.graphics_queue |= graphics;
+        candidate.present_queue |= present == VK_TRUE;
+        candidate.combined_graphics_present |= graphics && present;
+        candidate.async_compute_queue |= !graphics && (flags & VK_QUEUE_COMPUTE_BIT);
+        candidate.dedicated_transfer_queue |= !graphics && (flags & VK_QUEUE_TRANSFER_BIT);
+    }
+
+    candidate.swapchain_adequate = surface == VK_NULL_HANDLE;
+    if (surface != VK_NULL_HANDLE && has_extensions(device, required_extensions)) {
+        uint32_t format_count = 0;
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &format_count, nullptr);
+
+        uint32_t present_mode_count = 0;
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &present_mode_count, nullptr);
+
+        candidate.swapchain_adequate = format_count > 0 && present_mode_count > 0;
+    }
+
+    return candidate;
+}
+
+std::vector<DeviceCandidate> enumerate_device_candidates(VkInstance instance, VkSurfaceKHR surface, NameList required_extensions) {
+    uint32_t device_count = 0;
+    vkEnumeratePhysicalDevices(instance, &device_count, nullptr);
+
+    std::vector<VkPhysicalDevice> physical_devices(device_count);
+    vkEnumeratePhysicalDevices(instance, &device_count, physical_devices.data());
+
+    std::vector<DeviceCandidate> candidates;
+    for (auto device : physical_devices) {
+        candidates.push_back(describe_physical_device(device, surface, required_extensions));
+    }
+
+    return candidates;
+}
+
+DeviceScore score_device(const DeviceCandidate& candidate) {
+    DeviceScore score;
+
+    if (candidate.api_version < VK_API_VERSION_1_2) {
+        score.rejection = "Vulkan 1.2 not supported";
+    } else if (!candidate.timeline_semaphore) {
+        score.rejection = "no timelineSemaphore";
+    } else if (!candidate.bindless) {
+        score.rejection = "no update-after-bind descriptor indexing";
+    } else if (!candidate.indirect_count) {
+        score.rejection = "no multi-draw indirect count";
+    } else if (!candidate.graphics_queue) {
+        score.rejection = "no graphics queue";
+    } else if (!candidate.present_queue) {
+        score.rejection = "no queue can present to the surface";
+    } else if (!candidate.swapchain_adequate) {
+        score.rejection = "swapchain unsupported or has no formats";
+    }
+
+    switch (candidate.type) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        score.terms.push_back({"discrete gpu", 1000});
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        score.terms.push_back({"integrated gpu", 300});
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        score.terms.push_back({"virtual gpu", 100});
+        break;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        score.terms.push_back({"cpu", 10});
+        break;
+    default:
+        break;
+    }
+
+    // One point per 64 MiB
+    score.terms.push_back({"device local heap", std::min<int64_t>((int64_t)(candidate.device_local_bytes / (64 * MiB)), MAX_HEAP_POINTS)});
+    score.terms.push_back({"max image dimension", candidate.max_image_dimension_2d / 1024});
+    score.terms.push_back({"compute shared memory", candidate.max_compute_shared_memory / 4096});
+
+    if (candidate.dynamic_rendering && candidate.synchronization2) {
+        score.terms.push_back({"dynamic rendering + sync2", 200});
+    }
+    if (candidate.combined_graphics_present) {
+        score.terms.push_back({"graphics+present queue", 100});
+    }
+    if (candidate.async_compute_queue) {
+        score.terms.push_back({"async compute queue", 50});
+    }
+    if (candidate.dedicated_transfer_queue) {
+        score.terms.push_back({"transfer queue", 50});
+    }
+    if (candidate.pipeline_statistics) {
+        score.terms.push_back({"pipeline statistics", 20});
+    }
+
+    for (const auto& term : score.terms) {
+        score.total += term.points;
+    }
+
+    return score;
+}
+
+std::string format_uuid(const uint8_t uuid[VK_UUID_SIZE]) {
+    std::string text;
+    char digits[3];
+    for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            text.push_back('-');
+        }
+        std::snprintf(digits, sizeof(digits), "%02x", uuid[i]);
+        text += digits;
+    }
+    return text;
+}
+
+int32_t select_device(const std::vector<DeviceCandidate>& candidates, const std::string& override_device, std::vector<DeviceScore>& scores) {
+    scores.clear();
+    for (const auto& candidate : candidates) {
+        scores.push_back(score_device(candidate));
+    }
+
+    std::string wanted = lowercase(override_device);
+    std::string wanted_uuid = strip_dashes(wanted);
+
+    int32_t selected = -1;
+    bool matched = false;
+    for (int32_t i = 0; i < (int32_t)candidates.size(); i++) {
+        if (!wanted.empty()) {
+            bool name_match = lowercase(candidates[i].name).find(wanted) != std::string::npos;
+            bool uuid_match = strip_dashes(format_uuid(candidates[i].uuid)) == wanted_uuid;
+            if (!name_match && !uuid_match) {
+                continue;
+            }
+            matched = true;
+        }
+
+        if (!scores[i].rejection.empty()) {
+            continue;
+        }
+
+        if (selected < 0 || scores[i].total > scores[selected].total) {
+            selected = i;
+        }
+    }
+
+    if (!wanted.empty() && selected < 0) {
+        throw std::runtime_error(matched ? "Device override '" + override_device + "' only matches unsuitable devices"
+                                         : "Device override '" + override_device + "' matches no device");
+    }
+
+    return selected;
+}
+
+void log_device_selection(const std::vector<DeviceCandidate>& candidates, const std::vector<DeviceScore>& scores, int32_t selected) {
+    std::cout << "Devices:\n";
+    for (size_t i = 0; i < candidates.size(); i++) {
+        std::cout << ((int32_t)i == selected ? "  * " : "    ") << candidates[i].name << " [" << format_uuid(candidates[i].uuid) << "] ";
+        if (scores[i].rejection.empty()) {
+            std::cout << "score " << scores[i].total << "\n";
+        } else {
+            std::cout << "unsuitable: " << scores[i].rejection << "\n";
+        }
+    }
+
+    if (selected < 0) {
+        return;
+    }
+
+    std::cout << "  selected " << candidates[selected].name << ":";
+    for (const auto& term : scores[selected].terms) {
+        if (term.points != 0) {
+            std::cout << " " << term.label << " +" << term.points;
+        }
+    }
+    std::cout << "\n";
+}
@@ -0,0 +1,1539 @@
+#include "engine/engine.h"
+#include "pipeline/builtin_shaders.h"
+#include "device/device_selector.h"
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+const uint32_t SYNTHETIC_DRAWS_PER_SECONDARY = 512;
+const double STATS_REPORT_INTERVAL_MS = 1000.0;
+const uint32_t SCENE_SEED = 1234;
+// Radians per frame the camera orbits the scene
+const float SCENE_ORBIT_SPEED = 0.005f;
+
+const char* const validation_layers[] = {
+    "VK_LAYER_KHRONOS_validation"
+};
+
+const char* const device_extensions[] = {
+    VK_KHR_SWAPCHAIN_EXTENSION_NAME
+};
+
+const char* const headless_surface_extensions[] = {
+    VK_KHR_SURFACE_EXTENSION_NAME,
+    VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME
+};
+
+static VkResult create_debug_utils_messenger_ext(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* create_info, const VkAllocationCallbacks* allocator, VkDebugUtilsMessengerEXT* debug_messenger) {
+    auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+
+    if (func != nullptr) {
+        return func(instance, create_info, allocator, debug_messenger);
+    }
+
+    return VK_ERROR_EXTENSION_NOT_PRESENT;
+}
+
+static void destroy_debug_utils_messenger_ext(VkInstance instance, VkDebugUtilsMessengerEXT debug_messenger, const VkAllocationCallbacks* allocator) {
+    auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+
+    if (func != nullptr) {
+        return func(instance, debug_messenger, allocator);
+    }
+}
+
+void FrameStats::report() const {
+    double frame_avg = average(frame_ms);
+
+    std::cout << "Frames: " << frame_ms.size() << "\n";
+    std::cout << "  cpu   avg " << average(cpu_ms) << " ms, p50 " << percentile(cpu_ms, 0.50) << " ms, p99 " << percentile(cpu_ms, 0.99) << " ms\n";
+    std::cout << "  frame avg " << frame_avg << " ms, p50 " << percentile(frame_ms, 0.50) << " ms, p99 " << percentile(frame_ms, 0.99) << " ms";
+    if (frame_avg > 0.0) {
+        std::cout << " (" << 1000.0 / frame_avg << " fps)";
+    }
+    std::cout << "\n";
+    std::cout << "  input to present avg " << average(latency_ms) << " ms, p50 " << percentile(latency_ms, 0.50) << " ms, p99 "
+              << percentile(latency_ms, 0.99) << " ms\n";
+
+    if (!recreate_ms.empty()) {
+        std::cout << "  swapchain recreations " << recreate_ms.size() << ", avg " << average(recreate_ms)
+                  << " ms, max " << *std::max_element(recreate_ms.begin(), recreate_ms.end()) << " ms\n";
+    }
+
+    if (!recovery_ms.empty()) {
+        std::cout << "  device-lost recoveries " << recovery_ms.size() << ", avg " << average(recovery_ms)
+                  << " ms, max " << *std::max_element(recovery_ms.begin(), recovery_ms.end()) << " ms\n";
+    }
+}
+
+std::vector<const char *> HelloEngine::get_required_extenstions() {
+    std::vector<const char *> required_extensions;
+
+    if (uses_window()) {
+        uint32_t required_extension_count = 0;
+        const char **required_glfw_extensions;
+        required_glfw_extensions = glfwGetRequiredInstanceExtensions(&required_extension_count);
+
+        required_extensions.assign(required_glfw_extensions, required_glfw_extensions + required_extension_count);
+    } else if (uses_surface()) {
+        required_extensions.assign(std::begin(headless_surface_extensions), std::end(headless_surface_extensions));
+    }
+
+    required_extensions.emplace_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+
+    if (m_config.validation) {
+        required_extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        //extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
+    return required_extensions;
+}
+
+void HelloEngine::create_instance() {
+    if (m_config.validation && !check_validation_layer_support()) {
+        throw std::runtime_error("Validation layers requested, but not available!");
+    }
+
+    VkApplicationInfo app_info = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pApplicationName = "vulkan test app",
+        .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+        .pEngineName = "No Engine",
+        .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+        .apiVersion = VK_API_VERSION_1_3
+    };
+
+    std::vector<const char *> required_extensions = get_required_extenstions();
+
+    VkInstanceCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR,
+        .pApplicationInfo = &app_info,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = nullptr,
+        .enabledExtensionCount = (uint32_t)required_extensions.size(),
+        .ppEnabledExtensionNames = required_extensions.data(),
+    };
+
+    // Chained so vkCreateInstance and vkDestroyInstance themselves are covered, before the real messenger exists
+    VkDebugUtilsMessengerCreateInfoEXT debug_info;
+    if (m_config.validation) {
+        m_debug_log = std::make_unique<DebugLog>(m_config.debug);
+        m_debug_log->set_performance_handler([this](const DebugEvent& event) {
+            std::lock_guard<std::mutex> lock(m_performance_events_mutex);
+            m_report.performance_events.push_back(event);
+        });
+
+        debug_info = m_debug_log->messenger_info();
+        create_info.pNext = &debug_info;
+        create_info.enabledLayerCount = (uint32_t)std::size(validation_layers);
+        create_info.ppEnabledLayerNames = validation_layers;
+    }
+
+    if (vkCreateInstance(&create_info, m_host_allocator.callbacks(HostScope::Instance), &m_instance) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create vulkan instance");
+    }
+}
+
+void HelloEngine::init_window() {
+    if (!glfwInit()) {
+        throw std::runtime_error("Failed to initialize GLFW");
+    }
+
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    m_window = glfwCreateWindow(m_config.width, m_config.height, "Vulkan Window", nullptr, nullptr);
+
+    if (!m_window) {
+        glfwTerminate();
+        throw std::runtime_error("Failed to create window");
+    }
+
+    glfwSetWindowUserPointer(m_window, this);
+    glfwSetFramebufferSizeCallback(m_window, framebuffer_resize_callback);
+
+}
+
+void HelloEngine::create_surface() {
+    if (m_config.backend == PresentBackend::HeadlessSurface) {
+        auto func = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(m_instance, "vkCreateHeadlessSurfaceEXT");
+
+        VkHeadlessSurfaceCreateInfoEXT create_info = {
+            .sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+        };
+
+        if (func == nullptr || func(m_instance, &create_info, m_host_allocator.callbacks(HostScope::Instance), &m_surface) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create headless surface");
+        }
+        return;
+    }
+
+    if(glfwCreateWindowSurface(m_instance, m_window, m_host_allocator.callbacks(HostScope::Instance), &m_surface) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create window surface");
+    }
+}
+
+// Stand-in for a swapchain: device-local images that fill m_swapchain_images/m_swapchain_extent
+void HelloEngine::create_offscreen_images() {
+    m_swapchain_format = VK_FORMAT_R8G8B8A8_UNORM;
+    m_swapchain_extent = requested_extent();
+    m_present_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    m_swapchain_images.resize(m_config.frames_in_flight);
+    m_offscreen_memory.resize(m_config.frames_in_flight);
+
+    for (size_t i = 0; i < m_swapchain_images.size(); i++) {
+        VkImageCreateInfo image_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = m_swapchain_format,
+            .extent = {
+                .width = m_swapchain_extent.width,
+                .height = m_swapchain_extent.height,
+                .depth = 1
+            },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+
+        if (vkCreateImage(m_device, &image_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_swapchain_images[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create offscreen image");
+        }
+
+        m_offscreen_memory[i] = m_allocator->allocate_image(m_swapchain_images[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+}
+
+void HelloEngine::create_swapchain_image_views() {
+    m_swapchain_image_views.resize(m_swapchain_images.size());
+
+    for (size_t i = 0; i < m_swapchain_images.size(); i++) {
+        VkImageViewCreateInfo create_info = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = m_swapchain_images[i],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = m_swapchain_format,
+            .components = {
+                .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+            },
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+
+        if (vkCreateImageView(m_device, &create_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_swapchain_image_views[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create image view");
+        }
+        m_swapchain_objects.image_views++;
+    }
+}
+
+// Only the classic render path has framebuffers; dynamic rendering begins on the views directly
+void HelloEngine::create_framebuffers() {
+    if (!m_scene || m_scene->render_pass() == VK_NULL_HANDLE) {
+        return;
+    }
+
+    m_framebuffers.resize(m_swapchain_image_views.size());
+    for (size_t i = 0; i < m_swapchain_image_views.size(); i++) {
+        VkImageView attachments[] = {m_swapchain_image_views[i], m_depth_view};
+
+        VkFramebufferCreateInfo framebuffer_info = {
+            .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+            .renderPass = m_scene->render_pass(),
+            .attachmentCount = 2,
+            .pAttachments = attachments,
+            .width = m_swapchain_extent.width,
+            .height = m_swapchain_extent.height,
+            .layers = 1,
+        };
+
+        if (vkCreateFramebuffer(m_device, &framebuffer_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_framebuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create framebuffer");
+        }
+        m_swapchain_objects.framebuffers++;
+    }
+}
+
+void HelloEngine::init_vulkan() {
+    using clock = std::chrono::steady_clock;
+
+    auto start = clock::now();
+    create_instance();
+    setup_debug_messenger();
+    if (uses_surface()) {
+        create_surface();
+    }
+    m_report.startup.instance_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    create_device_resources(m_report.startup);
+    m_report.startup.total_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    m_report.startup_host_memory = m_host_allocator.total();
+
+    std::cout << "Startup: instance " << m_report.startup.instance_ms << " ms, device " << m_report.startup.device_ms << " ms, pipelines "
+              << m_report.startup.pipelines_ms << " ms, swapchain " << m_report.startup.swapchain_ms << " ms, total "
+              << m_report.startup.total_ms << " ms, " << m_report.startup_host_memory.allocations << " host allocations ("
+              << m_report.startup_host_memory.live_bytes / 1024 << " KiB live)\n";
+}
+
+// Everything below the instance and surface, built from the config alone so device-lost recovery can
+// run it again: the scene is regenerated from its seed, pipelines come back through the pipeline cache
+void HelloEngine::create_device_resources(StartupTimes& times) {
+    using clock = std::chrono::steady_clock;
+
+    auto stage_start = clock::now();
+    auto stage_ms = [&stage_start]() {
+        auto now = clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - stage_start).count();
+        stage_start = now;
+        return ms;
+    };
+
+    pick_physical_device();
+    create_logical_device();
+    times.device_ms = stage_ms();
+
+    m_allocator = std::make_unique<DeviceAllocator>(m_physical_device, m_device, DEFAULT_MEMORY_BLOCK_SIZE,
+                                                    m_host_allocator.callbacks(HostScope::Resources));
+    create_upload_manager();
+#ifdef PLUTO_PROFILER
+    create_profiler();
+#endif
+    m_bindless = std::make_unique<BindlessTable>(m_physical_device, m_device, m_config.frames_in_flight,
+                                                 m_host_allocator.callbacks(HostScope::Pipelines));
+    m_pipeline_cache = std::make_unique<PipelineCache>(m_physical_device, m_device, m_config.pipeline_cache_path,
+                                                       m_host_allocator.callbacks(HostScope::Pipelines));
+    create_shader_library();
+    create_startup_pipelines();
+    times.pipelines_ms = stage_ms();
+
+    if (compute_only()) {
+        m_compute_batch = std::make_unique<ComputeBatch>(m_device, *m_allocator, *m_bindless, *m_shaders, m_compute_queue,
+                                                         m_queue_families.compute_family.value_or(m_queue_families.graphics_family.value()),
+                                                         m_config.compute_batch.in_flight);
+    } else {
+        if (uses_surface()) {
+            create_swapchain();
+        } else {
+            create_offscreen_images();
+        }
+        create_swapchain_image_views();
+        times.swapchain_ms = stage_ms();
+
+        if (m_config.scene_objects > 0) {
+            create_depth_image();
+            create_scene();
+            create_framebuffers();
+        }
+        if (!m_config.asset_pack.empty()) {
+            create_asset_streamer();
+        }
+        create_frame_resources();
+        create_swapchain_sync_objects();
+        create_render_graph();
+    }
+}
+
+// One depth buffer serves every frame in flight; the graph orders each frame's writes after the last
+void HelloEngine::create_depth_image() {
+    VkImageCreateInfo image_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = SCENE_DEPTH_FORMAT,
+        .extent = {
+            .width = m_swapchain_extent.width,
+            .height = m_swapchain_extent.height,
+            .depth = 1
+        },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    if (vkCreateImage(m_device, &image_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_depth_image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image");
+    }
+
+    m_depth_memory = m_allocator->allocate_image(m_depth_image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkImageViewCreateInfo view_info = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = m_depth_image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = SCENE_DEPTH_FORMAT,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+
+    if (vkCreateImageView(m_device, &view_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_depth_view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create depth image view");
+    }
+    m_swapchain_objects.image_views++;
+}
+
+void HelloEngine::create_scene() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+
+    // Culled on the compute queue, drawn on graphics and streamed in on the transfer queue
+    std::vector<uint32_t> families;
+    if (indicies.compute_family.has_value()) {
+        families = {indicies.graphics_family.value(), indicies.compute_family.value(),
+                    indicies.transfer_family.value_or(indicies.graphics_family.value())};
+    }
+
+    m_scene = std::make_unique<GpuScene>(m_physical_device, m_device, *m_allocator, *m_bindless, *m_shaders, m_swapchain_format,
+                                         m_config.scene_objects, families, m_render_path);
+    if (m_scene->render_pass() != VK_NULL_HANDLE) {
+        m_swapchain_objects.render_passes++;
+    }
+    m_scene->set_objects(generate_scene_objects(m_config.scene_objects, SCENE_SEED));
+}
+
+void HelloEngine::create_asset_streamer() {
+    m_asset_pack = std::make_unique<AssetPack>(m_config.asset_pack);
+    m_assets = std::make_unique<AssetStreamer>(m_physical_device, m_device, *m_allocator, *m_asset_pack);
+
+    // Nothing draws pack assets yet, so nothing is known to be visible; materials go first since
+    // every draw would need them
+    for (uint32_t i = 0; i < m_asset_pack->asset_count(); i++) {
+        m_assets->request(i, m_asset_pack->asset(i).kind == AssetKind::Material ? 1.0f : 0.0f);
+    }
+
+    std::cout << "Assets: " << m_asset_pack->asset_count() << " in " << m_config.asset_pack << ", "
+              << m_asset_pack->size() / (1024 * 1024) << " MiB mapped\n";
+}
+
+// Orbits just inside the scene so the frustum cuts through it and culling has work to do
+void HelloEngine::update_scene_camera() {
+    float radius = scene_half_extent(m_config.scene_objects);
+    float angle = (float)m_frame_number * SCENE_ORBIT_SPEED;
+    float eye[3] = {radius * std::cos(angle), radius * 0.25f, radius * std::sin(angle)};
+    float target[3] = {0.0f, 0.0f, 0.0f};
+    float aspect = (float)m_swapchain_extent.width / (float)m_swapchain_extent.height;
+
+    m_scene->set_camera(eye, target, 1.0f, aspect, 0.1f, radius * 4.0f);
+}
+
+void HelloEngine::create_shader_library() {
+    ShaderLibraryConfig config = {
+        .source_dir = m_config.shader_source_dir,
+        .spirv_dir = PLUTO_SHADER_BINARY_DIR,
+        .cache_dir = m_config.shader_cache_dir,
+        .compiler = PLUTO_SHADER_COMPILER,
+        .frames_in_flight = m_config.frames_in_flight,
+    };
+
+    m_shaders = std::make_unique<ShaderLibrary>(m_device, *m_pipeline_cache, config);
+}
+
+// Every pipeline goes through m_shaders, and from there m_pipeline_cache so warm starts skip shader compilation
+void HelloEngine::create_startup_pipelines() {
+    VkPipelineLayout layout = m_bindless->pipeline_layout();
+    ShaderHandle noop_shader = m_shaders->add_shader("noop.comp", noop_compute_spirv, sizeof(noop_compute_spirv));
+
+    m_noop_pipeline = m_shaders->add_pipeline({noop_shader}, [layout](PipelineCache& cache, const std::vector<VkShaderModule>& modules) {
+        VkComputePipelineCreateInfo pipeline_info = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = modules[0],
+                .pName = "main",
+            },
+            .layout = layout,
+        };
+
+        return cache.create_compute_pipeline(pipeline_info);
+    });
+
+    m_pipeline_cache->report();
+}
+
+void HelloEngine::create_frame_resources() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+
+    m_frames.resize(m_config.frames_in_flight);
+
+    for (auto& frame : m_frames) {
+        VkSemaphoreCreateInfo semaphore_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        };
+
+        VkFenceCreateInfo fence_info = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+        };
+
+        if (vkCreateSemaphore(m_device, &semaphore_info, m_host_allocator.callbacks(HostScope::Commands), &frame.image_available_semaphore) != VK_SUCCESS ||
+            vkCreateFence(m_device, &fence_info, m_host_allocator.callbacks(HostScope::Commands), &frame.in_flight_fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create frame sync objects");
+        }
+    }
+
+    m_jobs = std::make_unique<JobSystem>(m_config.worker_threads);
+    m_recorder = std::make_unique<ParallelRecorder>(m_device, indicies.graphics_family.value(), m_config.frames_in_flight, *m_jobs,
+                                                    m_host_allocator.callbacks(HostScope::Commands));
+}
+
+// Render-finished semaphores are per swapchain image: the present engine holds them until the image comes back
+void HelloEngine::create_swapchain_sync_objects() {
+    VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+    };
+
+    m_render_finished_semaphores.resize(m_swapchain_images.size());
+    for (auto& semaphore : m_render_finished_semaphores) {
+        if (vkCreateSemaphore(m_device, &semaphore_info, m_host_allocator.callbacks(HostScope::Swapchain), &semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render finished semaphore");
+        }
+    }
+
+    m_images_in_flight.assign(m_swapchain_images.size(), VK_NULL_HANDLE);
+}
+
+void HelloEngine::create_swapchain() {
+    // Formats and present modes don't change for a surface; only the capabilities (current extent) do
+    if (m_swapchain_support.surface_formats.empty()) {
+        m_swapchain_support = query_swapchain_support(m_physical_device);
+    } else {
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physical_device, m_surface, &m_swapchain_support.capabilites);
+    }
+    const SwapChainSupportDetails& swapchain_support = m_swapchain_support;
+
+    VkSurfaceFormatKHR surface_format = choose_swapchain_surface_format(swapchain_support.surface_formats);
+    VkPresentModeKHR present_mode = choose_present_mode(m_config.present_policy, swapchain_support.surface_present_modes);
+    VkExtent2D extent = choose_swapchain_extent(swapchain_support.capabilites);
+
+    uint32_t image_count = choose_image_count(m_config.present_policy, present_mode, swapchain_support.capabilites);
+
+    VkSwapchainCreateInfoKHR create_info = {
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+        .surface = m_surface,
+        .minImageCount = image_count,
+        .imageFormat = surface_format.format,
+        .imageColorSpace = surface_format.colorSpace,
+        .imageExtent = extent,
+        .imageArrayLayers = 1,
+        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+    };
+
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+    uint32_t queue_family_indicies[] = {indicies.graphics_family.value(), indicies.present_family.value()};
+
+    if(indicies.graphics_family != indicies.present_family) {
+        create_info.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        create_info.queueFamilyIndexCount = 2;
+        create_info.pQueueFamilyIndices = queue_family_indicies;
+    } else {
+        create_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        create_info.queueFamilyIndexCount = 0;
+        create_info.pQueueFamilyIndices = nullptr;
+    }
+
+    create_info.preTransform = swapchain_support.capabilites.currentTransform;
+    create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    create_info.presentMode = present_mode;
+    create_info.clipped = VK_TRUE;
+    create_info.oldSwapchain = m_swapchain;
+
+    if (vkCreateSwapchainKHR(m_device, &create_info, m_host_allocator.callbacks(HostScope::Swapchain), &m_swapchain) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create swapchain");
+    }
+
+    vkGetSwapchainImagesKHR(m_device, m_swapchain, &image_count, nullptr);
+    m_swapchain_images.resize(image_count);
+    vkGetSwapchainImagesKHR(m_device, m_swapchain, &image_count, m_swapchain_images.data());
+
+    std::cout << "Swapchain: " << present_mode_name(present_mode) << " (" << present_policy_name(m_config.present_policy) << "), "
+              << image_count << " images, " << extent.width << "x" << extent.height << "\n";
+
+    m_swapchain_format = surface_format.format;
+    m_swapchain_extent = extent;
+}
+
+void HelloEngine::create_logical_device() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+
+    // Queues to create per family; compute may take the transfer family's second queue
+    std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
+    std::map<uint32_t, uint32_t> queue_counts = {{indicies.graphics_family.value(), 1}, {indicies.present_family.value(), 1}};
+    if (indicies.transfer_family.has_value()) {
+        queue_counts[indicies.transfer_family.value()] = 1;
+    }
+    if (indicies.compute_family.has_value()) {
+        uint32_t& count = queue_counts[indicies.compute_family.value()];
+        count = std::max(count, indicies.compute_queue_index + 1);
+    }
+
+    float queue_priorities[2] = {1.0f, 1.0f};
+    for (auto [family, count] : queue_counts) {
+        VkDeviceQueueCreateInfo queue_create_info = {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = family,
+            .queueCount = count,
+            .pQueuePriorities = queue_priorities,
+        };
+        queue_create_infos.push_back(queue_create_info);
+    }
+
+    VkPhysicalDeviceFeatures supported_features;
+    vkGetPhysicalDeviceFeatures(m_physical_device, &supported_features);
+
+    // Statistics queries stay open across the secondaries, which needs inheritedQueries too
+    m_pipeline_statistics_supported = supported_features.pipelineStatisticsQuery && supported_features.inheritedQueries;
+
+    VkPhysicalDeviceFeatures device_features = {
+        .multiDrawIndirect = VK_TRUE,
+        .drawIndirectFirstInstance = VK_TRUE,
+        .pipelineStatisticsQuery = m_pipeline_statistics_supported,
+        .shaderSampledImageArrayDynamicIndexing = VK_TRUE,
+        .shaderStorageBufferArrayDynamicIndexing = VK_TRUE,
+        .shaderStorageImageArrayDynamicIndexing = VK_TRUE,
+        .inheritedQueries = m_pipeline_statistics_supported,
+    };
+
+    // Only chained when the fast path uses them; a Vulkan 1.2 device doesn't know the struct
+    bool dynamic_rendering = m_render_path == RenderPath::Dynamic;
+    VkPhysicalDeviceVulkan13Features vulkan13_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = m_synchronization2,
+        .dynamicRendering = dynamic_rendering,
+    };
+
+    VkPhysicalDeviceVulkan12Features vulkan12_features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = m_synchronization2 || dynamic_rendering ? &vulkan13_features : nullptr,
+        .drawIndirectCount = VK_TRUE,
+        .descriptorIndexing = VK_TRUE,
+        .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+        .shaderStorageImageArrayNonUniformIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE,
+        .timelineSemaphore = VK_TRUE,
+    };
+
+    VkDeviceCreateInfo device_create_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &vulkan12_features,
+        .queueCreateInfoCount = (uint32_t)queue_create_infos.size(),
+        .pQueueCreateInfos = queue_create_infos.data(),
+        .enabledExtensionCount = uses_surface() ? (uint32_t)std::size(device_extensions) : 0,
+        .ppEnabledExtensionNames = uses_surface() ? device_extensions : nullptr,
+        .pEnabledFeatures = &device_features,
+    };
+
+    if (m_config.validation) {
+        device_create_info.enabledLayerCount = (uint32_t)std::size(validation_layers);
+        device_create_info.ppEnabledLayerNames = validation_layers;
+    } else {
+        device_create_info.enabledLayerCount = 0;
+    }
+
+    if (vkCreateDevice(m_physical_device, &device_create_info, m_host_allocator.callbacks(HostScope::Device), &m_device) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create logical device");
+    }
+
+    vkGetDeviceQueue(m_device, indicies.graphics_family.value(), 0, &m_graphics_queue);
+    vkGetDeviceQueue(m_device, indicies.present_family.value(), 0, &m_present_queue);
+
+    if (indicies.transfer_family.has_value()) {
+        vkGetDeviceQueue(m_device, indicies.transfer_family.value(), 0, &m_transfer_queue);
+    } else {
+        m_transfer_queue = m_graphics_queue;
+    }
+
+    if (indicies.compute_family.has_value()) {
+        vkGetDeviceQueue(m_device, indicies.compute_family.value(), indicies.compute_queue_index, &m_compute_queue);
+    } else {
+        m_compute_queue = m_graphics_queue;
+    }
+}
+
+void HelloEngine::create_profiler() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+    m_profiler = std::make_unique<Profiler>(m_physical_device, m_device, m_graphics_queue, indicies.graphics_family.value(),
+                                            m_config.frames_in_flight, m_pipeline_statistics_supported, DEFAULT_MAX_GPU_SCOPES,
+                                            m_host_allocator.callbacks(HostScope::Commands));
+    if (!m_config.trace_path.empty()) {
+        m_profiler->enable_trace();
+    }
+}
+
+void HelloEngine::create_upload_manager() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+
+    UploadQueues queues = {
+        .transfer_queue = m_transfer_queue,
+        .transfer_family = indicies.transfer_family.value_or(indicies.graphics_family.value()),
+        .graphics_family = indicies.graphics_family.value(),
+    };
+
+    m_uploads = std::make_unique<UploadManager>(m_device, *m_allocator, queues, m_config.frames_in_flight);
+
+    std::cout << "Uploads: " << (m_uploads->uses_dedicated_queue() ? "dedicated transfer queue" : "graphics queue") << "\n";
+}
+
+// The frame is a render graph around the imported backbuffer; the swapchain image is patched in every frame
+void HelloEngine::create_render_graph() {
+    const QueueFamiliyIndicies& indicies = m_queue_families;
+
+    RenderGraphQueues queues = {
+        .graphics_queue = m_graphics_queue,
+        .graphics_family = indicies.graphics_family.value(),
+        .compute_queue = m_compute_queue,
+        .compute_family = indicies.compute_family.value_or(indicies.graphics_family.value()),
+    };
+
+    m_render_graph = std::make_unique<RenderGraph>(m_device, *m_allocator, queues, m_config.frames_in_flight, m_synchronization2);
+
+    // Contents are discarded on acquire; the transition waits on the acquire semaphore's stage
+    ResourceState acquired = {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED};
+    ResourceState presented = {VK_PIPELINE_STAGE_2_NONE, 0, m_present_layout};
+    m_backbuffer = m_render_graph->import_image("backbuffer", m_swapchain_images[0], m_swapchain_image_views[0], acquired, presented);
+
+    PassHandle clear = m_render_graph->add_pass("clear", RenderQueue::Graphics, [this](VkCommandBuffer command_buffer) {
+        VkImageSubresourceRange color_range = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        };
+
+        float pulse = (float)(m_frame_number % 240) / 240.0f;
+        VkClearColorValue clear_color = {{0.1f, 0.1f, pulse, 1.0f}};
+        vkCmdClearColorImage(command_buffer, m_render_graph->image(m_backbuffer), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1, &color_range);
+    });
+    m_render_graph->write(clear, m_backbuffer, ResourceUsage::TransferDst);
+
+    if (m_scene) {
+        add_scene_passes();
+    }
+
+    if (m_config.synthetic_draws > 0) {
+        PassHandle draws = m_render_graph->add_pass("synthetic draws", RenderQueue::Graphics, [this](VkCommandBuffer command_buffer) {
+            VkCommandBufferInheritanceInfo inheritance = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                .pipelineStatistics = m_profiler ? m_profiler->inherited_statistics() : 0,
+            };
+
+            VkPipeline pipeline = m_shaders->pipeline(m_noop_pipeline);
+            m_recorder->record(command_buffer, m_config.synthetic_draws, SYNTHETIC_DRAWS_PER_SECONDARY, [this, pipeline](VkCommandBuffer secondary, uint32_t begin, uint32_t end) {
+                vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                m_bindless->bind(secondary, VK_PIPELINE_BIND_POINT_COMPUTE);
+                for (uint32_t draw = begin; draw < end; draw++) {
+                    uint32_t constants[4] = {draw, 0, 0, 0};
+                    vkCmdPushConstants(secondary, m_bindless->pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), constants);
+                    vkCmdDispatch(secondary, 1, 1, 1);
+                }
+            }, &inheritance);
+        });
+        // The dispatches touch no graph resources
+        m_render_graph->set_side_effects(draws);
+    }
+
+    m_render_graph->compile();
+    m_render_graph->set_profiler(m_profiler.get());
+    m_render_graph->report();
+
+    if (m_config.breadcrumbs) {
+        std::vector<uint32_t> families = {queues.graphics_family};
+        if (queues.compute_family != queues.graphics_family) {
+            families.push_back(queues.compute_family);
+        }
+
+        m_breadcrumbs = std::make_unique<Breadcrumbs>(m_device, *m_allocator, m_render_graph->pass_count(), families);
+        m_render_graph->set_breadcrumbs(m_breadcrumbs.get());
+    }
+
+    std::cout << "Compute passes: " << (m_render_graph->uses_async_compute() ? "async compute queue" : "graphics queue") << "\n";
+}
+
+// Reset the draw count, cull into the indirect buffers, then one indirect-count draw over the cleared backbuffer.
+// Reset and cull go to the compute queue, where they overlap the clear; the graph makes the draw wait for them.
+void HelloEngine::add_scene_passes() {
+    // Last frame's draw read the indirect buffers; the depth buffer carries its last writes
+    ResourceState indirect = {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+    ResourceState depth_written = {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                                   VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED};
+    ResourceState depth_final = depth_written;
+    depth_final.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    m_scene_commands = m_render_graph->import_buffer("scene commands", m_scene->commands_buffer(), indirect, indirect);
+    m_scene_count = m_render_graph->import_buffer("scene count", m_scene->count_buffer(), indirect, indirect);
+    m_scene_depth = m_render_graph->import_image("scene depth", m_depth_image, m_depth_view, depth_written, depth_final, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+    PassHandle reset = m_render_graph->add_pass("scene reset", RenderQueue::Compute, [this](VkCommandBuffer command_buffer) {
+        m_scene->record_reset(command_buffer);
+    });
+    m_render_graph->write(reset, m_scene_count, ResourceUsage::TransferDst);
+
+    PassHandle cull = m_render_graph->add_pass("scene cull", RenderQueue::Compute, [this](VkCommandBuffer command_buffer) {
+        m_scene->record_cull(command_buffer);
+    });
+    m_render_graph->read(cull, m_scene_count, ResourceUsage::StorageWrite);
+    m_render_graph->write(cull, m_scene_count, ResourceUsage::StorageWrite);
+    m_render_graph->write(cull, m_scene_commands, ResourceUsage::StorageWrite);
+
+    PassHandle draw = m_render_graph->add_pass("scene draw", RenderQueue::Graphics, [this](VkCommandBuffer command_buffer) {
+        m_scene->record_draw(command_buffer, m_render_graph->image_view(m_backbuffer), m_render_graph->image_view(m_scene_depth),
+                             m_swapchain_extent, m_framebuffers.empty() ? VK_NULL_HANDLE : m_framebuffers[m_image_index]);
+    });
+    m_render_graph->read(draw, m_scene_commands, ResourceUsage::IndirectBuffer);
+    m_render_graph->read(draw, m_scene_count, ResourceUsage::IndirectBuffer);
+    m_render_graph->read(draw, m_backbuffer, ResourceUsage::ColorAttachment);
+    m_render_graph->write(draw, m_backbuffer, ResourceUsage::ColorAttachment);
+    m_render_graph->write(draw, m_scene_depth, ResourceUsage::DepthAttachment);
+}
+
+QueueFamiliyIndicies HelloEngine::find_queue_families(VkPhysicalDevice device) {
+    QueueFamiliyIndicies indicies;
+
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
+
+    VkBool32 present_support = false;
+    for (uint32_t i = 0; i < queue_families.size(); i++) {
+        if (queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            indicies.graphics_family = i;
+        }
+
+        if (uses_surface()) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &present_support);
+        } else {
+            present_support = indicies.graphics_family == i;
+        }
+
+        if (present_support) {
+            indicies.present_family = i;
+        }
+
+        if (indicies.is_complete()) {
+            break;
+        }
+    }
+
+    // Prefer a transfer-only family (the DMA engine), then any non-graphics family that can transfer
+    for (uint32_t i = 0; i < queue_families.size(); i++) {
+        VkQueueFlags flags = queue_families[i].queueFlags;
+        if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+            continue;
+        }
+
+        if (!(flags & VK_QUEUE_COMPUTE_BIT)) {
+            indicies.transfer_family = i;
+            break;
+        }
+
+        if (!indicies.transfer_family.has_value()) {
+            indicies.transfer_family = i;
+        }
+    }
+
+    // Async compute: a compute family without graphics, preferably not the one uploads use
+    if (m_config.async_compute) {
+        for (uint32_t i = 0; i < queue_families.size(); i++) {
+            VkQueueFlags flags = queue_families[i].queueFlags;
+            if (!(flags & VK_QUEUE_COMPUTE_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+                continue;
+            }
+
+            if (indicies.transfer_family != i) {
+                indicies.compute_family = i;
+                break;
+            }
+
+            if (!indicies.compute_family.has_value()) {
+                indicies.compute_family = i;
+            }
+        }
+
+        // Sharing the transfer family; a second queue keeps the two from serialising
+        if (indicies.compute_family.has_value() && indicies.compute_family == indicies.transfer_family) {
+            indicies.compute_queue_index = queue_families[indicies.compute_family.value()].queueCount > 1 ? 1 : 0;
+        }
+    }
+
+    return indicies;
+}
+
+void HelloEngine::pick_physical_device() {
+    std::vector<DeviceCandidate> candidates = enumerate_device_candidates(m_instance, m_surface, uses_surface() ? name_list(device_extensions) : NameList());
+
+    if (candidates.empty()) {
+        throw std::runtime_error("Failed to find GPUs with Vulkan support");
+    }
+
+    std::vector<DeviceScore> scores;
+    int32_t selected = select_device(candidates, m_config.device, scores);
+    log_device_selection(candidates, scores, selected);
+
+    if (selected < 0) {
+        throw std::runtime_error("Failed to find a suitable physical device");
+    }
+
+    const DeviceCandidate& device = candidates[selected];
+    m_physical_device = device.handle;
+    m_report.device_name = device.name;
+    m_queue_families = find_queue_families(m_physical_device);
+
+    bool fast_path = device.dynamic_rendering && device.synchronization2 && !m_config.classic_render_path;
+    m_render_path = fast_path ? RenderPath::Dynamic : RenderPath::Classic;
+    m_synchronization2 = fast_path;
+    std::cout << "Render path: " << render_path_name(m_render_path) << ", " << (m_synchronization2 ? "sync2" : "sync1") << " barriers\n";
+}
+
+void HelloEngine::setup_debug_messenger() {
+    if (!m_config.validation) return;
+
+    VkDebugUtilsMessengerCreateInfoEXT create_info = m_debug_log->messenger_info();
+
+    if (create_debug_utils_messenger_ext(m_instance, &create_info, m_host_allocator.callbacks(HostScope::Instance), &m_debug_messenger) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to setup debug messenger");
+    }
+
+}
+
+bool HelloEngine::check_validation_layer_support() {
+    uint32_t layer_count;
+    vkEnumerateInstanceLayerProperties(&layer_count, nullptr);
+
+    std::vector<VkLayerProperties> available_layers(layer_count);
+    vkEnumerateInstanceLayerProperties(&layer_count, available_layers.data());
+
+    return has_names(available_layers, name_list(validation_layers));
+}
+
+SwapChainSupportDetails HelloEngine::query_swapchain_support(VkPhysicalDevice device) {
+    SwapChainSupportDetails details;
+
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, m_surface, &details.capabilites);
+
+    uint32_t format_count;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &format_count, nullptr);
+
+    if (format_count != 0) {
+        details.surface_formats.resize(format_count);
+        vkGetPhysicalDeviceSurfaceFormatsKHR(device, m_surface, &format_count, details.surface_formats.data());
+    }
+
+    uint32_t present_mode_count;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &present_mode_count, nullptr);
+
+    if (present_mode_count != 0) {
+        details.surface_present_modes.resize(present_mode_count);
+        vkGetPhysicalDeviceSurfacePresentModesKHR(device, m_surface, &present_mode_count, details.surface_present_modes.data());
+    }
+
+    return details;
+}
+
+VkSurfaceFormatKHR HelloEngine::choose_swapchain_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats) {
+    for (const auto& format : available_formats) {
+        if (format.format == VK_FORMAT_R8G8B8A8_SRGB && format.colorSpace == VK_COLORSPACE_SRGB_NONLINEAR_KHR) {
+            return format;
+        }
+    }
+    return available_formats[0];
+}
+
+VkExtent2D HelloEngine::choose_swapchain_extent(const VkSurfaceCapabilitiesKHR& capabilites) {
+    if (capabilites.currentExtent.width !=  std::numeric_limits<uint32_t>::max()) {
+        return capabilites.currentExtent;
+    } 
+
+    VkExtent2D requested = requested_extent();
+    int width = (int)requested.width;
+    int height = (int)requested.height;
+    if (uses_window()) {
+        glfwGetFramebufferSize(m_window, &width, &height);
+    }
+
+    VkExtent2D actual_extent = {
+        .width = (uint32_t)width,
+        .height = (uint32_t)height
+    };
+
+    actual_extent.width = std::clamp(actual_extent.width, capabilites.minImageExtent.width, capabilites.maxImageExtent.width);
+    actual_extent.height = std::clamp(actual_extent.height, capabilites.minImageExtent.height, capabilites.maxImageExtent.height);
+
+    return actual_extent;
+}
+
+VkExtent2D HelloEngine::requested_extent() const {
+    if (m_resize_halved) {
+        return {std::max(m_config.width / 2, 1u), std::max(m_config.height / 2, 1u)};
+    }
+    return {m_config.width, m_config.height};
+}
+
+// Only the image views, framebuffers, depth buffer and per-image sync objects depend on the
+// swapchain, everything else survives
+void HelloEngine::recreate_swapchain() {
+    using clock = std::chrono::steady_clock;
+
+    if (uses_window()) {
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(m_window, &width, &height);
+        while (width == 0 || height == 0) {
+            glfwWaitEvents();
+            glfwGetFramebufferSize(m_window, &width, &height);
+        }
+    }
+
+    auto start = clock::now();
+
+    RetiredSwapchain retired = {
+        .swapchain = m_swapchain,
+        .image_views = std::move(m_swapchain_image_views),
+        .framebuffers = std::move(m_framebuffers),
+        .render_finished_semaphores = std::move(m_render_finished_semaphores),
+        .depth_image = m_depth_image,
+        .depth_view = m_depth_view,
+        .depth_memory = m_depth_memory,
+        .retire_frame = m_frame_number + m_config.frames_in_flight,
+    };
+
+    if (uses_surface()) {
+        create_swapchain();
+    } else {
+        retired.offscreen_images = std::move(m_swapchain_images);
+        retired.offscreen_memory = std::move(m_offscreen_memory);
+        create_offscreen_images();
+    }
+    m_retired_swapchains.push_back(std::move(retired));
+
+    create_swapchain_image_views();
+    create_swapchain_sync_objects();
+    if (m_scene) {
+        create_depth_image();
+        m_render_graph->set_image(m_scene_depth, m_depth_image, m_depth_view);
+        create_framebuffers();
+    }
+    m_framebuffer_resized = false;
+
+    m_frame_stats.recreate_ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+}
+
+void HelloEngine::destroy_retired_swapchain(RetiredSwapchain& retired) {
+    for (auto framebuffer : retired.framebuffers) {
+        vkDestroyFramebuffer(m_device, framebuffer, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+
+    for (auto image_view : retired.image_views) {
+        vkDestroyImageView(m_device, image_view, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+
+    for (auto semaphore : retired.render_finished_semaphores) {
+        vkDestroySemaphore(m_device, semaphore, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+
+    if (retired.depth_image != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, retired.depth_view, m_host_allocator.callbacks(HostScope::Swapchain));
+        vkDestroyImage(m_device, retired.depth_image, m_host_allocator.callbacks(HostScope::Swapchain));
+        m_allocator->free(retired.depth_memory);
+    }
+
+    for (size_t i = 0; i < retired.offscreen_images.size(); i++) {
+        vkDestroyImage(m_device, retired.offscreen_images[i], m_host_allocator.callbacks(HostScope::Swapchain));
+        m_allocator->free(retired.offscreen_memory[i]);
+    }
+
+    if (retired.swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(m_device, retired.swapchain, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+}
+
+// Every frame submitted before retirement has passed its fence once frames_in_flight more frames have started
+void HelloEngine::destroy_retired_swapchains(bool force) {
+    auto it = m_retired_swapchains.begin();
+    while (it != m_retired_swapchains.end()) {
+        if (force || m_frame_number >= it->retire_frame) {
+            destroy_retired_swapchain(*it);
+            it = m_retired_swapchains.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool HelloEngine::acquire_image(FrameData& frame, uint32_t& image_index) {
+    if (m_swapchain == VK_NULL_HANDLE) {
+        image_index = (uint32_t)(m_frame_number % m_swapchain_images.size());
+        return true;
+    }
+
+    VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, frame.image_available_semaphore, VK_NULL_HANDLE, &image_index);
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        recreate_swapchain();
+        return false;
+    }
+
+    if (result == VK_ERROR_DEVICE_LOST) {
+        throw DeviceLostError("Device lost acquiring a swapchain image");
+    }
+
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+        throw std::runtime_error("Failed to acquire swapchain image");
+    }
+
+    return true;
+}
+
+void HelloEngine::present_image(uint32_t image_index) {
+    if (m_swapchain == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkPresentInfoKHR present_info = {
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &m_render_finished_semaphores[image_index],
+        .swapchainCount = 1,
+        .pSwapchains = &m_swapchain,
+        .pImageIndices = &image_index,
+    };
+
+    VkResult result = vkQueuePresentKHR(m_present_queue, &present_info);
+    if (result == VK_ERROR_DEVICE_LOST) {
+        throw DeviceLostError("Device lost presenting a swapchain image");
+    }
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebuffer_resized) {
+        recreate_swapchain();
+    } else if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to present swapchain image");
+    }
+}
+
+bool HelloEngine::should_close() {
+    if (m_config.max_frames != 0 && m_frame_number >= m_config.max_frames) {
+        return true;
+    }
+
+    return uses_window() && glfwWindowShouldClose(m_window);
+}
+
+// Returns false when no frame was submitted; wait_ms is the time spent blocked on the GPU or presentation engine
+bool HelloEngine::draw_frame(double& wait_ms) {
+    using clock = std::chrono::steady_clock;
+
+    FrameData& frame = m_frames[m_current_frame];
+
+    auto wait_start = clock::now();
+    {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "wait frame fence");
+        if (vkWaitForFences(m_device, 1, &frame.in_flight_fence, VK_TRUE, UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+            throw DeviceLostError("Device lost waiting for the frame fence");
+        }
+    }
+
+    if (m_profiler) {
+        m_profiler->begin_frame(m_current_frame);
+    }
+    destroy_retired_swapchains(false);
+    m_shaders->begin_frame(m_frame_number);
+    m_allocator->begin_frame(m_current_frame);
+    m_recorder->begin_frame(m_current_frame);
+    m_uploads->begin_frame(m_current_frame);
+    m_bindless->begin_frame(m_current_frame);
+
+    uint32_t image_index;
+    {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "acquire");
+        if (!acquire_image(frame, image_index)) {
+            return false;
+        }
+    }
+    m_image_index = image_index;
+
+    // Fewer swapchain images than frames in flight means an older frame may still own this image
+    if (m_images_in_flight[image_index] != VK_NULL_HANDLE &&
+        vkWaitForFences(m_device, 1, &m_images_in_flight[image_index], VK_TRUE, UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+        throw DeviceLostError("Device lost waiting for a swapchain image's previous frame");
+    }
+    m_images_in_flight[image_index] = frame.in_flight_fence;
+    auto wait_end = clock::now();
+
+    if (m_scene) {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "scene update");
+        bool resident = m_scene->stream(*m_uploads);
+        if (resident && m_report.stream_ms == 0.0) {
+            m_report.stream_ms = std::chrono::duration<double, std::milli>(clock::now() - m_loop_start).count();
+        }
+        update_scene_camera();
+    }
+
+    if (m_assets) {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "asset streaming");
+        bool resident = m_assets->stream(*m_uploads);
+        if (resident && m_report.assets_ms == 0.0) {
+            m_report.assets_ms = std::chrono::duration<double, std::milli>(clock::now() - m_loop_start).count();
+        }
+    }
+
+    // The frame's uploads go out first so graphics can wait on their timeline value
+    uint64_t upload_value = m_uploads->flush();
+    m_bindless->flush();
+
+    vkResetFences(m_device, 1, &frame.in_flight_fence);
+
+    // Offscreen images have no presentation engine to synchronise with
+    bool has_swapchain = m_swapchain != VK_NULL_HANDLE;
+
+    m_render_graph->set_image(m_backbuffer, m_swapchain_images[image_index], m_swapchain_image_views[image_index]);
+
+    RenderGraphExecuteInfo execute_info = {
+        .frame_index = m_current_frame,
+        .wait_semaphore = has_swapchain ? frame.image_available_semaphore : VK_NULL_HANDLE,
+        .wait_stage = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+        .wait_timeline = upload_value > 0 ? m_uploads->timeline() : VK_NULL_HANDLE,
+        .wait_timeline_value = upload_value,
+        .signal_semaphore = has_swapchain ? m_render_finished_semaphores[image_index] : VK_NULL_HANDLE,
+        .fence = frame.in_flight_fence,
+        .prologue = [this](VkCommandBuffer command_buffer) {
+            m_uploads->record_acquire_barriers(command_buffer);
+        },
+    };
+
+    if (m_config.inject_device_lost_after > 0 && m_frames_since_recovery + 1 == m_config.inject_device_lost_after) {
+        m_render_graph->inject_device_lost(m_config.inject_device_lost_pass);
+    }
+
+    {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "record");
+        m_render_graph->execute(execute_info);
+    }
+
+    {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "present");
+        present_image(image_index);
+    }
+    m_present_latency_ms = std::chrono::duration<double, std::milli>(clock::now() - m_input_time).count();
+
+    m_current_frame = (m_current_frame + 1) % m_config.frames_in_flight;
+    m_frame_number++;
+    m_frames_since_recovery++;
+
+    if (m_config.resize_every > 0 && m_frame_number % m_config.resize_every == 0) {
+        PROFILE_CPU_SCOPE(m_profiler.get(), "forced resize");
+        m_resize_halved = !m_resize_halved;
+        recreate_swapchain();
+    }
+
+    wait_ms = std::chrono::duration<double, std::milli>(wait_end - wait_start).count();
+    return true;
+}
+
+void HelloEngine::main_loop() {
+    using clock = std::chrono::steady_clock;
+
+    auto last_report = clock::now();
+    size_t report_first = 0;
+    m_loop_start = last_report;
+
+    while (!should_close()) {
+        // Before the frame's profiler scope opens; recovery replaces the profiler
+        if (m_device_lost) {
+            recover_device_lost();
+        }
+
+        auto frame_start = clock::now();
+
+        PROFILE_CPU_SCOPE(m_profiler.get(), "frame");
+
+        // Sleeping before input is polled, not after, is what keeps the input fresh
+        double pace_ms = 0.0;
+        {
+            PROFILE_CPU_SCOPE(m_profiler.get(), "pace");
+            pace_ms = m_pacer.wait();
+        }
+
+        if (uses_window()) {
+            PROFILE_CPU_SCOPE(m_profiler.get(), "poll events");
+            glfwPollEvents();
+        }
+        m_input_time = clock::now();
+
+        double wait_ms = 0.0;
+        bool drawn = false;
+        try {
+            drawn = draw_frame(wait_ms);
+        } catch (const DeviceLostError& error) {
+            std::cout << "Frame " << m_frame_number << ": " << error.what() << "\n";
+            m_device_lost = true;
+            continue;
+        }
+
+        if (!drawn) {
+            continue;
+        }
+
+        auto frame_end = clock::now();
+        double frame_ms = std::chrono::duration<double, std::milli>(frame_end - frame_start).count();
+        m_frame_stats.add(frame_ms - wait_ms - pace_ms, frame_ms, m_present_latency_ms);
+
+        if (std::chrono::duration<double, std::milli>(frame_end - last_report).count() >= STATS_REPORT_INTERVAL_MS) {
+            std::cout << "cpu " << FrameStats::average(m_frame_stats.cpu_ms, report_first) << " ms, frame "
+                      << FrameStats::average(m_frame_stats.frame_ms, report_first) << " ms\n";
+            report_first = m_frame_stats.frame_ms.size();
+            last_report = frame_end;
+        }
+    }
+
+    vkDeviceWaitIdle(m_device);
+    m_frame_stats.report();
+    std::cout << "  " << render_path_name(m_render_path) << ": " << m_swapchain_objects.image_views << " image views, "
+              << m_swapchain_objects.framebuffers << " framebuffers, " << m_swapchain_objects.render_passes
+              << " render passes created for the swapchain\n";
+
+    if (m_profiler) {
+        // Frames still in their slots were never resolved
+        for (uint32_t i = 0; i < m_config.frames_in_flight; i++) {
+            m_profiler->begin_frame(i);
+        }
+        m_profiler->report();
+
+        if (!m_config.trace_path.empty()) {
+            m_profiler->export_chrome_trace(m_config.trace_path);
+        }
+    } else if (!m_config.trace_path.empty()) {
+        std::cout << "--trace ignored, profiler compiled out\n";
+    }
+
+    AllocatorStats memory = m_allocator->stats();
+    std::cout << "  device memory " << memory.used_bytes << " / " << memory.reserved_bytes << " bytes used in "
+              << memory.allocation_count << " allocations, " << memory.device_allocation_count << " blocks, fragmentation "
+              << memory.fragmentation << "\n";
+
+    const UploadStats& uploads = m_uploads->stats();
+    if (uploads.upload_count > 0) {
+        std::cout << "  uploads " << uploads.upload_count << " (" << uploads.bytes << " bytes) in " << uploads.batch_count
+                  << " batches, latency avg " << uploads.total_latency_ms / std::max<uint64_t>(uploads.completed_count, 1)
+                  << " ms, max " << uploads.max_latency_ms << " ms\n";
+    }
+
+    m_bindless->report();
+    m_shaders->report();
+    if (m_scene) {
+        m_scene->report();
+    }
+    if (m_assets) {
+        m_assets->report();
+    }
+    m_host_allocator.report();
+
+    m_report.frames = m_frame_stats;
+    m_report.render_path = m_render_path;
+    m_report.synchronization2 = m_synchronization2;
+    m_report.swapchain_objects = m_swapchain_objects;
+    m_report.uploads = uploads;
+    m_report.memory = memory;
+    m_report.host_memory = m_host_allocator.total();
+}
+
+void HelloEngine::run_compute_batch() {
+    std::cout << "Compute batch: " << m_config.compute_batch.inputs.size() << " images on the "
+              << (m_compute_queue != m_graphics_queue ? "compute" : "graphics") << " queue\n";
+
+    m_report.compute_batch = m_compute_batch->run(m_config.compute_batch);
+    m_compute_batch->report();
+    m_host_allocator.report();
+
+    m_report.memory = m_allocator->stats();
+    m_report.host_memory = m_host_allocator.total();
+}
+
+// The breadcrumbs are read before anything is torn down, while their memory still exists. Frame
+// statistics, the frame counter and the report carry on across the rebuild.
+void HelloEngine::recover_device_lost() {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    if (m_breadcrumbs) {
+        m_breadcrumbs->report();
+        m_report.lost_in_passes = m_breadcrumbs->unfinished();
+    }
+
+    if (m_frame_stats.recovery_ms.size() >= m_config.max_device_lost_recoveries) {
+        throw DeviceLostError("Device lost after " + std::to_string(m_frame_stats.recovery_ms.size()) + " recoveries, giving up");
+    }
+
+    destroy_device_resources();
+    StartupTimes times;
+    create_device_resources(times);
+    m_frames_since_recovery = 0;
+
+    double recovery_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    m_frame_stats.recovery_ms.push_back(recovery_ms);
+    std::cout << "Recovered from device loss in " << recovery_ms << " ms: device " << times.device_ms << " ms, pipelines "
+              << times.pipelines_ms << " ms, swapchain " << times.swapchain_ms << " ms\n";
+}
+
+// Copes with anything init_vulkan got partway through. A lost device completes every wait at once,
+// which is all the teardown needs from it.
+void HelloEngine::destroy_device_resources() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkDeviceWaitIdle(m_device);
+    destroy_retired_swapchains(true);
+
+    m_render_graph.reset();
+    m_breadcrumbs.reset();
+    m_recorder.reset();
+    m_jobs.reset();
+    m_uploads.reset();
+    m_profiler.reset();
+
+    for (auto& frame : m_frames) {
+        vkDestroyFence(m_device, frame.in_flight_fence, m_host_allocator.callbacks(HostScope::Commands));
+        vkDestroySemaphore(m_device, frame.image_available_semaphore, m_host_allocator.callbacks(HostScope::Commands));
+    }
+    m_frames.clear();
+
+    for (auto semaphore : m_render_finished_semaphores) {
+        vkDestroySemaphore(m_device, semaphore, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+    m_render_finished_semaphores.clear();
+    m_images_in_flight.clear();
+
+    for (auto framebuffer : m_framebuffers) {
+        vkDestroyFramebuffer(m_device, framebuffer, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+    m_framebuffers.clear();
+
+    for (auto image_view : m_swapchain_image_views) {
+        vkDestroyImageView(m_device, image_view, m_host_allocator.callbacks(HostScope::Swapchain));
+    }
+    m_swapchain_image_views.clear();
+
+    if (m_swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(m_device, m_swapchain, m_host_allocator.callbacks(HostScope::Swapchain));
+        m_swapchain = VK_NULL_HANDLE;
+    }
+
+    for (size_t i = 0; i < m_offscreen_memory.size(); i++) {
+        vkDestroyImage(m_device, m_swapchain_images[i], m_host_allocator.callbacks(HostScope::Swapchain));
+        m_allocator->free(m_offscreen_memory[i]);
+    }
+    m_offscreen_memory.clear();
+    m_swapchain_images.clear();
+
+    if (m_depth_image != VK_NULL_HANDLE) {
+        vkDestroyImageView(m_device, m_depth_view, m_host_allocator.callbacks(HostScope::Swapchain));
+        vkDestroyImage(m_device, m_depth_image, m_host_allocator.callbacks(HostScope::Swapchain));
+        m_allocator->free(m_depth_memory);
+        m_depth_image = VK_NULL_HANDLE;
+        m_depth_view = VK_NULL_HANDLE;
+    }
+
+    m_scene.reset();
+    m_compute_batch.reset();
+    m_assets.reset();
+    m_asset_pack.reset();
+    m_shaders.reset();
+    m_bindless.reset();
+    // A lost device may hand back a truncated or garbage cache; keep the one on disk
+    if (m_pipeline_cache && !m_device_lost) {
+        m_pipeline_cache->save();
+    }
+    m_pipeline_cache.reset();
+
+    m_allocator.reset();
+
+    vkDestroyDevice(m_device, m_host_allocator.callbacks(HostScope::Device));
+    m_device = VK_NULL_HANDLE;
+    m_device_lost = false;
+
+    // The next device may be a different one; its surface support is queried afresh
+    m_swapchain_support = {};
+    m_current_frame = 0;
+}
+
+void HelloEngine::cleanup() {
+    // The messenger outlives the device so leaks reported by vkDestroyDevice are still caught
+    destroy_device_resources();
+    if (m_instance != VK_NULL_HANDLE) {
+        if (m_debug_messenger != VK_NULL_HANDLE) {
+            destroy_debug_utils_messenger_ext(m_instance, m_debug_messenger, m_host_allocator.callbacks(HostScope::Instance));
+        }
+        if (m_surface != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(m_instance, m_surface, m_host_allocator.callbacks(HostScope::Instance));
+        }
+        vkDestroyInstance(m_instance, m_host_allocator.callbacks(HostScope::Instance));
+    }
+
+    if (m_debug_log) {
+        m_debug_log->flush();
+        m_debug_log->report();
+        m_report.debug_messages = m_debug_log->stats();
+        m_debug_log.reset();
+    }
+
+    if (m_window != nullptr) {
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
+}
+
+void HelloEngine::framebuffer_resize_callback(GLFWwindow* window, int, int) {
+    auto engine = (HelloEngine*)glfwGetWindowUserPointer(window);
+    engine->m_framebuffer_resized = true;
+}
+
+void HelloEngine::run() {
+    // Whatever was created before a failure is still torn down before the error propagates
+    try {
+        if (uses_window()) {
+            init_window();
+        }
+        init_vulkan();
+        if (compute_only()) {
+            run_compute_batch();
+        } else {
+            main_loop();
+        }
+    } catch (...) {
+        cleanup();
+        throw;
+    }
+    cleanup();
+}
@@ -0,0 +1,146 @@
+#include "jobs/job_system.h"
+#include <algorithm>
+
+static thread_local uint32_t t_thread_index = 0;
+
+JobSystem::JobSystem(uint32_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 0; i < thread_count; i++) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (uint32_t i = 1; i < thread_count; i++) {
+        m_workers.emplace_back(&JobSystem::worker_main, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+uint32_t JobSystem::current_thread_index() {
+    return t_thread_index;
+}
+
+void JobSystem::push(uint32_t queue, Job job) {
+    {
+        std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+        m_queues[queue]->jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_pending++;
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::pop(uint32_t thread_index, Job& job) {
+    {
+        WorkQueue& own = *m_queues[thread_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_pending--;
+            return true;
+        }
+    }
+
+    for (uint32_t i = 1; i < m_queues.size(); i++) {
+        WorkQueue& victim = *m_queues[(thread_index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_pending--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool JobSystem::try_run_one(uint32_t thread_index) {
+    Job job;
+    if (!pop(thread_index, job)) {
+        return false;
+    }
+
+    try {
+        job.fn();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(job.batch->error_mutex);
+        if (!job.batch->error) {
+            job.batch->error = std::current_exception();
+        }
+    }
+
+    job.batch->remaining.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::worker_main(uint32_t thread_index) {
+    t_thread_index = thread_index;
+
+    while (true) {
+        if (try_run_one(thread_index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+        if (m_stop) {
+            return;
+        }
+    }
+}
+
+void JobSystem::parallel_for(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(1u, grain);
+
+    uint32_t chunk_count = (count + grain - 1) / grain;
+    if (chunk_count == 1 || m_queues.size() == 1) {
+        fn(0, count);
+        return;
+    }
+
+    Batch batch;
+    batch.remaining = chunk_count;
+    uint32_t thread_index = current_thread_index();
+
+    // Spread chunks over every deque up front so workers start without having to steal
+    for (uint32_t chunk = 0; chunk < chunk_count; chunk++) {
+        uint32_t begin = chunk * grain;
+        uint32_t end = std::min(count, begin + grain);
+
+        push((thread_index + chunk) % m_queues.size(), {
+            .fn = [&fn, begin, end] { fn(begin, end); },
+            .batch = &batch,
+        });
+    }
+
+    while (batch.remaining.load(std::memory_order_acquire) != 0) {
+        if (!try_run_one(thread_index)) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (batch.error) {
+        std::rethrow_exception(batch.error);
+    }
+}
@@ -0,0 +1,282 @@
+#include "math/soa_kernels.h"
+#include "soa_lanes.h"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(PLUTO_MATH_SSE) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef PLUTO_MATH_SSE
+namespace {
+
+typedef struct SseLane {
+    static const uint32_t WIDTH = 4;
+    __m128 v;
+
+    static SseLane load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static void store(float* p, SseLane a) { _mm_storeu_ps(p, a.v); }
+    static SseLane set1(float value) { return {_mm_set1_ps(value)}; }
+    static SseLane fmadd(SseLane a, SseLane b, SseLane c) { return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)}; }
+    static SseLane abs(SseLane a) { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)}; }
+    static uint32_t non_negative_mask(SseLane a) { return (uint32_t)_mm_movemask_ps(_mm_cmpge_ps(a.v, _mm_setzero_ps())); }
+
+    // No gather before AVX2: load every lane (roots read element 0) and blend the fallback in
+    static SseLane gather(const float* base, const int32_t* indices, float fallback) {
+        __m128i index = _mm_loadu_si128((const __m128i*)indices);
+        __m128 root = _mm_castsi128_ps(_mm_cmplt_epi32(index, _mm_setzero_si128()));
+        __m128 values = _mm_setr_ps(base[indices[0] & ~(indices[0] >> 31)], base[indices[1] & ~(indices[1] >> 31)],
+                                    base[indices[2] & ~(indices[2] >> 31)], base[indices[3] & ~(indices[3] >> 31)]);
+        return {_mm_or_ps(_mm_and_ps(root, _mm_set1_ps(fallback)), _mm_andnot_ps(root, values))};
+    }
+
+    friend SseLane operator+(SseLane a, SseLane b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend SseLane operator-(SseLane a, SseLane b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend SseLane operator*(SseLane a, SseLane b) { return {_mm_mul_ps(a.v, b.v)}; }
+} SseLane;
+
+}
+#endif
+
+static SimdLevel& active_level() {
+    static SimdLevel level = detected_simd_level();
+    return level;
+}
+
+SimdLevel detected_simd_level() {
+#if defined(PLUTO_MATH_SSE) && defined(PLUTO_MATH_AVX2)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    // The OS must save the YMM registers on context switches
+    bool os_avx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    if (fma && os_avx && avx2) {
+        return SimdLevel::AVX2;
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+#endif
+#ifdef PLUTO_MATH_SSE
+    return SimdLevel::SSE;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel simd_level() {
+    return active_level();
+}
+
+void set_simd_level(SimdLevel level) {
+    active_level() = std::min(level, detected_simd_level());
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE:
+        return "sse";
+    default:
+        return "scalar";
+    }
+}
+
+void TransformSoA::resize(uint32_t count) {
+    for (auto* array : {&position_x, &position_y, &position_z, &rotation_x, &rotation_y, &rotation_z, &rotation_w, &scale}) {
+        array->resize(count);
+    }
+}
+
+void TransformSoA::set(uint32_t index, Vec3 position, Quat rotation, float uniform_scale) {
+    position_x[index] = position.x;
+    position_y[index] = position.y;
+    position_z[index] = position.z;
+    rotation_x[index] = rotation.x;
+    rotation_y[index] = rotation.y;
+    rotation_z[index] = rotation.z;
+    rotation_w[index] = rotation.w;
+    scale[index] = uniform_scale;
+}
+
+void AabbSoA::resize(uint32_t count) {
+    for (auto* array : {&center_x, &center_y, &center_z, &extent_x, &extent_y, &extent_z}) {
+        array->resize(count);
+    }
+}
+
+void AabbSoA::set(uint32_t index, Vec3 center, Vec3 extent) {
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    extent_x[index] = extent.x;
+    extent_y[index] = extent.y;
+    extent_z[index] = extent.z;
+}
+
+static TransformInput input_arrays(const TransformSoA& transforms) {
+    return {
+        {transforms.position_x.data(), transforms.position_y.data(), transforms.position_z.data()},
+        {transforms.rotation_x.data(), transforms.rotation_y.data(), transforms.rotation_z.data(), transforms.rotation_w.data()},
+        transforms.scale.data(),
+    };
+}
+
+static TransformOutput output_arrays(TransformSoA& transforms) {
+    return {
+        {transforms.position_x.data(), transforms.position_y.data(), transforms.position_z.data()},
+        {transforms.rotation_x.data(), transforms.rotation_y.data(), transforms.rotation_z.data(), transforms.rotation_w.data()},
+        transforms.scale.data(),
+    };
+}
+
+std::vector<uint32_t> hierarchy_levels(const int32_t* parents, uint32_t count) {
+    std::vector<uint32_t> depths(count);
+    std::vector<uint32_t> levels = {0};
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (parents[i] >= (int32_t)i) {
+            throw std::runtime_error("Hierarchy parents must come before their children");
+        }
+
+        depths[i] = parents[i] < 0 ? 0 : depths[parents[i]] + 1;
+        if (i > 0 && depths[i] != depths[i - 1]) {
+            if (depths[i] < depths[i - 1]) {
+                throw std::runtime_error("Hierarchy must be sorted by depth");
+            }
+            levels.push_back(i);
+        }
+    }
+
+    levels.push_back(count);
+    return levels;
+}
+
+void compose_hierarchy(const TransformSoA& local, const int32_t* parents, const std::vector<uint32_t>& levels, TransformSoA& world) {
+    world.resize(local.size());
+
+    TransformInput input = input_arrays(local);
+    TransformOutput output = output_arrays(world);
+    SimdLevel level = active_level();
+
+    for (size_t l = 0; l + 1 < levels.size(); l++) {
+        uint32_t begin = levels[l];
+        uint32_t end = levels[l + 1];
+
+        switch (level) {
+#ifdef PLUTO_MATH_AVX2
+        case SimdLevel::AVX2:
+            compose_transforms_avx2(input, parents, begin, end, output);
+            break;
+#endif
+#ifdef PLUTO_MATH_SSE
+        case SimdLevel::SSE:
+            compose_range<SseLane>(input, parents, begin, end, output);
+            break;
+#endif
+        default:
+            compose_range<ScalarLane>(input, parents, begin, end, output);
+            break;
+        }
+    }
+}
+
+void transforms_to_matrices(const TransformSoA& transforms, Mat4* out) {
+    TransformInput input = input_arrays(transforms);
+
+    switch (active_level()) {
+#ifdef PLUTO_MATH_AVX2
+    case SimdLevel::AVX2:
+        transforms_to_matrices_avx2(input, transforms.size(), out->m);
+        break;
+#endif
+#ifdef PLUTO_MATH_SSE
+    case SimdLevel::SSE:
+        to_matrices_range<SseLane>(input, transforms.size(), out->m);
+        break;
+#endif
+    default:
+        to_matrices_range<ScalarLane>(input, transforms.size(), out->m);
+        break;
+    }
+}
+
+static void multiply_matrices_scalar(const Mat4* a, uint32_t a_stride, const Mat4* b, Mat4* out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const float* left = a[i * a_stride].m;
+        const float* right = b[i].m;
+        for (uint32_t column = 0; column < 4; column++) {
+            for (uint32_t row = 0; row < 4; row++) {
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < 4; k++) {
+                    sum += left[k * 4 + row] * right[column * 4 + k];
+                }
+                out[i].m[column * 4 + row] = sum;
+            }
+        }
+    }
+}
+
+static void multiply_matrices_dispatch(const Mat4* a, uint32_t a_stride, const Mat4* b, Mat4* out, uint32_t count) {
+    switch (active_level()) {
+#ifdef PLUTO_MATH_AVX2
+    case SimdLevel::AVX2:
+        multiply_matrices_avx2(a->m, a_stride * 16, b->m, out->m, count);
+        break;
+#endif
+#ifdef PLUTO_MATH_SSE
+    case SimdLevel::SSE:
+        // math.h's multiply is the SSE version on this target
+        for (uint32_t i = 0; i < count; i++) {
+            out[i] = multiply(a[i * a_stride], b[i]);
+        }
+        break;
+#endif
+    default:
+        multiply_matrices_scalar(a, a_stride, b, out, count);
+        break;
+    }
+}
+
+void multiply_matrices(const Mat4* a, const Mat4* b, Mat4* out, uint32_t count) {
+    multiply_matrices_dispatch(a, 1, b, out, count);
+}
+
+void multiply_matrices(const Mat4& a, const Mat4* b, Mat4* out, uint32_t count) {
+    multiply_matrices_dispatch(&a, 0, b, out, count);
+}
+
+uint32_t cull_aabbs(const AabbSoA& boxes, const Vec4 planes[6], uint32_t* visible) {
+    AabbInput input = {
+        {boxes.center_x.data(), boxes.center_y.data(), boxes.center_z.data()},
+        {boxes.extent_x.data(), boxes.extent_y.data(), boxes.extent_z.data()},
+    };
+
+    float plane_values[6][4];
+    for (uint32_t p = 0; p < 6; p++) {
+        plane_values[p][0] = planes[p].x;
+        plane_values[p][1] = planes[p].y;
+        plane_values[p][2] = planes[p].z;
+        plane_values[p][3] = planes[p].w;
+    }
+
+    switch (active_level()) {
+#ifdef PLUTO_MATH_AVX2
+    case SimdLevel::AVX2:
+        return cull_aabbs_avx2(input, boxes.size(), plane_values, visible);
+#endif
+#ifdef PLUTO_MATH_SSE
+    case SimdLevel::SSE:
+        return cull_range<SseLane>(input, boxes.size(), plane_values, visible);
+#endif
+    default:
+        return cull_range<ScalarLane>(input, boxes.size(), plane_values, visible);
+    }
+}
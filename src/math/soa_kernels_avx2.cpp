@@ -0,0 +1,72 @@
+// Compiled with AVX2 and FMA enabled (see CMakeLists.txt); only reached after soa_kernels.cpp
+// has checked the CPU supports both. Keep includes to soa_lanes.h and intrinsics.
+#include "soa_lanes.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace {
+
+typedef struct Avx2Lane {
+    static const uint32_t WIDTH = 8;
+    __m256 v;
+
+    static Avx2Lane load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static void store(float* p, Avx2Lane a) { _mm256_storeu_ps(p, a.v); }
+    static Avx2Lane set1(float value) { return {_mm256_set1_ps(value)}; }
+    static Avx2Lane fmadd(Avx2Lane a, Avx2Lane b, Avx2Lane c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+    static Avx2Lane abs(Avx2Lane a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+    static uint32_t non_negative_mask(Avx2Lane a) { return (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_GE_OQ)); }
+
+    // Lanes with a negative index keep the fallback and are never loaded
+    static Avx2Lane gather(const float* base, const int32_t* indices, float fallback) {
+        __m256i index = _mm256_loadu_si256((const __m256i*)indices);
+        __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(index, _mm256_set1_epi32(-1)));
+        return {_mm256_mask_i32gather_ps(_mm256_set1_ps(fallback), base, index, valid, 4)};
+    }
+
+    friend Avx2Lane operator+(Avx2Lane a, Avx2Lane b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend Avx2Lane operator-(Avx2Lane a, Avx2Lane b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend Avx2Lane operator*(Avx2Lane a, Avx2Lane b) { return {_mm256_mul_ps(a.v, b.v)}; }
+} Avx2Lane;
+
+}
+
+void compose_transforms_avx2(const TransformInput& local, const int32_t* parents, uint32_t begin, uint32_t end, const TransformOutput& world) {
+    compose_range<Avx2Lane>(local, parents, begin, end, world);
+}
+
+void transforms_to_matrices_avx2(const TransformInput& transforms, uint32_t count, float* out) {
+    to_matrices_range<Avx2Lane>(transforms, count, out);
+}
+
+// Two output columns per 256-bit register: a's columns are duplicated into both halves and
+// multiplied by b's matching entries from the two columns
+void multiply_matrices_avx2(const float* a, uint32_t a_stride, const float* b, float* out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        const float* left = a + (size_t)i * a_stride;
+        const float* right = b + (size_t)i * 16;
+        float* result = out + (size_t)i * 16;
+
+        __m256 a0 = _mm256_broadcast_ps((const __m128*)(left + 0));
+        __m256 a1 = _mm256_broadcast_ps((const __m128*)(left + 4));
+        __m256 a2 = _mm256_broadcast_ps((const __m128*)(left + 8));
+        __m256 a3 = _mm256_broadcast_ps((const __m128*)(left + 12));
+
+        for (uint32_t column = 0; column < 4; column += 2) {
+            const float* b0 = right + column * 4;
+            const float* b1 = b0 + 4;
+            __m256 sum = _mm256_mul_ps(a0, _mm256_setr_m128(_mm_set1_ps(b0[0]), _mm_set1_ps(b1[0])));
+            sum = _mm256_fmadd_ps(a1, _mm256_setr_m128(_mm_set1_ps(b0[1]), _mm_set1_ps(b1[1])), sum);
+            sum = _mm256_fmadd_ps(a2, _mm256_setr_m128(_mm_set1_ps(b0[2]), _mm_set1_ps(b1[2])), sum);
+            sum = _mm256_fmadd_ps(a3, _mm256_setr_m128(_mm_set1_ps(b0[3]), _mm_set1_ps(b1[3])), sum);
+            _mm256_storeu_ps(result + column * 4, sum);
+        }
+    }
+}
+
+uint32_t cull_aabbs_avx2(const AabbInput& boxes, uint32_t count, const float planes[6][4], uint32_t* visible) {
+    return cull_range<Avx2Lane>(boxes, count, planes, visible);
+}
+
+#endif
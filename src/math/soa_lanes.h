@@ -0,0 +1,198 @@
+#pragma once
+
+// Kernel bodies shared by soa_kernels.cpp (scalar, SSE) and soa_kernels_avx2.cpp, written once
+// against a lane type V:
+//   WIDTH, load, store, set1, gather (fallback for negative indices), fmadd (a * b + c), abs,
+//   non_negative_mask (bit per lane), and + - *.
+// soa_kernels_avx2.cpp is compiled with AVX2 enabled, so everything here has internal linkage:
+// each file gets its own copy and the linker can never hand an AVX2-encoded instantiation to a
+// CPU without it. For the same reason this header must not include math/math.h.
+#include <cstddef>
+#include <cstdint>
+
+typedef struct TransformInput {
+    const float* position[3];
+    const float* rotation[4];
+    const float* scale;
+} TransformInput;
+
+typedef struct TransformOutput {
+    float* position[3];
+    float* rotation[4];
+    float* scale;
+} TransformOutput;
+
+typedef struct AabbInput {
+    const float* center[3];
+    const float* extent[3];
+} AabbInput;
+
+// Defined in soa_kernels_avx2.cpp when PLUTO_MATH_AVX2 is set. Matrices are 16 column-major
+// floats; a_stride is 16 for an array of a, 0 to reuse one a for every b.
+void compose_transforms_avx2(const TransformInput& local, const int32_t* parents, uint32_t begin, uint32_t end, const TransformOutput& world);
+void transforms_to_matrices_avx2(const TransformInput& transforms, uint32_t count, float* out);
+void multiply_matrices_avx2(const float* a, uint32_t a_stride, const float* b, float* out, uint32_t count);
+uint32_t cull_aabbs_avx2(const AabbInput& boxes, uint32_t count, const float planes[6][4], uint32_t* visible);
+
+namespace {
+
+typedef struct ScalarLane {
+    static const uint32_t WIDTH = 1;
+    float v;
+
+    static ScalarLane load(const float* p) { return {*p}; }
+    static void store(float* p, ScalarLane a) { *p = a.v; }
+    static ScalarLane set1(float value) { return {value}; }
+    static ScalarLane gather(const float* base, const int32_t* indices, float fallback) { return {indices[0] < 0 ? fallback : base[indices[0]]}; }
+    static ScalarLane fmadd(ScalarLane a, ScalarLane b, ScalarLane c) { return {a.v * b.v + c.v}; }
+    static ScalarLane abs(ScalarLane a) { return {a.v < 0.0f ? -a.v : a.v}; }
+    static uint32_t non_negative_mask(ScalarLane a) { return a.v >= 0.0f ? 1u : 0u; }
+
+    friend ScalarLane operator+(ScalarLane a, ScalarLane b) { return {a.v + b.v}; }
+    friend ScalarLane operator-(ScalarLane a, ScalarLane b) { return {a.v - b.v}; }
+    friend ScalarLane operator*(ScalarLane a, ScalarLane b) { return {a.v * b.v}; }
+} ScalarLane;
+
+template <typename V>
+void compose_lanes(const TransformInput& local, const int32_t* parents, uint32_t i, const TransformOutput& world) {
+    // Roots see an identity parent
+    V px = V::gather(world.position[0], parents + i, 0.0f);
+    V py = V::gather(world.position[1], parents + i, 0.0f);
+    V pz = V::gather(world.position[2], parents + i, 0.0f);
+    V ax = V::gather(world.rotation[0], parents + i, 0.0f);
+    V ay = V::gather(world.rotation[1], parents + i, 0.0f);
+    V az = V::gather(world.rotation[2], parents + i, 0.0f);
+    V aw = V::gather(world.rotation[3], parents + i, 1.0f);
+    V ps = V::gather(world.scale, parents + i, 1.0f);
+
+    V lx = V::load(local.position[0] + i);
+    V ly = V::load(local.position[1] + i);
+    V lz = V::load(local.position[2] + i);
+    V bx = V::load(local.rotation[0] + i);
+    V by = V::load(local.rotation[1] + i);
+    V bz = V::load(local.rotation[2] + i);
+    V bw = V::load(local.rotation[3] + i);
+    V ls = V::load(local.scale + i);
+
+    // Local position rotated by the parent: l + 2w(u x l) + 2(u x (u x l))
+    V two = V::set1(2.0f);
+    V tx = two * (ay * lz - az * ly);
+    V ty = two * (az * lx - ax * lz);
+    V tz = two * (ax * ly - ay * lx);
+    V rx = V::fmadd(aw, tx, lx) + (ay * tz - az * ty);
+    V ry = V::fmadd(aw, ty, ly) + (az * tx - ax * tz);
+    V rz = V::fmadd(aw, tz, lz) + (ax * ty - ay * tx);
+
+    V::store(world.position[0] + i, V::fmadd(ps, rx, px));
+    V::store(world.position[1] + i, V::fmadd(ps, ry, py));
+    V::store(world.position[2] + i, V::fmadd(ps, rz, pz));
+
+    V::store(world.rotation[0] + i, V::fmadd(aw, bx, V::fmadd(ax, bw, ay * bz)) - az * by);
+    V::store(world.rotation[1] + i, V::fmadd(aw, by, V::fmadd(ay, bw, az * bx)) - ax * bz);
+    V::store(world.rotation[2] + i, V::fmadd(aw, bz, V::fmadd(az, bw, ax * by)) - ay * bx);
+    V::store(world.rotation[3] + i, aw * bw - V::fmadd(ax, bx, V::fmadd(ay, by, az * bz)));
+    V::store(world.scale + i, ps * ls);
+}
+
+template <typename V>
+void compose_range(const TransformInput& local, const int32_t* parents, uint32_t begin, uint32_t end, const TransformOutput& world) {
+    uint32_t i = begin;
+    for (; i + V::WIDTH <= end; i += V::WIDTH) {
+        compose_lanes<V>(local, parents, i, world);
+    }
+    for (; i < end; i++) {
+        compose_lanes<ScalarLane>(local, parents, i, world);
+    }
+}
+
+template <typename V>
+void to_matrices_lanes(const TransformInput& transforms, uint32_t i, float* out) {
+    V x = V::load(transforms.rotation[0] + i);
+    V y = V::load(transforms.rotation[1] + i);
+    V z = V::load(transforms.rotation[2] + i);
+    V w = V::load(transforms.rotation[3] + i);
+    V s = V::load(transforms.scale + i);
+    V two_s = V::set1(2.0f) * s;
+
+    V xx = x * x, yy = y * y, zz = z * z;
+    V xy = x * y, xz = x * z, yz = y * z;
+    V xw = x * w, yw = y * w, zw = z * w;
+
+    // The upper 3x4 of each column-major matrix; row 3 is constant
+    V columns[12] = {
+        s - two_s * (yy + zz), two_s * (xy + zw), two_s * (xz - yw),
+        two_s * (xy - zw), s - two_s * (xx + zz), two_s * (yz + xw),
+        two_s * (xz + yw), two_s * (yz - xw), s - two_s * (xx + yy),
+        V::load(transforms.position[0] + i), V::load(transforms.position[1] + i), V::load(transforms.position[2] + i),
+    };
+
+    float lanes[12][V::WIDTH];
+    for (uint32_t c = 0; c < 12; c++) {
+        V::store(lanes[c], columns[c]);
+    }
+
+    for (uint32_t lane = 0; lane < V::WIDTH; lane++) {
+        float* m = out + (size_t)(i + lane) * 16;
+        for (uint32_t column = 0; column < 4; column++) {
+            m[column * 4 + 0] = lanes[column * 3 + 0][lane];
+            m[column * 4 + 1] = lanes[column * 3 + 1][lane];
+            m[column * 4 + 2] = lanes[column * 3 + 2][lane];
+            m[column * 4 + 3] = column == 3 ? 1.0f : 0.0f;
+        }
+    }
+}
+
+template <typename V>
+void to_matrices_range(const TransformInput& transforms, uint32_t count, float* out) {
+    uint32_t i = 0;
+    for (; i + V::WIDTH <= count; i += V::WIDTH) {
+        to_matrices_lanes<V>(transforms, i, out);
+    }
+    for (; i < count; i++) {
+        to_matrices_lanes<ScalarLane>(transforms, i, out);
+    }
+}
+
+template <typename V>
+uint32_t cull_lanes(const AabbInput& boxes, uint32_t i, const float planes[6][4], uint32_t* visible) {
+    V cx = V::load(boxes.center[0] + i);
+    V cy = V::load(boxes.center[1] + i);
+    V cz = V::load(boxes.center[2] + i);
+    V ex = V::load(boxes.extent[0] + i);
+    V ey = V::load(boxes.extent[1] + i);
+    V ez = V::load(boxes.extent[2] + i);
+
+    // Outside a plane when even the box corner furthest along its normal is behind it
+    uint32_t mask = (1u << V::WIDTH) - 1;
+    for (uint32_t p = 0; p < 6; p++) {
+        V nx = V::set1(planes[p][0]);
+        V ny = V::set1(planes[p][1]);
+        V nz = V::set1(planes[p][2]);
+        V distance = V::fmadd(nx, cx, V::fmadd(ny, cy, V::fmadd(nz, cz, V::set1(planes[p][3]))));
+        V radius = V::fmadd(V::abs(nx), ex, V::fmadd(V::abs(ny), ey, V::abs(nz) * ez));
+        mask &= V::non_negative_mask(distance + radius);
+    }
+
+    uint32_t count = 0;
+    for (uint32_t lane = 0; lane < V::WIDTH; lane++) {
+        if (mask & (1u << lane)) {
+            visible[count++] = i + lane;
+        }
+    }
+    return count;
+}
+
+template <typename V>
+uint32_t cull_range(const AabbInput& boxes, uint32_t count, const float planes[6][4], uint32_t* visible) {
+    uint32_t visible_count = 0;
+    uint32_t i = 0;
+    for (; i + V::WIDTH <= count; i += V::WIDTH) {
+        visible_count += cull_lanes<V>(boxes, i, planes, visible + visible_count);
+    }
+    for (; i < count; i++) {
+        visible_count += cull_lanes<ScalarLane>(boxes, i, planes, visible + visible_count);
+    }
+    return visible_count;
+}
+
+}
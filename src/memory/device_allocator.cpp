@@ -0,0 +1,233 @@
+#include "memory/device_allocator.h"
+#include <algorithm>
+#include <stdexcept>
+
+DeviceAllocator::DeviceAllocator(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize block_size, const VkAllocationCallbacks* host_allocator)
+    : m_device(device), m_host_allocator(host_allocator), m_block_size(block_size) {
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &m_memory_properties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    m_buffer_image_granularity = properties.limits.bufferImageGranularity;
+    m_max_allocation_count = properties.limits.maxMemoryAllocationCount;
+
+    m_pools.resize(m_memory_properties.memoryTypeCount * 2);
+}
+
+DeviceAllocator::~DeviceAllocator() {
+    for (auto& pool : m_pools) {
+        for (auto& block : pool) {
+            free_device_memory(block->memory);
+        }
+    }
+
+    for (auto& arena : m_transient_arenas) {
+        free_device_memory(arena->memory);
+    }
+}
+
+uint32_t DeviceAllocator::find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < m_memory_properties.memoryTypeCount; i++) {
+        if ((type_bits & (1 << i)) && (m_memory_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find a suitable memory type");
+}
+
+VkDeviceMemory DeviceAllocator::allocate_device_memory(VkDeviceSize size, uint32_t memory_type, void** mapped) {
+    if (m_device_allocation_count >= m_max_allocation_count) {
+        throw std::runtime_error("Exceeded maxMemoryAllocationCount");
+    }
+
+    VkMemoryAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memory_type,
+    };
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(m_device, &alloc_info, m_host_allocator, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate device memory block");
+    }
+    m_device_allocation_count++;
+
+    *mapped = nullptr;
+    if (m_memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to map device memory block");
+        }
+    }
+
+    return memory;
+}
+
+void DeviceAllocator::free_device_memory(VkDeviceMemory memory) {
+    vkFreeMemory(m_device, memory, m_host_allocator);
+    m_device_allocation_count--;
+}
+
+// Small heaps get smaller blocks so a single block never claims a large share of the heap
+VkDeviceSize DeviceAllocator::block_size_for(uint32_t memory_type, VkDeviceSize request) const {
+    VkDeviceSize heap_size = m_memory_properties.memoryHeaps[m_memory_properties.memoryTypes[memory_type].heapIndex].size;
+    VkDeviceSize block_size = std::min(m_block_size, std::max<VkDeviceSize>(heap_size / 8, 1));
+
+    return std::max(block_size, request);
+}
+
+Allocation DeviceAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, AllocationKind kind) {
+    uint32_t memory_type = find_memory_type(requirements.memoryTypeBits, properties);
+
+    // Separate pools per kind keep linear and optimal resources off each other's granularity pages
+    size_t pool_index = memory_type * 2 + (m_buffer_image_granularity > 1 && kind == AllocationKind::Optimal ? 1 : 0);
+    auto& pool = m_pools[pool_index];
+
+    Allocation allocation;
+    allocation.memory_type = memory_type;
+    allocation.size = requirements.size;
+
+    for (auto& block : pool) {
+        if (block->pool.allocate(requirements.size, requirements.alignment, allocation.offset, allocation.handle)) {
+            allocation.block = block.get();
+            break;
+        }
+    }
+
+    if (allocation.block == nullptr) {
+        VkDeviceSize size = block_size_for(memory_type, requirements.size);
+
+        auto block = std::unique_ptr<MemoryBlock>(new MemoryBlock{VK_NULL_HANDLE, nullptr, TlsfPool(size)});
+        block->memory = allocate_device_memory(size, memory_type, &block->mapped);
+
+        if (!block->pool.allocate(requirements.size, requirements.alignment, allocation.offset, allocation.handle)) {
+            free_device_memory(block->memory);
+            throw std::runtime_error("Failed to sub-allocate from a new memory block");
+        }
+
+        allocation.block = block.get();
+        pool.push_back(std::move(block));
+    }
+
+    allocation.memory = allocation.block->memory;
+    if (allocation.block->mapped != nullptr) {
+        allocation.mapped = (char*)allocation.block->mapped + allocation.offset;
+    }
+
+    return allocation;
+}
+
+void DeviceAllocator::free(Allocation& allocation) {
+    if (allocation.block == nullptr) {
+        return;
+    }
+
+    MemoryBlock* block = allocation.block;
+    block->pool.free(allocation.handle);
+
+    // Keep one empty block per pool around so alloc/free churn does not hit the driver
+    if (block->pool.empty()) {
+        for (auto& pool : m_pools) {
+            auto it = std::find_if(pool.begin(), pool.end(), [block](const std::unique_ptr<MemoryBlock>& b) { return b.get() == block; });
+            if (it == pool.end()) {
+                continue;
+            }
+
+            size_t empty_blocks = std::count_if(pool.begin(), pool.end(), [](const std::unique_ptr<MemoryBlock>& b) { return b->pool.empty(); });
+            if (empty_blocks > 1) {
+                free_device_memory(block->memory);
+                pool.erase(it);
+            }
+            break;
+        }
+    }
+
+    allocation = {};
+}
+
+Allocation DeviceAllocator::allocate_image(VkImage image, VkMemoryPropertyFlags properties, AllocationKind kind) {
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_device, image, &requirements);
+
+    Allocation allocation = allocate(requirements, properties, kind);
+    if (vkBindImageMemory(m_device, image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+        free(allocation);
+        throw std::runtime_error("Failed to bind image memory");
+    }
+
+    return allocation;
+}
+
+Allocation DeviceAllocator::allocate_buffer(VkBuffer buffer, VkMemoryPropertyFlags properties) {
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(m_device, buffer, &requirements);
+
+    Allocation allocation = allocate(requirements, properties, AllocationKind::Linear);
+    if (vkBindBufferMemory(m_device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+        free(allocation);
+        throw std::runtime_error("Failed to bind buffer memory");
+    }
+
+    return allocation;
+}
+
+TransientArena* DeviceAllocator::create_transient_arena(VkDeviceSize size, uint32_t memory_type_bits, VkMemoryPropertyFlags properties, uint32_t frame_count) {
+    uint32_t memory_type = find_memory_type(memory_type_bits, properties);
+
+    auto arena = std::unique_ptr<TransientArena>(new TransientArena{VK_NULL_HANDLE, nullptr, memory_type, RingArena(size, frame_count)});
+    arena->memory = allocate_device_memory(size, memory_type, &arena->mapped);
+
+    m_transient_arenas.push_back(std::move(arena));
+    return m_transient_arenas.back().get();
+}
+
+void DeviceAllocator::begin_frame(uint32_t frame_index) {
+    for (auto& arena : m_transient_arenas) {
+        arena->ring.begin_frame(frame_index);
+    }
+}
+
+Allocation DeviceAllocator::allocate_transient(TransientArena* arena, VkDeviceSize size, VkDeviceSize alignment) {
+    Allocation allocation;
+    if (!arena->ring.allocate(size, alignment, allocation.offset)) {
+        throw std::runtime_error("Transient arena exhausted");
+    }
+
+    allocation.memory = arena->memory;
+    allocation.size = size;
+    allocation.memory_type = arena->memory_type;
+    if (arena->mapped != nullptr) {
+        allocation.mapped = (char*)arena->mapped + allocation.offset;
+    }
+
+    return allocation;
+}
+
+AllocatorStats DeviceAllocator::stats() const {
+    AllocatorStats stats;
+    stats.device_allocation_count = m_device_allocation_count;
+
+    VkDeviceSize free_bytes = 0;
+    VkDeviceSize largest_free = 0;
+
+    for (auto& pool : m_pools) {
+        for (auto& block : pool) {
+            stats.reserved_bytes += block->pool.size();
+            stats.used_bytes += block->pool.used_bytes();
+            stats.allocation_count += block->pool.allocation_count();
+            free_bytes += block->pool.free_bytes();
+            largest_free = std::max(largest_free, block->pool.largest_free_block());
+        }
+    }
+
+    for (auto& arena : m_transient_arenas) {
+        stats.transient_reserved_bytes += arena->ring.size();
+        stats.transient_used_bytes += arena->ring.used_bytes();
+    }
+
+    if (free_bytes > 0) {
+        stats.fragmentation = 1.0 - (double)largest_free / (double)free_bytes;
+    }
+
+    return stats;
+}
@@ -0,0 +1,178 @@
+#include "memory/host_allocator.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Stored immediately before every pointer handed to the driver
+typedef struct AllocationHeader {
+    size_t size;
+    // From the start of the malloc block to the returned pointer
+    size_t offset;
+} AllocationHeader;
+
+static AllocationHeader* header_of(void* memory) {
+    return (AllocationHeader*)((char*)memory - sizeof(AllocationHeader));
+}
+
+static void* allocate_aligned(size_t size, size_t alignment) {
+    alignment = std::max(alignment, alignof(std::max_align_t));
+
+    char* block = (char*)std::malloc(size + alignment + sizeof(AllocationHeader));
+    if (block == nullptr) {
+        return nullptr;
+    }
+
+    uintptr_t address = (uintptr_t)(block + sizeof(AllocationHeader));
+    char* memory = (char*)((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+    AllocationHeader* header = header_of(memory);
+    header->size = size;
+    header->offset = (size_t)(memory - block);
+    return memory;
+}
+
+static void free_aligned(void* memory) {
+    std::free((char*)memory - header_of(memory)->offset);
+}
+
+static void raise_peak(std::atomic<uint64_t>& peak, uint64_t live) {
+    uint64_t previous = peak.load(std::memory_order_relaxed);
+    while (live > previous && !peak.compare_exchange_weak(previous, live, std::memory_order_relaxed)) {
+    }
+}
+
+HostAllocator::HostAllocator() {
+    for (Scope& scope : m_scopes) {
+        scope.callbacks = {
+            .pUserData = &scope,
+            .pfnAllocation = allocate,
+            .pfnReallocation = reallocate,
+            .pfnFree = release,
+            .pfnInternalAllocation = internal_allocation,
+            .pfnInternalFree = internal_free,
+        };
+    }
+}
+
+void* VKAPI_CALL HostAllocator::allocate(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope) {
+    Scope* scope = (Scope*)user_data;
+
+    void* memory = allocate_aligned(size, alignment);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+
+    scope->allocations.fetch_add(1, std::memory_order_relaxed);
+    raise_peak(scope->peak_bytes, scope->live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+    return memory;
+}
+
+void* VKAPI_CALL HostAllocator::reallocate(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope allocation_scope) {
+    if (original == nullptr) {
+        return allocate(user_data, size, alignment, allocation_scope);
+    }
+    if (size == 0) {
+        release(user_data, original);
+        return nullptr;
+    }
+
+    Scope* scope = (Scope*)user_data;
+
+    // The original stays valid when the new allocation fails
+    void* memory = allocate_aligned(size, alignment);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+
+    size_t original_size = header_of(original)->size;
+    std::memcpy(memory, original, std::min(size, original_size));
+    free_aligned(original);
+
+    scope->reallocations.fetch_add(1, std::memory_order_relaxed);
+    scope->live_bytes.fetch_sub(original_size, std::memory_order_relaxed);
+    raise_peak(scope->peak_bytes, scope->live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+    return memory;
+}
+
+void VKAPI_CALL HostAllocator::release(void* user_data, void* memory) {
+    if (memory == nullptr) {
+        return;
+    }
+
+    Scope* scope = (Scope*)user_data;
+    scope->frees.fetch_add(1, std::memory_order_relaxed);
+    scope->live_bytes.fetch_sub(header_of(memory)->size, std::memory_order_relaxed);
+    free_aligned(memory);
+}
+
+void VKAPI_CALL HostAllocator::internal_allocation(void* user_data, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+    ((Scope*)user_data)->internal_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void VKAPI_CALL HostAllocator::internal_free(void* user_data, size_t size, VkInternalAllocationType, VkSystemAllocationScope) {
+    ((Scope*)user_data)->internal_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+HostScopeStats HostAllocator::stats(HostScope scope) const {
+    const Scope& source = m_scopes[(uint32_t)scope];
+
+    HostScopeStats stats;
+    stats.allocations = source.allocations.load(std::memory_order_relaxed);
+    stats.reallocations = source.reallocations.load(std::memory_order_relaxed);
+    stats.frees = source.frees.load(std::memory_order_relaxed);
+    stats.live_bytes = source.live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = source.peak_bytes.load(std::memory_order_relaxed);
+    stats.internal_bytes = source.internal_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Peaks are per scope and need not coincide, so the total peak is an upper bound
+HostScopeStats HostAllocator::total() const {
+    HostScopeStats total;
+    for (uint32_t i = 0; i < (uint32_t)HostScope::Count; i++) {
+        HostScopeStats scope = stats((HostScope)i);
+        total.allocations += scope.allocations;
+        total.reallocations += scope.reallocations;
+        total.frees += scope.frees;
+        total.live_bytes += scope.live_bytes;
+        total.peak_bytes += scope.peak_bytes;
+        total.internal_bytes += scope.internal_bytes;
+    }
+    return total;
+}
+
+const char* HostAllocator::scope_name(HostScope scope) {
+    switch (scope) {
+    case HostScope::Instance:
+        return "instance";
+    case HostScope::Device:
+        return "device";
+    case HostScope::Swapchain:
+        return "swapchain";
+    case HostScope::Pipelines:
+        return "pipelines";
+    case HostScope::Resources:
+        return "resources";
+    case HostScope::Commands:
+        return "commands";
+    default:
+        return "unknown";
+    }
+}
+
+void HostAllocator::report() const {
+    const double kib = 1024.0;
+
+    std::cout << "Host memory:\n";
+    for (uint32_t i = 0; i < (uint32_t)HostScope::Count; i++) {
+        HostScopeStats scope = stats((HostScope)i);
+        std::cout << "  " << scope_name((HostScope)i) << ": " << scope.allocations << " allocations, " << scope.reallocations
+                  << " reallocations, " << scope.live_bytes / kib << " KiB live, " << scope.peak_bytes / kib << " KiB peak";
+        if (scope.internal_bytes > 0) {
+            std::cout << ", " << scope.internal_bytes / kib << " KiB internal";
+        }
+        std::cout << "\n";
+    }
+}
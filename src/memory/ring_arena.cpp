@@ -0,0 +1,51 @@
+#include "memory/ring_arena.h"
+
+RingArena::RingArena(uint64_t size, uint32_t frame_count) : m_size(size), m_frame_ends(frame_count, 0), m_frame_bytes(frame_count, 0) {
+}
+
+void RingArena::begin_frame(uint32_t frame_index) {
+    if (m_frame_bytes[frame_index] != 0) {
+        m_tail = m_frame_ends[frame_index];
+        m_used -= m_frame_bytes[frame_index];
+        m_frame_bytes[frame_index] = 0;
+    }
+
+    if (m_used == 0) {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    m_current_frame = frame_index;
+}
+
+bool RingArena::allocate(uint64_t size, uint64_t alignment, uint64_t& offset) {
+    if (alignment == 0) {
+        alignment = 1;
+    }
+
+    uint64_t aligned = (m_head + alignment - 1) & ~(alignment - 1);
+    uint64_t end = aligned + size;
+
+    if (m_used == 0 || m_head > m_tail) {
+        // Free space is [head, size) followed by [0, tail)
+        if (end > m_size) {
+            if (size > m_tail) {
+                return false;
+            }
+            aligned = 0;
+            end = size;
+        }
+    } else if (end > m_tail) {
+        return false;
+    }
+
+    // Bytes skipped for alignment or wrapping are released together with this frame
+    uint64_t consumed = end > m_head ? end - m_head : (m_size - m_head) + end;
+    m_used += consumed;
+    m_frame_bytes[m_current_frame] += consumed;
+    m_frame_ends[m_current_frame] = end;
+    m_head = end;
+
+    offset = aligned;
+    return true;
+}
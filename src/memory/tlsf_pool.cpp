@@ -0,0 +1,251 @@
+#include "memory/tlsf_pool.h"
+
+static uint32_t bit_scan_reverse(uint64_t value) {
+    return 63 - (uint32_t)__builtin_clzll(value);
+}
+
+static uint32_t bit_scan_forward(uint64_t value) {
+    return (uint32_t)__builtin_ctzll(value);
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+TlsfPool::TlsfPool(uint64_t size) : m_size(size) {
+    for (auto& row : m_free_heads) {
+        for (auto& head : row) {
+            head = INVALID_HANDLE;
+        }
+    }
+
+    uint32_t root = new_node();
+    m_nodes[root] = {
+        .offset = 0,
+        .size = size,
+        .prev_physical = INVALID_HANDLE,
+        .next_physical = INVALID_HANDLE,
+        .prev_free = INVALID_HANDLE,
+        .next_free = INVALID_HANDLE,
+        .is_free = true,
+    };
+    insert_free(root);
+}
+
+void TlsfPool::mapping_insert(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < SL_COUNT) {
+        fl = 0;
+        sl = (uint32_t)size;
+        return;
+    }
+
+    fl = bit_scan_reverse(size);
+    sl = (uint32_t)(size >> (fl - SL_LOG2)) ^ SL_COUNT;
+}
+
+// Rounds up to the next size class so any block found there is large enough
+void TlsfPool::mapping_search(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size >= SL_COUNT) {
+        uint64_t round = (1ull << (bit_scan_reverse(size) - SL_LOG2)) - 1;
+        if (size + round > size) {
+            size += round;
+        }
+    }
+    mapping_insert(size, fl, sl);
+}
+
+uint32_t TlsfPool::new_node() {
+    if (!m_unused_nodes.empty()) {
+        uint32_t node = m_unused_nodes.back();
+        m_unused_nodes.pop_back();
+        return node;
+    }
+
+    m_nodes.push_back({});
+    return (uint32_t)(m_nodes.size() - 1);
+}
+
+void TlsfPool::insert_free(uint32_t node) {
+    uint32_t fl, sl;
+    mapping_insert(m_nodes[node].size, fl, sl);
+
+    uint32_t head = m_free_heads[fl][sl];
+    m_nodes[node].is_free = true;
+    m_nodes[node].prev_free = INVALID_HANDLE;
+    m_nodes[node].next_free = head;
+    if (head != INVALID_HANDLE) {
+        m_nodes[head].prev_free = node;
+    }
+
+    m_free_heads[fl][sl] = node;
+    m_fl_bitmap |= 1ull << fl;
+    m_sl_bitmap[fl] |= 1u << sl;
+}
+
+void TlsfPool::remove_free(uint32_t node) {
+    uint32_t fl, sl;
+    mapping_insert(m_nodes[node].size, fl, sl);
+
+    uint32_t prev = m_nodes[node].prev_free;
+    uint32_t next = m_nodes[node].next_free;
+    if (prev != INVALID_HANDLE) {
+        m_nodes[prev].next_free = next;
+    }
+    if (next != INVALID_HANDLE) {
+        m_nodes[next].prev_free = prev;
+    }
+
+    if (m_free_heads[fl][sl] == node) {
+        m_free_heads[fl][sl] = next;
+        if (next == INVALID_HANDLE) {
+            m_sl_bitmap[fl] &= ~(1u << sl);
+            if (m_sl_bitmap[fl] == 0) {
+                m_fl_bitmap &= ~(1ull << fl);
+            }
+        }
+    }
+
+    m_nodes[node].is_free = false;
+}
+
+uint32_t TlsfPool::find_free_block(uint64_t size) {
+    uint32_t fl, sl;
+    mapping_search(size, fl, sl);
+    if (fl >= FL_COUNT) {
+        return INVALID_HANDLE;
+    }
+
+    uint32_t sl_map = m_sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        uint64_t fl_map = fl + 1 < FL_COUNT ? m_fl_bitmap & (~0ull << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return INVALID_HANDLE;
+        }
+
+        fl = bit_scan_forward(fl_map);
+        sl_map = m_sl_bitmap[fl];
+    }
+
+    return m_free_heads[fl][bit_scan_forward(sl_map)];
+}
+
+// Splits node so it is exactly size bytes long and returns the free remainder, if any
+uint32_t TlsfPool::split(uint32_t node, uint64_t size) {
+    if (m_nodes[node].size - size < MIN_BLOCK_SIZE) {
+        return INVALID_HANDLE;
+    }
+
+    uint32_t remainder = new_node();
+    Node& current = m_nodes[node];
+    m_nodes[remainder] = {
+        .offset = current.offset + size,
+        .size = current.size - size,
+        .prev_physical = node,
+        .next_physical = current.next_physical,
+        .prev_free = INVALID_HANDLE,
+        .next_free = INVALID_HANDLE,
+        .is_free = false,
+    };
+
+    if (current.next_physical != INVALID_HANDLE) {
+        m_nodes[current.next_physical].prev_physical = remainder;
+    }
+    current.next_physical = remainder;
+    current.size = size;
+
+    return remainder;
+}
+
+bool TlsfPool::allocate(uint64_t size, uint64_t alignment, uint64_t& offset, uint32_t& handle) {
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment == 0) {
+        alignment = 1;
+    }
+    size = align_up(size, MIN_BLOCK_SIZE);
+
+    // Most blocks are already aligned; only pay for worst-case padding when the exact fit is misaligned
+    uint32_t node = find_free_block(size);
+    if (node == INVALID_HANDLE || align_up(m_nodes[node].offset, alignment) + size > m_nodes[node].offset + m_nodes[node].size) {
+        node = find_free_block(size + alignment - 1);
+    }
+    if (node == INVALID_HANDLE) {
+        return false;
+    }
+
+    remove_free(node);
+
+    uint64_t padding = align_up(m_nodes[node].offset, alignment) - m_nodes[node].offset;
+    if (padding > 0) {
+        // The physical predecessor of a free block is never free, so the padding becomes its own free block
+        uint32_t front = node;
+        node = split(front, padding);
+        if (node == INVALID_HANDLE) {
+            insert_free(front);
+            return false;
+        }
+        insert_free(front);
+    }
+
+    uint32_t remainder = split(node, size);
+    if (remainder != INVALID_HANDLE) {
+        insert_free(remainder);
+    }
+
+    m_used += m_nodes[node].size;
+    m_allocation_count++;
+
+    offset = m_nodes[node].offset;
+    handle = node;
+    return true;
+}
+
+void TlsfPool::free(uint32_t handle) {
+    uint32_t node = handle;
+    m_used -= m_nodes[node].size;
+    m_allocation_count--;
+
+    uint32_t prev = m_nodes[node].prev_physical;
+    if (prev != INVALID_HANDLE && m_nodes[prev].is_free) {
+        remove_free(prev);
+        m_nodes[prev].size += m_nodes[node].size;
+        m_nodes[prev].next_physical = m_nodes[node].next_physical;
+        if (m_nodes[node].next_physical != INVALID_HANDLE) {
+            m_nodes[m_nodes[node].next_physical].prev_physical = prev;
+        }
+        m_unused_nodes.push_back(node);
+        node = prev;
+    }
+
+    uint32_t next = m_nodes[node].next_physical;
+    if (next != INVALID_HANDLE && m_nodes[next].is_free) {
+        remove_free(next);
+        m_nodes[node].size += m_nodes[next].size;
+        m_nodes[node].next_physical = m_nodes[next].next_physical;
+        if (m_nodes[next].next_physical != INVALID_HANDLE) {
+            m_nodes[m_nodes[next].next_physical].prev_physical = node;
+        }
+        m_unused_nodes.push_back(next);
+    }
+
+    insert_free(node);
+}
+
+uint64_t TlsfPool::largest_free_block() const {
+    if (m_fl_bitmap == 0) {
+        return 0;
+    }
+
+    uint32_t fl = bit_scan_reverse(m_fl_bitmap);
+    uint32_t sl = bit_scan_reverse(m_sl_bitmap[fl]);
+
+    uint64_t largest = 0;
+    for (uint32_t node = m_free_heads[fl][sl]; node != INVALID_HANDLE; node = m_nodes[node].next_free) {
+        if (m_nodes[node].size > largest) {
+            largest = m_nodes[node].size;
+        }
+    }
+
+    return largest;
+}
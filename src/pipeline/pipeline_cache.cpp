@@ -0,0 +1,128 @@
+#include "pipeline/pipeline_cache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+// Layout of VkPipelineCacheHeaderVersionOne, read field by field to avoid relying on struct packing
+const size_t PIPELINE_CACHE_HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+static uint32_t read_u32(const std::string& blob, size_t offset) {
+    uint32_t value;
+    std::memcpy(&value, blob.data() + offset, sizeof(value));
+    return value;
+}
+
+PipelineCache::PipelineCache(VkPhysicalDevice physical_device, VkDevice device, const std::string& path, const VkAllocationCallbacks* host_allocator)
+    : m_device(device), m_host_allocator(host_allocator), m_path(path) {
+    vkGetPhysicalDeviceProperties(physical_device, &m_properties);
+
+    std::string blob;
+    std::ifstream file(m_path, std::ios::binary);
+    if (file) {
+        blob.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    if (!blob.empty() && !validate_header(blob)) {
+        std::cout << "Discarding pipeline cache " << m_path << ": created by a different device or driver\n";
+        blob.clear();
+    }
+
+    VkPipelineCacheCreateInfo create_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = blob.size(),
+        .pInitialData = blob.empty() ? nullptr : blob.data(),
+    };
+
+    if (vkCreatePipelineCache(m_device, &create_info, m_host_allocator, &m_cache) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create pipeline cache");
+    }
+
+    m_loaded_bytes = blob.size();
+}
+
+PipelineCache::~PipelineCache() {
+    vkDestroyPipelineCache(m_device, m_cache, m_host_allocator);
+}
+
+bool PipelineCache::validate_header(const std::string& blob) const {
+    if (blob.size() < PIPELINE_CACHE_HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t header_size = read_u32(blob, 0);
+    uint32_t header_version = read_u32(blob, 4);
+    uint32_t vendor_id = read_u32(blob, 8);
+    uint32_t device_id = read_u32(blob, 12);
+
+    return header_size >= PIPELINE_CACHE_HEADER_SIZE &&
+           header_size <= blob.size() &&
+           header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           vendor_id == m_properties.vendorID &&
+           device_id == m_properties.deviceID &&
+           std::memcmp(blob.data() + 16, m_properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::record_build(double ms) {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_pipeline_count++;
+    m_build_ms += ms;
+}
+
+VkPipeline PipelineCache::create_compute_pipeline(const VkComputePipelineCreateInfo& create_info) {
+    auto start = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline;
+    if (vkCreateComputePipelines(m_device, m_cache, 1, &create_info, m_host_allocator, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create compute pipeline");
+    }
+
+    record_build(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return pipeline;
+}
+
+VkPipeline PipelineCache::create_graphics_pipeline(const VkGraphicsPipelineCreateInfo& create_info) {
+    auto start = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline;
+    if (vkCreateGraphicsPipelines(m_device, m_cache, 1, &create_info, m_host_allocator, &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create graphics pipeline");
+    }
+
+    record_build(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return pipeline;
+}
+
+void PipelineCache::save() {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) != VK_SUCCESS || size == 0) {
+        return;
+    }
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) != VK_SUCCESS) {
+        return;
+    }
+
+    std::string temp_path = m_path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), (std::streamsize)size)) {
+            std::cerr << "Failed to write pipeline cache " << temp_path << "\n";
+            return;
+        }
+    }
+
+    if (std::rename(temp_path.c_str(), m_path.c_str()) != 0) {
+        std::cerr << "Failed to replace pipeline cache " << m_path << "\n";
+    }
+}
+
+void PipelineCache::report() const {
+    std::cout << "Pipeline cache: " << (is_warm() ? "warm" : "cold") << " (" << m_loaded_bytes << " bytes loaded), "
+              << m_pipeline_count << " pipelines built in " << m_build_ms << " ms\n";
+}
@@ -0,0 +1,351 @@
+#include "pipeline/shader_library.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+const uint32_t SPIRV_MAGIC = 0x07230203;
+// Shared with the pluto_shaders target in CMakeLists.txt. Vulkan 1.2 (SPIR-V 1.5) so the same
+// modules load on devices that take the classic render path; the shaders only need descriptor indexing.
+const char* SHADER_COMPILE_ARGS = "--target-env=vulkan1.2";
+
+static bool read_spirv(const std::filesystem::path& path, std::vector<uint32_t>& spirv) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size < 20 || size % 4 != 0) {
+        return false;
+    }
+
+    std::vector<uint32_t> words(size / 4);
+    file.seekg(0);
+    if (!file.read((char*)words.data(), size) || words[0] != SPIRV_MAGIC) {
+        return false;
+    }
+
+    spirv = std::move(words);
+    return true;
+}
+
+// FNV-1a
+static uint64_t hash_text(const std::string& text, uint64_t hash = 0xcbf29ce484222325ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// "blur.comp.hlsl" -> "-fshader-stage=compute"; GLSL stages come from the extension alone
+static std::string stage_args(const std::filesystem::path& source) {
+    if (source.extension() != ".hlsl") {
+        return "";
+    }
+
+    std::string stage = source.stem().extension().string();
+    const char* stages[][2] = {
+        {".vert", "vertex"}, {".frag", "fragment"}, {".comp", "compute"},
+        {".geom", "geometry"}, {".tesc", "tesscontrol"}, {".tese", "tesseval"},
+    };
+
+    for (const auto& entry : stages) {
+        if (stage == entry[0]) {
+            return std::string(" -fshader-stage=") + entry[1];
+        }
+    }
+    return "";
+}
+
+ShaderLibrary::ShaderLibrary(VkDevice device, PipelineCache& pipelines, const ShaderLibraryConfig& config)
+    : m_device(device), m_pipeline_cache(pipelines), m_config(config) {
+    if (m_config.source_dir.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(m_config.source_dir, error)) {
+        std::cout << "Shader sources not found at " << m_config.source_dir << ", hot reload disabled\n";
+        m_config.source_dir.clear();
+        return;
+    }
+
+    std::filesystem::create_directories(m_config.cache_dir, error);
+    m_thread = std::thread(&ShaderLibrary::watch_main, this);
+}
+
+ShaderLibrary::~ShaderLibrary() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    for (auto& replacement : m_replacements) {
+        vkDestroyPipeline(m_device, replacement.pipeline, m_pipeline_cache.host_allocator());
+    }
+
+    for (auto& retired : m_retired) {
+        vkDestroyPipeline(m_device, retired.pipeline, m_pipeline_cache.host_allocator());
+    }
+
+    for (auto& pipeline : m_pipelines) {
+        vkDestroyPipeline(m_device, pipeline.current, m_pipeline_cache.host_allocator());
+    }
+}
+
+ShaderHandle ShaderLibrary::add_shader(const std::string& file, const uint32_t* fallback, size_t fallback_size) {
+    Shader shader;
+    shader.file = file;
+
+    if (!m_config.source_dir.empty()) {
+        std::error_code error;
+        shader.source = std::filesystem::path(m_config.source_dir) / file;
+        shader.modified = std::filesystem::last_write_time(shader.source, error);
+    }
+
+    if (m_config.spirv_dir.empty() || !read_spirv(std::filesystem::path(m_config.spirv_dir) / (file + ".spv"), shader.spirv)) {
+        shader.spirv.assign(fallback, fallback + fallback_size / sizeof(uint32_t));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shaders.push_back(std::move(shader));
+    return (ShaderHandle)m_shaders.size() - 1;
+}
+
+PipelineHandle ShaderLibrary::add_pipeline(const std::vector<ShaderHandle>& shaders, PipelineBuilder builder) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Pipeline pipeline;
+    pipeline.shaders = shaders;
+    pipeline.builder = std::move(builder);
+
+    std::vector<const std::vector<uint32_t>*> spirv;
+    for (ShaderHandle shader : shaders) {
+        spirv.push_back(&m_shaders[shader].spirv);
+        pipeline.built_versions.push_back(m_shaders[shader].version);
+    }
+
+    pipeline.current = build(pipeline, spirv);
+    m_pipelines.push_back(std::move(pipeline));
+    return (PipelineHandle)m_pipelines.size() - 1;
+}
+
+VkPipeline ShaderLibrary::build(const Pipeline& pipeline, const std::vector<const std::vector<uint32_t>*>& spirv) {
+    std::vector<VkShaderModule> modules;
+
+    for (const auto* code : spirv) {
+        VkShaderModuleCreateInfo module_info = {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .codeSize = code->size() * sizeof(uint32_t),
+            .pCode = code->data(),
+        };
+
+        VkShaderModule module;
+        if (vkCreateShaderModule(m_device, &module_info, m_pipeline_cache.host_allocator(), &module) != VK_SUCCESS) {
+            for (auto created : modules) {
+                vkDestroyShaderModule(m_device, created, m_pipeline_cache.host_allocator());
+            }
+            throw std::runtime_error("Failed to create shader module");
+        }
+        modules.push_back(module);
+    }
+
+    VkPipeline result = VK_NULL_HANDLE;
+    try {
+        result = pipeline.builder(m_pipeline_cache, modules);
+    } catch (...) {
+        for (auto module : modules) {
+            vkDestroyShaderModule(m_device, module, m_pipeline_cache.host_allocator());
+        }
+        throw;
+    }
+
+    for (auto module : modules) {
+        vkDestroyShaderModule(m_device, module, m_pipeline_cache.host_allocator());
+    }
+    return result;
+}
+
+void ShaderLibrary::begin_frame(uint64_t frame_number) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& replacement : m_replacements) {
+            Pipeline& pipeline = m_pipelines[replacement.handle];
+            m_retired.push_back({pipeline.current, frame_number + m_config.frames_in_flight});
+            pipeline.current = replacement.pipeline;
+        }
+        m_replacements.clear();
+    }
+
+    auto it = m_retired.begin();
+    while (it != m_retired.end()) {
+        if (frame_number >= it->retire_frame) {
+            vkDestroyPipeline(m_device, it->pipeline, m_pipeline_cache.host_allocator());
+            it = m_retired.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ShaderLibrary::watch_main() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(SHADER_POLL_INTERVAL_MS), [this] { return m_stop; });
+        if (m_stop) {
+            break;
+        }
+
+        lock.unlock();
+        poll_sources();
+        rebuild_pipelines();
+        lock.lock();
+    }
+}
+
+void ShaderLibrary::poll_sources() {
+    std::vector<ShaderHandle> changed;
+    std::vector<Shader> sources;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t i = 0; i < m_shaders.size(); i++) {
+            std::error_code error;
+            auto modified = std::filesystem::last_write_time(m_shaders[i].source, error);
+            if (!error && modified != m_shaders[i].modified) {
+                m_shaders[i].modified = modified;
+                changed.push_back(i);
+                sources.push_back({m_shaders[i].file, m_shaders[i].source});
+            }
+        }
+    }
+
+    // A failed compile keeps the last good SPIR-V; the next save retries
+    for (size_t i = 0; i < changed.size(); i++) {
+        std::vector<uint32_t> spirv;
+        if (compile(sources[i], spirv)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_shaders[changed[i]].spirv = std::move(spirv);
+            m_shaders[changed[i]].version++;
+        }
+    }
+}
+
+void ShaderLibrary::rebuild_pipelines() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (uint32_t handle = 0; handle < m_pipelines.size(); handle++) {
+        const Pipeline& pipeline = m_pipelines[handle];
+
+        std::vector<uint32_t> versions;
+        for (ShaderHandle shader : pipeline.shaders) {
+            versions.push_back(m_shaders[shader].version);
+        }
+        if (versions == pipeline.built_versions) {
+            continue;
+        }
+
+        // Copies, so the build runs unlocked while add_shader/add_pipeline may grow the vectors
+        Pipeline snapshot = {pipeline.shaders, pipeline.builder, versions};
+        std::vector<std::vector<uint32_t>> code;
+        for (ShaderHandle shader : pipeline.shaders) {
+            code.push_back(m_shaders[shader].spirv);
+        }
+        std::vector<const std::vector<uint32_t>*> spirv;
+        for (const auto& words : code) {
+            spirv.push_back(&words);
+        }
+
+        lock.unlock();
+        VkPipeline rebuilt = VK_NULL_HANDLE;
+        try {
+            rebuilt = build(snapshot, spirv);
+        } catch (const std::exception& e) {
+            std::cerr << "Pipeline rebuild failed: " << e.what() << "\n";
+        }
+        lock.lock();
+
+        m_pipelines[handle].built_versions = versions;
+        if (rebuilt != VK_NULL_HANDLE) {
+            m_replacements.push_back({handle, rebuilt});
+            m_stats.pipelines_rebuilt++;
+        } else {
+            m_stats.failures++;
+        }
+    }
+}
+
+bool ShaderLibrary::compile(const Shader& shader, std::vector<uint32_t>& spirv) {
+    using clock = std::chrono::steady_clock;
+
+    std::ifstream file(shader.source, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file && !file.eof()) {
+        return false;
+    }
+
+    // Only the file's own text is hashed; edits to #included files need the includer touched too
+    std::string args = std::string(SHADER_COMPILE_ARGS) + stage_args(shader.source);
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash_text(text, hash_text(args)));
+    std::filesystem::path cached = std::filesystem::path(m_config.cache_dir) / (std::string(name) + ".spv");
+
+    if (read_spirv(cached, spirv)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.cache_hits++;
+        return true;
+    }
+
+    std::filesystem::path temporary = cached;
+    temporary += ".tmp";
+    std::string command = "\"" + m_config.compiler + "\" " + args + " -o \"" + temporary.string() + "\" \"" + shader.source.string() + "\"";
+
+    auto start = clock::now();
+    int status = std::system(command.c_str());
+    double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::error_code error;
+    if (status != 0 || !read_spirv(temporary, spirv)) {
+        std::filesystem::remove(temporary, error);
+        std::cerr << "Shader compile failed: " << shader.file << "\n";
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.failures++;
+        return false;
+    }
+
+    std::filesystem::rename(temporary, cached, error);
+    std::cout << "Recompiled " << shader.file << " in " << ms << " ms\n";
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.compiled++;
+    m_stats.compile_ms += ms;
+    m_stats.max_compile_ms = std::max(m_stats.max_compile_ms, ms);
+    return true;
+}
+
+ShaderLibraryStats ShaderLibrary::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ShaderLibrary::report() const {
+    ShaderLibraryStats stats = this->stats();
+
+    std::cout << "Shaders: " << m_shaders.size() << " shaders, " << m_pipelines.size() << " pipelines, hot reload "
+              << (hot_reload() ? "on" : "off") << "\n";
+    if (stats.compiled + stats.cache_hits + stats.failures > 0) {
+        std::cout << "  compiled " << stats.compiled << " (avg " << stats.compile_ms / std::max<uint32_t>(stats.compiled, 1) << " ms, max "
+                  << stats.max_compile_ms << " ms), cache hits " << stats.cache_hits << ", failures " << stats.failures
+                  << ", pipelines rebuilt " << stats.pipelines_rebuilt << "\n";
+    }
+}
@@ -0,0 +1,114 @@
+#include "present/present_policy.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+// Left to spin rather than sleep under Balanced and LowLatency; covers typical timer slack on Linux
+// without keeping a core busy for most of a 1 ms tick
+const std::chrono::microseconds PACER_SPIN_MARGIN(200);
+
+PresentPolicy parse_present_policy(const std::string& name) {
+    if (name == "balanced") return PresentPolicy::Balanced;
+    if (name == "low-latency") return PresentPolicy::LowLatency;
+    if (name == "power-saving") return PresentPolicy::PowerSaving;
+    if (name == "relaxed") return PresentPolicy::Relaxed;
+
+    throw std::runtime_error("Unknown present policy: " + name + " (expected balanced, low-latency, power-saving or relaxed)");
+}
+
+const char* present_policy_name(PresentPolicy policy) {
+    switch (policy) {
+    case PresentPolicy::LowLatency:
+        return "low-latency";
+    case PresentPolicy::PowerSaving:
+        return "power-saving";
+    case PresentPolicy::Relaxed:
+        return "relaxed";
+    default:
+        return "balanced";
+    }
+}
+
+const char* present_mode_name(VkPresentModeKHR mode) {
+    switch (mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "IMMEDIATE";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "MAILBOX";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "FIFO_RELAXED";
+    default:
+        return "other";
+    }
+}
+
+VkPresentModeKHR choose_present_mode(PresentPolicy policy, const std::vector<VkPresentModeKHR>& available_modes) {
+    std::vector<VkPresentModeKHR> preferred;
+    switch (policy) {
+    case PresentPolicy::Balanced:
+        preferred = {VK_PRESENT_MODE_MAILBOX_KHR};
+        break;
+    case PresentPolicy::LowLatency:
+        preferred = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+        break;
+    case PresentPolicy::PowerSaving:
+        break;
+    case PresentPolicy::Relaxed:
+        preferred = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+        break;
+    }
+
+    for (VkPresentModeKHR mode : preferred) {
+        if (std::find(available_modes.begin(), available_modes.end(), mode) != available_modes.end()) {
+            return mode;
+        }
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t choose_image_count(PresentPolicy policy, VkPresentModeKHR mode, const VkSurfaceCapabilitiesKHR& capabilities) {
+    uint32_t image_count = capabilities.minImageCount + 1;
+    if (policy == PresentPolicy::LowLatency && mode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+        image_count = capabilities.minImageCount;
+    }
+
+    if (capabilities.maxImageCount > 0) {
+        image_count = std::min(image_count, capabilities.maxImageCount);
+    }
+    return image_count;
+}
+
+FramePacer::FramePacer(double target_fps, PresentPolicy policy) {
+    if (target_fps > 0.0) {
+        m_interval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / target_fps));
+    }
+
+    if (policy == PresentPolicy::Balanced || policy == PresentPolicy::LowLatency) {
+        m_spin_margin = PACER_SPIN_MARGIN;
+    }
+}
+
+double FramePacer::wait() {
+    if (!enabled()) {
+        return 0.0;
+    }
+
+    auto start = clock::now();
+    if (m_next_frame.time_since_epoch().count() == 0 || start >= m_next_frame) {
+        m_next_frame = start + m_interval;
+        return 0.0;
+    }
+
+    if (m_next_frame - start > m_spin_margin) {
+        std::this_thread::sleep_until(m_next_frame - m_spin_margin);
+    }
+    while (clock::now() < m_next_frame) {
+        std::this_thread::yield();
+    }
+
+    auto end = clock::now();
+    m_next_frame += m_interval;
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
@@ -0,0 +1,360 @@
+#include "profiler/profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+const uint32_t INVALID_GPU_SCOPE = UINT32_MAX;
+
+const VkQueryPipelineStatisticFlags PIPELINE_STATISTICS_FLAGS =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+Profiler::Profiler(VkPhysicalDevice physical_device, VkDevice device, VkQueue queue, uint32_t queue_family, uint32_t frame_count,
+                   bool pipeline_statistics, uint32_t max_gpu_scopes, const VkAllocationCallbacks* host_allocator)
+    : m_device(device), m_host_allocator(host_allocator), m_max_gpu_scopes(max_gpu_scopes), m_epoch(clock::now()) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    m_timestamp_period_ns = properties.limits.timestampPeriod;
+
+    uint32_t queue_family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_families.data());
+
+    uint32_t valid_bits = queue_families[queue_family].timestampValidBits;
+    if (valid_bits > 0) {
+        m_timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (1ull << valid_bits) - 1;
+    } else {
+        std::cout << "Profiler: queue family " << queue_family << " has no timestamp support, GPU scopes disabled\n";
+    }
+
+    if (pipeline_statistics) {
+        m_statistics_flags = PIPELINE_STATISTICS_FLAGS;
+    }
+
+    m_frames.resize(frame_count);
+    for (auto& frame : m_frames) {
+        frame.names.resize(m_max_gpu_scopes);
+
+        if (m_timestamp_mask != 0) {
+            VkQueryPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = m_max_gpu_scopes * 2,
+            };
+
+            if (vkCreateQueryPool(m_device, &pool_info, m_host_allocator, &frame.timestamps) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create timestamp query pool");
+            }
+        }
+
+        if (m_statistics_flags != 0) {
+            VkQueryPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                .queryCount = MAX_STATISTICS_QUERIES,
+                .pipelineStatistics = m_statistics_flags,
+            };
+
+            if (vkCreateQueryPool(m_device, &pool_info, m_host_allocator, &frame.statistics) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create pipeline statistics query pool");
+            }
+        }
+    }
+
+    if (m_timestamp_mask != 0) {
+        calibrate(queue, queue_family);
+    }
+}
+
+Profiler::~Profiler() {
+    for (auto& frame : m_frames) {
+        if (frame.timestamps != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(m_device, frame.timestamps, m_host_allocator);
+        }
+        if (frame.statistics != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(m_device, frame.statistics, m_host_allocator);
+        }
+    }
+}
+
+double Profiler::now_us() const {
+    return std::chrono::duration<double, std::micro>(clock::now() - m_epoch).count();
+}
+
+double Profiler::gpu_ticks_to_us(uint64_t ticks) const {
+    return (double)(ticks & m_timestamp_mask) * m_timestamp_period_ns / 1000.0;
+}
+
+// Writes one timestamp and pins it to the midpoint of the CPU submit/wait window. Good to within
+// the submit latency, which is plenty for lining scopes up in a trace viewer.
+void Profiler::calibrate(VkQueue queue, uint32_t queue_family) {
+    VkCommandPoolCreateInfo pool_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queue_family,
+    };
+
+    VkCommandPool command_pool;
+    if (vkCreateCommandPool(m_device, &pool_info, m_host_allocator, &command_pool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create profiler command pool");
+    }
+
+    VkCommandBufferAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    VkCommandBuffer command_buffer;
+    vkAllocateCommandBuffers(m_device, &alloc_info, &command_buffer);
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    VkQueryPool pool = m_frames[0].timestamps;
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+    vkCmdResetQueryPool(command_buffer, pool, 0, 1);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, 0);
+    vkEndCommandBuffer(command_buffer);
+
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+    };
+
+    VkFence fence;
+    vkCreateFence(m_device, &fence_info, m_host_allocator, &fence);
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &command_buffer,
+    };
+
+    double cpu_before = now_us();
+    if (vkQueueSubmit(queue, 1, &submit_info, fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit profiler calibration");
+    }
+    vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+    double cpu_after = now_us();
+
+    uint64_t ticks = 0;
+    vkGetQueryPoolResults(m_device, pool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    m_gpu_offset_us = (cpu_before + cpu_after) * 0.5 - gpu_ticks_to_us(ticks);
+
+    vkDestroyFence(m_device, fence, m_host_allocator);
+    vkDestroyCommandPool(m_device, command_pool, m_host_allocator);
+}
+
+void Profiler::add_total(std::unordered_map<const char*, ScopeTotals>& totals, const char* name, double ms) {
+    ScopeTotals& total = totals[name];
+    total.total_ms += ms;
+    total.max_ms = std::max(total.max_ms, ms);
+    total.count++;
+}
+
+void Profiler::resolve(FrameQueries& frame) {
+    if (!frame.recorded) {
+        return;
+    }
+    frame.recorded = false;
+
+    if (frame.scope_count > 0) {
+        std::vector<uint64_t> ticks(frame.scope_count * 2);
+        VkResult result = vkGetQueryPoolResults(m_device, frame.timestamps, 0, frame.scope_count * 2, ticks.size() * sizeof(uint64_t),
+                                                ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+        // The slot's fence has signalled so this never waits; NOT_READY means the frame was never submitted
+        if (result == VK_SUCCESS) {
+            for (uint32_t i = 0; i < frame.scope_count; i++) {
+                double start_us = gpu_ticks_to_us(ticks[i * 2]) + m_gpu_offset_us;
+                double duration_us = gpu_ticks_to_us(ticks[i * 2 + 1] - ticks[i * 2]);
+
+                add_total(m_gpu_totals, frame.names[i], duration_us / 1000.0);
+                push_event({frame.names[i], true, start_us, duration_us});
+            }
+        }
+    }
+
+    if (frame.statistics_count > 0) {
+        std::vector<PipelineStatistics> batches(frame.statistics_count);
+        VkResult result = vkGetQueryPoolResults(m_device, frame.statistics, 0, frame.statistics_count, batches.size() * sizeof(PipelineStatistics),
+                                                batches.data(), sizeof(PipelineStatistics), VK_QUERY_RESULT_64_BIT);
+
+        PipelineStatistics statistics = {};
+        for (const PipelineStatistics& batch : batches) {
+            statistics.input_assembly_vertices += batch.input_assembly_vertices;
+            statistics.vertex_invocations += batch.vertex_invocations;
+            statistics.fragment_invocations += batch.fragment_invocations;
+            statistics.compute_invocations += batch.compute_invocations;
+        }
+
+        if (result == VK_SUCCESS) {
+            m_last_statistics = statistics;
+            if (m_statistics.size() < m_max_events) {
+                m_statistics.push_back({now_us(), statistics});
+            } else if (m_max_events > 0) {
+                m_statistics[m_next_statistics] = {now_us(), statistics};
+                m_next_statistics = (m_next_statistics + 1) % m_max_events;
+            }
+        }
+    }
+}
+
+void Profiler::begin_frame(uint32_t frame_index) {
+    m_frame_index = frame_index;
+    resolve(m_frames[frame_index]);
+}
+
+// resolve() clears recorded, so the first call after begin_frame is the frame's first command buffer
+void Profiler::begin_commands(VkCommandBuffer command_buffer) {
+    FrameQueries& frame = m_frames[m_frame_index];
+
+    if (!frame.recorded) {
+        frame.scope_count = 0;
+        frame.statistics_count = 0;
+        frame.recorded = true;
+
+        if (frame.timestamps != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(command_buffer, frame.timestamps, 0, m_max_gpu_scopes * 2);
+        }
+        if (frame.statistics != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(command_buffer, frame.statistics, 0, MAX_STATISTICS_QUERIES);
+        }
+    }
+
+    frame.statistics_open = frame.statistics != VK_NULL_HANDLE && frame.statistics_count < MAX_STATISTICS_QUERIES;
+    if (frame.statistics_open) {
+        vkCmdBeginQuery(command_buffer, frame.statistics, frame.statistics_count, 0);
+    }
+}
+
+void Profiler::end_commands(VkCommandBuffer command_buffer) {
+    FrameQueries& frame = m_frames[m_frame_index];
+
+    if (frame.statistics_open) {
+        vkCmdEndQuery(command_buffer, frame.statistics, frame.statistics_count++);
+        frame.statistics_open = false;
+    }
+}
+
+uint32_t Profiler::begin_gpu_scope(VkCommandBuffer command_buffer, const char* name) {
+    FrameQueries& frame = m_frames[m_frame_index];
+    if (frame.timestamps == VK_NULL_HANDLE || frame.scope_count == m_max_gpu_scopes) {
+        return INVALID_GPU_SCOPE;
+    }
+
+    uint32_t scope = frame.scope_count++;
+    frame.names[scope] = name;
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.timestamps, scope * 2);
+    return scope;
+}
+
+void Profiler::end_gpu_scope(VkCommandBuffer command_buffer, uint32_t scope) {
+    if (scope == INVALID_GPU_SCOPE) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_frames[m_frame_index].timestamps, scope * 2 + 1);
+}
+
+void Profiler::end_cpu_scope(const char* name, double start_us) {
+    double duration_us = now_us() - start_us;
+    add_total(m_cpu_totals, name, duration_us / 1000.0);
+    push_event({name, false, start_us, duration_us});
+}
+
+void Profiler::enable_trace(size_t max_events) {
+    m_max_events = max_events;
+    m_events.reserve(std::min<size_t>(m_max_events, 64 * 1024));
+}
+
+void Profiler::push_event(const TraceEvent& event) {
+    if (m_events.size() < m_max_events) {
+        m_events.push_back(event);
+    } else if (m_max_events > 0) {
+        m_events[m_next_event] = event;
+        m_next_event = (m_next_event + 1) % m_max_events;
+        m_overwritten_events++;
+    }
+}
+
+void Profiler::report() const {
+    // The same name can be a different literal in each translation unit; merge them for printing
+    auto print = [](const char* label, const std::unordered_map<const char*, ScopeTotals>& scopes) {
+        std::map<std::string, ScopeTotals> totals;
+        for (const auto& [name, scope] : scopes) {
+            ScopeTotals& total = totals[name];
+            total.total_ms += scope.total_ms;
+            total.max_ms = std::max(total.max_ms, scope.max_ms);
+            total.count += scope.count;
+        }
+
+        for (const auto& [name, total] : totals) {
+            std::cout << "  " << label << " " << name << ": avg " << total.total_ms / total.count << " ms, max "
+                      << total.max_ms << " ms over " << total.count << "\n";
+        }
+    };
+
+    std::cout << "Profiler:\n";
+    print("cpu", m_cpu_totals);
+    print("gpu", m_gpu_totals);
+
+    if (m_last_statistics) {
+        const PipelineStatistics& last = *m_last_statistics;
+        std::cout << "  last frame: " << last.input_assembly_vertices << " vertices, " << last.vertex_invocations << " vs, "
+                  << last.fragment_invocations << " fs, " << last.compute_invocations << " cs invocations\n";
+    }
+
+    if (m_overwritten_events > 0) {
+        std::cout << "  trace buffer wrapped, only the last " << m_events.size() << " events are kept\n";
+    }
+}
+
+static void write_json_string(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+// Chrome trace event format, loadable in chrome://tracing and Perfetto
+void Profiler::export_chrome_trace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open trace file " + path);
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    for (size_t i = 0; i < m_events.size(); i++) {
+        const TraceEvent& event = m_events[(m_next_event + i) % m_events.size()];
+        out << ",\n{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1) << ",\"ts\":" << event.start_us
+            << ",\"dur\":" << event.duration_us << "}";
+    }
+
+    for (size_t i = 0; i < m_statistics.size(); i++) {
+        const StatisticsSample& sample = m_statistics[(m_next_statistics + i) % m_statistics.size()];
+        const PipelineStatistics& s = sample.statistics;
+        out << ",\n{\"name\":\"pipeline statistics\",\"ph\":\"C\",\"pid\":1,\"ts\":" << sample.timestamp_us
+            << ",\"args\":{\"vertices\":" << s.input_assembly_vertices << ",\"vs\":" << s.vertex_invocations
+            << ",\"fs\":" << s.fragment_invocations << ",\"cs\":" << s.compute_invocations << "}}";
+    }
+
+    out << "\n]}\n";
+    std::cout << "Wrote trace " << path << " (" << m_events.size() << " events)\n";
+}
@@ -0,0 +1,602 @@
+#include "render/gpu_scene.h"
+#include "math/math.h"
+#include "pipeline/builtin_shaders.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// Push constant blocks, laid out as the shaders declare them
+typedef struct CullConstants {
+    float planes[6][4];
+    uint32_t object_count;
+    uint32_t bounds;
+    uint32_t mesh_ids;
+    uint32_t meshes;
+    uint32_t commands;
+    uint32_t count;
+} CullConstants;
+
+typedef struct DrawConstants {
+    float view_proj[16];
+    uint32_t transforms;
+    uint32_t colors;
+} DrawConstants;
+
+static_assert(sizeof(CullConstants) <= BINDLESS_PUSH_CONSTANT_SIZE, "cull constants exceed the push constant range");
+static_assert(sizeof(DrawConstants) <= BINDLESS_PUSH_CONSTANT_SIZE, "draw constants exceed the push constant range");
+
+// Bounding radius of each mesh at scale 1
+static const float mesh_radii[SCENE_MESH_COUNT] = {0.8660254f, 1.0f, 1.0f};
+
+static uint32_t next_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static float random_float(uint32_t& state) {
+    return (float)(next_random(state) >> 8) / (float)(1u << 24);
+}
+
+const char* render_path_name(RenderPath path) {
+    switch (path) {
+    case RenderPath::Dynamic:
+        return "dynamic rendering";
+    case RenderPath::Classic:
+        return "render pass + framebuffers";
+    }
+    return "unknown";
+}
+
+// Roughly one object per 4x4x4 cell
+float scene_half_extent(uint32_t count) {
+    return 2.0f * std::cbrt((float)std::max(count, 1u));
+}
+
+std::vector<SceneObject> generate_scene_objects(uint32_t count, uint32_t seed) {
+    float half_extent = scene_half_extent(count);
+    uint32_t state = seed ? seed : 1;
+
+    std::vector<SceneObject> objects(count);
+    for (auto& object : objects) {
+        for (float& coordinate : object.position) {
+            coordinate = (random_float(state) * 2.0f - 1.0f) * half_extent;
+        }
+        object.scale = 0.25f + random_float(state) * 0.75f;
+        object.mesh = (SceneMesh)(next_random(state) % SCENE_MESH_COUNT);
+        object.color = next_random(state) | 0xff000000;
+    }
+
+    return objects;
+}
+
+GpuScene::GpuScene(VkPhysicalDevice physical_device, VkDevice device, DeviceAllocator& allocator, BindlessTable& bindless, ShaderLibrary& shaders,
+                   VkFormat color_format, uint32_t max_objects, const std::vector<uint32_t>& queue_families, RenderPath render_path)
+    : m_device(device), m_allocator(allocator), m_bindless(bindless), m_shaders(shaders), m_max_objects(max_objects), m_render_path(render_path) {
+    for (uint32_t family : queue_families) {
+        if (std::find(m_queue_families.begin(), m_queue_families.end(), family) == m_queue_families.end()) {
+            m_queue_families.push_back(family);
+        }
+    }
+    if (m_queue_families.size() < 2) {
+        m_queue_families.clear();
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    m_stats.max_draws = std::min(max_objects, properties.limits.maxDrawIndirectCount);
+
+    build_meshes();
+
+    m_vertices = create_buffer(m_vertex_data.size() * sizeof(float), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, false);
+    m_indices = create_buffer(m_index_data.size() * sizeof(uint16_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, false);
+    m_meshes = create_buffer(sizeof(m_mesh_ranges), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true);
+
+    for (uint32_t array = 0; array < STREAM_ARRAY_COUNT; array++) {
+        m_arrays[array] = create_buffer(max_objects * stream_stride(array), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true);
+    }
+
+    m_commands = create_buffer(max_objects * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, true);
+    m_count = create_buffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, true);
+
+    if (m_render_path == RenderPath::Classic) {
+        create_render_pass(color_format);
+    }
+    create_pipelines(color_format);
+}
+
+GpuScene::~GpuScene() {
+    if (m_render_pass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(m_device, m_render_pass, m_allocator.host_allocator());
+    }
+    destroy_buffer(m_vertices);
+    destroy_buffer(m_indices);
+    destroy_buffer(m_meshes);
+    for (auto& buffer : m_arrays) {
+        destroy_buffer(buffer);
+    }
+    destroy_buffer(m_commands);
+    destroy_buffer(m_count);
+}
+
+GpuScene::SceneBuffer GpuScene::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, bool bindless) {
+    SceneBuffer result;
+
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = std::max<VkDeviceSize>(size, 16),
+        .usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = m_queue_families.empty() ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT,
+        .queueFamilyIndexCount = (uint32_t)m_queue_families.size(),
+        .pQueueFamilyIndices = m_queue_families.data(),
+    };
+
+    if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &result.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create scene buffer");
+    }
+
+    result.memory = m_allocator.allocate_buffer(result.buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (bindless) {
+        result.slot = m_bindless.add_storage_buffer(result.buffer);
+    }
+
+    m_stats.device_bytes += buffer_info.size;
+    return result;
+}
+
+void GpuScene::destroy_buffer(SceneBuffer& buffer) {
+    if (buffer.slot != BINDLESS_INVALID_SLOT) {
+        m_bindless.release(BindlessKind::StorageBuffer, buffer.slot);
+    }
+    vkDestroyBuffer(m_device, buffer.buffer, m_allocator.host_allocator());
+    m_allocator.free(buffer.memory);
+    buffer = {};
+}
+
+void GpuScene::build_meshes() {
+    auto add_mesh = [this](SceneMesh mesh, const std::vector<float>& vertices, const std::vector<uint16_t>& indices) {
+        m_mesh_ranges[(uint32_t)mesh] = {
+            .index_count = (uint32_t)indices.size(),
+            .first_index = (uint32_t)m_index_data.size(),
+            .vertex_offset = (uint32_t)(m_vertex_data.size() / 3),
+        };
+        m_vertex_data.insert(m_vertex_data.end(), vertices.begin(), vertices.end());
+        m_index_data.insert(m_index_data.end(), indices.begin(), indices.end());
+    };
+
+    add_mesh(SceneMesh::Cube,
+             {-0.5f, -0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f,
+              -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f},
+             {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4, 3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5});
+
+    add_mesh(SceneMesh::Octahedron,
+             {1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f},
+             {0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4, 2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5});
+
+    const float t = 0.5773503f;
+    add_mesh(SceneMesh::Tetrahedron,
+             {t, t, t, t, -t, -t, -t, t, -t, -t, -t, t},
+             {0, 1, 2, 0, 3, 1, 0, 2, 3, 1, 3, 2});
+}
+
+// Same load/store ops and layouts as the dynamic rendering attachments. The caller has both in those
+// layouts before the pass starts and orders it with its own barriers, as it does for dynamic
+// rendering, so the pass needs no transitions or external dependencies.
+void GpuScene::create_render_pass(VkFormat color_format) {
+    VkAttachmentDescription attachments[] = {
+        {
+            .format = color_format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        },
+        {
+            .format = SCENE_DEPTH_FORMAT,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        },
+    };
+
+    VkAttachmentReference color_reference = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    VkAttachmentReference depth_reference = {1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+    VkSubpassDescription subpass = {
+        .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &color_reference,
+        .pDepthStencilAttachment = &depth_reference,
+    };
+
+    VkRenderPassCreateInfo render_pass_info = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        .attachmentCount = 2,
+        .pAttachments = attachments,
+        .subpassCount = 1,
+        .pSubpasses = &subpass,
+    };
+
+    if (vkCreateRenderPass(m_device, &render_pass_info, m_allocator.host_allocator(), &m_render_pass) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create scene render pass");
+    }
+}
+
+void GpuScene::create_pipelines(VkFormat color_format) {
+    VkPipelineLayout layout = m_bindless.pipeline_layout();
+    VkRenderPass render_pass = m_render_pass;
+
+    ShaderHandle cull_shader = m_shaders.add_shader("scene_cull.comp", scene_cull_spirv, sizeof(scene_cull_spirv));
+    ShaderHandle vertex_shader = m_shaders.add_shader("scene.vert", scene_vertex_spirv, sizeof(scene_vertex_spirv));
+    ShaderHandle fragment_shader = m_shaders.add_shader("scene.frag", scene_fragment_spirv, sizeof(scene_fragment_spirv));
+
+    m_cull_pipeline = m_shaders.add_pipeline({cull_shader}, [layout](PipelineCache& cache, const std::vector<VkShaderModule>& modules) {
+        VkComputePipelineCreateInfo cull_info = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = modules[0],
+                .pName = "main",
+            },
+            .layout = layout,
+        };
+
+        return cache.create_compute_pipeline(cull_info);
+    });
+
+    m_draw_pipeline = m_shaders.add_pipeline({vertex_shader, fragment_shader}, [layout, color_format, render_pass](PipelineCache& cache, const std::vector<VkShaderModule>& modules) {
+        VkPipelineShaderStageCreateInfo stages[] = {
+            {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = modules[0],
+                .pName = "main",
+            },
+            {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = modules[1],
+                .pName = "main",
+            },
+        };
+
+        VkVertexInputBindingDescription vertex_binding = {
+            .binding = 0,
+            .stride = 3 * sizeof(float),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        };
+
+        VkVertexInputAttributeDescription position_attribute = {
+            .location = 0,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32_SFLOAT,
+            .offset = 0,
+        };
+
+        VkPipelineVertexInputStateCreateInfo vertex_input = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .vertexBindingDescriptionCount = 1,
+            .pVertexBindingDescriptions = &vertex_binding,
+            .vertexAttributeDescriptionCount = 1,
+            .pVertexAttributeDescriptions = &position_attribute,
+        };
+
+        VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        };
+
+        VkPipelineViewportStateCreateInfo viewport_state = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+            .viewportCount = 1,
+            .scissorCount = 1,
+        };
+
+        // The projection flips y, so winding flips with it; the meshes are closed and cheap enough to skip culling
+        VkPipelineRasterizationStateCreateInfo rasterization = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+            .polygonMode = VK_POLYGON_MODE_FILL,
+            .cullMode = VK_CULL_MODE_NONE,
+            .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+            .lineWidth = 1.0f,
+        };
+
+        VkPipelineMultisampleStateCreateInfo multisample = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        };
+
+        VkPipelineDepthStencilStateCreateInfo depth_stencil = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .depthTestEnable = VK_TRUE,
+            .depthWriteEnable = VK_TRUE,
+            .depthCompareOp = VK_COMPARE_OP_LESS,
+        };
+
+        VkPipelineColorBlendAttachmentState blend_attachment = {
+            .blendEnable = VK_FALSE,
+            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        };
+
+        VkPipelineColorBlendStateCreateInfo color_blend = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+            .attachmentCount = 1,
+            .pAttachments = &blend_attachment,
+        };
+
+        VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+        VkPipelineDynamicStateCreateInfo dynamic_state = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = 2,
+            .pDynamicStates = dynamic_states,
+        };
+
+        // Ignored when the pipeline is built against the classic render pass
+        VkPipelineRenderingCreateInfo rendering_info = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &color_format,
+            .depthAttachmentFormat = SCENE_DEPTH_FORMAT,
+        };
+
+        VkGraphicsPipelineCreateInfo draw_info = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = render_pass == VK_NULL_HANDLE ? &rendering_info : nullptr,
+            .stageCount = 2,
+            .pStages = stages,
+            .pVertexInputState = &vertex_input,
+            .pInputAssemblyState = &input_assembly,
+            .pViewportState = &viewport_state,
+            .pRasterizationState = &rasterization,
+            .pMultisampleState = &multisample,
+            .pDepthStencilState = &depth_stencil,
+            .pColorBlendState = &color_blend,
+            .pDynamicState = &dynamic_state,
+            .layout = layout,
+            .renderPass = render_pass,
+            .subpass = 0,
+        };
+
+        return cache.create_graphics_pipeline(draw_info);
+    });
+}
+
+void GpuScene::set_objects(const std::vector<SceneObject>& objects) {
+    if (objects.size() > m_max_objects) {
+        throw std::runtime_error("Scene has more objects than its buffers hold");
+    }
+
+    uint32_t count = (uint32_t)objects.size();
+    m_bounds.resize(count * 4);
+    m_transforms.resize(count * 4);
+    m_colors.resize(count);
+    m_mesh_ids.resize(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const SceneObject& object = objects[i];
+        std::memcpy(&m_bounds[i * 4], object.position, sizeof(object.position));
+        m_bounds[i * 4 + 3] = object.scale * mesh_radii[(uint32_t)object.mesh];
+        std::memcpy(&m_transforms[i * 4], object.position, sizeof(object.position));
+        m_transforms[i * 4 + 3] = object.scale;
+        m_colors[i] = object.color;
+        m_mesh_ids[i] = (uint32_t)object.mesh;
+    }
+
+    std::fill(std::begin(m_stream_cursor), std::end(m_stream_cursor), 0);
+    m_stats.object_count = count;
+    m_stats.resident_count = 0;
+}
+
+VkDeviceSize GpuScene::stream_stride(uint32_t array) const {
+    return array == STREAM_BOUNDS || array == STREAM_TRANSFORMS ? 4 * sizeof(float) : sizeof(uint32_t);
+}
+
+const void* GpuScene::stream_data(uint32_t array, uint32_t first) const {
+    switch (array) {
+    case STREAM_BOUNDS:
+        return &m_bounds[first * 4];
+    case STREAM_TRANSFORMS:
+        return &m_transforms[first * 4];
+    case STREAM_COLORS:
+        return &m_colors[first];
+    default:
+        return &m_mesh_ids[first];
+    }
+}
+
+bool GpuScene::stream(UploadManager& uploads) {
+    bool concurrent = !m_queue_families.empty();
+
+    if (!m_geometry_uploaded) {
+        if (!uploads.upload_buffer(m_vertices.buffer, 0, m_vertex_data.data(), m_vertex_data.size() * sizeof(float), concurrent) ||
+            !uploads.upload_buffer(m_indices.buffer, 0, m_index_data.data(), m_index_data.size() * sizeof(uint16_t), concurrent) ||
+            !uploads.upload_buffer(m_meshes.buffer, 0, m_mesh_ranges, sizeof(m_mesh_ranges), concurrent)) {
+            return false;
+        }
+        m_geometry_uploaded = true;
+    }
+
+    // Arrays advance independently; an object becomes resident once all four have passed it
+    bool staging_full = false;
+    while (!staging_full && m_stats.resident_count < m_stats.object_count) {
+        for (uint32_t array = 0; array < STREAM_ARRAY_COUNT && !staging_full; array++) {
+            uint32_t first = m_stream_cursor[array];
+            uint32_t count = std::min(SCENE_STREAM_CHUNK, m_stats.object_count - first);
+            if (count == 0) {
+                continue;
+            }
+
+            VkDeviceSize stride = stream_stride(array);
+            if (uploads.upload_buffer(m_arrays[array].buffer, first * stride, stream_data(array, first), count * stride, concurrent)) {
+                m_stream_cursor[array] += count;
+            } else {
+                staging_full = true;
+            }
+        }
+
+        m_stats.resident_count = *std::min_element(std::begin(m_stream_cursor), std::end(m_stream_cursor));
+    }
+
+    return m_stats.resident_count == m_stats.object_count;
+}
+
+void GpuScene::set_camera(const float eye[3], const float target[3], float fov_y, float aspect, float near_plane, float far_plane) {
+    Mat4 view = look_at({eye[0], eye[1], eye[2]}, {target[0], target[1], target[2]}, {0.0f, 1.0f, 0.0f});
+    Mat4 view_proj = multiply(perspective(fov_y, aspect, near_plane, far_plane), view);
+    std::memcpy(m_view_proj, view_proj.m, sizeof(m_view_proj));
+
+    Vec4 planes[6];
+    frustum_planes(view_proj, planes);
+    for (uint32_t i = 0; i < 6; i++) {
+        m_planes[i][0] = planes[i].x;
+        m_planes[i][1] = planes[i].y;
+        m_planes[i][2] = planes[i].z;
+        m_planes[i][3] = planes[i].w;
+    }
+}
+
+void GpuScene::record_reset(VkCommandBuffer command_buffer) const {
+    vkCmdFillBuffer(command_buffer, m_count.buffer, 0, sizeof(uint32_t), 0);
+}
+
+void GpuScene::record_cull(VkCommandBuffer command_buffer) const {
+    if (m_stats.resident_count == 0) {
+        return;
+    }
+
+    CullConstants constants = {
+        .object_count = m_stats.resident_count,
+        .bounds = m_arrays[STREAM_BOUNDS].slot,
+        .mesh_ids = m_arrays[STREAM_MESH_IDS].slot,
+        .meshes = m_meshes.slot,
+        .commands = m_commands.slot,
+        .count = m_count.slot,
+    };
+    std::memcpy(constants.planes, m_planes, sizeof(m_planes));
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_shaders.pipeline(m_cull_pipeline));
+    m_bindless.bind(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+    vkCmdPushConstants(command_buffer, m_bindless.pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), &constants);
+    vkCmdDispatch(command_buffer, (m_stats.resident_count + SCENE_CULL_WORKGROUP_SIZE - 1) / SCENE_CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuScene::begin_rendering(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent,
+                               VkFramebuffer framebuffer) const {
+    if (m_render_path == RenderPath::Classic) {
+        VkClearValue clear_values[2] = {};
+        clear_values[1].depthStencil = {1.0f, 0};
+
+        VkRenderPassBeginInfo render_pass_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass = m_render_pass,
+            .framebuffer = framebuffer,
+            .renderArea = {{0, 0}, extent},
+            .clearValueCount = 2,
+            .pClearValues = clear_values,
+        };
+
+        vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    } else {
+        VkRenderingAttachmentInfo color_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = color,
+            .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        };
+
+        VkRenderingAttachmentInfo depth_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = depth,
+            .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue = {.depthStencil = {1.0f, 0}},
+        };
+
+        VkRenderingInfo rendering_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .renderArea = {{0, 0}, extent},
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &color_attachment,
+            .pDepthAttachment = &depth_attachment,
+        };
+
+        vkCmdBeginRendering(command_buffer, &rendering_info);
+    }
+
+    VkViewport viewport = {0.0f, 0.0f, (float)extent.width, (float)extent.height, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, extent};
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+    DrawConstants constants = {
+        .transforms = m_arrays[STREAM_TRANSFORMS].slot,
+        .colors = m_arrays[STREAM_COLORS].slot,
+    };
+    std::memcpy(constants.view_proj, m_view_proj, sizeof(m_view_proj));
+
+    VkDeviceSize vertex_offset = 0;
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_shaders.pipeline(m_draw_pipeline));
+    m_bindless.bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    vkCmdPushConstants(command_buffer, m_bindless.pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants), &constants);
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &m_vertices.buffer, &vertex_offset);
+    vkCmdBindIndexBuffer(command_buffer, m_indices.buffer, 0, VK_INDEX_TYPE_UINT16);
+}
+
+void GpuScene::end_rendering(VkCommandBuffer command_buffer) const {
+    if (m_render_path == RenderPath::Classic) {
+        vkCmdEndRenderPass(command_buffer);
+    } else {
+        vkCmdEndRendering(command_buffer);
+    }
+}
+
+void GpuScene::record_draw(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent,
+                           VkFramebuffer framebuffer) const {
+    begin_rendering(command_buffer, color, depth, extent, framebuffer);
+    vkCmdDrawIndexedIndirectCount(command_buffer, m_commands.buffer, 0, m_count.buffer, 0, m_stats.max_draws, sizeof(VkDrawIndexedIndirectCommand));
+    end_rendering(command_buffer);
+}
+
+uint32_t GpuScene::record_draw_direct(VkCommandBuffer command_buffer, VkImageView color, VkImageView depth, VkExtent2D extent,
+                                      VkFramebuffer framebuffer) const {
+    begin_rendering(command_buffer, color, depth, extent, framebuffer);
+
+    uint32_t draws = 0;
+    for (uint32_t i = 0; i < m_stats.resident_count; i++) {
+        const float* sphere = &m_bounds[i * 4];
+
+        bool visible = true;
+        for (const auto& plane : m_planes) {
+            visible &= plane[0] * sphere[0] + plane[1] * sphere[1] + plane[2] * sphere[2] + plane[3] >= -sphere[3];
+        }
+
+        if (visible) {
+            const SceneMeshRange& range = m_mesh_ranges[m_mesh_ids[i]];
+            vkCmdDrawIndexed(command_buffer, range.index_count, 1, range.first_index, (int32_t)range.vertex_offset, i);
+            draws++;
+        }
+    }
+
+    end_rendering(command_buffer);
+    return draws;
+}
+
+void GpuScene::report() const {
+    std::cout << "GPU scene: " << m_stats.resident_count << "/" << m_stats.object_count << " objects resident, " << m_stats.max_draws
+              << " max draws, " << m_stats.device_bytes / 1024 << " KiB of buffers\n";
+}
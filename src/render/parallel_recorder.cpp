@@ -0,0 +1,110 @@
+#include "render/parallel_recorder.h"
+#include <algorithm>
+#include <stdexcept>
+
+ParallelRecorder::ParallelRecorder(VkDevice device, uint32_t queue_family, uint32_t frame_count, JobSystem& jobs, const VkAllocationCallbacks* host_allocator)
+    : m_device(device), m_host_allocator(host_allocator), m_jobs(jobs) {
+    m_pools.resize(frame_count * jobs.thread_count());
+
+    for (auto& pool : m_pools) {
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queue_family,
+        };
+
+        if (vkCreateCommandPool(m_device, &pool_info, m_host_allocator, &pool.pool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create worker command pool");
+        }
+    }
+}
+
+ParallelRecorder::~ParallelRecorder() {
+    for (auto& pool : m_pools) {
+        vkDestroyCommandPool(m_device, pool.pool, m_host_allocator);
+    }
+}
+
+void ParallelRecorder::begin_frame(uint32_t frame_index) {
+    m_frame_index = frame_index;
+    m_secondary_count = 0;
+
+    uint32_t thread_count = m_jobs.thread_count();
+    for (uint32_t thread = 0; thread < thread_count; thread++) {
+        ThreadPool& pool = m_pools[frame_index * thread_count + thread];
+        if (pool.used > 0) {
+            vkResetCommandPool(m_device, pool.pool, 0);
+            pool.used = 0;
+        }
+    }
+}
+
+// Buffers are allocated lazily and recycled by the per-frame pool reset
+VkCommandBuffer ParallelRecorder::next_buffer(ThreadPool& pool) {
+    if (pool.used == pool.buffers.size()) {
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = pool.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1,
+        };
+
+        VkCommandBuffer command_buffer;
+        if (vkAllocateCommandBuffers(m_device, &alloc_info, &command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate secondary command buffer");
+        }
+        pool.buffers.push_back(command_buffer);
+    }
+
+    return pool.buffers[pool.used++];
+}
+
+void ParallelRecorder::record(VkCommandBuffer primary, uint32_t count, uint32_t grain, const RecordFn& fn,
+                              const VkCommandBufferInheritanceInfo* inheritance, VkCommandBufferUsageFlags usage) {
+    if (count == 0) {
+        return;
+    }
+
+    VkCommandBufferInheritanceInfo default_inheritance = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+    };
+    if (inheritance == nullptr) {
+        inheritance = &default_inheritance;
+    }
+
+    uint32_t chunk_count = (count + grain - 1) / grain;
+    m_secondaries.resize(chunk_count);
+
+    uint32_t thread_count = m_jobs.thread_count();
+    ThreadPool* frame_pools = &m_pools[m_frame_index * thread_count];
+
+    m_jobs.parallel_for(chunk_count, 1, [&](uint32_t first_chunk, uint32_t last_chunk) {
+        ThreadPool& pool = frame_pools[JobSystem::current_thread_index()];
+
+        for (uint32_t chunk = first_chunk; chunk < last_chunk; chunk++) {
+            VkCommandBuffer command_buffer = next_buffer(pool);
+
+            VkCommandBufferBeginInfo begin_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | usage,
+                .pInheritanceInfo = inheritance,
+            };
+
+            if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin secondary command buffer");
+            }
+
+            uint32_t begin = chunk * grain;
+            fn(command_buffer, begin, std::min(count, begin + grain));
+
+            if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to record secondary command buffer");
+            }
+
+            m_secondaries[chunk] = command_buffer;
+        }
+    });
+
+    vkCmdExecuteCommands(primary, chunk_count, m_secondaries.data());
+    m_secondary_count += chunk_count;
+}
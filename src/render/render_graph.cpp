@@ -0,0 +1,1435 @@
+#include "render/render_graph.h"
+#include "profiler/profiler.h"
+#include "debug/breadcrumbs.h"
+#include "debug/device_lost.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+typedef struct UsageInfo {
+    VkPipelineStageFlags2 stage;
+    VkAccessFlags2 read_access;
+    VkAccessFlags2 write_access;
+    VkImageLayout layout;
+    VkImageUsageFlags image_usage;
+    VkBufferUsageFlags buffer_usage;
+    bool graphics_only;
+} UsageInfo;
+
+static UsageInfo usage_info(ResourceUsage usage) {
+    const VkPipelineStageFlags2 fragment_tests = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+    switch (usage) {
+    case ResourceUsage::ColorAttachment:
+        return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, 0, true};
+    case ResourceUsage::DepthAttachment:
+        return {fragment_tests, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 0, true};
+    case ResourceUsage::DepthRead:
+        return {fragment_tests, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 0, true};
+    case ResourceUsage::FragmentSampled:
+        return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, 0, true};
+    case ResourceUsage::ComputeSampled:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, 0, false};
+    case ResourceUsage::StorageRead:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false};
+    case ResourceUsage::StorageWrite:
+        return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, false};
+    case ResourceUsage::TransferSrc:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false};
+    case ResourceUsage::TransferDst:
+        return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, 0, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_BUFFER_USAGE_TRANSFER_DST_BIT, false};
+    case ResourceUsage::IndirectBuffer:
+        return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, false};
+    case ResourceUsage::VertexBuffer:
+        return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, true};
+    case ResourceUsage::IndexBuffer:
+        return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, 0,
+                VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, true};
+    }
+
+    throw std::runtime_error("Unknown resource usage");
+}
+
+static VkImageAspectFlags format_aspect(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static VkImageMemoryBarrier2 image_barrier(VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stage,
+                                           VkAccessFlags2 dst_access, VkImageLayout old_layout, VkImageLayout new_layout, VkImageAspectFlags aspect) {
+    return {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+        .srcStageMask = src_stage,
+        .srcAccessMask = src_access,
+        .dstStageMask = dst_stage,
+        .dstAccessMask = dst_access,
+        .oldLayout = old_layout,
+        .newLayout = new_layout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .subresourceRange = {
+            .aspectMask = aspect,
+            .baseMipLevel = 0,
+            .levelCount = VK_REMAINING_MIP_LEVELS,
+            .baseArrayLayer = 0,
+            .layerCount = VK_REMAINING_ARRAY_LAYERS
+        },
+    };
+}
+
+// Buffer hazards within a pass fold into one global memory barrier
+static void merge_memory_barrier(std::vector<VkMemoryBarrier2>& barriers, VkPipelineStageFlags2 src_stage, VkAccessFlags2 src_access,
+                                 VkPipelineStageFlags2 dst_stage, VkAccessFlags2 dst_access) {
+    if (barriers.empty()) {
+        barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+        });
+    }
+
+    barriers[0].srcStageMask |= src_stage;
+    barriers[0].srcAccessMask |= src_access;
+    barriers[0].dstStageMask |= dst_stage;
+    barriers[0].dstAccessMask |= dst_access;
+}
+
+// The low 32 bits of the sync2 flags are the sync1 ones; only the stages and accesses sync2 split
+// out need folding back. Nothing left means the barrier's none side: top or bottom of pipe.
+static VkPipelineStageFlags sync1_stages(VkPipelineStageFlags2 stages, VkPipelineStageFlags none) {
+    VkPipelineStageFlags result = (VkPipelineStageFlags)(stages & 0xffffffffull);
+    if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT)) {
+        result |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT)) {
+        result |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    }
+    return result != 0 ? result : none;
+}
+
+static VkAccessFlags sync1_access(VkAccessFlags2 access) {
+    VkAccessFlags result = (VkAccessFlags)(access & 0xffffffffull);
+    if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) {
+        result |= VK_ACCESS_SHADER_READ_BIT;
+    }
+    if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) {
+        result |= VK_ACCESS_SHADER_WRITE_BIT;
+    }
+    return result;
+}
+
+RenderGraph::RenderGraph(VkDevice device, DeviceAllocator& allocator, const RenderGraphQueues& queues, uint32_t frame_count,
+                         bool synchronization2)
+    : m_device(device), m_allocator(allocator), m_queues(queues), m_async_compute(queues.compute_queue != queues.graphics_queue),
+      m_synchronization2(synchronization2) {
+    VkSemaphoreTypeCreateInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_info,
+    };
+
+    uint32_t queue_count = m_async_compute ? 2 : 1;
+    for (uint32_t queue = 0; queue < queue_count; queue++) {
+        if (vkCreateSemaphore(m_device, &semaphore_info, m_allocator.host_allocator(), &m_timelines[queue]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create render graph timeline semaphore");
+        }
+    }
+
+    m_frames.resize(frame_count);
+    for (auto& frame : m_frames) {
+        for (uint32_t queue = 0; queue < queue_count; queue++) {
+            VkCommandPoolCreateInfo pool_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = family((RenderQueue)queue),
+            };
+
+            if (vkCreateCommandPool(m_device, &pool_info, m_allocator.host_allocator(), &frame.queues[queue].pool) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph command pool");
+            }
+        }
+    }
+}
+
+RenderGraph::~RenderGraph() {
+    destroy_transients();
+
+    for (auto& frame : m_frames) {
+        for (auto& commands : frame.queues) {
+            if (commands.pool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(m_device, commands.pool, m_allocator.host_allocator());
+            }
+        }
+    }
+
+    for (auto timeline : m_timelines) {
+        if (timeline != VK_NULL_HANDLE) {
+            vkDestroySemaphore(m_device, timeline, m_allocator.host_allocator());
+        }
+    }
+}
+
+RenderQueue RenderGraph::queue_of(const Pass& pass) const {
+    return m_async_compute ? pass.queue : RenderQueue::Graphics;
+}
+
+VkQueue RenderGraph::vk_queue(RenderQueue queue) const {
+    return queue == RenderQueue::Compute ? m_queues.compute_queue : m_queues.graphics_queue;
+}
+
+uint32_t RenderGraph::family(RenderQueue queue) const {
+    return queue == RenderQueue::Compute ? m_queues.compute_family : m_queues.graphics_family;
+}
+
+ResourceHandle RenderGraph::create_image(const char* name, VkFormat format, VkExtent2D extent) {
+    Resource resource = {
+        .name = name,
+        .is_image = true,
+        .imported = false,
+        .format = format,
+        .extent = extent,
+        .aspect = format_aspect(format),
+    };
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+ResourceHandle RenderGraph::create_buffer(const char* name, VkDeviceSize size) {
+    Resource resource = {
+        .name = name,
+        .is_image = false,
+        .imported = false,
+        .size = size,
+    };
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+ResourceHandle RenderGraph::import_image(const char* name, VkImage image, VkImageView view, const ResourceState& initial, const ResourceState& final,
+                                         VkImageAspectFlags aspect) {
+    Resource resource = {
+        .name = name,
+        .is_image = true,
+        .imported = true,
+        .output = true,
+        .aspect = aspect,
+        .initial = initial,
+        .final = final,
+        .image = image,
+        .view = view,
+    };
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+ResourceHandle RenderGraph::import_buffer(const char* name, VkBuffer buffer, const ResourceState& initial, const ResourceState& final) {
+    Resource resource = {
+        .name = name,
+        .is_image = false,
+        .imported = true,
+        .output = true,
+        .initial = initial,
+        .final = final,
+        .buffer = buffer,
+    };
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+void RenderGraph::set_image(ResourceHandle resource, VkImage image, VkImageView view) {
+    if (!m_resources[resource].imported) {
+        throw std::runtime_error("Only imported images can be rebound");
+    }
+
+    m_resources[resource].image = image;
+    m_resources[resource].view = view;
+}
+
+PassHandle RenderGraph::add_pass(const char* name, RenderQueue queue, ExecuteFn fn) {
+    Pass pass = {
+        .name = name,
+        .queue = queue,
+        .fn = std::move(fn),
+    };
+    m_passes.push_back(std::move(pass));
+    m_compiled = false;
+    return (PassHandle)m_passes.size() - 1;
+}
+
+void RenderGraph::add_access(PassHandle pass_handle, ResourceHandle resource, ResourceUsage usage, bool write) {
+    Pass& pass = m_passes[pass_handle];
+    UsageInfo info = usage_info(usage);
+
+    if (write && info.write_access == 0) {
+        throw std::runtime_error(std::string("Pass ") + pass.name + " writes through a read-only usage");
+    }
+    if (!write && info.read_access == 0) {
+        throw std::runtime_error(std::string("Pass ") + pass.name + " reads through a write-only usage");
+    }
+    if (info.graphics_only && pass.queue == RenderQueue::Compute) {
+        throw std::runtime_error(std::string("Compute pass ") + pass.name + " uses a graphics-only stage");
+    }
+
+    Access access = {
+        .resource = resource,
+        .stage = info.stage,
+        .access = write ? info.read_access | info.write_access : info.read_access,
+        .write_access = write ? info.write_access : 0,
+        .layout = info.layout,
+        .image_usage = info.image_usage,
+        .buffer_usage = info.buffer_usage,
+        .read = !write,
+        .write = write,
+    };
+
+    for (auto& existing : pass.accesses) {
+        if (existing.resource != resource) {
+            continue;
+        }
+
+        // The write's layout has to serve the read as well (depth test + depth write, storage read + write)
+        if (access.layout != existing.layout && !existing.write && !access.write) {
+            throw std::runtime_error(std::string("Pass ") + pass.name + " reads " + m_resources[resource].name + " in two layouts");
+        }
+        if (access.write) {
+            existing.layout = access.layout;
+        }
+        existing.stage |= access.stage;
+        existing.access |= access.access;
+        existing.write_access |= access.write_access;
+        existing.image_usage |= access.image_usage;
+        existing.buffer_usage |= access.buffer_usage;
+        existing.read |= access.read;
+        existing.write |= access.write;
+        m_compiled = false;
+        return;
+    }
+
+    pass.accesses.push_back(access);
+    m_compiled = false;
+}
+
+void RenderGraph::read(PassHandle pass, ResourceHandle resource, ResourceUsage usage) {
+    add_access(pass, resource, usage, false);
+}
+
+void RenderGraph::write(PassHandle pass, ResourceHandle resource, ResourceUsage usage) {
+    add_access(pass, resource, usage, true);
+}
+
+void RenderGraph::set_side_effects(PassHandle pass) {
+    m_passes[pass].side_effects = true;
+}
+
+void RenderGraph::mark_output(ResourceHandle resource) {
+    m_resources[resource].output = true;
+}
+
+// A pass is live if it has side effects, produces the final contents of an output, or produces
+// something a live pass reads. A plain write starts a new version and does not keep earlier writers alive.
+void RenderGraph::cull() {
+    std::vector<std::vector<PassHandle>> needs(m_passes.size());
+    std::vector<int32_t> current_writer(m_resources.size(), -1);
+
+    for (PassHandle p = 0; p < m_passes.size(); p++) {
+        for (const auto& access : m_passes[p].accesses) {
+            int32_t writer = current_writer[access.resource];
+            if (access.read && writer >= 0) {
+                needs[p].push_back((PassHandle)writer);
+            }
+            if (access.write) {
+                current_writer[access.resource] = (int32_t)p;
+            }
+        }
+    }
+
+    std::vector<bool> live(m_passes.size(), false);
+    std::vector<PassHandle> stack;
+
+    for (PassHandle p = 0; p < m_passes.size(); p++) {
+        if (m_passes[p].side_effects) {
+            stack.push_back(p);
+        }
+    }
+    for (ResourceHandle r = 0; r < m_resources.size(); r++) {
+        if (m_resources[r].output && current_writer[r] >= 0) {
+            stack.push_back((PassHandle)current_writer[r]);
+        }
+    }
+
+    while (!stack.empty()) {
+        PassHandle p = stack.back();
+        stack.pop_back();
+        if (live[p]) {
+            continue;
+        }
+        live[p] = true;
+        stack.insert(stack.end(), needs[p].begin(), needs[p].end());
+    }
+
+    m_stats.culled_passes = 0;
+    for (PassHandle p = 0; p < m_passes.size(); p++) {
+        m_passes[p].culled = !live[p];
+        if (!live[p]) {
+            m_stats.culled_passes++;
+        }
+    }
+}
+
+// Topological order over RAW/WAR/WAW edges. Among ready passes the one on the queue we are already
+// on wins, then declaration order, so same-queue work clumps into fewer batches.
+void RenderGraph::schedule() {
+    std::vector<std::vector<PassHandle>> successors(m_passes.size());
+    std::vector<uint32_t> in_degree(m_passes.size(), 0);
+    std::vector<int32_t> last_writer(m_resources.size(), -1);
+    std::vector<std::vector<PassHandle>> readers(m_resources.size());
+
+    auto add_edge = [&](PassHandle from, PassHandle to) {
+        if (from == to) {
+            return;
+        }
+        successors[from].push_back(to);
+        in_degree[to]++;
+    };
+
+    for (PassHandle p = 0; p < m_passes.size(); p++) {
+        if (m_passes[p].culled) {
+            continue;
+        }
+
+        for (const auto& access : m_passes[p].accesses) {
+            ResourceHandle r = access.resource;
+            if (last_writer[r] >= 0) {
+                add_edge((PassHandle)last_writer[r], p);
+            }
+
+            if (access.write) {
+                for (auto reader : readers[r]) {
+                    add_edge(reader, p);
+                }
+                readers[r].clear();
+                last_writer[r] = (int32_t)p;
+            } else {
+                readers[r].push_back(p);
+            }
+        }
+    }
+
+    std::vector<PassHandle> ready;
+    for (PassHandle p = 0; p < m_passes.size(); p++) {
+        if (!m_passes[p].culled && in_degree[p] == 0) {
+            ready.push_back(p);
+        }
+    }
+
+    m_schedule.clear();
+    RenderQueue current = RenderQueue::Graphics;
+
+    while (!ready.empty()) {
+        auto pick = ready.end();
+        for (auto it = ready.begin(); it != ready.end(); ++it) {
+            bool same_queue = queue_of(m_passes[*it]) == current;
+            if (pick == ready.end()) {
+                pick = it;
+            } else {
+                bool pick_same_queue = queue_of(m_passes[*pick]) == current;
+                if ((same_queue && !pick_same_queue) || (same_queue == pick_same_queue && *it < *pick)) {
+                    pick = it;
+                }
+            }
+        }
+
+        PassHandle p = *pick;
+        ready.erase(pick);
+        m_schedule.push_back(p);
+        current = queue_of(m_passes[p]);
+
+        for (auto successor : successors[p]) {
+            if (--in_degree[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+}
+
+void RenderGraph::build_batches() {
+    m_batches.clear();
+
+    for (auto p : m_schedule) {
+        RenderQueue queue = queue_of(m_passes[p]);
+        if (m_batches.empty() || m_batches.back().queue != queue) {
+            Batch batch = {
+                .queue = queue,
+            };
+            m_batches.push_back(batch);
+        }
+
+        m_batches.back().passes.push_back(p);
+        m_passes[p].batch = (uint32_t)m_batches.size() - 1;
+    }
+}
+
+// Transients are sorted largest first and packed into buckets; a bucket takes a resource when its
+// memory type fits and no member's lifetime overlaps. Each bucket is one allocation, its members alias it.
+void RenderGraph::create_transients() {
+    std::vector<VkImageUsageFlags> image_usage(m_resources.size(), 0);
+    std::vector<VkBufferUsageFlags> buffer_usage(m_resources.size(), 0);
+
+    for (uint32_t position = 0; position < m_schedule.size(); position++) {
+        for (const auto& access : m_passes[m_schedule[position]].accesses) {
+            Resource& resource = m_resources[access.resource];
+            if (resource.first_use < 0) {
+                resource.first_use = (int32_t)position;
+            }
+            resource.last_use = (int32_t)position;
+            image_usage[access.resource] |= access.image_usage;
+            buffer_usage[access.resource] |= access.buffer_usage;
+        }
+    }
+
+    uint32_t families[] = {m_queues.graphics_family, m_queues.compute_family};
+    bool concurrent = m_async_compute && m_queues.graphics_family != m_queues.compute_family;
+
+    std::vector<ResourceHandle> transients;
+    for (ResourceHandle r = 0; r < m_resources.size(); r++) {
+        Resource& resource = m_resources[r];
+        if (resource.imported || resource.first_use < 0) {
+            continue;
+        }
+
+        if (resource.is_image) {
+            VkImageCreateInfo image_info = {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = resource.format,
+                .extent = {resource.extent.width, resource.extent.height, 1},
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = image_usage[r],
+                .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = concurrent ? 2u : 0u,
+                .pQueueFamilyIndices = concurrent ? families : nullptr,
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            };
+
+            if (vkCreateImage(m_device, &image_info, m_allocator.host_allocator(), &resource.image) != VK_SUCCESS) {
+                throw std::runtime_error(std::string("Failed to create transient image ") + resource.name);
+            }
+            vkGetImageMemoryRequirements(m_device, resource.image, &resource.requirements);
+        } else {
+            VkBufferCreateInfo buffer_info = {
+                .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .size = resource.size,
+                .usage = buffer_usage[r],
+                .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = concurrent ? 2u : 0u,
+                .pQueueFamilyIndices = concurrent ? families : nullptr,
+            };
+
+            if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &resource.buffer) != VK_SUCCESS) {
+                throw std::runtime_error(std::string("Failed to create transient buffer ") + resource.name);
+            }
+            vkGetBufferMemoryRequirements(m_device, resource.buffer, &resource.requirements);
+        }
+
+        transients.push_back(r);
+        m_stats.transient_bytes += resource.requirements.size;
+    }
+
+    std::sort(transients.begin(), transients.end(), [this](ResourceHandle a, ResourceHandle b) {
+        return m_resources[a].requirements.size > m_resources[b].requirements.size;
+    });
+
+    for (auto r : transients) {
+        Resource& resource = m_resources[r];
+        AllocationKind kind = resource.is_image ? AllocationKind::Optimal : AllocationKind::Linear;
+
+        for (uint32_t b = 0; b < m_buckets.size() && resource.bucket < 0; b++) {
+            MemoryBucket& bucket = m_buckets[b];
+            if (bucket.kind != kind || !(bucket.requirements.memoryTypeBits & resource.requirements.memoryTypeBits) ||
+                resource.requirements.size > bucket.requirements.size) {
+                continue;
+            }
+
+            bool overlaps = false;
+            for (auto member : bucket.resources) {
+                const Resource& other = m_resources[member];
+                if (resource.first_use <= other.last_use && other.first_use <= resource.last_use) {
+                    overlaps = true;
+                    break;
+                }
+            }
+
+            if (!overlaps) {
+                bucket.requirements.memoryTypeBits &= resource.requirements.memoryTypeBits;
+                bucket.requirements.alignment = std::max(bucket.requirements.alignment, resource.requirements.alignment);
+                bucket.resources.push_back(r);
+                resource.bucket = (int32_t)b;
+            }
+        }
+
+        if (resource.bucket < 0) {
+            MemoryBucket bucket = {
+                .requirements = resource.requirements,
+                .kind = kind,
+                .resources = {r},
+            };
+            m_buckets.push_back(bucket);
+            resource.bucket = (int32_t)m_buckets.size() - 1;
+        }
+    }
+
+    for (auto& bucket : m_buckets) {
+        bucket.allocation = m_allocator.allocate(bucket.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bucket.kind);
+        m_stats.aliased_bytes += bucket.requirements.size;
+
+        std::sort(bucket.resources.begin(), bucket.resources.end(), [this](ResourceHandle a, ResourceHandle b) {
+            return m_resources[a].first_use < m_resources[b].first_use;
+        });
+
+        for (uint32_t i = 0; i < bucket.resources.size(); i++) {
+            Resource& resource = m_resources[bucket.resources[i]];
+            resource.alias_predecessor = i > 0 ? (int32_t)bucket.resources[i - 1] : -1;
+
+            if (resource.is_image) {
+                vkBindImageMemory(m_device, resource.image, bucket.allocation.memory, bucket.allocation.offset);
+
+                VkImageViewCreateInfo view_info = {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                    .image = resource.image,
+                    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                    .format = resource.format,
+                    .components = {
+                        .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                        .a = VK_COMPONENT_SWIZZLE_IDENTITY
+                    },
+                    .subresourceRange = {
+                        .aspectMask = resource.aspect,
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1
+                    },
+                };
+
+                if (vkCreateImageView(m_device, &view_info, m_allocator.host_allocator(), &resource.view) != VK_SUCCESS) {
+                    throw std::runtime_error(std::string("Failed to create transient image view ") + resource.name);
+                }
+            } else {
+                vkBindBufferMemory(m_device, resource.buffer, bucket.allocation.memory, bucket.allocation.offset);
+            }
+        }
+    }
+
+    m_stats.transient_resources = (uint32_t)transients.size();
+    m_stats.memory_buckets = (uint32_t)m_buckets.size();
+}
+
+// Walks the schedule tracking, per resource and per queue, the last write and the reads since.
+// A barrier is only emitted for RAW (reads not yet made visible), WAR, WAW or a layout change.
+// Hazards against the other queue become a timeline wait on the batch that last touched the
+// resource there; the semaphore makes those writes visible, so no barrier is needed on top
+// unless the layout changes.
+void RenderGraph::build_barriers() {
+    typedef struct QueueSync {
+        VkPipelineStageFlags2 write_stage = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 write_access = VK_ACCESS_2_NONE;
+        VkPipelineStageFlags2 read_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkPipelineStageFlags2 visible_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 visible_access = VK_ACCESS_2_NONE;
+    } QueueSync;
+
+    typedef struct SyncState {
+        QueueSync queues[2];
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        int32_t last_write_batch = -1;
+        int32_t last_read_batch[2] = {-1, -1};
+        // Latest batch on the other queue each queue has already waited for
+        int32_t synced_batch[2] = {-1, -1};
+    } SyncState;
+
+    std::vector<SyncState> states(m_resources.size());
+    for (ResourceHandle r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (resource.imported) {
+            // Imported resources are handed over on the graphics queue
+            states[r].queues[(uint32_t)RenderQueue::Graphics].write_stage = resource.initial.stage;
+            states[r].queues[(uint32_t)RenderQueue::Graphics].write_access = resource.initial.access;
+            states[r].layout = resource.initial.layout;
+        }
+    }
+
+    // Transient memory is shared by every frame in flight, so the first occupant of each bucket has to
+    // wait for the bucket's last occupant from the previous frame
+    m_frame_waits[0] = m_frame_waits[1] = false;
+    for (const auto& bucket : m_buckets) {
+        ResourceHandle head = bucket.resources[0];
+        ResourceHandle tail = bucket.resources[0];
+        for (auto r : bucket.resources) {
+            if (m_resources[r].first_use < m_resources[head].first_use) {
+                head = r;
+            }
+            if (m_resources[r].last_use > m_resources[tail].last_use) {
+                tail = r;
+            }
+        }
+
+        QueueSync tail_sync[2];
+        for (auto p : m_schedule) {
+            const Pass& pass = m_passes[p];
+            uint32_t queue = (uint32_t)m_batches[pass.batch].queue;
+            for (const auto& access : pass.accesses) {
+                if (access.resource != tail) {
+                    continue;
+                }
+                if (access.write) {
+                    tail_sync[queue] = {.write_stage = access.stage, .write_access = access.write_access};
+                    tail_sync[1 - queue] = {};
+                } else {
+                    tail_sync[queue].read_stages |= access.stage;
+                }
+            }
+        }
+
+        uint32_t queue = (uint32_t)m_batches[m_passes[m_schedule[m_resources[head].first_use]].batch].queue;
+        QueueSync& sync = states[head].queues[queue];
+        sync.write_stage = tail_sync[queue].write_stage | tail_sync[queue].read_stages;
+        sync.write_access = tail_sync[queue].write_access;
+
+        // The other queue is covered by a timeline wait at the start of the frame, see execute()
+        if ((tail_sync[1 - queue].write_stage | tail_sync[1 - queue].read_stages) != VK_PIPELINE_STAGE_2_NONE) {
+            sync.write_stage |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            m_frame_waits[queue] = true;
+        }
+    }
+
+    // Imported resources start the frame on the graphics queue, so a compute first use has to wait
+    // for the previous frame's graphics work, e.g. a cull overwriting buffers last frame's draw read
+    for (ResourceHandle r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (resource.imported && resource.first_use >= 0 &&
+            m_batches[m_passes[m_schedule[resource.first_use]].batch].queue == RenderQueue::Compute) {
+            m_frame_waits[(uint32_t)RenderQueue::Compute] = true;
+        }
+    }
+
+    // Reads later in the schedule on the same queue and in the same layout ride along on a read barrier
+    auto later_reads = [&](size_t position, ResourceHandle resource, RenderQueue queue, VkImageLayout layout,
+                           VkPipelineStageFlags2& stage, VkAccessFlags2& access_mask) {
+        for (size_t i = position + 1; i < m_schedule.size(); i++) {
+            const Pass& later = m_passes[m_schedule[i]];
+            for (const auto& access : later.accesses) {
+                if (access.resource != resource) {
+                    continue;
+                }
+                if (access.write || m_batches[later.batch].queue != queue || access.layout != layout) {
+                    return;
+                }
+                stage |= access.stage;
+                access_mask |= access.access;
+            }
+        }
+    };
+
+    int32_t waited[2] = {-1, -1};
+
+    for (size_t position = 0; position < m_schedule.size(); position++) {
+        PassHandle p = m_schedule[position];
+        Pass& pass = m_passes[p];
+        Batch& batch = m_batches[pass.batch];
+        uint32_t queue = (uint32_t)batch.queue;
+        uint32_t other = 1 - queue;
+
+        for (const auto& access : pass.accesses) {
+            const Resource& resource = m_resources[access.resource];
+            SyncState& state = states[access.resource];
+
+            // The first user of aliased memory must wait for the previous occupant to finish with it
+            if (m_schedule[resource.first_use] == p && resource.alias_predecessor >= 0) {
+                const SyncState& previous = states[resource.alias_predecessor];
+                for (uint32_t q = 0; q < 2; q++) {
+                    state.queues[q] = {
+                        .write_stage = previous.queues[q].write_stage | previous.queues[q].read_stages,
+                        .write_access = previous.queues[q].write_access,
+                    };
+                    state.last_read_batch[q] = previous.last_read_batch[q];
+                    state.synced_batch[q] = previous.synced_batch[q];
+                }
+                state.last_write_batch = previous.last_write_batch;
+                state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+
+            // Transitions are writes too, so they also have to wait for readers on the other queue
+            bool layout_change = resource.is_image && access.layout != state.layout;
+            int32_t wait = -1;
+            if (state.last_write_batch >= 0 && m_batches[state.last_write_batch].queue != batch.queue) {
+                wait = state.last_write_batch;
+            }
+            if ((access.write || layout_change) && state.last_read_batch[other] >= 0) {
+                wait = std::max(wait, state.last_read_batch[other]);
+            }
+
+            QueueSync& sync = state.queues[queue];
+            bool cross_queue = wait > state.synced_batch[queue];
+            if (cross_queue) {
+                state.synced_batch[queue] = wait;
+                if (wait > waited[queue]) {
+                    batch.wait_batch = std::max(batch.wait_batch, wait);
+                    waited[queue] = wait;
+                }
+
+                // The timeline wait makes the other queue's write visible to everything; it had already
+                // waited for this queue's earlier writes, but not necessarily for its reads
+                if (m_batches[state.last_write_batch].queue != batch.queue) {
+                    sync.write_stage = VK_PIPELINE_STAGE_2_NONE;
+                    sync.write_access = VK_ACCESS_2_NONE;
+                    sync.visible_stages = ~VK_PIPELINE_STAGE_2_NONE;
+                    sync.visible_access = ~VK_ACCESS_2_NONE;
+                }
+            }
+
+            VkPipelineStageFlags2 src_stage;
+            VkAccessFlags2 src_access = sync.write_access;
+            VkPipelineStageFlags2 dst_stage = access.stage;
+            VkAccessFlags2 dst_access = access.access;
+            bool needs_barrier;
+
+            if (access.write) {
+                src_stage = sync.write_stage | sync.read_stages;
+                needs_barrier = src_stage != VK_PIPELINE_STAGE_2_NONE || layout_change;
+            } else {
+                bool visible = (access.stage & ~sync.visible_stages) == 0 && (access.access & ~sync.visible_access) == 0;
+                src_stage = sync.write_stage;
+                needs_barrier = layout_change || (sync.write_stage != VK_PIPELINE_STAGE_2_NONE && !visible);
+                if (layout_change) {
+                    src_stage |= sync.read_stages;
+                }
+                if (needs_barrier) {
+                    later_reads(position, access.resource, batch.queue, access.layout, dst_stage, dst_access);
+                }
+            }
+
+            // A transition after a timeline wait has to chain with the wait's ALL_COMMANDS scope
+            if (cross_queue && layout_change) {
+                src_stage |= VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            }
+
+            if (needs_barrier) {
+                if (resource.is_image) {
+                    pass.image_barriers.push_back(image_barrier(src_stage, src_access, dst_stage, dst_access,
+                                                                state.layout, access.layout, resource.aspect));
+                    pass.image_barrier_resources.push_back(access.resource);
+                } else {
+                    merge_memory_barrier(pass.memory_barriers, src_stage, src_access, dst_stage, dst_access);
+                }
+            }
+
+            if (access.write || layout_change) {
+                // A layout transition is a write of its own; later reads chain off this pass's stage
+                sync = {
+                    .write_stage = access.stage,
+                    .write_access = access.write_access,
+                    .read_stages = access.write ? VK_PIPELINE_STAGE_2_NONE : access.stage,
+                    .visible_stages = access.write ? VK_PIPELINE_STAGE_2_NONE : dst_stage,
+                    .visible_access = access.write ? VK_ACCESS_2_NONE : dst_access,
+                };
+                state.last_write_batch = (int32_t)pass.batch;
+                state.last_read_batch[queue] = access.write ? -1 : (int32_t)pass.batch;
+                state.last_read_batch[other] = -1;
+            } else {
+                if (needs_barrier) {
+                    sync.visible_stages |= dst_stage;
+                    sync.visible_access |= dst_access;
+                }
+                sync.read_stages |= access.stage;
+                state.last_read_batch[queue] = (int32_t)pass.batch;
+            }
+            state.layout = access.layout;
+        }
+    }
+
+    for (ResourceHandle r = 0; r < m_resources.size(); r++) {
+        const Resource& resource = m_resources[r];
+        if (!resource.imported || resource.last_use < 0) {
+            continue;
+        }
+
+        Batch& batch = m_batches[m_passes[m_schedule[resource.last_use]].batch];
+        const SyncState& state = states[r];
+        const QueueSync& sync = state.queues[(uint32_t)batch.queue];
+        bool layout_change = resource.is_image && resource.final.layout != state.layout;
+        if (!layout_change && resource.final.stage == VK_PIPELINE_STAGE_2_NONE) {
+            continue;
+        }
+
+        VkPipelineStageFlags2 src_stage = sync.write_stage | sync.read_stages;
+        if (resource.is_image) {
+            batch.final_image_barriers.push_back(image_barrier(src_stage, sync.write_access, resource.final.stage, resource.final.access,
+                                                               state.layout, resource.final.layout, resource.aspect));
+            batch.final_image_resources.push_back(r);
+        } else {
+            merge_memory_barrier(batch.final_memory_barriers, src_stage, sync.write_access, resource.final.stage, resource.final.access);
+        }
+    }
+}
+
+void RenderGraph::destroy_transients() {
+    for (auto& resource : m_resources) {
+        if (resource.imported) {
+            continue;
+        }
+
+        if (resource.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(m_device, resource.view, m_allocator.host_allocator());
+        }
+        if (resource.image != VK_NULL_HANDLE) {
+            vkDestroyImage(m_device, resource.image, m_allocator.host_allocator());
+        }
+        if (resource.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(m_device, resource.buffer, m_allocator.host_allocator());
+        }
+
+        resource.view = VK_NULL_HANDLE;
+        resource.image = VK_NULL_HANDLE;
+        resource.buffer = VK_NULL_HANDLE;
+    }
+
+    for (auto& bucket : m_buckets) {
+        m_allocator.free(bucket.allocation);
+    }
+    m_buckets.clear();
+}
+
+// Recompiling destroys the previous transients; the caller makes sure the GPU is done with them
+void RenderGraph::compile() {
+    destroy_transients();
+
+    for (auto& pass : m_passes) {
+        pass.image_barriers.clear();
+        pass.image_barrier_resources.clear();
+        pass.memory_barriers.clear();
+    }
+    for (auto& resource : m_resources) {
+        resource.first_use = -1;
+        resource.last_use = -1;
+        resource.bucket = -1;
+        resource.alias_predecessor = -1;
+    }
+
+    m_stats = {};
+    m_stats.declared_passes = (uint32_t)m_passes.size();
+
+    cull();
+    schedule();
+    build_batches();
+    create_transients();
+    build_barriers();
+
+    m_stats.batches = (uint32_t)m_batches.size();
+    for (auto p : m_schedule) {
+        const Pass& pass = m_passes[p];
+        if (!pass.image_barriers.empty() || !pass.memory_barriers.empty()) {
+            m_stats.barrier_calls++;
+        }
+        m_stats.image_barriers += (uint32_t)pass.image_barriers.size();
+        m_stats.memory_barriers += (uint32_t)pass.memory_barriers.size();
+
+        m_stats.naive_barrier_calls++;
+        for (const auto& access : pass.accesses) {
+            if (m_resources[access.resource].is_image) {
+                m_stats.naive_image_barriers++;
+            }
+        }
+    }
+    for (const auto& batch : m_batches) {
+        if (!batch.final_image_barriers.empty() || !batch.final_memory_barriers.empty()) {
+            m_stats.barrier_calls++;
+            m_stats.naive_barrier_calls++;
+        }
+        m_stats.image_barriers += (uint32_t)batch.final_image_barriers.size();
+        m_stats.naive_image_barriers += (uint32_t)batch.final_image_barriers.size();
+        m_stats.memory_barriers += (uint32_t)batch.final_memory_barriers.size();
+        if (batch.wait_batch >= 0) {
+            m_stats.queue_waits++;
+        }
+    }
+
+    m_compiled = true;
+}
+
+VkCommandBuffer RenderGraph::next_command_buffer(QueueCommands& commands) {
+    if (commands.used == commands.buffers.size()) {
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = commands.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+        VkCommandBuffer command_buffer;
+        if (vkAllocateCommandBuffers(m_device, &alloc_info, &command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate render graph command buffer");
+        }
+        commands.buffers.push_back(command_buffer);
+    }
+
+    return commands.buffers[commands.used++];
+}
+
+void RenderGraph::set_breadcrumbs(Breadcrumbs* breadcrumbs) {
+    if (breadcrumbs != nullptr) {
+        if (breadcrumbs->slot_count() < m_passes.size()) {
+            throw std::runtime_error("Not enough breadcrumb slots for the render graph's passes");
+        }
+        for (auto p : m_schedule) {
+            breadcrumbs->set_label(p, m_passes[p].name);
+        }
+    }
+    m_breadcrumbs = breadcrumbs;
+}
+
+void RenderGraph::inject_device_lost(const std::string& pass_name) {
+    m_inject_device_lost = true;
+    m_inject_pass = pass_name;
+}
+
+int32_t RenderGraph::find_fault_pass() const {
+    if (m_inject_pass.empty()) {
+        return m_schedule.empty() ? -1 : (int32_t)m_schedule.back();
+    }
+
+    for (auto p : m_schedule) {
+        if (std::strcmp(m_passes[p].name, m_inject_pass.c_str()) == 0) {
+            return (int32_t)p;
+        }
+    }
+    throw std::runtime_error("No scheduled pass named " + m_inject_pass + " to inject a device loss into");
+}
+
+// The batch is cut off where the pass would have started and submitted with its waits but none of
+// its signals, the way a hang leaves it; once it drains the breadcrumbs read as they would after a
+// real loss. frame_wait_submitted says whether info.wait_semaphore has already been waited on.
+void RenderGraph::simulate_device_lost(VkQueue queue, const std::vector<VkSemaphoreSubmitInfo>& waits, VkCommandBuffer command_buffer, const Pass& pass,
+                                       const RenderGraphExecuteInfo& info, bool frame_wait_submitted) {
+    if (m_breadcrumbs) {
+        m_breadcrumbs->record_host_barrier(command_buffer);
+    }
+    if (m_profiler && queue_of(pass) == RenderQueue::Graphics) {
+        m_profiler->end_commands(command_buffer);
+    }
+
+    if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record render graph command buffer");
+    }
+    submit(queue, waits, command_buffer, {}, VK_NULL_HANDLE);
+
+    // The graphics batches that would have consumed the caller's wait semaphore and signalled its
+    // fence never get submitted, e.g. when the pass is on the compute queue, so an empty submission
+    // does both; otherwise the semaphore stays signalled and the fence never does
+    std::vector<VkSemaphoreSubmitInfo> frame_waits;
+    if (!frame_wait_submitted && info.wait_semaphore != VK_NULL_HANDLE) {
+        frame_waits.push_back({
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = info.wait_semaphore,
+            .stageMask = info.wait_stage,
+        });
+    }
+    if (!frame_waits.empty() || info.fence != VK_NULL_HANDLE) {
+        submit(m_queues.graphics_queue, frame_waits, VK_NULL_HANDLE, {}, info.fence);
+    }
+    vkDeviceWaitIdle(m_device);
+
+    throw DeviceLostError(std::string("Device lost in pass ") + pass.name + " (injected)");
+}
+
+void RenderGraph::record_barriers(VkCommandBuffer command_buffer, std::vector<VkImageMemoryBarrier2>& image_barriers,
+                                  const std::vector<ResourceHandle>& image_resources, const std::vector<VkMemoryBarrier2>& memory_barriers) {
+    if (image_barriers.empty() && memory_barriers.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < image_barriers.size(); i++) {
+        image_barriers[i].image = m_resources[image_resources[i]].image;
+    }
+
+    if (m_synchronization2) {
+        VkDependencyInfo dependency_info = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .memoryBarrierCount = (uint32_t)memory_barriers.size(),
+            .pMemoryBarriers = memory_barriers.data(),
+            .imageMemoryBarrierCount = (uint32_t)image_barriers.size(),
+            .pImageMemoryBarriers = image_barriers.data(),
+        };
+
+        vkCmdPipelineBarrier2(command_buffer, &dependency_info);
+        return;
+    }
+
+    // One sync1 call has one pair of stage masks, so the per-barrier masks are merged
+    VkPipelineStageFlags2 src_stages = 0;
+    VkPipelineStageFlags2 dst_stages = 0;
+
+    m_sync1_memory_barriers.clear();
+    for (const auto& barrier : memory_barriers) {
+        src_stages |= barrier.srcStageMask;
+        dst_stages |= barrier.dstStageMask;
+        m_sync1_memory_barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = sync1_access(barrier.srcAccessMask),
+            .dstAccessMask = sync1_access(barrier.dstAccessMask),
+        });
+    }
+
+    m_sync1_image_barriers.clear();
+    for (const auto& barrier : image_barriers) {
+        src_stages |= barrier.srcStageMask;
+        dst_stages |= barrier.dstStageMask;
+        m_sync1_image_barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = sync1_access(barrier.srcAccessMask),
+            .dstAccessMask = sync1_access(barrier.dstAccessMask),
+            .oldLayout = barrier.oldLayout,
+            .newLayout = barrier.newLayout,
+            .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+            .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+            .image = barrier.image,
+            .subresourceRange = barrier.subresourceRange,
+        });
+    }
+
+    vkCmdPipelineBarrier(command_buffer, sync1_stages(src_stages, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+                         sync1_stages(dst_stages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT), 0,
+                         (uint32_t)m_sync1_memory_barriers.size(), m_sync1_memory_barriers.data(), 0, nullptr,
+                         (uint32_t)m_sync1_image_barriers.size(), m_sync1_image_barriers.data());
+}
+
+VkResult RenderGraph::submit(VkQueue queue, const std::vector<VkSemaphoreSubmitInfo>& waits, VkCommandBuffer command_buffer,
+                             const std::vector<VkSemaphoreSubmitInfo>& signals, VkFence fence) {
+    uint32_t command_buffer_count = command_buffer != VK_NULL_HANDLE ? 1 : 0;
+
+    if (m_synchronization2) {
+        VkCommandBufferSubmitInfo command_buffer_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+            .commandBuffer = command_buffer,
+        };
+
+        VkSubmitInfo2 submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+            .waitSemaphoreInfoCount = (uint32_t)waits.size(),
+            .pWaitSemaphoreInfos = waits.data(),
+            .commandBufferInfoCount = command_buffer_count,
+            .pCommandBufferInfos = &command_buffer_info,
+            .signalSemaphoreInfoCount = (uint32_t)signals.size(),
+            .pSignalSemaphoreInfos = signals.data(),
+        };
+
+        return vkQueueSubmit2(queue, 1, &submit_info, fence);
+    }
+
+    // Values are ignored for the binary semaphores mixed in with the timelines
+    std::vector<VkSemaphore> wait_semaphores;
+    std::vector<uint64_t> wait_values;
+    std::vector<VkPipelineStageFlags> wait_stages;
+    for (const auto& wait : waits) {
+        wait_semaphores.push_back(wait.semaphore);
+        wait_values.push_back(wait.value);
+        wait_stages.push_back(sync1_stages(wait.stageMask, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT));
+    }
+
+    std::vector<VkSemaphore> signal_semaphores;
+    std::vector<uint64_t> signal_values;
+    for (const auto& signal : signals) {
+        signal_semaphores.push_back(signal.semaphore);
+        signal_values.push_back(signal.value);
+    }
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount = (uint32_t)wait_values.size(),
+        .pWaitSemaphoreValues = wait_values.data(),
+        .signalSemaphoreValueCount = (uint32_t)signal_values.size(),
+        .pSignalSemaphoreValues = signal_values.data(),
+    };
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_info,
+        .waitSemaphoreCount = (uint32_t)wait_semaphores.size(),
+        .pWaitSemaphores = wait_semaphores.data(),
+        .pWaitDstStageMask = wait_stages.data(),
+        .commandBufferCount = command_buffer_count,
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = (uint32_t)signal_semaphores.size(),
+        .pSignalSemaphores = signal_semaphores.data(),
+    };
+
+    return vkQueueSubmit(queue, 1, &submit_info, fence);
+}
+
+void RenderGraph::execute(const RenderGraphExecuteInfo& info) {
+    if (!m_compiled) {
+        throw std::runtime_error("RenderGraph::execute called before compile");
+    }
+
+    FrameCommands& frame = m_frames[info.frame_index];
+
+    // Normally long signalled: the caller's fence covers the last graphics batch of this slot
+    VkSemaphore wait_semaphores[2];
+    uint64_t wait_values[2];
+    uint32_t wait_count = 0;
+    for (uint32_t queue = 0; queue < 2; queue++) {
+        if (frame.queues[queue].timeline_value > 0) {
+            wait_semaphores[wait_count] = m_timelines[queue];
+            wait_values[wait_count] = frame.queues[queue].timeline_value;
+            wait_count++;
+        }
+    }
+
+    if (wait_count > 0) {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = wait_count,
+            .pSemaphores = wait_semaphores,
+            .pValues = wait_values,
+        };
+        if (vkWaitSemaphores(m_device, &wait_info, UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+            throw DeviceLostError("Device lost waiting for render graph command buffers");
+        }
+    }
+
+    for (auto& commands : frame.queues) {
+        if (commands.used > 0) {
+            vkResetCommandPool(m_device, commands.pool, 0);
+            commands.used = 0;
+        }
+    }
+
+    int32_t first_graphics = -1;
+    int32_t last_graphics = -1;
+    for (int32_t b = 0; b < (int32_t)m_batches.size(); b++) {
+        if (m_batches[b].queue == RenderQueue::Graphics) {
+            if (first_graphics < 0) {
+                first_graphics = b;
+            }
+            last_graphics = b;
+        }
+    }
+
+    int32_t fault_pass = -1;
+    if (m_inject_device_lost) {
+        m_inject_device_lost = false;
+        fault_pass = find_fault_pass();
+    }
+    if (m_breadcrumbs) {
+        m_breadcrumbs->begin_frame();
+    }
+
+    std::vector<uint64_t> batch_values(m_batches.size(), 0);
+    // What the previous frame left on each queue, for the transients it shares with this one
+    uint64_t previous_values[2] = {m_timeline_values[0], m_timeline_values[1]};
+    bool queue_started[2] = {false, false};
+
+    for (int32_t b = 0; b < (int32_t)m_batches.size(); b++) {
+        Batch& batch = m_batches[b];
+        uint32_t queue = (uint32_t)batch.queue;
+        QueueCommands& commands = frame.queues[queue];
+
+        std::vector<VkSemaphoreSubmitInfo> waits;
+        if (batch.wait_batch >= 0) {
+            waits.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = m_timelines[(uint32_t)m_batches[batch.wait_batch].queue],
+                .value = batch_values[batch.wait_batch],
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            });
+        } else if (!queue_started[queue] && m_frame_waits[queue] && previous_values[1 - queue] > 0) {
+            waits.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = m_timelines[1 - queue],
+                .value = previous_values[1 - queue],
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            });
+        }
+        bool first_on_queue = !queue_started[queue];
+        queue_started[queue] = true;
+        if (b == first_graphics && info.wait_semaphore != VK_NULL_HANDLE) {
+            waits.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = info.wait_semaphore,
+                .stageMask = info.wait_stage,
+            });
+        }
+        if (first_on_queue && info.wait_timeline != VK_NULL_HANDLE) {
+            waits.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = info.wait_timeline,
+                .value = info.wait_timeline_value,
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            });
+        }
+
+        VkCommandBuffer command_buffer = next_command_buffer(commands);
+
+        VkCommandBufferBeginInfo begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin render graph command buffer");
+        }
+
+        // The profiler's statistics query can't span command buffers, so every graphics batch gets one
+        bool profiled = m_profiler != nullptr && batch.queue == RenderQueue::Graphics;
+        if (profiled) {
+            m_profiler->begin_commands(command_buffer);
+        }
+
+        if (b == first_graphics && info.prologue) {
+            info.prologue(command_buffer);
+        }
+
+        for (auto p : batch.passes) {
+            Pass& pass = m_passes[p];
+            record_barriers(command_buffer, pass.image_barriers, pass.image_barrier_resources, pass.memory_barriers);
+
+            if (m_breadcrumbs) {
+                m_breadcrumbs->record_begin(command_buffer, p);
+            }
+            if ((int32_t)p == fault_pass) {
+                simulate_device_lost(vk_queue(batch.queue), waits, command_buffer, pass, info, first_graphics >= 0 && b >= first_graphics);
+            }
+
+            {
+                // Profiler queries are reset in the first graphics batch, so only graphics passes get scopes
+                PROFILE_GPU_SCOPE(batch.queue == RenderQueue::Graphics ? m_profiler : nullptr, command_buffer, pass.name);
+                pass.fn(command_buffer);
+            }
+
+            if (m_breadcrumbs) {
+                m_breadcrumbs->record_end(command_buffer, p);
+            }
+        }
+
+        record_barriers(command_buffer, batch.final_image_barriers, batch.final_image_resources, batch.final_memory_barriers);
+
+        if (b == last_graphics && info.epilogue) {
+            info.epilogue(command_buffer);
+        }
+
+        if (profiled) {
+            m_profiler->end_commands(command_buffer);
+        }
+
+        if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record render graph command buffer");
+        }
+
+        batch_values[b] = ++m_timeline_values[queue];
+        commands.timeline_value = batch_values[b];
+
+        std::vector<VkSemaphoreSubmitInfo> signals = {{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+            .semaphore = m_timelines[queue],
+            .value = batch_values[b],
+            .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        }};
+        if (b == last_graphics && info.signal_semaphore != VK_NULL_HANDLE) {
+            signals.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = info.signal_semaphore,
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            });
+        }
+
+        VkFence fence = b == last_graphics ? info.fence : VK_NULL_HANDLE;
+        VkResult result = submit(vk_queue(batch.queue), waits, command_buffer, signals, fence);
+        if (result == VK_ERROR_DEVICE_LOST) {
+            throw DeviceLostError(std::string("Device lost submitting render graph batch ") + std::to_string(b));
+        }
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error(std::string("Failed to submit render graph batch ") + std::to_string(b));
+        }
+    }
+
+    // Keep the caller's semaphores and fence balanced even if every graphics pass was culled
+    if (first_graphics < 0 && (info.wait_semaphore != VK_NULL_HANDLE || info.signal_semaphore != VK_NULL_HANDLE || info.fence != VK_NULL_HANDLE)) {
+        std::vector<VkSemaphoreSubmitInfo> waits;
+        if (info.wait_semaphore != VK_NULL_HANDLE) {
+            waits.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = info.wait_semaphore,
+                .stageMask = info.wait_stage,
+            });
+        }
+
+        std::vector<VkSemaphoreSubmitInfo> signals;
+        if (info.signal_semaphore != VK_NULL_HANDLE) {
+            signals.push_back({
+                .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                .semaphore = info.signal_semaphore,
+                .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+            });
+        }
+
+        if (submit(m_queues.graphics_queue, waits, VK_NULL_HANDLE, signals, info.fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit empty render graph frame");
+        }
+    }
+}
+
+void RenderGraph::report() const {
+    std::cout << "Render graph: " << m_stats.declared_passes - m_stats.culled_passes << "/" << m_stats.declared_passes << " passes ("
+              << m_stats.culled_passes << " culled) in " << m_stats.batches << " batches, " << m_stats.queue_waits << " queue waits\n";
+    std::cout << "  barriers (" << (m_synchronization2 ? "sync2" : "sync1") << "): " << m_stats.barrier_calls << " calls, " << m_stats.image_barriers << " image, " << m_stats.memory_barriers
+              << " memory; naive " << m_stats.naive_barrier_calls << " calls, " << m_stats.naive_image_barriers << " image\n";
+
+    if (m_stats.transient_resources > 0) {
+        std::cout << "  transients: " << m_stats.transient_resources << " resources in " << m_stats.memory_buckets << " allocations, "
+                  << m_stats.aliased_bytes << " bytes (" << m_stats.transient_bytes << " without aliasing)\n";
+    }
+
+    for (uint32_t b = 0; b < m_batches.size(); b++) {
+        const Batch& batch = m_batches[b];
+        std::cout << "  batch " << b << (batch.queue == RenderQueue::Graphics ? " graphics:" : " compute:");
+        for (auto p : batch.passes) {
+            std::cout << " " << m_passes[p].name;
+        }
+        if (batch.wait_batch >= 0) {
+            std::cout << " (waits on batch " << batch.wait_batch << ")";
+        }
+        std::cout << "\n";
+    }
+}
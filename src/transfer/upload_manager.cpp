@@ -0,0 +1,352 @@
+#include "transfer/upload_manager.h"
+#include "debug/device_lost.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+const VkDeviceSize STAGING_ALIGNMENT = 16;
+
+UploadManager::UploadManager(VkDevice device, DeviceAllocator& allocator, const UploadQueues& queues, uint32_t frame_count, VkDeviceSize staging_size)
+    : m_device(device), m_allocator(allocator), m_queues(queues), m_ring(staging_size, frame_count) {
+    VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = staging_size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    if (vkCreateBuffer(m_device, &buffer_info, m_allocator.host_allocator(), &m_staging_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create staging buffer");
+    }
+
+    m_staging_memory = m_allocator.allocate_buffer(m_staging_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    VkSemaphoreTypeCreateInfo timeline_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphore_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timeline_info,
+    };
+
+    if (vkCreateSemaphore(m_device, &semaphore_info, m_allocator.host_allocator(), &m_timeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create upload timeline semaphore");
+    }
+
+    m_frames.resize(frame_count);
+    for (auto& frame : m_frames) {
+        VkCommandPoolCreateInfo pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = m_queues.transfer_family,
+        };
+
+        if (vkCreateCommandPool(m_device, &pool_info, m_allocator.host_allocator(), &frame.command_pool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create upload command pool");
+        }
+
+        VkCommandBufferAllocateInfo alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = frame.command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+        if (vkAllocateCommandBuffers(m_device, &alloc_info, &frame.command_buffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate upload command buffer");
+        }
+    }
+}
+
+UploadManager::~UploadManager() {
+    wait_idle();
+
+    for (auto& frame : m_frames) {
+        vkDestroyCommandPool(m_device, frame.command_pool, m_allocator.host_allocator());
+    }
+
+    vkDestroySemaphore(m_device, m_timeline, m_allocator.host_allocator());
+    vkDestroyBuffer(m_device, m_staging_buffer, m_allocator.host_allocator());
+    m_allocator.free(m_staging_memory);
+}
+
+void UploadManager::begin_frame(uint32_t frame_index) {
+    FrameSlot& frame = m_frames[frame_index];
+
+    if (frame.timeline_value > 0) {
+        VkSemaphoreWaitInfo wait_info = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &m_timeline,
+            .pValues = &frame.timeline_value,
+        };
+        if (vkWaitSemaphores(m_device, &wait_info, UINT64_MAX) == VK_ERROR_DEVICE_LOST) {
+            throw DeviceLostError("Device lost waiting for an upload batch");
+        }
+
+        vkResetCommandPool(m_device, frame.command_pool, 0);
+        frame.timeline_value = 0;
+    }
+
+    m_ring.begin_frame(frame_index);
+    m_frame_index = frame_index;
+
+    poll();
+}
+
+bool UploadManager::stage(const void* data, VkDeviceSize size, VkDeviceSize& offset) {
+    if (!m_ring.allocate(size, STAGING_ALIGNMENT, offset)) {
+        return false;
+    }
+
+    std::memcpy((char*)m_staging_memory.mapped + offset, data, size);
+    m_enqueue_times.push_back(clock::now());
+    m_stats.bytes += size;
+    m_stats.upload_count++;
+    return true;
+}
+
+bool UploadManager::upload_buffer(VkBuffer dst, VkDeviceSize dst_offset, const void* data, VkDeviceSize size, bool concurrent) {
+    VkDeviceSize staging_offset;
+    if (!stage(data, size, staging_offset)) {
+        return false;
+    }
+
+    m_buffer_copies.push_back({
+        .dst = dst,
+        .region = {
+            .srcOffset = staging_offset,
+            .dstOffset = dst_offset,
+            .size = size
+        },
+        .concurrent = concurrent,
+    });
+    return true;
+}
+
+bool UploadManager::upload_image(VkImage dst, VkExtent3D extent, VkImageLayout final_layout, const void* data, VkDeviceSize size, uint32_t mip_level) {
+    VkDeviceSize staging_offset;
+    if (!stage(data, size, staging_offset)) {
+        return false;
+    }
+
+    m_image_copies.push_back({
+        .dst = dst,
+        .region = {
+            .bufferOffset = staging_offset,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = mip_level,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = {0, 0, 0},
+            .imageExtent = extent,
+        },
+        .range = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = mip_level,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .final_layout = final_layout,
+    });
+    return true;
+}
+
+uint64_t UploadManager::flush() {
+    if (m_buffer_copies.empty() && m_image_copies.empty()) {
+        return 0;
+    }
+
+    FrameSlot& frame = m_frames[m_frame_index];
+    if (frame.timeline_value > 0) {
+        throw std::runtime_error("UploadManager::flush called twice in one frame");
+    }
+
+    VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    if (vkBeginCommandBuffer(frame.command_buffer, &begin_info) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin upload command buffer");
+    }
+
+    std::vector<VkImageMemoryBarrier> to_transfer;
+    for (const auto& copy : m_image_copies) {
+        to_transfer.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = copy.dst,
+            .subresourceRange = copy.range,
+        });
+    }
+
+    if (!to_transfer.empty()) {
+        vkCmdPipelineBarrier(frame.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr, (uint32_t)to_transfer.size(), to_transfer.data());
+    }
+
+    for (const auto& copy : m_buffer_copies) {
+        vkCmdCopyBuffer(frame.command_buffer, m_staging_buffer, copy.dst, 1, &copy.region);
+    }
+
+    for (const auto& copy : m_image_copies) {
+        vkCmdCopyBufferToImage(frame.command_buffer, m_staging_buffer, copy.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+    }
+
+    // Same family: plain barriers make the writes visible. Dedicated family: release ownership to
+    // graphics; the acquire half is recorded by record_acquire_barriers. Concurrent buffers are left
+    // to the consumer's timeline wait, which makes the copies visible on any queue.
+    bool dedicated = uses_dedicated_queue();
+    uint32_t src_family = dedicated ? m_queues.transfer_family : VK_QUEUE_FAMILY_IGNORED;
+    uint32_t dst_family = dedicated ? m_queues.graphics_family : VK_QUEUE_FAMILY_IGNORED;
+
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+    for (const auto& copy : m_buffer_copies) {
+        if (dedicated && copy.concurrent) {
+            continue;
+        }
+        buffer_barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = dedicated ? 0u : (VkAccessFlags)VK_ACCESS_MEMORY_READ_BIT,
+            .srcQueueFamilyIndex = src_family,
+            .dstQueueFamilyIndex = dst_family,
+            .buffer = copy.dst,
+            .offset = copy.region.dstOffset,
+            .size = copy.region.size,
+        });
+    }
+
+    std::vector<VkImageMemoryBarrier> image_barriers;
+    for (const auto& copy : m_image_copies) {
+        image_barriers.push_back({
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = dedicated ? 0u : (VkAccessFlags)VK_ACCESS_MEMORY_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .newLayout = copy.final_layout,
+            .srcQueueFamilyIndex = src_family,
+            .dstQueueFamilyIndex = dst_family,
+            .image = copy.dst,
+            .subresourceRange = copy.range,
+        });
+    }
+
+    VkPipelineStageFlags dst_stage = dedicated ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    vkCmdPipelineBarrier(frame.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage, 0,
+                         0, nullptr, (uint32_t)buffer_barriers.size(), buffer_barriers.data(), (uint32_t)image_barriers.size(), image_barriers.data());
+
+    if (vkEndCommandBuffer(frame.command_buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to record upload command buffer");
+    }
+
+    uint64_t signal_value = ++m_timeline_value;
+
+    VkTimelineSemaphoreSubmitInfo timeline_submit = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &signal_value,
+    };
+
+    VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = &timeline_submit,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &frame.command_buffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &m_timeline,
+    };
+
+    VkResult result = vkQueueSubmit(m_queues.transfer_queue, 1, &submit_info, VK_NULL_HANDLE);
+    if (result == VK_ERROR_DEVICE_LOST) {
+        throw DeviceLostError("Device lost submitting upload batch");
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit upload batch");
+    }
+
+    frame.timeline_value = signal_value;
+    m_in_flight.push_back({signal_value, std::move(m_enqueue_times)});
+    m_enqueue_times.clear();
+    m_stats.batch_count++;
+
+    if (dedicated) {
+        for (auto& barrier : buffer_barriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        }
+        for (auto& barrier : image_barriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        }
+        m_acquire_buffers.insert(m_acquire_buffers.end(), buffer_barriers.begin(), buffer_barriers.end());
+        m_acquire_images.insert(m_acquire_images.end(), image_barriers.begin(), image_barriers.end());
+    }
+
+    m_buffer_copies.clear();
+    m_image_copies.clear();
+
+    return signal_value;
+}
+
+void UploadManager::record_acquire_barriers(VkCommandBuffer command_buffer) {
+    if (m_acquire_buffers.empty() && m_acquire_images.empty()) {
+        return;
+    }
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                         0, nullptr, (uint32_t)m_acquire_buffers.size(), m_acquire_buffers.data(), (uint32_t)m_acquire_images.size(), m_acquire_images.data());
+
+    m_acquire_buffers.clear();
+    m_acquire_images.clear();
+}
+
+void UploadManager::poll() {
+    if (m_in_flight.empty()) {
+        return;
+    }
+
+    uint64_t completed;
+    vkGetSemaphoreCounterValue(m_device, m_timeline, &completed);
+
+    auto now = clock::now();
+    while (!m_in_flight.empty() && m_in_flight.front().timeline_value <= completed) {
+        for (auto enqueue_time : m_in_flight.front().enqueue_times) {
+            double latency_ms = std::chrono::duration<double, std::milli>(now - enqueue_time).count();
+            m_stats.total_latency_ms += latency_ms;
+            m_stats.max_latency_ms = std::max(m_stats.max_latency_ms, latency_ms);
+            m_stats.completed_count++;
+        }
+        m_in_flight.pop_front();
+    }
+}
+
+void UploadManager::wait_idle() {
+    if (m_timeline_value == 0) {
+        return;
+    }
+
+    VkSemaphoreWaitInfo wait_info = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &m_timeline,
+        .pValues = &m_timeline_value,
+    };
+    vkWaitSemaphores(m_device, &wait_info, UINT64_MAX);
+
+    poll();
+}
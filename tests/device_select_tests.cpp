@@ -0,0 +1,120 @@
+#include "test.h"
+#include "device/device_selector.h"
+#include "pipeline/builtin_shaders.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Highest SPIR-V version a Vulkan 1.2 device has to accept
+const uint32_t SPIRV_VERSION_1_5 = 0x00010500;
+
+static DeviceCandidate mock_device(const char* name, VkPhysicalDeviceType type, VkDeviceSize device_local_mib, uint8_t uuid_tag) {
+    DeviceCandidate candidate;
+    candidate.name = name;
+    candidate.uuid[0] = uuid_tag;
+    candidate.type = type;
+    candidate.api_version = VK_API_VERSION_1_3;
+    candidate.device_local_bytes = device_local_mib * 1024 * 1024;
+    candidate.max_image_dimension_2d = 16384;
+    candidate.max_compute_shared_memory = 32768;
+    candidate.graphics_queue = true;
+    candidate.present_queue = true;
+    candidate.timeline_semaphore = true;
+    candidate.synchronization2 = true;
+    candidate.bindless = true;
+    candidate.indirect_count = true;
+    candidate.dynamic_rendering = true;
+    candidate.swapchain_adequate = true;
+    candidate.combined_graphics_present = true;
+    return candidate;
+}
+
+// Selection on a mocked device list; an override that has to be rejected comes back as -1 too
+static int32_t select(const std::vector<DeviceCandidate>& candidates, const std::string& override_device = "") {
+    std::vector<DeviceScore> scores;
+    try {
+        return select_device(candidates, override_device, scores);
+    } catch (const std::runtime_error&) {
+        return -1;
+    }
+}
+
+// A Vulkan 1.2 device is only selectable if every shader module the engine can hand it, built-in or
+// compiled by the pluto_shaders target, is SPIR-V 1.5 or older. The version is the header's second word.
+static void check_spirv_versions() {
+    CHECK(noop_compute_spirv[1] <= SPIRV_VERSION_1_5);
+    CHECK(scene_cull_spirv[1] <= SPIRV_VERSION_1_5);
+    CHECK(scene_vertex_spirv[1] <= SPIRV_VERSION_1_5);
+    CHECK(scene_fragment_spirv[1] <= SPIRV_VERSION_1_5);
+    CHECK(image_filter_spirv[1] <= SPIRV_VERSION_1_5);
+
+#ifdef PLUTO_SHADER_BINARY_DIR
+    uint32_t compiled = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(PLUTO_SHADER_BINARY_DIR)) {
+        if (entry.path().extension() != ".spv") {
+            continue;
+        }
+
+        uint32_t header[2] = {};
+        std::ifstream file(entry.path(), std::ios::binary);
+        file.read((char*)header, sizeof(header));
+        if (header[1] > SPIRV_VERSION_1_5) {
+            std::cout << "  " << entry.path().filename().string() << " is newer than SPIR-V 1.5\n";
+        }
+        CHECK(header[1] <= SPIRV_VERSION_1_5);
+        compiled++;
+    }
+    CHECK(compiled > 0);
+#endif
+}
+
+bool device_select_tests() {
+    DeviceCandidate discrete = mock_device("Mock Discrete", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192, 0xd1);
+    discrete.async_compute_queue = true;
+    discrete.dedicated_transfer_queue = true;
+    discrete.pipeline_statistics = true;
+
+    // Shared system memory shows up as a large device local heap
+    DeviceCandidate integrated = mock_device("Mock Integrated", VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU, 32768, 0x1a);
+    integrated.pipeline_statistics = true;
+
+    DeviceCandidate cpu = mock_device("Mock llvmpipe", VK_PHYSICAL_DEVICE_TYPE_CPU, 2048, 0xc0);
+
+    DeviceCandidate old_discrete = mock_device("Mock Old Discrete", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 16384, 0x0d);
+    old_discrete.api_version = VK_API_VERSION_1_1;
+
+    // Usable through the classic render pass path, but ranked below an equal 1.3 device
+    DeviceCandidate vulkan12 = mock_device("Mock Vulkan 1.2 Discrete", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 8192, 0x12);
+    vulkan12.api_version = VK_API_VERSION_1_2;
+    vulkan12.synchronization2 = false;
+    vulkan12.dynamic_rendering = false;
+    vulkan12.async_compute_queue = true;
+    vulkan12.dedicated_transfer_queue = true;
+    vulkan12.pipeline_statistics = true;
+
+    DeviceCandidate headless_only = mock_device("Mock Compute Card", VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU, 16384, 0xcc);
+    headless_only.present_queue = false;
+    headless_only.combined_graphics_present = false;
+
+    // Integrated listed first still loses to the discrete GPU
+    CHECK(select({integrated, discrete}) == 1);
+    // Unsuitable devices are skipped
+    CHECK(select({old_discrete, headless_only, cpu, integrated}) == 3);
+    // A Vulkan 1.2 device is accepted when nothing better is around, but loses to 1.3
+    CHECK(select({old_discrete, vulkan12, cpu}) == 1);
+    CHECK(select({vulkan12, discrete}) == 1);
+
+    CHECK(select({integrated, discrete}, "integrated") == 0);
+    CHECK(select({integrated, discrete, cpu}, format_uuid(cpu.uuid)) == 2);
+    // Overrides naming an unsuitable device or nothing at all are rejected
+    CHECK(select({old_discrete, discrete}, "old discrete") == -1);
+    CHECK(select({integrated, discrete}, "no such gpu") == -1);
+
+    CHECK(select({old_discrete, headless_only}) == -1);
+
+    check_spirv_versions();
+    return true;
+}
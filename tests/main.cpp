@@ -0,0 +1,68 @@
+#include "test.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// CTest's SKIP_RETURN_CODE, see CMakeLists.txt
+const int EXIT_SKIPPED = 77;
+
+typedef struct TestGroup {
+    const char* name;
+    bool (*run)();
+} TestGroup;
+
+static const TestGroup TEST_GROUPS[] = {
+    {"memory", memory_tests},
+    {"device_select", device_select_tests},
+    {"render_graph", render_graph_tests},
+    {"math", math_tests},
+};
+
+static uint32_t g_checks = 0;
+static uint32_t g_failures = 0;
+
+void record_check(bool passed, const char* expression, const char* file, int line) {
+    g_checks++;
+    if (!passed) {
+        g_failures++;
+        std::cout << "  FAILED " << file << ":" << line << ": " << expression << "\n";
+    }
+}
+
+// pluto_tests [group]; without a group every group runs
+int main(int argc, char** argv) {
+    const char* selected = argc > 1 ? argv[1] : nullptr;
+    bool found = false;
+    bool ran = false;
+
+    try {
+        for (const auto& group : TEST_GROUPS) {
+            if (selected != nullptr && std::strcmp(selected, group.name) != 0) {
+                continue;
+            }
+            found = true;
+
+            std::cout << "== " << group.name << "\n";
+            if (group.run()) {
+                ran = true;
+            } else {
+                std::cout << "  skipped\n";
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!found) {
+        std::cerr << "No test group named " << selected << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << g_checks - g_failures << " / " << g_checks << " checks passed\n";
+    if (g_failures > 0) {
+        return EXIT_FAILURE;
+    }
+    return ran ? EXIT_SUCCESS : EXIT_SKIPPED;
+}
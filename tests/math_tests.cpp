@@ -0,0 +1,142 @@
+#include "test.h"
+#include "math/math.h"
+#include "math/soa_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Not a multiple of any SIMD width, so every kernel's scalar tail runs too
+const uint32_t OBJECT_COUNT = 4099;
+const uint32_t HIERARCHY_DEPTH = 4;
+// SIMD paths reorder and fuse operations, so they only match the scalar reference to rounding
+const float TOLERANCE = 1e-3f;
+
+typedef struct Scene {
+    TransformSoA local;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> levels;
+    AabbSoA boxes;
+    std::vector<Mat4> models;
+    Mat4 view_proj;
+    Vec4 planes[6];
+} Scene;
+
+typedef struct Results {
+    TransformSoA world;
+    std::vector<Mat4> matrices;
+    std::vector<Mat4> mvp;
+    std::vector<uint32_t> visible;
+} Results;
+
+// A forest sorted by depth with parents picked from the level above, boxes scattered around the
+// frustum so some are inside, some outside and some straddle a plane
+static Scene make_scene() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    Scene scene;
+    scene.local.resize(OBJECT_COUNT);
+    scene.parents.resize(OBJECT_COUNT);
+    scene.boxes.resize(OBJECT_COUNT);
+    scene.models.resize(OBJECT_COUNT);
+
+    uint32_t roots = OBJECT_COUNT / 8;
+    uint32_t per_level = (OBJECT_COUNT - roots) / (HIERARCHY_DEPTH - 1);
+    uint32_t parent_begin = 0, level_begin = 0, level_end = roots;
+    for (uint32_t i = 0; i < OBJECT_COUNT; i++) {
+        if (i == level_end) {
+            parent_begin = level_begin;
+            level_begin = level_end;
+            level_end = std::min(OBJECT_COUNT, level_end + per_level);
+        }
+
+        bool root = level_begin == 0;
+        if (root) {
+            scene.parents[i] = -1;
+        } else {
+            std::uniform_int_distribution<uint32_t> parent(parent_begin, level_begin - 1);
+            scene.parents[i] = (int32_t)parent(rng);
+        }
+
+        Vec3 position = Vec3{unit(rng), unit(rng), unit(rng)} * (root ? 50.0f : 2.0f);
+        Quat rotation = quat_axis_angle({unit(rng), unit(rng), unit(rng) + 1.5f}, unit(rng) * 3.14159f);
+        scene.local.set(i, position, rotation, 0.75f + 0.25f * unit(rng));
+        scene.boxes.set(i, Vec3{unit(rng), unit(rng), unit(rng)} * 60.0f, {1.0f, 1.0f, 1.0f});
+    }
+    scene.levels = hierarchy_levels(scene.parents.data(), OBJECT_COUNT);
+
+    transforms_to_matrices(scene.local, scene.models.data());
+
+    scene.view_proj = multiply(perspective(1.0f, 16.0f / 9.0f, 0.1f, 200.0f), look_at({0.0f, 10.0f, 80.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}));
+    frustum_planes(scene.view_proj, scene.planes);
+    return scene;
+}
+
+static Results run_level(const Scene& scene, SimdLevel level) {
+    set_simd_level(level);
+
+    Results results;
+    results.matrices.resize(OBJECT_COUNT);
+    results.mvp.resize(OBJECT_COUNT);
+    results.visible.resize(OBJECT_COUNT);
+
+    compose_hierarchy(scene.local, scene.parents.data(), scene.levels, results.world);
+    transforms_to_matrices(results.world, results.matrices.data());
+    multiply_matrices(scene.view_proj, scene.models.data(), results.mvp.data(), OBJECT_COUNT);
+    results.visible.resize(cull_aabbs(scene.boxes, scene.planes, results.visible.data()));
+    return results;
+}
+
+static float max_difference(const std::vector<float>& a, const std::vector<float>& b) {
+    float difference = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        difference = std::max(difference, std::fabs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+static float max_difference(const TransformSoA& a, const TransformSoA& b) {
+    return std::max({max_difference(a.position_x, b.position_x), max_difference(a.position_y, b.position_y), max_difference(a.position_z, b.position_z),
+                     max_difference(a.rotation_x, b.rotation_x), max_difference(a.rotation_y, b.rotation_y), max_difference(a.rotation_z, b.rotation_z),
+                     max_difference(a.rotation_w, b.rotation_w), max_difference(a.scale, b.scale)});
+}
+
+static float max_difference(const std::vector<Mat4>& a, const std::vector<Mat4>& b) {
+    float difference = 0.0f;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (uint32_t j = 0; j < 16; j++) {
+            difference = std::max(difference, std::fabs(a[i].m[j] - b[i].m[j]));
+        }
+    }
+    return difference;
+}
+
+// Every SIMD level this CPU supports against the scalar path. Levels above detected_simd_level()
+// would silently run a narrower path, so they are left out rather than counted as passes.
+bool math_tests() {
+    Scene scene = make_scene();
+    SimdLevel detected = detected_simd_level();
+    Results reference = run_level(scene, SimdLevel::Scalar);
+
+    // The frustum has to split the scene for the cull comparison to mean anything
+    CHECK(!reference.visible.empty() && reference.visible.size() < OBJECT_COUNT);
+
+    for (SimdLevel level : {SimdLevel::SSE, SimdLevel::AVX2}) {
+        if (level > detected) {
+            continue;
+        }
+        std::cout << "  " << simd_level_name(level) << "\n";
+
+        Results results = run_level(scene, level);
+        CHECK(results.world.size() == OBJECT_COUNT);
+        CHECK(max_difference(results.world, reference.world) <= TOLERANCE);
+        CHECK(max_difference(results.matrices, reference.matrices) <= TOLERANCE);
+        CHECK(max_difference(results.mvp, reference.mvp) <= TOLERANCE);
+        CHECK(results.visible == reference.visible);
+    }
+
+    set_simd_level(detected);
+    return true;
+}
@@ -0,0 +1,126 @@
+#include "test.h"
+#include "memory/ring_arena.h"
+#include "memory/tlsf_pool.h"
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+const uint64_t POOL_SIZE = 4 << 20;
+const uint32_t STRESS_ITERATIONS = 20000;
+const uint32_t STRESS_LIVE = 128;
+
+static void check_tlsf_exact_fit() {
+    TlsfPool pool(4096);
+    uint64_t offset = 1;
+    uint32_t handle = TlsfPool::INVALID_HANDLE;
+
+    CHECK(pool.allocate(4096, 16, offset, handle));
+    CHECK(offset == 0);
+    CHECK(pool.free_bytes() == 0);
+
+    uint64_t other_offset;
+    uint32_t other_handle;
+    CHECK(!pool.allocate(16, 16, other_offset, other_handle));
+
+    pool.free(handle);
+    CHECK(pool.empty());
+    CHECK(pool.largest_free_block() == 4096);
+}
+
+// Random sizes and alignments against a shadow map of live ranges: every allocation has to be
+// aligned, in bounds and clear of every other one, and freeing everything has to coalesce back
+// into one block
+static void check_tlsf_stress() {
+    TlsfPool pool(POOL_SIZE);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint64_t> sizes(1, 4096);
+    std::uniform_int_distribution<uint32_t> alignment_log2(0, 12);
+
+    typedef struct Live {
+        uint32_t handle = TlsfPool::INVALID_HANDLE;
+        uint64_t offset = 0;
+    } Live;
+
+    std::vector<Live> live(STRESS_LIVE);
+    std::map<uint64_t, uint64_t> ranges;
+    bool aligned = true, in_bounds = true, disjoint = true;
+    uint32_t failed_allocations = 0;
+
+    for (uint32_t i = 0; i < STRESS_ITERATIONS; i++) {
+        Live& slot = live[rng() % STRESS_LIVE];
+        if (slot.handle != TlsfPool::INVALID_HANDLE) {
+            pool.free(slot.handle);
+            ranges.erase(slot.offset);
+            slot.handle = TlsfPool::INVALID_HANDLE;
+        }
+
+        uint64_t size = sizes(rng);
+        uint64_t alignment = 1ull << alignment_log2(rng);
+        if (!pool.allocate(size, alignment, slot.offset, slot.handle)) {
+            failed_allocations++;
+            continue;
+        }
+
+        aligned &= slot.offset % alignment == 0;
+        in_bounds &= slot.offset + size <= POOL_SIZE;
+
+        auto next = ranges.lower_bound(slot.offset);
+        if (next != ranges.end()) {
+            disjoint &= slot.offset + size <= next->first;
+        }
+        if (next != ranges.begin()) {
+            disjoint &= std::prev(next)->second <= slot.offset;
+        }
+        ranges[slot.offset] = slot.offset + size;
+    }
+
+    CHECK(aligned);
+    CHECK(in_bounds);
+    CHECK(disjoint);
+    // At most 1 MiB is live including alignment padding, so a 4 MiB pool always has room
+    CHECK(failed_allocations == 0);
+    CHECK(pool.allocation_count() == ranges.size());
+
+    for (auto& slot : live) {
+        if (slot.handle != TlsfPool::INVALID_HANDLE) {
+            pool.free(slot.handle);
+        }
+    }
+
+    CHECK(pool.empty());
+    CHECK(pool.used_bytes() == 0);
+    CHECK(pool.largest_free_block() == POOL_SIZE);
+}
+
+static void check_ring_arena() {
+    RingArena ring(1024, 2);
+    uint64_t offset = 1;
+
+    ring.begin_frame(0);
+    CHECK(ring.allocate(400, 1, offset) && offset == 0);
+
+    ring.begin_frame(1);
+    CHECK(ring.allocate(10, 1, offset) && offset == 400);
+    CHECK(ring.allocate(16, 256, offset) && offset == 512);
+    CHECK(ring.allocate(400, 1, offset) && offset == 528);
+    // Frame 0 still holds the start of the ring, so this can neither fit nor wrap
+    CHECK(!ring.allocate(200, 1, offset));
+
+    // Releasing frame 0 frees [0, 400), which a wrapping allocation can then use
+    ring.begin_frame(0);
+    CHECK(ring.allocate(300, 1, offset) && offset == 0);
+    CHECK(!ring.allocate(200, 1, offset));
+
+    ring.begin_frame(1);
+    ring.begin_frame(0);
+    CHECK(ring.used_bytes() == 0);
+    CHECK(ring.allocate(1024, 1, offset) && offset == 0);
+}
+
+bool memory_tests() {
+    check_tlsf_exact_fit();
+    check_tlsf_stress();
+    check_ring_arena();
+    return true;
+}
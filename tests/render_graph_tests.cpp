@@ -0,0 +1,202 @@
+#include "test.h"
+#include "bench_device.h"
+#include "memory/device_allocator.h"
+#include "render/render_graph.h"
+#include <iostream>
+#include <stdexcept>
+
+const uint32_t FRAME_COUNT = 2;
+const VkExtent2D EXTENT = {256, 256};
+
+// Everything runs on the graphics queue so batching and barrier counts don't depend on the device's
+// queue families
+static RenderGraphQueues single_queue(const BenchDevice& bench) {
+    return {
+        .graphics_queue = bench.queue,
+        .graphics_family = bench.queue_family,
+        .compute_queue = bench.queue,
+        .compute_family = bench.queue_family,
+    };
+}
+
+// Passes that feed neither an output nor a side effect pass are dropped, along with whatever only
+// they read
+static void check_culling(const BenchDevice& bench, DeviceAllocator& allocator) {
+    RenderGraph graph(bench.device, allocator, single_queue(bench), FRAME_COUNT);
+    auto nothing = [](VkCommandBuffer) {};
+
+    ResourceHandle color = graph.create_image("color", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    ResourceHandle debug = graph.create_image("debug", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    ResourceHandle histogram = graph.create_buffer("histogram", 256 * sizeof(uint32_t));
+    ResourceHandle readback = graph.create_buffer("readback", 256 * sizeof(uint32_t));
+    graph.mark_output(color);
+
+    PassHandle draw = graph.add_pass("draw", RenderQueue::Graphics, nothing);
+    graph.write(draw, color, ResourceUsage::ColorAttachment);
+
+    PassHandle debug_view = graph.add_pass("debug view", RenderQueue::Graphics, nothing);
+    graph.write(debug_view, debug, ResourceUsage::ColorAttachment);
+
+    PassHandle luminance = graph.add_pass("luminance", RenderQueue::Compute, nothing);
+    graph.read(luminance, debug, ResourceUsage::ComputeSampled);
+    graph.write(luminance, histogram, ResourceUsage::StorageWrite);
+
+    PassHandle copy = graph.add_pass("copy", RenderQueue::Compute, nothing);
+    graph.write(copy, readback, ResourceUsage::StorageWrite);
+    graph.set_side_effects(copy);
+
+    graph.compile();
+
+    const RenderGraphStats& stats = graph.stats();
+    CHECK(stats.declared_passes == 4);
+    CHECK(stats.culled_passes == 2);
+    // Only the resources of surviving passes get memory
+    CHECK(stats.transient_resources == 2);
+}
+
+// draw writes a, blur samples a into b, composite samples a and b into out. The second read of a
+// is already visible in the right layout, so it needs no barrier of its own; every other access
+// is a transition.
+static void check_barriers(const BenchDevice& bench, DeviceAllocator& allocator) {
+    RenderGraph graph(bench.device, allocator, single_queue(bench), FRAME_COUNT);
+    auto nothing = [](VkCommandBuffer) {};
+
+    ResourceHandle a = graph.create_image("a", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    ResourceHandle b = graph.create_image("b", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    ResourceHandle out = graph.create_image("out", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    graph.mark_output(out);
+
+    PassHandle draw = graph.add_pass("draw", RenderQueue::Graphics, nothing);
+    graph.write(draw, a, ResourceUsage::ColorAttachment);
+
+    PassHandle blur = graph.add_pass("blur", RenderQueue::Graphics, nothing);
+    graph.read(blur, a, ResourceUsage::FragmentSampled);
+    graph.write(blur, b, ResourceUsage::ColorAttachment);
+
+    PassHandle composite = graph.add_pass("composite", RenderQueue::Graphics, nothing);
+    graph.read(composite, a, ResourceUsage::FragmentSampled);
+    graph.read(composite, b, ResourceUsage::FragmentSampled);
+    graph.write(composite, out, ResourceUsage::ColorAttachment);
+
+    graph.compile();
+
+    const RenderGraphStats& stats = graph.stats();
+    CHECK(stats.batches == 1);
+    CHECK(stats.queue_waits == 0);
+    CHECK(stats.barrier_calls == 3);
+    CHECK(stats.image_barriers == 5);
+    CHECK(stats.memory_barriers == 0);
+    CHECK(stats.naive_image_barriers == 6);
+
+    // Every lifetime overlaps the others, so nothing can share memory
+    CHECK(stats.memory_buckets == stats.transient_resources);
+    CHECK(stats.aliased_bytes == stats.transient_bytes);
+}
+
+// A chain of same-sized images where each lives for two passes: the first and third never
+// overlap, so at least one pair shares memory
+static void check_aliasing(const BenchDevice& bench, DeviceAllocator& allocator) {
+    RenderGraph graph(bench.device, allocator, single_queue(bench), FRAME_COUNT);
+    auto nothing = [](VkCommandBuffer) {};
+
+    const char* names[] = {"chain 0", "chain 1", "chain 2", "chain 3"};
+    const char* pass_names[] = {"step 0", "step 1", "step 2", "step 3"};
+    ResourceHandle images[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        images[i] = graph.create_image(names[i], VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    }
+    graph.mark_output(images[3]);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        PassHandle pass = graph.add_pass(pass_names[i], RenderQueue::Graphics, nothing);
+        if (i > 0) {
+            graph.read(pass, images[i - 1], ResourceUsage::FragmentSampled);
+        }
+        graph.write(pass, images[i], ResourceUsage::ColorAttachment);
+    }
+
+    graph.compile();
+
+    const RenderGraphStats& stats = graph.stats();
+    CHECK(stats.transient_resources == 4);
+    CHECK(stats.memory_buckets >= 2 && stats.memory_buckets < 4);
+    CHECK(stats.aliased_bytes < stats.transient_bytes);
+    // Each step transitions what it reads and what it writes, aliased or not
+    CHECK(stats.image_barriers == 7);
+}
+
+// The Vulkan 1.2 fallback: barriers folded into vkCmdPipelineBarrier and vkQueueSubmit with chained
+// timeline values. Compiles to the same barriers as sync2, then runs a few frames on the device.
+static void check_synchronization1(const BenchDevice& bench, DeviceAllocator& allocator) {
+    RenderGraph graph(bench.device, allocator, single_queue(bench), FRAME_COUNT, false);
+    auto nothing = [](VkCommandBuffer) {};
+
+    ResourceHandle color = graph.create_image("color", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    ResourceHandle histogram = graph.create_buffer("histogram", 256 * sizeof(uint32_t));
+    ResourceHandle out = graph.create_image("out", VK_FORMAT_R8G8B8A8_UNORM, EXTENT);
+    graph.mark_output(out);
+
+    PassHandle draw = graph.add_pass("draw", RenderQueue::Graphics, nothing);
+    graph.write(draw, color, ResourceUsage::ColorAttachment);
+
+    PassHandle luminance = graph.add_pass("luminance", RenderQueue::Compute, nothing);
+    graph.read(luminance, color, ResourceUsage::ComputeSampled);
+    graph.write(luminance, histogram, ResourceUsage::StorageWrite);
+
+    PassHandle tonemap = graph.add_pass("tonemap", RenderQueue::Graphics, nothing);
+    graph.read(tonemap, color, ResourceUsage::FragmentSampled);
+    graph.read(tonemap, histogram, ResourceUsage::StorageRead);
+    graph.write(tonemap, out, ResourceUsage::ColorAttachment);
+
+    graph.compile();
+    CHECK(graph.stats().culled_passes == 0);
+    CHECK(graph.stats().memory_barriers > 0);
+
+    VkFenceCreateInfo fence_info = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+    };
+    VkFence fences[FRAME_COUNT];
+    for (auto& fence : fences) {
+        CHECK(vkCreateFence(bench.device, &fence_info, nullptr, &fence) == VK_SUCCESS);
+    }
+
+    // More frames than slots, so command buffers and timeline values get reused
+    for (uint32_t frame = 0; frame < FRAME_COUNT * 2; frame++) {
+        uint32_t frame_index = frame % FRAME_COUNT;
+        CHECK(vkWaitForFences(bench.device, 1, &fences[frame_index], VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+        vkResetFences(bench.device, 1, &fences[frame_index]);
+
+        RenderGraphExecuteInfo info = {
+            .frame_index = frame_index,
+            .fence = fences[frame_index],
+        };
+        graph.execute(info);
+    }
+    CHECK(vkWaitForFences(bench.device, FRAME_COUNT, fences, VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+
+    for (auto fence : fences) {
+        vkDestroyFence(bench.device, fence, nullptr);
+    }
+}
+
+bool render_graph_tests() {
+    BenchDevice bench;
+    try {
+        bench = create_bench_device();
+    } catch (const std::runtime_error& e) {
+        std::cout << "  " << e.what() << "\n";
+        return false;
+    }
+
+    {
+        DeviceAllocator allocator(bench.physical_device, bench.device);
+        check_culling(bench, allocator);
+        check_barriers(bench, allocator);
+        check_aliasing(bench, allocator);
+        check_synchronization1(bench, allocator);
+    }
+
+    destroy_bench_device(bench);
+    return true;
+}
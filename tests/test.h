@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Minimal check harness for pluto_tests. A failed CHECK prints the expression and keeps going, so
+// one run lists every failure; main() turns the count into the exit code.
+void record_check(bool passed, const char* expression, const char* file, int line);
+
+#define CHECK(expression) record_check((expression), #expression, __FILE__, __LINE__)
+
+// Test groups, one CTest entry each. They return false when they were skipped, e.g. because there
+// is no Vulkan device to run on.
+bool memory_tests();
+bool device_select_tests();
+bool render_graph_tests();
+bool math_tests();
@@ -0,0 +1,231 @@
+#include "assets/asset_baker.h"
+#include "assets/ppm.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Offline asset baker: converts OBJ meshes (with their MTL materials and the PPM textures those
+// reference) and standalone PPM textures into one asset pack.
+//
+//   pluto_baker -o assets.pak [--rgba8] [--no-mips] model.obj texture.ppm ...
+
+static std::string directory_of(const std::string& path) {
+    size_t split = path.find_last_of("/\\");
+    return split == std::string::npos ? "" : path.substr(0, split + 1);
+}
+
+static std::string stem_of(const std::string& path) {
+    size_t start = path.find_last_of("/\\");
+    start = start == std::string::npos ? 0 : start + 1;
+    size_t end = path.find_last_of('.');
+    return path.substr(start, end == std::string::npos || end < start ? std::string::npos : end - start);
+}
+
+static bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static uint32_t bake_ppm(AssetBaker& baker, const std::string& path, const TextureBakeOptions& options) {
+    std::string name = stem_of(path);
+    uint32_t existing = baker.find(name);
+    if (existing != ASSET_NOT_FOUND) {
+        return existing;
+    }
+
+    uint32_t width, height;
+    std::vector<uint8_t> rgba;
+    load_ppm(path, width, height, rgba);
+    return baker.add_texture(name, width, height, rgba, options);
+}
+
+// Kd, d, Ns (mapped to roughness) and map_Kd; anything else is ignored. Materials from every
+// library end up in one "materials" asset, in the order they were declared.
+static void load_mtl(const std::string& path, AssetBaker& baker, const TextureBakeOptions& options, std::vector<AssetMaterial>& materials) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open material library " + path);
+    }
+
+    AssetMaterial* current = nullptr;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+
+        if (keyword == "newmtl") {
+            materials.push_back({
+                .base_color = {1.0f, 1.0f, 1.0f, 1.0f},
+                .base_color_texture = ASSET_NOT_FOUND,
+                .roughness = 0.5f,
+                .metallic = 0.0f,
+                .padding = 0,
+            });
+            current = &materials.back();
+        } else if (current == nullptr) {
+            continue;
+        } else if (keyword == "Kd") {
+            stream >> current->base_color[0] >> current->base_color[1] >> current->base_color[2];
+        } else if (keyword == "d") {
+            stream >> current->base_color[3];
+        } else if (keyword == "Ns") {
+            float shininess = 0.0f;
+            stream >> shininess;
+            current->roughness = 1.0f - std::min(shininess, 1000.0f) / 1000.0f;
+        } else if (keyword == "map_Kd") {
+            std::string texture;
+            stream >> texture;
+            current->base_color_texture = bake_ppm(baker, directory_of(path) + texture, options);
+        }
+    }
+}
+
+static void bake_obj(const std::string& path, AssetBaker& baker, const TextureBakeOptions& options, std::vector<AssetMaterial>& materials) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open mesh " + path);
+    }
+
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<AssetVertex> vertices;
+    std::vector<uint32_t> indices;
+    // OBJ indexes attributes separately; each distinct position/uv/normal triple is one vertex
+    std::map<std::tuple<int, int, int>, uint32_t> vertex_ids;
+
+    auto resolve = [](int index, size_t count) {
+        return index < 0 ? (int)count + index : index - 1;
+    };
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+
+        if (keyword == "v" || keyword == "vn") {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            stream >> x >> y >> z;
+            std::vector<float>& target = keyword == "v" ? positions : normals;
+            target.insert(target.end(), {x, y, z});
+        } else if (keyword == "vt") {
+            float u = 0.0f, v = 0.0f;
+            stream >> u >> v;
+            // OBJ puts v = 0 at the bottom, Vulkan at the top
+            uvs.insert(uvs.end(), {u, 1.0f - v});
+        } else if (keyword == "mtllib") {
+            std::string library;
+            stream >> library;
+            load_mtl(directory_of(path) + library, baker, options, materials);
+        } else if (keyword == "f") {
+            std::vector<uint32_t> face;
+            std::string corner;
+            while (stream >> corner) {
+                int p = 0, t = 0, n = 0;
+                size_t first = corner.find('/');
+                p = std::stoi(corner.substr(0, first));
+                if (first != std::string::npos) {
+                    size_t second = corner.find('/', first + 1);
+                    std::string uv = corner.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1);
+                    if (!uv.empty()) {
+                        t = std::stoi(uv);
+                    }
+                    if (second != std::string::npos) {
+                        n = std::stoi(corner.substr(second + 1));
+                    }
+                }
+
+                auto key = std::make_tuple(resolve(p, positions.size() / 3), t ? resolve(t, uvs.size() / 2) : -1, n ? resolve(n, normals.size() / 3) : -1);
+                auto found = vertex_ids.find(key);
+                if (found == vertex_ids.end()) {
+                    AssetVertex vertex = {};
+                    int position = std::get<0>(key);
+                    if (position < 0 || (size_t)position * 3 + 2 >= positions.size()) {
+                        throw std::runtime_error("Failed to load mesh " + path + ": vertex index out of range");
+                    }
+                    std::copy_n(&positions[position * 3], 3, vertex.position);
+                    if (std::get<1>(key) >= 0 && (size_t)std::get<1>(key) * 2 + 1 < uvs.size()) {
+                        std::copy_n(&uvs[std::get<1>(key) * 2], 2, vertex.uv);
+                    }
+                    if (std::get<2>(key) >= 0 && (size_t)std::get<2>(key) * 3 + 2 < normals.size()) {
+                        std::copy_n(&normals[std::get<2>(key) * 3], 3, vertex.normal);
+                    }
+                    found = vertex_ids.emplace(key, (uint32_t)vertices.size()).first;
+                    vertices.push_back(vertex);
+                }
+                face.push_back(found->second);
+            }
+
+            // Fan triangulation; fine for the convex polygons exporters write
+            for (size_t i = 2; i < face.size(); i++) {
+                indices.insert(indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+    }
+
+    baker.add_mesh(stem_of(path), vertices, indices);
+    std::cout << stem_of(path) << ": " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles\n";
+}
+
+int main(int argc, char** argv) {
+    std::string output;
+    std::vector<std::string> inputs;
+    TextureBakeOptions options;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "-o" && i + 1 < argc) {
+                output = argv[++i];
+            } else if (arg == "--rgba8") {
+                options.format = VK_FORMAT_R8G8B8A8_UNORM;
+            } else if (arg == "--no-mips") {
+                options.mips = false;
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::runtime_error("Unknown argument: " + arg);
+            } else {
+                inputs.push_back(arg);
+            }
+        }
+
+        if (output.empty() || inputs.empty()) {
+            std::cerr << "usage: pluto_baker -o OUTPUT [--rgba8] [--no-mips] INPUT.obj|INPUT.ppm...\n";
+            return EXIT_FAILURE;
+        }
+
+        AssetBaker baker;
+        std::vector<AssetMaterial> materials;
+
+        for (const std::string& input : inputs) {
+            if (ends_with(input, ".obj")) {
+                bake_obj(input, baker, options, materials);
+            } else if (ends_with(input, ".ppm")) {
+                bake_ppm(baker, input, options);
+            } else {
+                throw std::runtime_error("Don't know how to bake " + input);
+            }
+        }
+
+        if (!materials.empty()) {
+            baker.add_materials("materials", materials);
+        }
+
+        baker.write(output);
+        std::cout << "Wrote " << output << ": " << baker.asset_count() << " assets, " << baker.payload_bytes() / 1024 << " KiB of payload\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}